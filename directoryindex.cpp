@@ -0,0 +1,108 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+#include "directoryindex.h"
+#include "helpers.h"
+#include "logger.h"
+
+constexpr char logModule[] = "dirindex";
+constexpr int maxDirectories = 8;
+
+DirectoryIndex *DirectoryIndex::singleton()
+{
+    // Parented to the application so that the watcher goes away with it.
+    static DirectoryIndex *instance = new DirectoryIndex(qApp);
+    return instance;
+}
+
+DirectoryIndex::DirectoryIndex(QObject *parent) : QObject(parent)
+{
+    connect(&watcher, &QFileSystemWatcher::directoryChanged,
+            this, &DirectoryIndex::watcher_directoryChanged);
+}
+
+QString DirectoryIndex::neighbour(const QString &filePath, int delta)
+{
+    QFileInfo info(filePath);
+    QString directory = info.absolutePath();
+    QString fileName = info.fileName();
+    const QStringList &files = listing(directory);
+
+    auto less = [this](const QString &a, const QString &b) {
+        return lessThan(a, b);
+    };
+    auto it = std::lower_bound(files.begin(), files.end(), fileName, less);
+    qsizetype index = it - files.begin();
+    // When the file is gone, index is where it would have been, which is
+    // already one step forwards.
+    bool present = it != files.end() && *it == fileName;
+    if (delta > 0 && !present)
+        delta--;
+    index += delta;
+    if (index < 0 || index >= files.count())
+        return QString();
+    return QDir(directory).filePath(files[index]);
+}
+
+void DirectoryIndex::setNaturalOrder(bool yes)
+{
+    if (collator.numericMode() == yes)
+        return;
+    collator.setNumericMode(yes);
+    // Everything was sorted the other way
+    for (const QString &directory : std::as_const(recent))
+        watcher.removePath(directory);
+    listings.clear();
+    recent.clear();
+}
+
+const QStringList &DirectoryIndex::listing(const QString &directory)
+{
+    recent.removeOne(directory);
+    recent.append(directory);
+    auto it = listings.find(directory);
+    if (it != listings.end())
+        return it.value();
+
+    while (recent.count() > maxDirectories)
+        dropListing(recent.first());
+
+    QStringList files;
+    QDirIterator dirIterator(directory, QDir::Files);
+    while (dirIterator.hasNext()) {
+        QFileInfo info = dirIterator.nextFileInfo();
+        if (Helpers::audioVideoFileExtensions.contains(info.suffix().toLower().split(" ")[0]))
+            files.append(info.fileName());
+    }
+    std::sort(files.begin(), files.end(), [this](const QString &a, const QString &b) {
+        return lessThan(a, b);
+    });
+    Logger::log(logModule, QString("indexed %1 files in %2").arg(files.count()).arg(directory));
+
+    if (!watcher.directories().contains(directory))
+        watcher.addPath(directory);
+    return listings.insert(directory, files).value();
+}
+
+bool DirectoryIndex::lessThan(const QString &a, const QString &b) const
+{
+    int order = collator.compare(a, b);
+    // The collator may call different names equal; keep them apart so
+    // that the binary search can tell them apart too.
+    return order != 0 ? order < 0 : a < b;
+}
+
+void DirectoryIndex::dropListing(const QString &directory)
+{
+    listings.remove(directory);
+    recent.removeOne(directory);
+    watcher.removePath(directory);
+}
+
+void DirectoryIndex::watcher_directoryChanged(const QString &path)
+{
+    // Relisted on the next lookup, so that a burst of changes costs one
+    listings.remove(path);
+}
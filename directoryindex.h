@@ -0,0 +1,46 @@
+#ifndef DIRECTORYINDEX_H
+#define DIRECTORYINDEX_H
+
+#include <QCollator>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+// DirectoryIndex answers "which file comes before/after this one" for the
+// next and previous file commands.  Each directory asked about is listed
+// once, filtered down to audio and video files and sorted, then watched so
+// that the listing is thrown away when the directory changes.  Lookups are
+// binary searches over the sorted names.  Only the few most recently used
+// directories are kept.  Use from the gui thread.
+class DirectoryIndex : public QObject {
+    Q_OBJECT
+
+public:
+    static DirectoryIndex *singleton();
+
+    // Returns the path of the media file delta places away from filePath
+    // in its directory, or an empty string if there is none.  filePath
+    // itself does not need to exist any more.
+    QString neighbour(const QString &filePath, int delta);
+
+public slots:
+    void setNaturalOrder(bool yes);
+
+private:
+    explicit DirectoryIndex(QObject *parent = nullptr);
+    const QStringList &listing(const QString &directory);
+    bool lessThan(const QString &a, const QString &b) const;
+    void dropListing(const QString &directory);
+
+private slots:
+    void watcher_directoryChanged(const QString &path);
+
+private:
+    QFileSystemWatcher watcher;
+    QCollator collator;
+    QHash<QString, QStringList> listings;
+    QStringList recent;
+};
+
+#endif // DIRECTORYINDEX_H
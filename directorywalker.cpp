@@ -0,0 +1,247 @@
+#include <QCollator>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+#include "directorywalker.h"
+#include "helpers.h"
+#include "logger.h"
+#include "platform/unify.h"
+
+static constexpr char logModule[] = "walker";
+
+// Listing is bound by the disk or the network rather than the cpu, and more
+// threads than this would only fight over the same drive.
+static constexpr int maxWalkerThreads = 4;
+
+// How many urls are given out at once before letting the gui catch up.
+static constexpr int urlsPerChunk = 1000;
+
+DirectoryWalker::DirectoryWalker(QObject *parent)
+    : QObject(parent), cancelled(new QAtomicInt(0))
+{
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+    // Listings still in flight hold a guarded pointer to us and will find
+    // it null when they get back.
+    cancelled->storeRelaxed(1);
+    qDeleteAll(nodes);
+}
+
+void DirectoryWalker::walk(const QList<QUrl> &urls)
+{
+    clock.start();
+
+    // The root stands for the list of urls, and has a child for each
+    // directory in it.  Runs of plain files become leaves, so that they
+    // are given out in their place between the directories.
+    Node *root = new Node;
+    root->listed = true;
+    nodes.append(root);
+    stack.append(root);
+
+    Node *leaf = nullptr;
+    auto addFile = [&](const QUrl &url) {
+        if (!leaf) {
+            leaf = new Node;
+            leaf->listed = true;
+            nodes.append(leaf);
+            root->children.append(leaf);
+        }
+        leaf->files.append(url);
+        filesFound++;
+    };
+
+    for (const QUrl &url : urls) {
+        if (!url.isLocalFile()) {
+            addFile(url);
+            continue;
+        }
+        QFileInfo info(url.toLocalFile());
+        if (info.isDir()) {
+            leaf = nullptr;
+            Node *node = addDirectory(root, info.filePath(),
+                                      Platform::fileIdentity(info.filePath()));
+            if (node)
+                startListing(node);
+            continue;
+        }
+        if (Helpers::allMediaExtensions.contains(info.suffix().toLower().split(" ")[0]))
+            addFile(url);
+    }
+    sendReady();
+}
+
+void DirectoryWalker::cancel()
+{
+    if (done)
+        return;
+    cancelled->storeRelaxed(1);
+    Logger::log(logModule, "cancelled");
+    finish();
+}
+
+bool DirectoryWalker::isCancelled() const
+{
+    return cancelled->loadRelaxed() != 0;
+}
+
+QThreadPool *DirectoryWalker::pool()
+{
+    static QThreadPool *walkerPool = nullptr;
+    if (!walkerPool) {
+        walkerPool = new QThreadPool(qApp);
+        walkerPool->setMaxThreadCount(maxWalkerThreads);
+    }
+    return walkerPool;
+}
+
+DirectoryWalker::Listing DirectoryWalker::listDirectory(const QString &path,
+                                                        const QSharedPointer<QAtomicInt> &cancelled)
+{
+    Listing listing;
+    if (cancelled->loadRelaxed())
+        return listing;
+
+    // QDirIterator reads the directory in batches and takes the entry type
+    // from them, so only symlinks and the odd filesystem need a stat.
+    QStringList files;
+    QStringList directories;
+    QDirIterator it(path, QDir::NoDotAndDotDot | QDir::AllEntries);
+    int entries = 0;
+    while (it.hasNext()) {
+        if ((++entries & 255) == 0 && cancelled->loadRelaxed())
+            return Listing();
+        QFileInfo info = it.nextFileInfo();
+        if (info.isDir())
+            directories.append(info.filePath());
+        else if (Helpers::allMediaExtensions.contains(info.suffix().toLower().split(" ")[0]))
+            files.append(info.filePath());
+    }
+
+    QCollator collator;
+    auto byName = [&collator](const QString &a, const QString &b) {
+        return collator.compare(a, b) < 0;
+    };
+    std::sort(files.begin(), files.end(), byName);
+    std::sort(directories.begin(), directories.end(), byName);
+
+    listing.files.reserve(files.count());
+    for (const QString &file : std::as_const(files))
+        listing.files.append(QUrl::fromLocalFile(file));
+    listing.directories = directories;
+    listing.identities.reserve(directories.count());
+    for (const QString &directory : std::as_const(directories))
+        listing.identities.append(Platform::fileIdentity(directory));
+    return listing;
+}
+
+DirectoryWalker::Node *DirectoryWalker::addDirectory(Node *parent,
+                                                     const QString &path,
+                                                     const QByteArray &identity)
+{
+    if (identity.isEmpty())
+        return nullptr;
+    if (visited.contains(identity)) {
+        Logger::log(logModule, QString("skipping %1, already visited").arg(path));
+        return nullptr;
+    }
+    visited.insert(identity);
+
+    Node *node = new Node;
+    node->path = path;
+    nodes.append(node);
+    parent->children.append(node);
+    directoriesFound++;
+    return node;
+}
+
+void DirectoryWalker::startListing(Node *node)
+{
+    QPointer<DirectoryWalker> self(this);
+    QString path = node->path;
+    QSharedPointer<QAtomicInt> cancelled = this->cancelled;
+    pool()->start([self, node, path, cancelled]() {
+        Listing listing = listDirectory(path, cancelled);
+        QMetaObject::invokeMethod(qApp, [self, node, listing]() {
+            if (self)
+                self->directoryListed(node, listing);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void DirectoryWalker::directoryListed(Node *node, const Listing &listing)
+{
+    if (done)
+        return;
+
+    node->files = listing.files;
+    node->listed = true;
+    directoriesListed++;
+    filesFound += listing.files.count();
+    for (int i = 0; i < listing.directories.count(); i++) {
+        Node *child = addDirectory(node, listing.directories[i],
+                                   listing.identities[i]);
+        if (child)
+            startListing(child);
+    }
+    emit progress(directoriesListed, directoriesFound, filesFound);
+    sendReady();
+}
+
+void DirectoryWalker::sendReady()
+{
+    sendQueued = false;
+    if (done)
+        return;
+
+    // Give out files depth first, stopping at the first directory that has
+    // not been listed yet.  Everything before it is in its final order.
+    QList<QUrl> ready;
+    while (!stack.isEmpty() && ready.count() < urlsPerChunk) {
+        Node *node = stack.last();
+        if (!node->listed)
+            break;
+        if (!node->files.isEmpty()) {
+            int take = std::min(int(node->files.count()),
+                                urlsPerChunk - int(ready.count()));
+            ready.append(node->files.mid(0, take));
+            node->files.remove(0, take);
+            if (!node->files.isEmpty())
+                break;
+        }
+        if (node->nextChild < node->children.count()) {
+            stack.append(node->children[node->nextChild++]);
+            continue;
+        }
+        stack.removeLast();
+    }
+
+    if (!ready.isEmpty())
+        emit urlsFound(ready);
+    if (done)
+        return;
+    if (stack.isEmpty()) {
+        finish();
+        return;
+    }
+    if (ready.count() >= urlsPerChunk && stack.last()->listed && !sendQueued) {
+        sendQueued = true;
+        QTimer::singleShot(0, this, &DirectoryWalker::sendReady);
+    }
+}
+
+void DirectoryWalker::finish()
+{
+    if (done)
+        return;
+    done = true;
+    Logger::log(logModule, QString("listed %1 directories, found %2 files in %3ms")
+                .arg(directoriesListed).arg(filesFound).arg(clock.elapsed()));
+    emit finished();
+}
@@ -0,0 +1,75 @@
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QUrl>
+
+class QThreadPool;
+
+// DirectoryWalker expands dropped or opened urls into the media files they
+// name, listing directories on a small thread pool of its own so that the
+// gui never waits on the disk.  Each directory is listed in one pass and its
+// subdirectories are handed back to the pool, while the files found so far
+// are given out in the same order Helpers::filterUrls would have produced:
+// inputs in order, files of a directory by name, and subdirectories after.
+// Directories already visited through another path are skipped, which stops
+// symlink loops.
+class DirectoryWalker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DirectoryWalker(QObject *parent = nullptr);
+    ~DirectoryWalker();
+
+    void walk(const QList<QUrl> &urls);
+    void cancel();
+    bool isCancelled() const;
+
+signals:
+    void urlsFound(const QList<QUrl> &urls);
+    void progress(int directoriesListed, int directoriesFound, int filesFound);
+    void finished();
+
+private:
+    struct Node {
+        QString path;
+        QList<QUrl> files;
+        QList<Node*> children;
+        int nextChild = 0;
+        bool listed = false;
+    };
+    struct Listing {
+        QList<QUrl> files;
+        QStringList directories;
+        QList<QByteArray> identities;
+    };
+
+    static QThreadPool *pool();
+    static Listing listDirectory(const QString &path,
+                                 const QSharedPointer<QAtomicInt> &cancelled);
+    Node *addDirectory(Node *parent, const QString &path,
+                       const QByteArray &identity);
+    void startListing(Node *node);
+    void directoryListed(Node *node, const Listing &listing);
+    void sendReady();
+    void finish();
+
+    QList<Node*> nodes;
+    QList<Node*> stack;
+    QSet<QByteArray> visited;
+    QSharedPointer<QAtomicInt> cancelled;
+    QElapsedTimer clock;
+    int directoriesListed = 0;
+    int directoriesFound = 0;
+    int filesFound = 0;
+    bool sendQueued = false;
+    bool done = false;
+};
+
+#endif // DIRECTORYWALKER_H
@@ -14,6 +14,8 @@
 #include <cmath>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include <QVarLengthArray>
+#include <QMutex>
 #include "helpers.h"
 #include "platform/unify.h"
 
@@ -348,61 +350,21 @@ static QString grabBrackets(QString source, int &position, int &length) {
 }
 
 
-QString Helpers::parseFormat(QString fmt, QString fileName,
-                             Helpers::DisabledTrack disabled,
-                             Subtitles subtitles, double timeNav,
-                             double timeBegin, double timeEnd)
-{
-    // convenient format parsing
-    struct TimeParse {
-        TimeParse(double time) {
-            this->time = time;
-            int t = int(time*1000 + 0.5);
-            hr = t/3600000;
-            mn = t/60000 % 60;
-            se = t%60000 / 1000;
-            fr = t % 1000;
-        }
-        QString toString(QChar fmt) {
-            switch (fmt.unicode()) {
-            case 'p':
-                return QString("%1:%2:%3")
-                        .arg(QString::number(hr),2,'0')
-                        .arg(QString::number(mn),2,'0')
-                        .arg(QString::number(se),2,'0');
-            case 'P':
-                return QString("%1:%2:%3.%4")
-                        .arg(QString::number(hr),2,'0')
-                        .arg(QString::number(mn),2,'0')
-                        .arg(QString::number(se),2,'0')
-                        .arg(QString::number(fr),3,'0');
-            case 'H':
-                return QString("%1").arg(QString::number(hr),2,'0');
-            case 'M':
-                return QString("%1").arg(QString::number(mn),2,'0');
-            case 'S':
-                return QString("%1").arg(QString::number(se),2,'0');
-            case 'T':
-                return QString("%1").arg(QString::number(fr),3,'0');
-            case 'h':
-                return QString::number(hr);
-            case 'm':
-                return QString::number(int(time)/60);
-            case 's':
-                return QString::number(int(time));
-            case 'f':
-                return QString::number(time,'f');
-            }
-            return fmt;
-        }
-        double time;
-        int hr, mn, se, fr;
-    };
+// A parseFormat template broken down into the pieces that get filled in,
+// so that a template is scanned once rather than for every file name.
+struct FormatOp {
+    enum Code { Text, FileName, FileNameNoExt, Subtitles, Disabled,
+                CurrentTime, TimeBegin, TimeEnd, TimeNav };
+    Code code;
+    QString a;
+    QString b;
+    QChar c;
+};
 
-    QString fileNameNoExt = QFileInfo(fileName).completeBaseName();
-    TimeParse nav(timeNav), begin(timeBegin), end(timeEnd);
-    QDateTime currentTime = QDateTime::currentDateTime();
-    QString output;
+static QList<FormatOp> compileFormat(const QString &fmt)
+{
+    QList<FormatOp> ops;
+    QString text;
     int length = fmt.length();
     int position = 0;
 
@@ -413,6 +375,15 @@ QString Helpers::parseFormat(QString fmt, QString fileName,
         return QStringList({p1, p2});
     };
 
+    // emit an op, flushing any plain text before it
+    auto append = [&ops, &text](FormatOp op) {
+        if (!text.isEmpty()) {
+            ops.append({ FormatOp::Text, text });
+            text.clear();
+        }
+        ops.append(op);
+    };
+
     QStringList pairs;
     while (position < length) {
         QChar c = fmt.at(position);
@@ -424,61 +395,169 @@ QString Helpers::parseFormat(QString fmt, QString fileName,
             switch (c.unicode()) {
             case 'f':
                 ++position;
-                output += fileName;
+                append({ FormatOp::FileName });
                 break;
             case 'F':
                 ++position;
-                output += fileNameNoExt;
+                append({ FormatOp::FileNameNoExt });
                 break;
             case 's':
                 ++position;
                 pairs = grabPair(fmt);
-                if (subtitles == SubtitlesPresent)
-                    output.append(pairs[0]);
-                if (subtitles == SubtitlesDisabled)
-                    output.append(pairs[1]);
+                append({ FormatOp::Subtitles, pairs[0], pairs[1] });
                 break;
             case 'd':
                 ++position;
                 pairs = grabPair(fmt);
-                if (disabled == DisabledAudio)
-                    output.append(pairs[0]);
-                if (disabled == DisabledVideo)
-                    output.append(pairs[1]);
+                append({ FormatOp::Disabled, pairs[0], pairs[1] });
                 break;
             case 't':
                 ++position;
-                output.append(currentTime.toString(grabBrackets(fmt, position, length)));
+                append({ FormatOp::CurrentTime, grabBrackets(fmt, position, length) });
                 break;
             case 'a':
                 if (++position < length)
-                    output.append(begin.toString(fmt.at(position)));
+                    append({ FormatOp::TimeBegin, {}, {}, fmt.at(position) });
                 ++position;
                 break;
             case 'b':
                 if (++position < length)
-                    output.append(end.toString(fmt.at(position)));
+                    append({ FormatOp::TimeEnd, {}, {}, fmt.at(position) });
                 ++position;
                 break;
             case 'w':
                 if (++position < length)
-                    output.append(nav.toString(fmt.at(position)));
+                    append({ FormatOp::TimeNav, {}, {}, fmt.at(position) });
                 ++position;
                 break;
             case '%':
-                output.append('%');
+                text.append('%');
                 ++position;
                 break;
             default:
-                output.append(c);
+                text.append(c);
                 ++position;
                 // %n unimplemented (look at mpv source code?)
             }
         } else {
-            output.append(c);
+            text.append(c);
             position++;
         }
     }
+    if (!text.isEmpty())
+        ops.append({ FormatOp::Text, text });
+    return ops;
+}
+
+static QList<FormatOp> compiledFormat(const QString &fmt)
+{
+    // Only a handful of templates are ever in use at once.
+    static constexpr int maxCompiledFormats = 32;
+    static QMutex mutex;
+    static QHash<QString, QList<FormatOp>> compiled;
+
+    QMutexLocker locker(&mutex);
+    auto it = compiled.constFind(fmt);
+    if (it != compiled.constEnd())
+        return it.value();
+    if (compiled.size() >= maxCompiledFormats)
+        compiled.clear();
+    return compiled.insert(fmt, compileFormat(fmt)).value();
+}
+
+QString Helpers::parseFormat(QString fmt, QString fileName,
+                             Helpers::DisabledTrack disabled,
+                             Subtitles subtitles, double timeNav,
+                             double timeBegin, double timeEnd)
+{
+    // convenient format parsing
+    struct TimeParse {
+        TimeParse(double time) {
+            this->time = time;
+            int t = int(time*1000 + 0.5);
+            hr = t/3600000;
+            mn = t/60000 % 60;
+            se = t%60000 / 1000;
+            fr = t % 1000;
+        }
+        QString toString(QChar fmt) {
+            switch (fmt.unicode()) {
+            case 'p':
+                return QString("%1:%2:%3")
+                        .arg(QString::number(hr),2,'0')
+                        .arg(QString::number(mn),2,'0')
+                        .arg(QString::number(se),2,'0');
+            case 'P':
+                return QString("%1:%2:%3.%4")
+                        .arg(QString::number(hr),2,'0')
+                        .arg(QString::number(mn),2,'0')
+                        .arg(QString::number(se),2,'0')
+                        .arg(QString::number(fr),3,'0');
+            case 'H':
+                return QString("%1").arg(QString::number(hr),2,'0');
+            case 'M':
+                return QString("%1").arg(QString::number(mn),2,'0');
+            case 'S':
+                return QString("%1").arg(QString::number(se),2,'0');
+            case 'T':
+                return QString("%1").arg(QString::number(fr),3,'0');
+            case 'h':
+                return QString::number(hr);
+            case 'm':
+                return QString::number(int(time)/60);
+            case 's':
+                return QString::number(int(time));
+            case 'f':
+                return QString::number(time,'f');
+            }
+            return fmt;
+        }
+        double time;
+        int hr, mn, se, fr;
+    };
+
+    QString fileNameNoExt = QFileInfo(fileName).completeBaseName();
+    TimeParse nav(timeNav), begin(timeBegin), end(timeEnd);
+    QDateTime currentTime = QDateTime::currentDateTime();
+    QString output;
+    const QList<FormatOp> ops = compiledFormat(fmt);
+    for (const FormatOp &op : ops) {
+        switch (op.code) {
+        case FormatOp::Text:
+            output += op.a;
+            break;
+        case FormatOp::FileName:
+            output += fileName;
+            break;
+        case FormatOp::FileNameNoExt:
+            output += fileNameNoExt;
+            break;
+        case FormatOp::Subtitles:
+            if (subtitles == SubtitlesPresent)
+                output.append(op.a);
+            if (subtitles == SubtitlesDisabled)
+                output.append(op.b);
+            break;
+        case FormatOp::Disabled:
+            if (disabled == DisabledAudio)
+                output.append(op.a);
+            if (disabled == DisabledVideo)
+                output.append(op.b);
+            break;
+        case FormatOp::CurrentTime:
+            output.append(currentTime.toString(op.a));
+            break;
+        case FormatOp::TimeBegin:
+            output.append(begin.toString(op.c));
+            break;
+        case FormatOp::TimeEnd:
+            output.append(end.toString(op.c));
+            break;
+        case FormatOp::TimeNav:
+            output.append(nav.toString(op.c));
+            break;
+        }
+    }
     return output;
 }
 
@@ -716,108 +795,6 @@ void IconThemer::updateButton(const IconData &data)
 
 
 
-// For the sake of optimizing 0.0001% of execution time, let's create a
-// tree out of the format string, so we don't need to do string operations
-// all the time other than those we need to.
-class DisplayNode {
-public:
-    enum NodeType { NullNode, PlainText, Trie, Property, DisplayName };
-    DisplayNode() { }
-    ~DisplayNode() {
-        empty();
-        if (next)
-            delete next;
-        next = nullptr;
-    }
-
-    bool isNull() {
-        return type == NullNode;
-    }
-
-    DisplayNode *nextNode() { return next; }
-
-    void setPlainText(QString text) {
-        empty();
-        data = text;
-        type = PlainText;
-    }
-
-    void setDisplayName() {
-        empty();
-        type = DisplayName;
-    }
-
-    void setActualProperty(QString text) {
-        empty();
-        type = Property;
-        data = text;
-    }
-
-    void setNodeTrie(QString propertyName, DisplayNode *tag,
-                     DisplayNode *audio, DisplayNode *video) {
-        empty();
-        type = Trie;
-        data = propertyName;
-        tagNode = tag;
-        audioNode = audio;
-        videoNode = video;
-    }
-
-    void appendNode(DisplayNode *next) {
-        if (this->next)
-            delete this->next;
-        this->next = next;
-    }
-
-    void empty() {
-        if (tagNode)    { delete tagNode;   tagNode = nullptr; }
-        if (audioNode)  { delete audioNode; audioNode = nullptr; }
-        if (videoNode)  { delete videoNode; videoNode = nullptr; }
-    }
-
-    QString output(const QVariantMap &metaData, const QString &displayString,
-                   const Helpers::FileType fileType) {
-        QString t;
-        switch (type) {
-        case NullNode:
-            break;
-        case PlainText:
-            t += data;
-            break;
-        case Trie:
-            if (metaData.contains(data) && tagNode) {
-                t += tagNode->output(metaData, displayString, fileType);
-            } else if (fileType == Helpers::AudioFile && audioNode) {
-                t += audioNode->output(metaData, displayString, fileType);
-            } else if (videoNode) {
-                t += videoNode->output(metaData, displayString, fileType);
-            }
-            break;
-        case Property:
-            if (metaData.contains(data)) {
-                t += metaData[data].toString();
-            }
-            break;
-        case DisplayName:
-            t += displayString;
-            break;
-        }
-        if (next)
-            t += next->output(metaData, displayString, fileType);
-        return t;
-    }
-
-private:
-    DisplayNode *tagNode = nullptr;
-    DisplayNode *audioNode = nullptr;
-    DisplayNode *videoNode = nullptr;
-    DisplayNode *next = nullptr;
-    QString data;
-    NodeType type = NullNode;
-};
-
-
-
 DisplayParser::DisplayParser()
 {
 
@@ -825,14 +802,21 @@ DisplayParser::DisplayParser()
 
 DisplayParser::~DisplayParser()
 {
-    if (node) { delete node; node = nullptr; }
+
 }
 
+// The format string is compiled into a flat list of ops, where every
+// metadata key it mentions is given an index.  parseMetadata then looks
+// each key up once and runs the ops without walking or copying anything.
 void DisplayParser::takeFormatString(QString fmt)
 {
     int length = fmt.length();
     int position = 0;
 
+    program.clear();
+    literals.clear();
+    keys.clear();
+
     // grab a {}{}{} tuple from the format string
     auto grabTuple = [&position, &length](QString source) {
         QString p1 = grabBrackets(source, position, length);
@@ -853,22 +837,16 @@ void DisplayParser::takeFormatString(QString fmt)
     };
 
     // dump whatever data may have been gathered up to this point
-    auto dumpGatheredData = [](QString &gathered, DisplayNode* &current,
-            bool final = false) {
+    auto dumpGatheredData = [this](QString &gathered) {
         if (!gathered.isEmpty()) {
-            current->setPlainText(gathered);
-            if (!final) {
-                current->appendNode(new DisplayNode);
-                current = current->nextNode();
-                gathered.clear();
-            }
+            program.append({ Op::Text, int(literals.size()) });
+            literals.append(gathered);
+            gathered.clear();
         }
     };
 
-    // convert text inside {} to a node
-    auto nodeInnerChars = [dumpGatheredData](QString text, QString propertyValue) {
-        DisplayNode *first = new DisplayNode;
-        DisplayNode *current = first;
+    // convert text inside {} to ops
+    auto compileInnerChars = [this, dumpGatheredData](QString text, int key) {
         QString gathered;
         QChar c;
         int length = text.length();
@@ -881,34 +859,24 @@ void DisplayParser::takeFormatString(QString fmt)
                     gathered += '#';
                     position++;
                 } else {
-                    dumpGatheredData(gathered, current);
-                    current->setActualProperty(propertyValue);
-                    current->appendNode(new DisplayNode);
-                    current = current->nextNode();
+                    dumpGatheredData(gathered);
+                    program.append({ Op::Property, key });
                 }
             } else if (c == '$') {
                 if (position < length && text.at(position)=='$') {
                     gathered += '$';
                     position++;
                 } else {
-                    dumpGatheredData(gathered, current);
-                    current->setDisplayName();
-                    current->appendNode(new DisplayNode);
-                    current = current->nextNode();
+                    dumpGatheredData(gathered);
+                    program.append({ Op::DisplayName });
                 }
             } else {
                 gathered += c;
             }
         }
-        dumpGatheredData(gathered, current, true);
-        return first;
+        dumpGatheredData(gathered);
     };
 
-    if (node)
-        delete node;
-    node = new DisplayNode;
-
-    DisplayNode *current = node;
     QString prop;
     QStringList tuple;
     QString gathered;
@@ -917,36 +885,92 @@ void DisplayParser::takeFormatString(QString fmt)
         if (c == '%') {
             if (position < length && fmt.at(position)=='%') {
                 gathered += '%';
+                position++;
                 continue;
             }
-            dumpGatheredData(gathered, current);
+            dumpGatheredData(gathered);
             prop = grabProp(fmt);
             if (prop.isEmpty())
                 continue;
             tuple = grabTuple(fmt);
-            current->setNodeTrie(prop, nodeInnerChars(tuple[0], prop),
-                                 nodeInnerChars(tuple[1], prop),
-                                 nodeInnerChars(tuple[2], prop));
-            current->appendNode(new DisplayNode);
-            current = current->nextNode();
+            int key = keys.indexOf(prop);
+            if (key < 0) {
+                key = keys.size();
+                keys.append(prop);
+            }
+
+            // tag {}, then audio {}, then video {}
+            int choose = program.size();
+            program.append({ Op::Choose, key });
+            compileInnerChars(tuple[0], key);
+            int tagJump = program.size();
+            program.append({ Op::Jump });
+            program[choose].audioAt = program.size();
+            compileInnerChars(tuple[1], key);
+            int audioJump = program.size();
+            program.append({ Op::Jump });
+            program[choose].videoAt = program.size();
+            compileInnerChars(tuple[2], key);
+            program[tagJump].arg = program.size();
+            program[audioJump].arg = program.size();
         } else {
             gathered += c;
         }
     }
-    dumpGatheredData(gathered, current, true);
+    dumpGatheredData(gathered);
+    titleKey = keys.indexOf("title");
+    revision_++;
+}
+
+int DisplayParser::revision() const
+{
+    return revision_;
 }
 
-QString DisplayParser::parseMetadata(QVariantMap metaData,
-                                     QString displayString,
-                                     Helpers::FileType fileType)
+QString DisplayParser::parseMetadata(const QVariantMap &metaData,
+                                     const QString &displayString,
+                                     Helpers::FileType fileType) const
 {
-    if (metaData.isEmpty()) {
+    if (metaData.isEmpty() || program.isEmpty())
         return displayString;
-    } else {
-        if (!metaData.contains("title"))
-            metaData["title"] = displayString;
-        return node->output(metaData, displayString, fileType);
+
+    QVariant title;
+    QVarLengthArray<const QVariant*, 16> values(keys.size());
+    for (int k = 0; k < keys.size(); k++) {
+        auto it = metaData.constFind(keys[k]);
+        values[k] = it != metaData.constEnd() ? &it.value() : nullptr;
     }
+    if (titleKey >= 0 && !values[titleKey]) {
+        title = displayString;
+        values[titleKey] = &title;
+    }
+
+    QString t;
+    int pc = 0;
+    int end = program.size();
+    while (pc < end) {
+        const Op &op = program[pc++];
+        switch (op.code) {
+        case Op::Text:
+            t += literals[op.arg];
+            break;
+        case Op::Property:
+            if (values[op.arg])
+                t += values[op.arg]->toString();
+            break;
+        case Op::DisplayName:
+            t += displayString;
+            break;
+        case Op::Choose:
+            if (!values[op.arg])
+                pc = fileType == Helpers::AudioFile ? op.audioAt : op.videoAt;
+            break;
+        case Op::Jump:
+            pc = op.arg;
+            break;
+        }
+    }
+    return t;
 }
 
 
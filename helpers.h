@@ -12,6 +12,10 @@
 #include <QDate>
 #include <QTime>
 #include <QDir>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <array>
 
 extern const char autoIcons[];
 extern const char blackIconsPath[];
@@ -30,7 +34,7 @@ namespace Helpers {
     enum ScreenshotRender { VideoRender, SubsRender, WindowRender };
     enum TitlePrefix { PrefixFullPath, PrefixFileName, NoPrefix };
     enum MpvWidgetType { NullWidget, EmbedWidget, GlCbWidget, VulkanCbWidget,
-                         CustomWidget };
+                         SwRenderWidget, CustomWidget };
     enum ControlHiding { NeverShown, ShowWhenMoving, ShowWhenHovering,
                          AlwaysShow };
     enum AfterPlayback { DoNothingAfter, RepeatAfter, PlayNextAfter,
@@ -73,6 +77,43 @@ namespace Helpers {
     QRect availableGeometryFromPoint(const QPoint &point);
     QScreen *findScreenByName(QString s);
     QString screenToVisualName(QScreen *s);
+
+    // Stable sort that sorts runs of the range on the global thread pool,
+    // then merges neighbouring runs until one is left.
+    template<class Iterator, class LessThan>
+    void parallelSort(Iterator begin, Iterator end, LessThan lessThan)
+    {
+        constexpr qsizetype serialThreshold = 8192;
+        using Run = std::array<qsizetype, 3>;   // start, middle, end
+
+        qsizetype count = end - begin;
+        int threads = QThreadPool::globalInstance()->maxThreadCount();
+        if (count < serialThreshold || threads < 2) {
+            std::stable_sort(begin, end, lessThan);
+            return;
+        }
+
+        QList<Run> runs;
+        qsizetype runLength = (count + threads - 1) / threads;
+        for (qsizetype i = 0; i < count; i += runLength)
+            runs.append({ i, i, std::min(count, i + runLength) });
+        QtConcurrent::blockingMap(runs, [begin, &lessThan](const Run &r) {
+            std::stable_sort(begin + r[0], begin + r[2], lessThan);
+        });
+
+        while (runs.count() > 1) {
+            QList<Run> merged;
+            for (int i = 0; i + 1 < runs.count(); i += 2)
+                merged.append({ runs[i][0], runs[i][2], runs[i + 1][2] });
+            QtConcurrent::blockingMap(merged, [begin, &lessThan](const Run &r) {
+                std::inplace_merge(begin + r[0], begin + r[1], begin + r[2],
+                                   lessThan);
+            });
+            if (runs.count() % 2)
+                merged.append(runs.last());
+            runs = merged;
+        }
+    }
 }
 
 class IconThemer : public QObject {
@@ -98,17 +139,30 @@ private:
     QString customFolder_;
 };
 
-class DisplayNode;
 class DisplayParser {
 public:
     DisplayParser();
     ~DisplayParser();
 
     void takeFormatString(QString fmt);
-    QString parseMetadata(QVariantMap metaData, QString displayString,
-                          Helpers::FileType fileType);
+    QString parseMetadata(const QVariantMap &metaData,
+                          const QString &displayString,
+                          Helpers::FileType fileType) const;
+    // Bumped whenever the format string is replaced.
+    int revision() const;
 private:
-    DisplayNode *node = nullptr;
+    struct Op {
+        enum Code { Text, Property, DisplayName, Choose, Jump };
+        Code code;
+        int arg = 0;        // literal, key or jump target
+        int audioAt = 0;    // where Choose goes without the key
+        int videoAt = 0;
+    };
+    QList<Op> program;
+    QStringList literals;
+    QStringList keys;
+    int titleKey = -1;
+    int revision_ = 0;
 };
 
 class TrackInfo {
@@ -3,9 +3,11 @@
 #include <QCoreApplication>
 #include <QMetaMethod>
 #include <QJsonDocument>
+#include <QPointer>
 
 #include <mpv/client.h>
 
+#include "latencystats.h"
 #include "logger.h"
 #include "mainwindow.h"
 #include "manager.h"
@@ -189,6 +191,17 @@ void MpcQtServer::socket_payloadReceived(const QByteArray &payload,
     QVariant value;
     if (ipcCommands.contains(command)) {
         QMetaMethod method = ipcCommands[command];
+        if (method.returnMetaType() == QMetaType::fromType<QFuture<QVariant>>()) {
+            // Reply when mpv does, instead of blocking the gui thread.
+            QFuture<QVariant> future;
+            method.invoke(this, Q_RETURN_ARG(QFuture<QVariant>, future),
+                                Q_ARG(QVariantMap, map));
+            QPointer<QLocalSocket> guard(socket);
+            future.then(this, [this, guard](const QVariant &v) {
+                socketReturn(guard, true, v);
+            });
+            return;
+        }
         if (ipcCommands[command].returnType() == QMetaType::QVariant)
             method.invoke(this, Q_RETURN_ARG(QVariant, value),
                                 Q_ARG(QVariantMap, map));
@@ -293,36 +306,36 @@ void MpcQtServer::ipc_deltaExtraPlaytimes(const QVariantMap &map)
     playbackManager->deltaExtraPlaytimes(delta);
 }
 
-QVariant MpcQtServer::ipc_getMpvProperty(const QVariantMap &map)
+QFuture<QVariant> MpcQtServer::ipc_getMpvProperty(const QVariantMap &map)
 {
     if (!map.contains("name"))
-        return QVariant::fromValue(MpvErrorCode(-0xdedbeef));
-    return mainWindow->mpvObject()->getMpvPropertyVariant(map["name"].toString());
+        return QtFuture::makeReadyFuture(QVariant::fromValue(MpvErrorCode(-0xdedbeef)));
+    return mainWindow->mpvObject()->getMpvPropertyVariantAsync(map["name"].toString());
 }
 
-QVariant MpcQtServer::ipc_setMpvProperty(const QVariantMap &map)
+QFuture<QVariant> MpcQtServer::ipc_setMpvProperty(const QVariantMap &map)
 {
     QString name = map.value("name").toString();
     if (name.isEmpty() || bannedProperties->contains(name))
-        return QVariant::fromValue(MpvErrorCode(-0xdedbeef));
+        return QtFuture::makeReadyFuture(QVariant::fromValue(MpvErrorCode(-0xdedbeef)));
 
-    return mainWindow->mpvObject()->blockingSetMpvPropertyVariant(name, map["value"]);
+    return mainWindow->mpvObject()->setMpvPropertyVariantAsync(name, map["value"]);
 }
 
-QVariant MpcQtServer::ipc_setMpvOption(const QVariantMap &map)
+QFuture<QVariant> MpcQtServer::ipc_setMpvOption(const QVariantMap &map)
 {
     QString name = map.value("name").toString();
     if (name.isEmpty() || bannedOptions->contains(name))
-        return QVariant::fromValue(MpvErrorCode(-0xdedbeef));
+        return QtFuture::makeReadyFuture(QVariant::fromValue(MpvErrorCode(-0xdedbeef)));
 
-    return mainWindow->mpvObject()->blockingSetMpvOptionVariant(name, map["value"]);
+    return mainWindow->mpvObject()->setMpvOptionVariantAsync(name, map["value"]);
 }
 
-QVariant MpcQtServer::ipc_doMpvCommand(const QVariantMap &map)
+QFuture<QVariant> MpcQtServer::ipc_doMpvCommand(const QVariantMap &map)
 {
     QString name = map.value("name").toString();
     if (name.isEmpty() || bannedCommands->contains(name))
-        return QVariant::fromValue(MpvErrorCode(-0xdedbeef));
+        return QtFuture::makeReadyFuture(QVariant::fromValue(MpvErrorCode(-0xdedbeef)));
 
     QVariantList command = { name };
     QVariant options = map.value("options");
@@ -333,7 +346,32 @@ QVariant MpcQtServer::ipc_doMpvCommand(const QVariantMap &map)
     else
         command.append(options);
     end:
-    return mainWindow->mpvObject()->blockingMpvCommand(QVariant(command));
+    return mainWindow->mpvObject()->mpvCommandAsync(QVariant(command));
+}
+
+QVariant MpcQtServer::ipc_getLatencyStats(const QVariantMap &map)
+{
+    LatencyStats *latency = LatencyStats::singleton();
+    QVariant stats = latency->toVMap();
+    if (map.value("reset", false).toBool())
+        latency->reset();
+    return stats;
+}
+
+QVariant MpcQtServer::ipc_getSeekStats(const QVariantMap &map)
+{
+    return mainWindow->mpvObject()->seekStatistics(map.value("reset", false).toBool());
+}
+
+QFuture<QVariant> MpcQtServer::ipc_getDrainStats(const QVariantMap &map)
+{
+    return mainWindow->mpvObject()->drainStatistics(map.value("reset", false).toBool());
+}
+
+void MpcQtServer::ipc_setDrainTimeSlice(const QVariantMap &map)
+{
+    if (map.contains("value"))
+        mainWindow->mpvObject()->setDrainTimeSlice(map["value"].toInt());
 }
 
 
@@ -566,7 +604,9 @@ void MpvConnection::command_get_property(const QStringList &list,
         commandReturn(MPV_ERROR_INVALID_PARAMETER, requestId);
         return;
     }
-    commandReturnVariant(requestId, mpvObject->controller()->getPropertyVariant(list.at(1)));
+    mpvObject->getMpvPropertyVariantAsync(list.at(1)).then(this, [this, requestId](const QVariant &v) {
+        commandReturnVariant(requestId, v);
+    });
 }
 
 void MpvConnection::command_get_property_string(const QStringList &list,
@@ -2,6 +2,7 @@
 #define IPCJSON_H
 
 #include <QObject>
+#include <QFuture>
 #include <QVariant>
 #include <QSharedPointer>
 #include <QHash>
@@ -71,10 +72,14 @@ private slots:
     void ipc_repeat();
     void ipc_togglePlayback();
     void ipc_deltaExtraPlaytimes(const QVariantMap &map);
-    QVariant ipc_getMpvProperty(const QVariantMap &map);
-    QVariant ipc_setMpvProperty(const QVariantMap &map);
-    QVariant ipc_setMpvOption(const QVariantMap &map);
-    QVariant ipc_doMpvCommand(const QVariantMap &map);
+    QFuture<QVariant> ipc_getMpvProperty(const QVariantMap &map);
+    QFuture<QVariant> ipc_setMpvProperty(const QVariantMap &map);
+    QFuture<QVariant> ipc_setMpvOption(const QVariantMap &map);
+    QFuture<QVariant> ipc_doMpvCommand(const QVariantMap &map);
+    QVariant ipc_getLatencyStats(const QVariantMap &map);
+    QVariant ipc_getSeekStats(const QVariantMap &map);
+    QFuture<QVariant> ipc_getDrainStats(const QVariantMap &map);
+    void ipc_setDrainTimeSlice(const QVariantMap &map);
 
 private:
     PlaybackManager *playbackManager = nullptr;
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <QDataStream>
+#include <QtConcurrent/QtConcurrentRun>
+#include "keyframeindex.h"
+#include "logger.h"
+#include "mpvwidget.h"
+#include "thumbnailcache.h"
+
+constexpr char logModule[] = "keyframes";
+constexpr char friendlyName[] = "Media Player Classic Qute Theater - Indexer";
+constexpr char cacheKey[] = "keyframes:1";
+// Sampling granularity, see the header
+constexpr double minimumProbeSec = 1.0;
+constexpr int maximumProbes = 3000;
+
+KeyframeIndexer::KeyframeIndexer(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+KeyframeIndexer::~KeyframeIndexer()
+{
+    deinitPlayer();
+}
+
+void KeyframeIndexer::setSource(const QUrl &url)
+{
+    // Like the seek previewer, only local files are worth a second decoder.
+    QUrl local = url.isLocalFile() ? url : QUrl();
+    if (local == source)
+        return;
+    source = local;
+    serial++;
+    duration = 0;
+    probeTime = -1;
+    indexedUntil = 0;
+    loaded = false;
+    ready = false;
+    complete = false;
+    keyframes.clear();
+
+    if (source.isEmpty()) {
+        deinitPlayer();
+        return;
+    }
+    loadIndex();
+}
+
+double KeyframeIndexer::snap(double time) const
+{
+    if (keyframes.isEmpty() || (!complete && time > indexedUntil))
+        return time;
+    qint32 msec = qint32(std::lround(time * 1000));
+    auto after = std::lower_bound(keyframes.cbegin(), keyframes.cend(), msec);
+    qint32 nearest;
+    if (after == keyframes.cend())
+        nearest = keyframes.last();
+    else if (after == keyframes.cbegin())
+        nearest = *after;
+    else
+        nearest = msec - *(after - 1) <= *after - msec ? *(after - 1) : *after;
+    return nearest / 1000.0;
+}
+
+bool KeyframeIndexer::isComplete() const
+{
+    return complete;
+}
+
+void KeyframeIndexer::initPlayer()
+{
+    mpv = new MpvObject(this, friendlyName, MpvObject::HelperRole);
+    connect(mpv, &MpvObject::playLengthChanged,
+            this, &KeyframeIndexer::mpv_playLengthChanged);
+    connect(mpv, &MpvObject::playbackStarted,
+            this, &KeyframeIndexer::mpv_playbackStarted);
+    connect(mpv, &MpvObject::playbackRestarted,
+            this, &KeyframeIndexer::mpv_playbackRestarted);
+
+    // Nothing is shown or heard, and only keyframes are decoded, so each
+    // probe costs little more than the demuxer seek itself.
+    emit mpv->ctrlSetOptionVariant("vo", "null");
+    emit mpv->ctrlSetOptionVariant("ao", "null");
+    emit mpv->ctrlSetOptionVariant("aid", "no");
+    emit mpv->ctrlSetOptionVariant("sid", "no");
+    emit mpv->ctrlSetOptionVariant("hr-seek", "no");
+    emit mpv->ctrlSetOptionVariant("vd-lavc-skipframe", "nokey");
+    emit mpv->ctrlSetOptionVariant("vd-lavc-skiploopfilter", "all");
+    emit mpv->ctrlSetOptionVariant("untimed", "yes");
+}
+
+void KeyframeIndexer::deinitPlayer()
+{
+    if (!mpv)
+        return;
+    delete mpv;
+    mpv = nullptr;
+}
+
+void KeyframeIndexer::loadIndex()
+{
+    // Look for an index from an earlier run off the gui thread, and only
+    // start probing when there isn't one.
+    int current = serial;
+    QUrl media = source;
+    QtConcurrent::run([media]() {
+        return ThumbnailCache::singleton()->fetchData(media, cacheKey);
+    }).then(this, [this, current](const QByteArray &data) {
+        if (current != serial)
+            return;
+        if (takeIndex(data)) {
+            deinitPlayer();
+            return;
+        }
+        if (!mpv)
+            initPlayer();
+        LogStream(logModule) << "indexing " << source;
+        mpv->urlOpen(source);
+        mpv->setPaused(true);
+    });
+}
+
+bool KeyframeIndexer::takeIndex(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return false;
+    QDataStream stream(data);
+    stream >> keyframes;
+    if (stream.status() != QDataStream::Ok || keyframes.isEmpty()) {
+        keyframes.clear();
+        return false;
+    }
+    complete = true;
+    LogStream(logModule) << "loaded " << keyframes.count() << " keyframes for " << source;
+    emit indexed(keyframes.count());
+    return true;
+}
+
+void KeyframeIndexer::saveIndex()
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << keyframes;
+    ThumbnailCache::singleton()->storeData(source, cacheKey, data);
+}
+
+void KeyframeIndexer::startProbing()
+{
+    // Probing needs both the restart after loading and the length, which
+    // may arrive in either order.
+    if (ready || !loaded || duration <= 0)
+        return;
+    ready = true;
+    addKeyframe(0);
+    probeNext();
+}
+
+void KeyframeIndexer::probeNext()
+{
+    if (!ready || probeTime >= 0 || complete)
+        return;
+    if (indexedUntil >= duration) {
+        complete = true;
+        deinitPlayer();
+        LogStream(logModule) << "found " << keyframes.count() << " keyframes in " << source;
+        saveIndex();
+        emit indexed(keyframes.count());
+        return;
+    }
+    probeTime = std::min(duration, indexedUntil + probeStep);
+    mpv->setTime(probeTime);
+}
+
+void KeyframeIndexer::addKeyframe(double time)
+{
+    qint32 msec = qint32(std::lround(time * 1000));
+    auto it = std::lower_bound(keyframes.begin(), keyframes.end(), msec);
+    if (it == keyframes.end() || *it != msec)
+        keyframes.insert(it, msec);
+}
+
+void KeyframeIndexer::mpv_playLengthChanged(double length)
+{
+    duration = length;
+    probeStep = std::max(minimumProbeSec, duration / maximumProbes);
+    startProbing();
+}
+
+void KeyframeIndexer::mpv_playbackStarted()
+{
+    // The restart that follows loading is not the end of a probe
+    loaded = false;
+    ready = false;
+    probeTime = -1;
+}
+
+void KeyframeIndexer::mpv_playbackRestarted()
+{
+    if (!ready) {
+        loaded = true;
+        startProbing();
+        return;
+    }
+    if (probeTime < 0)
+        return;
+
+    // Read where the seek landed, which is where the keyframe is.
+    int current = serial;
+    mpv->getMpvPropertyVariantAsync("time-pos").then(this, [this, current](const QVariant &v) {
+        if (current != serial || probeTime < 0)
+            return;
+        if (v.typeId() == QMetaType::Double)
+            addKeyframe(v.toDouble());
+        indexedUntil = probeTime;
+        probeTime = -1;
+        probeNext();
+    });
+}
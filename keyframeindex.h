@@ -0,0 +1,69 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+class MpvObject;
+
+// KeyframeIndexer learns where the keyframes of the file being played are,
+// so that seeks made while dragging the seekbar can land on one and be shown
+// without decoding the frames in between.  mpv cannot list keyframes, so a
+// headless instance with no video or audio output does keyframe-only seeks
+// across the file and notes where each of them lands.
+//
+// The index is therefore a sample, not a full list.  Seeks are made every
+// second, or every 1/3000th of the file if that is longer, and a seek only
+// finds the keyframe at or before its target.  Keyframes closer together
+// than that step are missed, so a snapped position may be a keyframe a
+// little further away than the true nearest one.  That is all dragging
+// needs, and it keeps indexing a long file to a few thousand seeks.  The
+// finished sample is kept in the thumbnail cache, as a sorted list of
+// millisecond offsets.
+class KeyframeIndexer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit KeyframeIndexer(QObject *parent = nullptr);
+    ~KeyframeIndexer();
+
+    void setSource(const QUrl &url);
+    // Returns the sampled keyframe nearest to time, or time itself when
+    // that part of the file has not been sampled yet.
+    double snap(double time) const;
+    bool isComplete() const;
+
+signals:
+    void indexed(int keyframes);
+
+private:
+    void initPlayer();
+    void deinitPlayer();
+    void loadIndex();
+    bool takeIndex(const QByteArray &data);
+    void saveIndex();
+    void startProbing();
+    void probeNext();
+    void addKeyframe(double time);
+
+private slots:
+    void mpv_playLengthChanged(double length);
+    void mpv_playbackStarted();
+    void mpv_playbackRestarted();
+
+private:
+    MpvObject *mpv = nullptr;
+    QUrl source;
+    int serial = 0;
+    double duration = 0;
+    double probeStep = 1;
+    double probeTime = -1;      // target of the seek in flight, or -1
+    double indexedUntil = 0;    // keyframes before this have been looked for
+    bool loaded = false;        // the restart after loading has been seen
+    bool ready = false;
+    bool complete = false;
+    QList<qint32> keyframes;
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -0,0 +1,127 @@
+#include <QtAlgorithms>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "latencystats.h"
+
+void LatencyHistogram::record(qint64 usec)
+{
+    usec = std::max(usec, qint64(0));
+    counts[indexOf(usec)]++;
+    min_ = count_ ? std::min(min_, usec) : usec;
+    max_ = std::max(max_, usec);
+    sum += usec;
+    count_++;
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if (!count_)
+        return 0;
+    qint64 wanted = std::max(qint64(1), qint64(std::ceil(count_ * percentile / 100.0)));
+    qint64 seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= wanted)
+            return std::min(highestValueAt(int(i)), max_);
+    }
+    return max_;
+}
+
+QVariantMap LatencyHistogram::toVMap() const
+{
+    return QVariantMap {
+        { "count", count_ },
+        { "minUsec", min() },
+        { "meanUsec", mean() },
+        { "p50Usec", valueAtPercentile(50) },
+        { "p90Usec", valueAtPercentile(90) },
+        { "p99Usec", valueAtPercentile(99) },
+        { "p999Usec", valueAtPercentile(99.9) },
+        { "maxUsec", max_ }
+    };
+}
+
+int LatencyHistogram::indexOf(qint64 usec)
+{
+    // The first bucket holds 0..31 at full resolution, every following one
+    // covers the next power of two with 16 sub-buckets.
+    int bits = 64 - qCountLeadingZeroBits(quint64(usec));
+    int magnitude = std::clamp(bits - (subBucketBits + 1), 0, maxMagnitude);
+    int subBucket = int(std::min(usec >> magnitude, qint64(2 * subBucketHalf - 1)));
+    return magnitude * subBucketHalf + subBucket;
+}
+
+qint64 LatencyHistogram::highestValueAt(int index)
+{
+    int magnitude = index < 2 * subBucketHalf ? 0 : index / subBucketHalf - 1;
+    qint64 subBucket = index - magnitude * subBucketHalf;
+    return ((subBucket + 1) << magnitude) - 1;
+}
+
+
+
+LatencyStats *LatencyStats::singleton()
+{
+    static LatencyStats instance;
+    return &instance;
+}
+
+qint64 LatencyStats::timestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyStats::record(const QString &className, const QString &stage,
+                          qint64 fromNsec, qint64 toNsec)
+{
+    if (!fromNsec)
+        return;
+    histograms[className][stage].record((toNsec - fromNsec) / 1000);
+}
+
+void LatencyStats::reset()
+{
+    histograms.clear();
+}
+
+QVariantMap LatencyStats::toVMap() const
+{
+    QVariantMap map;
+    for (auto it = histograms.cbegin(); it != histograms.cend(); it++) {
+        QVariantMap stages;
+        for (auto st = it.value().cbegin(); st != it.value().cend(); st++)
+            stages.insert(st.key(), st.value().toVMap());
+        map.insert(it.key(), stages);
+    }
+    return map;
+}
+
+QStringList LatencyStats::summary() const
+{
+    auto msec = [](qint64 usec) {
+        return QString::number(usec / 1000.0, 'f', 2);
+    };
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                .arg("class", -24).arg("stage", -8).arg("count", 8)
+                .arg("p50ms", 8).arg("p90ms", 8).arg("p99ms", 8).arg("maxms", 8);
+    for (auto it = histograms.cbegin(); it != histograms.cend(); it++) {
+        for (auto st = it.value().cbegin(); st != it.value().cend(); st++) {
+            const LatencyHistogram &h = st.value();
+            lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                        .arg(it.key(), -24).arg(st.key(), -8).arg(h.count(), 8)
+                        .arg(msec(h.valueAtPercentile(50)), 8)
+                        .arg(msec(h.valueAtPercentile(90)), 8)
+                        .arg(msec(h.valueAtPercentile(99)), 8)
+                        .arg(msec(h.max()), 8);
+        }
+    }
+    return lines;
+}
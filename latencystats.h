@@ -0,0 +1,60 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QMap>
+#include <QStringList>
+#include <QVariantMap>
+#include <array>
+
+// LatencyHistogram is a small HdrHistogram-alike.  Values are bucketed by
+// their power of two, and each power of two is split into 16 linear
+// sub-buckets, so reported percentiles are within ~6% of the real value
+// while recording stays a couple of shifts and an increment.
+class LatencyHistogram {
+public:
+    void record(qint64 usec);
+    void reset();
+    qint64 count() const { return count_; }
+    qint64 min() const { return count_ ? min_ : 0; }
+    qint64 max() const { return max_; }
+    qint64 mean() const { return count_ ? sum / count_ : 0; }
+    qint64 valueAtPercentile(double percentile) const;
+    QVariantMap toVMap() const;
+
+private:
+    static constexpr int subBucketBits = 4;
+    static constexpr int subBucketHalf = 1 << subBucketBits;
+    static constexpr int maxMagnitude = 32;
+    static int indexOf(qint64 usec);
+    static qint64 highestValueAt(int index);
+
+    std::array<qint64, (maxMagnitude + 2) * subBucketHalf> counts {};
+    qint64 count_ = 0;
+    qint64 sum = 0;
+    qint64 min_ = 0;
+    qint64 max_ = 0;
+};
+
+
+
+// LatencyStats collects histograms of how long things take to travel
+// through the program, keyed by a class name (e.g. an mpv property) and a
+// stage (e.g. "queued" or "handled").  Record and query it from the gui
+// thread only; timestamps may be taken on any thread.
+class LatencyStats {
+public:
+    static LatencyStats *singleton();
+    // Monotonic nanoseconds, comparable between threads.
+    static qint64 timestamp();
+
+    void record(const QString &className, const QString &stage,
+                qint64 fromNsec, qint64 toNsec);
+    void reset();
+    QVariantMap toVMap() const;
+    QStringList summary() const;
+
+private:
+    QMap<QString, QMap<QString, LatencyHistogram>> histograms;
+};
+
+#endif // LATENCYSTATS_H
@@ -1,4 +1,7 @@
 #include <QCloseEvent>
+#include <QFileDialog>
+#include <algorithm>
+#include "medialibrary.h"
 #include "playlist.h"
 #include "widgets/drawncollection.h"
 #include "widgets/drawnplaylist.h"
@@ -19,6 +22,11 @@ LibraryWindow::LibraryWindow(QWidget *parent) :
 
     connect(collectionWidget, &DrawnCollection::playlistSelected,
             playlistWidget, &DrawnPlaylist::setUuid);
+
+    library = MediaLibrary::singleton();
+    connect(library, &MediaLibrary::catalogChanged,
+            this, &LibraryWindow::library_catalogChanged);
+    updateRoots();
 }
 
 LibraryWindow::~LibraryWindow()
@@ -37,6 +45,66 @@ void LibraryWindow::closeEvent(QCloseEvent *event)
     emit windowClosed();
 }
 
+void LibraryWindow::showEvent(QShowEvent *event)
+{
+    // The media tab is only kept up to date while it can be seen
+    library_catalogChanged();
+    QWidget::showEvent(event);
+}
+
+void LibraryWindow::updateRoots()
+{
+    ui->libraryRoots->clear();
+    ui->libraryRoots->addItems(library->roots());
+}
+
+void LibraryWindow::updateKeys()
+{
+    QString current = ui->libraryKeys->currentItem() ? ui->libraryKeys->currentItem()->text()
+                                                     : QString();
+    auto index = static_cast<MediaLibrary::Index>(ui->libraryIndex->currentIndex());
+    QStringList keys = library->keys(index);
+    ui->libraryKeys->clear();
+    ui->libraryKeys->addItems(keys);
+    int row = keys.indexOf(current);
+    if (row >= 0)
+        ui->libraryKeys->setCurrentRow(row);
+    else
+        ui->libraryFiles->clear();
+}
+
+void LibraryWindow::updateFiles()
+{
+    ui->libraryFiles->clear();
+    if (!ui->libraryKeys->currentItem())
+        return;
+    auto index = static_cast<MediaLibrary::Index>(ui->libraryIndex->currentIndex());
+    const QList<int> found = library->find(index, ui->libraryKeys->currentItem()->text());
+    QStringList names;
+    names.reserve(found.count());
+    for (int entry : found)
+        names.append(library->displayNameOf(entry));
+    ui->libraryFiles->addItems(names);
+}
+
+void LibraryWindow::updateStatus()
+{
+    QString status = tr("%n file(s)", nullptr, library->count());
+    if (library->isScanning())
+        status = tr("Scanning...");
+    else if (library->pendingCount() > 0)
+        status += " " + tr("(%n left to read)", nullptr, library->pendingCount());
+    ui->libraryStatus->setText(status);
+}
+
+void LibraryWindow::library_catalogChanged()
+{
+    if (!isVisible())
+        return;
+    updateStatus();
+    updateKeys();
+}
+
 void LibraryWindow::on_restorePlaylist_clicked()
 {
     int currentRow = collectionWidget->currentRow();
@@ -63,3 +131,69 @@ void LibraryWindow::on_removePlaylist_clicked()
     backupCollection->removePlaylist(collectionItem->uuid());
     delete collectionWidget->takeItem(currentRow);
 }
+
+void LibraryWindow::on_libraryAddFolder_clicked()
+{
+    QString folder = QFileDialog::getExistingDirectory(this, tr("Add Folder"));
+    if (folder.isEmpty())
+        return;
+    library->addRoot(folder);
+    updateRoots();
+}
+
+void LibraryWindow::on_libraryRemoveFolder_clicked()
+{
+    auto item = ui->libraryRoots->currentItem();
+    if (!item)
+        return;
+    library->removeRoot(item->text());
+    updateRoots();
+}
+
+void LibraryWindow::on_libraryRescan_clicked()
+{
+    library->rescan();
+}
+
+void LibraryWindow::on_libraryIndex_currentIndexChanged(int index)
+{
+    Q_UNUSED(index)
+    ui->libraryKeys->setCurrentRow(-1);
+    updateKeys();
+}
+
+void LibraryWindow::on_libraryKeys_currentTextChanged(const QString &currentText)
+{
+    Q_UNUSED(currentText)
+    updateFiles();
+}
+
+void LibraryWindow::on_libraryToPlaylist_clicked()
+{
+    auto keyItem = ui->libraryKeys->currentItem();
+    if (!keyItem)
+        return;
+    auto index = static_cast<MediaLibrary::Index>(ui->libraryIndex->currentIndex());
+    QList<int> found = library->find(index, keyItem->text());
+
+    // Rows line up with what was found unless the catalog has changed
+    // since the list was filled, in which case everything is taken.
+    QModelIndexList selected = ui->libraryFiles->selectionModel()->selectedRows();
+    if (!selected.isEmpty() && ui->libraryFiles->count() == found.count()) {
+        std::sort(selected.begin(), selected.end());
+        QList<int> picked;
+        for (const QModelIndex &row : std::as_const(selected))
+            picked.append(found[row.row()]);
+        found = picked;
+    }
+    if (found.isEmpty())
+        return;
+
+    // Fill the items in from the catalog, so that nothing has to be probed.
+    auto pl = PlaylistCollection::getSingleton()->newPlaylist(keyItem->text());
+    for (int entry : std::as_const(found)) {
+        auto item = pl->addItem(library->urlOf(entry));
+        item->setMetadata(library->metadataOf(entry));
+    }
+    emit playlistCreated(pl->uuid());
+}
@@ -12,6 +12,7 @@ QT_END_NAMESPACE
 
 class DrawnPlaylist;
 class DrawnCollection;
+class MediaLibrary;
 
 class LibraryWindow : public QWidget
 {
@@ -27,19 +28,42 @@ public slots:
 signals:
     void windowClosed();
     void playlistRestored(QUuid playlistUuid);
+    void playlistCreated(QUuid playlistUuid);
 
 protected:
     void closeEvent(QCloseEvent *event);
+    void showEvent(QShowEvent *event);
+
+private:
+    void updateRoots();
+    void updateKeys();
+    void updateFiles();
+    void updateStatus();
 
 private slots:
+    void library_catalogChanged();
+
     void on_restorePlaylist_clicked();
 
     void on_removePlaylist_clicked();
 
+    void on_libraryAddFolder_clicked();
+
+    void on_libraryRemoveFolder_clicked();
+
+    void on_libraryRescan_clicked();
+
+    void on_libraryIndex_currentIndexChanged(int index);
+
+    void on_libraryKeys_currentTextChanged(const QString &currentText);
+
+    void on_libraryToPlaylist_clicked();
+
 private:
     Ui::LibraryWindow *ui;
     DrawnPlaylist *playlistWidget;
     DrawnCollection *collectionWidget;
+    MediaLibrary *library;
 };
 
 #endif // LIBRARYWINDOW_H
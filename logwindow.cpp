@@ -2,7 +2,7 @@
 #include <QFileDialog>
 #include <QPlainTextEdit>
 #include <QTextDocument>
-#include "logger.h"
+#include "latencystats.h"
 #include "logwindow.h"
 #include "ui_logwindow.h"
 
@@ -12,13 +12,6 @@ LogWindow::LogWindow(QWidget *parent) :
     ui(new Ui::LogWindow)
 {
     ui->setupUi(this);
-    Logger *logger = Logger::singleton();
-    connect(logger, &Logger::logMessage,
-            this, &LogWindow::appendMessage,
-            Qt::QueuedConnection);
-    connect(logger, &Logger::logMessageBuffer,
-            this, &LogWindow::appendMessageBlock,
-            Qt::QueuedConnection);
 }
 
 LogWindow::~LogWindow()
@@ -36,6 +29,15 @@ void LogWindow::appendMessageBlock(QStringList messages)
     ui->messages->appendPlainText(messages.join('\n'));
 }
 
+void LogWindow::appendDrainStatistics(const QVariantMap &stats)
+{
+    QStringList lines;
+    lines << QString("%1 %2").arg("mpv event drain", -24).arg("value", 12);
+    for (auto it = stats.cbegin(); it != stats.cend(); it++)
+        lines << QString("%1 %2").arg(it.key(), -24).arg(it.value().toString(), 12);
+    appendMessageBlock(lines);
+}
+
 void LogWindow::setLogLimit(int lines)
 {
     ui->messages->setMaximumBlockCount(lines);
@@ -47,6 +49,12 @@ void LogWindow::closeEvent(QCloseEvent *event)
     emit windowClosed();
 }
 
+void LogWindow::on_latency_clicked()
+{
+    appendMessageBlock(LatencyStats::singleton()->summary());
+    emit drainStatisticsRequested();
+}
+
 void LogWindow::on_copy_clicked()
 {
     QTextDocument *doc = ui->messages->document();
@@ -4,6 +4,7 @@
 #include <QFile>
 #include <QStringList>
 #include <QTimer>
+#include <QVariantMap>
 #include <QWidget>
 
 namespace Ui {
@@ -20,16 +21,19 @@ public:
 
 signals:
     void windowClosed();
+    void drainStatisticsRequested();
 
 public slots:
     void appendMessage(QString message);
     void appendMessageBlock(QStringList messages);
+    void appendDrainStatistics(const QVariantMap &stats);
     void setLogLimit(int lines);
 
 protected:
     void closeEvent(QCloseEvent *event);
 
 private slots:
+    void on_latency_clicked();
     void on_copy_clicked();
     void on_save_clicked();
     void on_clear_clicked();
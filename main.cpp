@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <clocale>
 #include <csignal>
 #include <cstring>
@@ -16,6 +17,7 @@
 #include <QThread>
 #include <QTranslator>
 #include <QLibraryInfo>
+#include "directoryindex.h"
 #include "logger.h"
 #include "main.h"
 #include "qprocess.h"
@@ -41,6 +43,7 @@ constexpr char keyStreams[] = "streams";
 
 constexpr char optConsoleLog[] = "log-to-console";
 constexpr char optConsoleLogEx[] = "--log-to-console";
+constexpr char optThumbnailsEx[] = "--thumbnails";
 
 //---------------------------------------------------------------------------
 
@@ -54,7 +57,14 @@ int main(int argc, char *argv[])
     std::signal(SIGTERM, signalHandler);
     std::signal(SIGSEGV, signalHandler);
 
-    Flow::earlyPlatformOverride();
+    bool foundThumbnailsOpt = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strncmp(argv[i], optThumbnailsEx, std::strlen(optThumbnailsEx))) {
+            foundThumbnailsOpt = true;
+            break;
+        }
+    }
+    Flow::earlyPlatformOverride(foundThumbnailsOpt);
 
     QApplication a(argc, argv);
     bool foundLoggingOpt = false;
@@ -121,6 +131,8 @@ bool Flow::settingsDisableWindowManagement = false;
 Flow::Flow(QObject *owner) :
     QObject(owner)
 {
+    coldStartTimer.start();
+
     // Start logging early
     logThread = new QThread();
     logThread->start();
@@ -132,6 +144,14 @@ Flow::Flow(QObject *owner) :
             logger, &Logger::flushMessages,
             Qt::BlockingQueuedConnection);
 
+    // logger -> this, which holds on to messages until the log window is made
+    connect(logger, &Logger::logMessage,
+            this, &Flow::logger_logMessage,
+            Qt::QueuedConnection);
+    connect(logger, &Logger::logMessageBuffer,
+            this, &Flow::logger_logMessageBuffer,
+            Qt::QueuedConnection);
+
     readConfig();
     Logger::log("main", "finished reading config");
 }
@@ -157,7 +177,7 @@ Flow::~Flow()
         // settings, but they do inherit them.
         if (programMode == PrimaryMode) {
             updateRecentPosition(false);
-            settings = settingsWindow->settings();
+            settings = settingsModel->settings();
             writeConfig();
             storage.writeVList(filePlaylists, mainWindow->playlistWindow()->tabsToVList());
             storage.writeVList(filePlaylistsBackup, PlaylistCollection::getBackup()->toVList());
@@ -202,6 +222,10 @@ Flow::~Flow()
         delete logWindow;
         logWindow = nullptr;
     }
+    if (thumbnailBatch) {
+        delete thumbnailBatch;
+        thumbnailBatch = nullptr;
+    }
     if (logThread) {
         Logger::log("logger", "flushing log before closing it");
         emit flushLog();
@@ -226,6 +250,11 @@ void Flow::parseArgs()
     QCommandLineOption sizeOpt("size", tr("Main window size."), "w,h");
     QCommandLineOption posOpt("pos", tr("Main window position."), "x,y");
     QCommandLineOption loggingOpt(optConsoleLog, tr("Also write logging messages to console."));
+    QCommandLineOption thumbnailsOpt("thumbnails", tr("Make thumbnail sheets for every media file in a directory, then quit."), "dir");
+    QCommandLineOption colsOpt("cols", tr("Thumbnail sheet columns."), "n", "4");
+    QCommandLineOption rowsOpt("rows", tr("Thumbnail sheet rows."), "n", "4");
+    QCommandLineOption widthOpt("width", tr("Thumbnail sheet width."), "px", "800");
+    QCommandLineOption jobsOpt("jobs", tr("Thumbnail sheets to make at once."), "n", "0");
 
     parser.addOption(freestandingOpt);
     parser.addOption(noConfigOpt);
@@ -233,6 +262,11 @@ void Flow::parseArgs()
     parser.addOption(sizeOpt);
     parser.addOption(posOpt);
     parser.addOption(loggingOpt);
+    parser.addOption(thumbnailsOpt);
+    parser.addOption(colsOpt);
+    parser.addOption(rowsOpt);
+    parser.addOption(widthOpt);
+    parser.addOption(jobsOpt);
     parser.addPositionalArgument("urls", tr("URLs to open, optionally."), "[urls...]");
 
     parser.process(QCoreApplication::arguments());
@@ -243,6 +277,15 @@ void Flow::parseArgs()
     validCliSize = parser.isSet(sizeOpt) && Helpers::sizeFromString(cliSize, parser.value(sizeOpt));
     validCliPos = parser.isSet(posOpt) && Helpers::pointFromString(cliPos, parser.value(posOpt));
     customFiles = parser.positionalArguments();
+
+    if (parser.isSet(thumbnailsOpt)) {
+        programMode = ThumbnailMode;
+        cliThumbnails.directory = parser.value(thumbnailsOpt);
+        cliThumbnails.cols = std::clamp(parser.value(colsOpt).toInt(), 1, 12);
+        cliThumbnails.rows = std::clamp(parser.value(rowsOpt).toInt(), 1, 12);
+        cliThumbnails.imageWidth = std::clamp(parser.value(widthOpt).toInt(), 800, 8192);
+        cliThumbnails.jobs = std::max(0, parser.value(jobsOpt).toInt());
+    }
 }
 
 void Flow::detectMode() {
@@ -284,6 +327,11 @@ void Flow::init() {
 
     Logger::log("main", "starting init");
 
+    if (programMode == ThumbnailMode) {
+        initThumbnailBatch();
+        return;
+    }
+
     // Create our windows
     Logger::log("main", "creating main window");
     mainWindow = new MainWindow();
@@ -291,24 +339,10 @@ void Flow::init() {
     playbackManager = new PlaybackManager(this);
     playbackManager->setMpvObject(mainWindow->mpvObject(), true);
     playbackManager->setPlaylistWindow(mainWindow->playlistWindow());
-    Logger::log("main", "creating settings window");
-    settingsWindow = new SettingsWindow();
-    settingsWindow->setWindowModality(Qt::WindowModal);
-    if (settingsDisableWindowManagement)
-        settingsWindow->disableWindowManagment();
-    Logger::log("main", "creating properties window");
-    propertiesWindow = new PropertiesWindow();
-    Logger::log("main", "creating favorites window");
-    favoritesWindow = new FavoritesWindow();
-    Logger::log("main", "creating goto window");
-    gotoWindow = new GoToWindow();
-    Logger::log("main", "creating log window");
-    logWindow = new LogWindow();
-    Logger::log("main", "creating library window");
-    libraryWindow = new LibraryWindow();
-    Logger::log("main", "creating thumbnailer window");
-    thumbnailerWindow = new ThumbnailerWindow();
+    Logger::log("main", "creating settings model");
+    settingsModel = new SettingsModel(this);
 
+    // The other windows are made when they are first asked for.
     Logger::log("main", "finished creating windows");
 
     // Start our servers
@@ -332,7 +366,6 @@ void Flow::init() {
     QSet<ScreenSaver::Ability> desiredPowers;
     desiredPowers << ScreenSaver::Inhibit << ScreenSaver::Uninhibit;
     manipulateScreensaver = actualPowers.contains(desiredPowers);
-    settingsWindow->setScreensaverDisablingEnabled(manipulateScreensaver);
 
     // Initialize the device manager if present
     if (Platform::deviceManager()->deviceAccessPossible()) {
@@ -354,31 +387,26 @@ void Flow::init() {
         Logger::log("main", "completed setting up primary servers");
     }
 
-    // update player framework
-    settingsWindow->takeActions(mainWindow->editableActions());
-    mainWindow->setRecentDocuments(recentFiles);
-    mainWindow->setFavoriteTracks(favoriteFiles, favoriteStreams);
-    favoritesWindow->setFiles(favoriteFiles);
-    favoritesWindow->setStreams(favoriteStreams);
-
-    settingsWindow->setAudioDevices(mainWindow->mpvObject()->audioDevices());
-    settingsWindow->takeSettings(settings);
-    settingsWindow->setMouseMapDefaults(mainWindow->mouseMapDefaults());
-    settingsWindow->takeKeyMap(keyMap);
-    settingsWindow->sendSignals();
-    settingsWindow->sendAcceptedSettings();
-
     // Turn our servers on in primary mode
     if (programMode == PrimaryMode) {
         server->listen();
         mpvServer->listen();
     }
-    // and notify settings window of our server
-    settingsWindow->setServerName(server->fullServerName());
+
+    // update player framework
+    settingsModel->takeActions(mainWindow->editableActions());
+    mainWindow->setRecentDocuments(recentFiles);
+    mainWindow->setFavoriteTracks(favoriteFiles, favoriteStreams);
+
+    settingsModel->setAudioDevices(mainWindow->mpvObject()->audioDevices());
+    settingsModel->setMouseMapDefaults(mainWindow->mouseMapDefaults());
+    settingsModel->takeSettings(settings);
+    settingsModel->takeKeyMap(keyMap);
+    settingsModel->sendSignals();
+    settingsModel->sendAcceptedSettings();
 
     // Turn certain things off in freestanding mode
     mainWindow->setFreestanding(programMode == FreestandingMode);
-    settingsWindow->setFreestanding(programMode == FreestandingMode);
 
     Logger::log("main", "finished initialization");
     showVersionInfo();
@@ -387,6 +415,12 @@ void Flow::init() {
 
 int Flow::run()
 {
+    if (programMode == ThumbnailMode) {
+        Logger::log("main", "telling the thumbnailer to run");
+        thumbnailBatch->execute(cliThumbnails);
+        return qApp->exec();
+    }
+
     // Load our data
     auto playlist = cliNoFiles ? QVariantList() : storage.readVList(filePlaylists);
     auto backup = cliNoFiles ? QVariantList() : storage.readVList(filePlaylistsBackup);
@@ -395,11 +429,15 @@ int Flow::run()
     // Send data to the ui
     mainWindow->playlistWindow()->tabsFromVList(playlist);
     PlaylistCollection::getBackup()->fromVList(backup);
-    libraryWindow->refreshLibrary();
 
     // Restore our window positions
     restoreWindows_v2(geometry);
 
+    // Say how long starting up took, once the event loop has got going
+    QTimer::singleShot(0, this, [this]() {
+        Logger::log("main", QString("cold start took %1 ms").arg(coldStartTimer.elapsed()));
+    });
+
     // Wait here until quit
     Logger::log("main", "telling the program to run");
     return qApp->exec();
@@ -410,8 +448,16 @@ bool Flow::earlyQuit()
     return programMode == EarlyQuitMode;
 }
 
-void Flow::earlyPlatformOverride()
+void Flow::earlyPlatformOverride(bool headless)
 {
+    // Batch thumbnailing renders in software and never shows a window, so
+    // it can run without a display, e.g. over ssh or from cron.
+    if (headless) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        return;
+    }
+
     if (!Platform::isUnix)
         return;
 
@@ -529,7 +575,7 @@ void Flow::setupMainWindowConnections()
     connect(mainWindow, &MainWindow::chapterSelected,
             playbackManager, &PlaybackManager::navigateToChapter);
     connect(mainWindow, &MainWindow::timeSelected,
-            playbackManager, &PlaybackManager::navigateToTime);
+            playbackManager, &PlaybackManager::scrubToTime);
     connect(mainWindow, &MainWindow::favoriteCurrentTrack,
             playbackManager, &PlaybackManager::sendCurrentTrackInfo);
 
@@ -541,10 +587,6 @@ void Flow::setupMainWindowConnections()
     connect(mainWindow->playlistWindow(), &PlaylistWindow::hideFullscreenChanged,
             mainWindow, &MainWindow::setFullscreenHidePanels);
 
-    // propertieswindow -> mainwindow
-    connect(propertiesWindow, &PropertiesWindow::artistAndTitleChanged,
-            mainWindow, &MainWindow::setMediaTitle);
-
     // mainwindow -> playlistwindow
     connect(mainWindow, &MainWindow::playCurrentItemRequested,
             mainWindow->playlistWindow(), &PlaylistWindow::playCurrentItem);
@@ -584,57 +626,49 @@ void Flow::setupMainWindowConnections()
             mainWindow, &MainWindow::setVideoBitrate);
     connect(playbackManager, &PlaybackManager::afterPlaybackReset,
             mainWindow, &MainWindow::resetPlayAfterOnce);
+    connect(playbackManager, &PlaybackManager::startingPlayingFile,
+            mainWindow, &MainWindow::setPreviewSource);
 
     // mainwindow -> favorites
     connect(mainWindow, &MainWindow::organizeFavorites,
-            favoritesWindow, &FavoritesWindow::show);
+            this, [this]() { getFavoritesWindow()->show(); });
 
     // mainwindow -> goto
     connect(mainWindow, &MainWindow::showGoToWindow,
-            gotoWindow, &GoToWindow::init);
-
-    // favorites -> mainwindow
-    connect(favoritesWindow, &FavoritesWindow::favoriteTracks,
-            mainWindow, &MainWindow::setFavoriteTracks);
+            this, [this](double playTime, double playLength, double fps) {
+        getGoToWindow()->init(playTime, playLength, fps);
+    });
 
     // mainwindow -> properties
     connect(mainWindow, &MainWindow::showFileProperties,
-            propertiesWindow, &QWidget::show);
+            this, [this]() { getPropertiesWindow()->show(); });
 
     // mainwindow -> log
     connect(mainWindow, &MainWindow::showLogWindow,
-            logWindow, &LogWindow::show);
-    connect(mainWindow, &MainWindow::hideLogWindow,
-            logWindow, &LogWindow::close);
-    connect(logWindow, &LogWindow::windowClosed,
-            mainWindow, &MainWindow::logWindowClosed);
+            this, [this]() { getLogWindow()->show(); });
+    connect(mainWindow, &MainWindow::hideLogWindow, this, [this]() {
+        if (logWindow)
+            logWindow->close();
+    });
 
     // mainwindow -> library
     connect(mainWindow, &MainWindow::showLibraryWindow,
-            libraryWindow, &LibraryWindow::show);
-    connect(mainWindow, &MainWindow::hideLibraryWindow,
-            libraryWindow, &LibraryWindow::hide);
-    connect(libraryWindow, &LibraryWindow::windowClosed,
-            mainWindow, &MainWindow::libraryWindowClosed);
-    connect(libraryWindow, &LibraryWindow::playlistRestored,
-            mainWindow->playlistWindow(), &PlaylistWindow::addPlaylistByUuid);
-    connect(mainWindow->playlistWindow(), &PlaylistWindow::playlistMovedToBackup,
-            libraryWindow, &LibraryWindow::refreshLibrary);
+            this, [this]() { getLibraryWindow()->show(); });
+    connect(mainWindow, &MainWindow::hideLibraryWindow, this, [this]() {
+        if (libraryWindow)
+            libraryWindow->hide();
+    });
 }
 
 void Flow::setupManagerConnections()
 {
     // manager -> favorites
     connect(playbackManager, &PlaybackManager::currentTrackInfo,
-            favoritesWindow, &FavoritesWindow::addTrack);
+            this, &Flow::manager_currentTrackInfo);
 
     // manager -> settings
     connect(playbackManager, &PlaybackManager::playerSettingsRequested,
-            settingsWindow, &SettingsWindow::sendSignals);
-
-    // goto -> manager
-    connect(gotoWindow, &GoToWindow::goTo,
-            playbackManager, &PlaybackManager::navigateToTime);
+            settingsModel, &SettingsModel::sendSignals);
 }
 
 void Flow::setupSettingsConnections()
@@ -642,106 +676,110 @@ void Flow::setupSettingsConnections()
 
     // mainwindow -> settings
     connect(mainWindow, &MainWindow::volumeChanged,
-            settingsWindow, &SettingsWindow::setVolume);
+            settingsModel, &SettingsModel::setVolume);
     connect(mainWindow, &MainWindow::zoomPresetChanged,
-            settingsWindow, &SettingsWindow::setZoomPreset);
+            settingsModel, &SettingsModel::setZoomPreset);
 
     // settings -> mainwindow
-    connect(settingsWindow, &SettingsWindow::trayIcon,
+    connect(settingsModel, &SettingsModel::trayIcon,
             mainWindow, &MainWindow::setTrayIcon);
-    connect(settingsWindow, &SettingsWindow::mouseWindowedMap,
+    connect(settingsModel, &SettingsModel::mouseWindowedMap,
             mainWindow, &MainWindow::setWindowedMouseMap);
-    connect(settingsWindow, &SettingsWindow::mouseFullscreenMap,
+    connect(settingsModel, &SettingsModel::mouseFullscreenMap,
             mainWindow, &MainWindow::setFullscreenMouseMap);
-    connect(settingsWindow, &SettingsWindow::iconTheme,
+    connect(settingsModel, &SettingsModel::iconTheme,
             mainWindow, &MainWindow::setIconTheme);
-    connect(settingsWindow, &SettingsWindow::highContrastWidgets,
+    connect(settingsModel, &SettingsModel::highContrastWidgets,
             mainWindow, &MainWindow::setHighContrastWidgets);
-    connect(settingsWindow, &SettingsWindow::infoStatsColors,
+    connect(settingsModel, &SettingsModel::infoStatsColors,
             mainWindow, &MainWindow::setInfoColors);
-    connect(settingsWindow, &SettingsWindow::volume,
+    connect(settingsModel, &SettingsModel::volume,
             mainWindow, &MainWindow::setVolume);
-    connect(settingsWindow, &SettingsWindow::volumeStep,
+    connect(settingsModel, &SettingsModel::volumeStep,
             mainWindow, &MainWindow::setVolumeStep);
-    connect(settingsWindow, &SettingsWindow::zoomPreset,
+    connect(settingsModel, &SettingsModel::zoomPreset,
             mainWindow, &MainWindow::setZoomPreset);
-    connect(settingsWindow, &SettingsWindow::zoomCenter,
+    connect(settingsModel, &SettingsModel::zoomCenter,
             mainWindow, &MainWindow::setZoomCenter);
-    connect(settingsWindow, &SettingsWindow::mouseHideTimeFullscreen,
+    connect(settingsModel, &SettingsModel::mouseHideTimeFullscreen,
             mainWindow, &MainWindow::setMouseHideTimeFullscreen);
-    connect(settingsWindow, &SettingsWindow::mouseHideTimeWindowed,
+    connect(settingsModel, &SettingsModel::mouseHideTimeWindowed,
             mainWindow, &MainWindow::setMouseHideTimeWindowed);
-    connect(settingsWindow, &SettingsWindow::fullscreenScreen,
+    connect(settingsModel, &SettingsModel::fullscreenScreen,
             mainWindow, &MainWindow::setFullscreenName);
-    connect(settingsWindow, &SettingsWindow::fullscreenAtLaunch,
+    connect(settingsModel, &SettingsModel::fullscreenAtLaunch,
             mainWindow, &MainWindow::setFullscreenOnPlay);
-    connect(settingsWindow, &SettingsWindow::fullscreenExitAtEnd,
+    connect(settingsModel, &SettingsModel::fullscreenExitAtEnd,
             mainWindow, &MainWindow::setFullscreenExitOnEnd);
-    connect(settingsWindow, &SettingsWindow::fullscreenHideControls,
+    connect(settingsModel, &SettingsModel::fullscreenHideControls,
             mainWindow, &MainWindow::setControlsInFullscreen);
-    connect(settingsWindow, &SettingsWindow::hidePanels,
+    connect(settingsModel, &SettingsModel::hidePanels,
             mainWindow, &MainWindow::setFullscreenHidePanels);
-    connect(settingsWindow, &SettingsWindow::volumeMax,
+    connect(settingsModel, &SettingsModel::volumeMax,
             mainWindow, &MainWindow::setVolumeMax);
-    connect(settingsWindow, &SettingsWindow::subtitlesDelayStep,
+    connect(settingsModel, &SettingsModel::subtitlesDelayStep,
             mainWindow, &MainWindow::setSubtitlesDelayStep);
-    connect(settingsWindow, &SettingsWindow::timeShorten,
+    connect(settingsModel, &SettingsModel::timeShorten,
             mainWindow, &MainWindow::setTimeShortMode);
-    connect(settingsWindow, &SettingsWindow::timeTooltip,
+    connect(settingsModel, &SettingsModel::timeTooltip,
             mainWindow, &MainWindow::setTimeTooltip);
-    connect(settingsWindow, &SettingsWindow::osdTimerOnSeek,
+    connect(settingsModel, &SettingsModel::seekPreviews,
+            mainWindow, &MainWindow::setSeekPreviews);
+    connect(settingsModel, &SettingsModel::keyframeSnapping,
+            mainWindow, &MainWindow::setKeyframeSnapping);
+    connect(settingsModel, &SettingsModel::waveform,
+            mainWindow, &MainWindow::setWaveform);
+    connect(settingsModel, &SettingsModel::osdTimerOnSeek,
             mainWindow, &MainWindow::setOsdTimerOnSeek);
 
     // settings -> playlistWindow
-    connect(settingsWindow, &SettingsWindow::iconTheme,
+    connect(settingsModel, &SettingsModel::iconTheme,
             mainWindow->playlistWindow(), &PlaylistWindow::setIconTheme);
-    connect(settingsWindow, &SettingsWindow::hidePanels,
+    connect(settingsModel, &SettingsModel::hidePanels,
             mainWindow->playlistWindow(), &PlaylistWindow::setHideFullscreen);
-    connect(settingsWindow, &SettingsWindow::playlistFormat,
+    connect(settingsModel, &SettingsModel::playlistFormat,
             mainWindow->playlistWindow(), &PlaylistWindow::setDisplayFormatSpecifier);
+    connect(settingsModel, &SettingsModel::playlistNaturalSort,
+            mainWindow->playlistWindow(), &PlaylistWindow::setNaturalSort);
+    connect(settingsModel, &SettingsModel::playlistNaturalSort,
+            DirectoryIndex::singleton(), &DirectoryIndex::setNaturalOrder);
 
     // playlistWindow -> settings
     connect(mainWindow->playlistWindow(), &PlaylistWindow::hideFullscreenChanged,
-            settingsWindow, &SettingsWindow::setHidePanels);
+            settingsModel, &SettingsModel::setHidePanels);
 
     // settings -> manager
-    connect(settingsWindow, &SettingsWindow::speedStep,
+    connect(settingsModel, &SettingsModel::speedStep,
             playbackManager, &PlaybackManager::setSpeedStep);
-    connect(settingsWindow, &SettingsWindow::speedStepAdditive,
+    connect(settingsModel, &SettingsModel::speedStepAdditive,
             playbackManager, &PlaybackManager::setSpeedStepAdditive);
-    connect(settingsWindow, &SettingsWindow::stepTimeNormal,
+    connect(settingsModel, &SettingsModel::stepTimeNormal,
             playbackManager, &PlaybackManager::setStepTimeNormal);
-    connect(settingsWindow, &SettingsWindow::stepTimeLarge,
+    connect(settingsModel, &SettingsModel::stepTimeLarge,
             playbackManager, &PlaybackManager::setStepTimeLarge);
-    connect(settingsWindow, &SettingsWindow::trackSubtitlePreference,
+    connect(settingsModel, &SettingsModel::trackSubtitlePreference,
             playbackManager, &PlaybackManager::setSubtitleTrackPreference);
-    connect(settingsWindow, &SettingsWindow::trackAudioPreference,
+    connect(settingsModel, &SettingsModel::trackAudioPreference,
             playbackManager, &PlaybackManager::setAudioTrackPreference);
-    connect(settingsWindow, &SettingsWindow::playbackForever,
+    connect(settingsModel, &SettingsModel::playbackForever,
             playbackManager, &PlaybackManager::setPlaybackForever);
-    connect(settingsWindow, &SettingsWindow::playbackPlayTimes,
+    connect(settingsModel, &SettingsModel::playbackPlayTimes,
             playbackManager, &PlaybackManager::setPlaybackPlayTimes);
-    connect(settingsWindow, &SettingsWindow::fallbackToFolder,
+    connect(settingsModel, &SettingsModel::fallbackToFolder,
             playbackManager, &PlaybackManager::setFolderFallback);
-    connect(settingsWindow, &SettingsWindow::subsPreferDefaultForced,
+    connect(settingsModel, &SettingsModel::subsPreferDefaultForced,
             playbackManager, &PlaybackManager::setSubtitlesPreferDefaultForced);
-    connect(settingsWindow, &SettingsWindow::subsPreferExternal,
+    connect(settingsModel, &SettingsModel::subsPreferExternal,
             playbackManager, &PlaybackManager::setSubtitlesPreferExternal);
-    connect(settingsWindow, &SettingsWindow::subsIgnoreEmbeded,
+    connect(settingsModel, &SettingsModel::subsIgnoreEmbeded,
             playbackManager, &PlaybackManager::setSubtitlesIgnoreEmbedded);
-    connect(settingsWindow, &SettingsWindow::afterPlaybackDefault,
+    connect(settingsModel, &SettingsModel::afterPlaybackDefault,
             playbackManager, &PlaybackManager::setAfterPlaybackAlwaysDefault);
-    connect(settingsWindow, &SettingsWindow::afterPlaybackDefault,
+    connect(settingsModel, &SettingsModel::afterPlaybackDefault,
             mainWindow, &MainWindow::setPlayAfterAlwaysDefault);
 
-    // settings -> thumbnailer
-    connect(settingsWindow, &SettingsWindow::screenshotDirectory,
-            thumbnailerWindow, &ThumbnailerWindow::setScreenshotDirectory);
-    connect(settingsWindow, &SettingsWindow::screenshotFormat,
-            thumbnailerWindow, &ThumbnailerWindow::setScreenshotFormat);
-
     // settings -> application
-    connect(settingsWindow, &SettingsWindow::applicationPalette,
+    connect(settingsModel, &SettingsModel::applicationPalette,
             qApp, [](const QPalette &pal) { qApp->setPalette(pal); });
 }
 
@@ -749,54 +787,35 @@ void Flow::setupMpvObjectConnections()
 {
     // settings -> mpvwidget
     auto mpvObject = mainWindow->mpvObject();
-    connect(settingsWindow, &SettingsWindow::videoColor,
+    connect(settingsModel, &SettingsModel::videoColor,
             mpvObject, &MpvObject::setLogoBackground);
-    connect(settingsWindow, &SettingsWindow::logoSource,
+    connect(settingsModel, &SettingsModel::logoSource,
             mpvObject, &MpvObject::setLogoUrl);
-    connect(settingsWindow, &SettingsWindow::volume,
+    connect(settingsModel, &SettingsModel::volume,
             mpvObject, &MpvObject::setVolume);
-    connect(settingsWindow, &SettingsWindow::option,
+    connect(settingsModel, &SettingsModel::option,
             mpvObject, &MpvObject::setCachedMpvOption);
-    connect(settingsWindow, &SettingsWindow::audioFilter,
+    connect(settingsModel, &SettingsModel::audioFilter,
             mpvObject, &MpvObject::setAudioFilter);
-    connect(settingsWindow, &SettingsWindow::clientDebuggingMessages,
+    connect(settingsModel, &SettingsModel::clientDebuggingMessages,
             mpvObject, &MpvObject::setClientDebuggingMessages);
-    connect(settingsWindow, &SettingsWindow::mpvLogLevel,
+    connect(settingsModel, &SettingsModel::mpvLogLevel,
             mpvObject, &MpvObject::setMpvLogLevel);
-    connect(settingsWindow, &SettingsWindow::mpvMouseEvents,
+    connect(settingsModel, &SettingsModel::mpvMouseEvents,
             mpvObject, &MpvObject::setSendMouseEvents);
-    connect(settingsWindow, &SettingsWindow::mpvKeyEvents,
+    connect(settingsModel, &SettingsModel::mpvKeyEvents,
             mpvObject, &MpvObject::setSendKeyEvents);
 
     // mpvwidget -> settings
     connect(mpvObject, &MpvObject::audioDeviceList,
-            settingsWindow, &SettingsWindow::setAudioDevices);
-
-    // mpvwidget -> properties
-    connect(mpvObject, &MpvObject::fileNameChanged,
-            propertiesWindow, &PropertiesWindow::setFileName);
-    connect(mpvObject, &MpvObject::fileFormatChanged,
-            propertiesWindow, &PropertiesWindow::setFileFormat);
-    connect(mpvObject, &MpvObject::fileSizeChanged,
-            propertiesWindow, &PropertiesWindow::setFileSize);
-    connect(mpvObject, &MpvObject::playLengthChanged,
-            propertiesWindow, &PropertiesWindow::setMediaLength);
-    connect(mpvObject, &MpvObject::videoSizeChanged,
-            propertiesWindow, &PropertiesWindow::setVideoSize);
-    connect(mpvObject, &MpvObject::fileCreationTimeChanged,
-            propertiesWindow, &PropertiesWindow::setFileCreationTime);
-    connect(mpvObject, &MpvObject::tracksChanged,
-            propertiesWindow, &PropertiesWindow::setTracks);
-    connect(mpvObject, &MpvObject::mediaTitleChanged,
-            propertiesWindow, &PropertiesWindow::setMediaTitle);
-    connect(mpvObject, &MpvObject::filePathChanged,
-            propertiesWindow, &PropertiesWindow::setFilePath);
-    connect(mpvObject, &MpvObject::metaDataChanged,
-            propertiesWindow, &PropertiesWindow::setMetaData);
-    connect(mpvObject, &MpvObject::chaptersChanged,
-            propertiesWindow, &PropertiesWindow::setChapters);
+            settingsModel, &SettingsModel::setAudioDevices);
 
     // mpvwidget -> mainwindow
+    connect(mpvObject, &MpvObject::metaDataChanged,
+            mainWindow, [this](const QVariantMap &data) {
+        if (data.contains("artist") && data.contains("title"))
+            mainWindow->setMediaTitle(data["artist"].toString() + " - " + data["title"].toString());
+    });
     connect(mpvObject, &MpvObject::audioTrackSet,
             mainWindow, &MainWindow::audioTrackSet);
     connect(mpvObject, &MpvObject::subtitleTrackSet,
@@ -808,14 +827,14 @@ void Flow::setupMpvObjectConnections()
 
     // settingswindow -> log
     auto logger = Logger::singleton();
-    connect(settingsWindow, &SettingsWindow::loggingEnabled,
+    connect(settingsModel, &SettingsModel::loggingEnabled,
             logger, &Logger::setLoggingEnabled);
-    connect(settingsWindow, &SettingsWindow::logFilePath,
+    connect(settingsModel, &SettingsModel::logFilePath,
             logger, &Logger::setLogFile);
-    connect(settingsWindow, &SettingsWindow::logDelay,
+    connect(settingsModel, &SettingsModel::logDelay,
             logger, &Logger::setFlushTime);
-    connect(settingsWindow, &SettingsWindow::logHistory,
-            logWindow, &LogWindow::setLogLimit);
+    connect(settingsModel, &SettingsModel::logHistory,
+            this, &Flow::settingswindow_logHistory);
 }
 
 void Flow::setupFlowConnections()
@@ -863,35 +882,35 @@ void Flow::setupFlowConnections()
             this, &Flow::manager_playingNextFile);
 
     // settings -> this
-    connect(settingsWindow, &SettingsWindow::settingsData,
+    connect(settingsModel, &SettingsModel::settingsData,
             this, &Flow::settingswindow_settingsData);
-    connect(settingsWindow, &SettingsWindow::keyMapData,
+    connect(settingsModel, &SettingsModel::keyMapData,
             this, &Flow::settingswindow_keymapData);
-    connect(settingsWindow, &SettingsWindow::inhibitScreensaver,
+    connect(settingsModel, &SettingsModel::inhibitScreensaver,
             this, &Flow::settingswindow_inhibitScreensaver);
-    connect(settingsWindow, &SettingsWindow::rememberHistory,
+    connect(settingsModel, &SettingsModel::rememberHistory,
             this, &Flow::settingswindow_rememberHistory);
-    connect(settingsWindow, &SettingsWindow::rememberFilePosition,
+    connect(settingsModel, &SettingsModel::rememberFilePosition,
             this, &Flow::settingswindow_rememberFilePosition);
-    connect(settingsWindow, &SettingsWindow::rememberWindowGeometry,
+    connect(settingsModel, &SettingsModel::rememberWindowGeometry,
             this, &Flow::settingswindow_rememberWindowGeometry);
-    connect(settingsWindow, &SettingsWindow::rememberPanels,
+    connect(settingsModel, &SettingsModel::rememberPanels,
             this, &Flow::settingswindow_rememberPanels);
-    connect(settingsWindow, &SettingsWindow::mprisIpc,
+    connect(settingsModel, &SettingsModel::mprisIpc,
             this, &Flow::settingswindow_mprisIpc);
-    connect(settingsWindow, &SettingsWindow::stylesheetIsFusion,
+    connect(settingsModel, &SettingsModel::stylesheetIsFusion,
             this, &Flow::settingswindow_stylesheetIsFusion);
-    connect(settingsWindow, &SettingsWindow::stylesheetText,
+    connect(settingsModel, &SettingsModel::stylesheetText,
             this, &Flow::settingswindow_stylesheetText);
-    connect(settingsWindow, &SettingsWindow::screenshotDirectory,
+    connect(settingsModel, &SettingsModel::screenshotDirectory,
             this, &Flow::settingswindow_screenshotDirectory);
-    connect(settingsWindow, &SettingsWindow::encodeDirectory,
+    connect(settingsModel, &SettingsModel::encodeDirectory,
             this, &Flow::settingswindow_encodeDirectory);
-    connect(settingsWindow, &SettingsWindow::screenshotTemplate,
+    connect(settingsModel, &SettingsModel::screenshotTemplate,
             this, &Flow::settingswindow_screenshotTemplate);
-    connect(settingsWindow, &SettingsWindow::encodeTemplate,
+    connect(settingsModel, &SettingsModel::encodeTemplate,
             this, &Flow::settingswindow_encodeTemplate);
-    connect(settingsWindow, &SettingsWindow::screenshotFormat,
+    connect(settingsModel, &SettingsModel::screenshotFormat,
             this, &Flow::settingswindow_screenshotFormat);
 
     // playlistwindow -> this.storage
@@ -912,12 +931,6 @@ void Flow::setupFlowConnections()
     connect(playbackManager, &PlaybackManager::systemShouldStandby,
             screenSaver, &ScreenSaver::suspendSystem);
 
-    // favorites -> this.favorite*
-    connect(favoritesWindow, &FavoritesWindow::favoriteTracks,
-            this, &Flow::favoriteswindow_favoriteTracks);
-    connect(favoritesWindow, &FavoritesWindow::favoriteTracksCancel,
-            this, &Flow::favoriteswindow_favoriteTracksCancel);
-
     // this.screensaver -> this
     connect(screenSaver, &ScreenSaver::systemShutdown,
             this, &Flow::endProgram);
@@ -989,17 +1002,17 @@ void Flow::setupMpcHc()
             this, &Flow::mpcHcServer_fileSelected);
 
     // settings -> mpcHcServer
-    connect(settingsWindow, &SettingsWindow::webserverListening,
+    connect(settingsModel, &SettingsModel::webserverListening,
             mpcHcServer, &MpcHcServer::setEnabled);
-    connect(settingsWindow, &SettingsWindow::webserverPort,
+    connect(settingsModel, &SettingsModel::webserverPort,
             mpcHcServer, &MpcHcServer::setTcpPort);
-    connect(settingsWindow, &SettingsWindow::webserverLocalhost,
+    connect(settingsModel, &SettingsModel::webserverLocalhost,
             mpcHcServer, &MpcHcServer::setLocalHostOnly);
-    connect(settingsWindow, &SettingsWindow::webserverServePages,
+    connect(settingsModel, &SettingsModel::webserverServePages,
             mpcHcServer, &MpcHcServer::setServeFiles);
-    connect(settingsWindow, &SettingsWindow::webserverRoot,
+    connect(settingsModel, &SettingsModel::webserverRoot,
             mpcHcServer, &MpcHcServer::setWebRoot);
-    connect(settingsWindow, &SettingsWindow::webserverDefaultPage,
+    connect(settingsModel, &SettingsModel::webserverDefaultPage,
             mpcHcServer, &MpcHcServer::setDefaultPage);
 
     // mpcHcServer -> mainWindow
@@ -1133,6 +1146,18 @@ void Flow::setupMpcHc()
             mpcHcServer, &MpcHcServer::setPlaybackState);
 }
 
+void Flow::initThumbnailBatch()
+{
+    // No windows, servers or saved state in this mode.  The exit is queued
+    // because an empty directory finishes before the event loop is running.
+    Logger::log("main", "creating thumbnail batch");
+    thumbnailBatch = new ThumbnailBatch(this);
+    connect(thumbnailBatch, &ThumbnailBatch::finished,
+            qApp, [](int failures) {
+        qApp->exit(failures ? 1 : 0);
+    }, Qt::QueuedConnection);
+}
+
 bool Flow::isNvidiaGPU()
 {
     bool foundNvidia = false;
@@ -1219,14 +1244,23 @@ QVariantMap Flow::favoritesToVMap() const
 
 QVariantMap Flow::windowsToVMap_v2()
 {
+    // Windows that were never made keep where they were last time.
+    QVariantMap previousJson = windowManager.json();
+    auto saveWindow = [this, &previousJson](QWidget *window, const QString &objectName) {
+        if (window)
+            windowManager.saveWindow(window);
+        else
+            windowManager.keepWindow(objectName, previousJson);
+    };
+
     windowManager.clearJson();
     if (rememberPanels)
         windowManager.saveDocks(mainWindow->dockHost());
     if (rememberWindowGeometry) {
-        windowManager.saveWindow(settingsWindow);
-        windowManager.saveWindow(propertiesWindow);
-        windowManager.saveWindow(logWindow);
-        windowManager.saveWindow(libraryWindow);
+        saveWindow(settingsWindow, "SettingsWindow");
+        saveWindow(propertiesWindow, "PropertiesWindow");
+        saveWindow(logWindow, "LogWindow");
+        saveWindow(libraryWindow, "LibraryWindow");
     }
     windowManager.saveAppWindow(mainWindow, rememberWindowGeometry, rememberPanels);
     return windowManager.json();
@@ -1238,10 +1272,10 @@ void Flow::restoreWindows_v2(const QVariantMap &geometryMap)
 
     windowManager.setJson(geometryMap);
     windowManager.restoreDocks(mainWindow->dockHost(), { mainWindow->playlistWindow() });
-    windowManager.restoreWindow(settingsWindow);
-    windowManager.restoreWindow(propertiesWindow);
-    windowManager.restoreWindow(logWindow);
-    windowManager.restoreWindow(libraryWindow);
+    // The other windows are put back when they are made, apart from the
+    // settings window, which may have been made already.
+    if (settingsWindow)
+        windowManager.restoreWindow(settingsWindow);
     windowManager.restoreAppWindow(mainWindow, cliInfo);
 
     // Tell the main window it can process size requests et al now
@@ -1252,6 +1286,200 @@ void Flow::restoreWindows_v2(const QVariantMap &geometryMap)
     QTimer::singleShot(50, this, &Flow::windowsRestored);
 }
 
+SettingsWindow *Flow::getSettingsWindow()
+{
+    if (settingsWindow)
+        return settingsWindow;
+
+    Logger::log("main", "creating settings window");
+    settingsWindow = new SettingsWindow(settingsModel);
+    settingsWindow->setWindowModality(Qt::WindowModal);
+    if (settingsDisableWindowManagement)
+        settingsWindow->disableWindowManagment();
+    settingsWindow->setScreensaverDisablingEnabled(manipulateScreensaver);
+    settingsWindow->setServerName(server->fullServerName());
+    settingsWindow->setFreestanding(programMode == FreestandingMode);
+    windowManager.restoreWindow(settingsWindow);
+
+    // mpvwidget -> settings
+    connect(mainWindow->mpvObject(), &MpvObject::audioDeviceList,
+            settingsWindow, &SettingsWindow::setAudioDevices);
+    return settingsWindow;
+}
+
+PropertiesWindow *Flow::getPropertiesWindow()
+{
+    if (propertiesWindow)
+        return propertiesWindow;
+
+    Logger::log("main", "creating properties window");
+    propertiesWindow = new PropertiesWindow();
+    windowManager.restoreWindow(propertiesWindow);
+
+    // mpvwidget -> properties
+    auto mpvObject = mainWindow->mpvObject();
+    connect(mpvObject, &MpvObject::fileNameChanged,
+            propertiesWindow, &PropertiesWindow::setFileName);
+    connect(mpvObject, &MpvObject::fileFormatChanged,
+            propertiesWindow, &PropertiesWindow::setFileFormat);
+    connect(mpvObject, &MpvObject::fileSizeChanged,
+            propertiesWindow, &PropertiesWindow::setFileSize);
+    connect(mpvObject, &MpvObject::playLengthChanged,
+            propertiesWindow, &PropertiesWindow::setMediaLength);
+    connect(mpvObject, &MpvObject::videoSizeChanged,
+            propertiesWindow, &PropertiesWindow::setVideoSize);
+    connect(mpvObject, &MpvObject::fileCreationTimeChanged,
+            propertiesWindow, &PropertiesWindow::setFileCreationTime);
+    connect(mpvObject, &MpvObject::tracksChanged,
+            propertiesWindow, &PropertiesWindow::setTracks);
+    connect(mpvObject, &MpvObject::mediaTitleChanged,
+            propertiesWindow, &PropertiesWindow::setMediaTitle);
+    connect(mpvObject, &MpvObject::filePathChanged,
+            propertiesWindow, &PropertiesWindow::setFilePath);
+    connect(mpvObject, &MpvObject::metaDataChanged,
+            propertiesWindow, &PropertiesWindow::setMetaData);
+    connect(mpvObject, &MpvObject::chaptersChanged,
+            propertiesWindow, &PropertiesWindow::setChapters);
+
+    // The window missed what was said about the file playing before it was
+    // made, so ask the player again.
+    propertiesWindow->setMediaLength(mpvObject->playLength());
+    propertiesWindow->setVideoSize(mpvObject->videoSize());
+    QUrl playing = playbackManager->nowPlaying();
+    if (playing.isEmpty())
+        return propertiesWindow;
+    auto fetch = [this, mpvObject, playing](const QString &name,
+                                            std::function<void(const QVariant &)> setter) {
+        mpvObject->getMpvPropertyVariantAsync(name).then(propertiesWindow,
+                                                         [this, playing, setter](const QVariant &value) {
+            // A newer file will have told the window about itself already.
+            if (playbackManager->nowPlaying() == playing)
+                setter(value);
+        });
+    };
+    fetch("filename", [this](const QVariant &v) { propertiesWindow->setFileName(v.toString()); });
+    fetch("file-format", [this](const QVariant &v) { propertiesWindow->setFileFormat(v.toString()); });
+    fetch("file-size", [this](const QVariant &v) { propertiesWindow->setFileSize(v.toLongLong()); });
+    fetch("file-date-created", [this](const QVariant &v) { propertiesWindow->setFileCreationTime(v.toLongLong()); });
+    fetch("track-list", [this](const QVariant &v) { propertiesWindow->setTracks(v.toList()); });
+    fetch("media-title", [this](const QVariant &v) { propertiesWindow->setMediaTitle(v.toString()); });
+    fetch("path", [this](const QVariant &v) { propertiesWindow->setFilePath(v.toString()); });
+    fetch("chapter-list", [this](const QVariant &v) { propertiesWindow->setChapters(v.toList()); });
+    fetch("metadata", [this](const QVariant &v) {
+        // Keys are lowercased like those of MpvObject::metaDataChanged.
+        QVariantMap metadata;
+        const QVariantMap map = v.toMap();
+        for (auto it = map.cbegin(); it != map.cend(); it++)
+            metadata.insert(it.key().toLower(), it.value());
+        propertiesWindow->setMetaData(metadata);
+    });
+    return propertiesWindow;
+}
+
+FavoritesWindow *Flow::getFavoritesWindow()
+{
+    if (favoritesWindow)
+        return favoritesWindow;
+
+    Logger::log("main", "creating favorites window");
+    favoritesWindow = new FavoritesWindow();
+    favoritesWindow->setFiles(favoriteFiles);
+    favoritesWindow->setStreams(favoriteStreams);
+
+    // favorites -> mainwindow
+    connect(favoritesWindow, &FavoritesWindow::favoriteTracks,
+            mainWindow, &MainWindow::setFavoriteTracks);
+
+    // favorites -> this.favorite*
+    connect(favoritesWindow, &FavoritesWindow::favoriteTracks,
+            this, &Flow::favoriteswindow_favoriteTracks);
+    connect(favoritesWindow, &FavoritesWindow::favoriteTracksCancel,
+            this, &Flow::favoriteswindow_favoriteTracksCancel);
+    return favoritesWindow;
+}
+
+GoToWindow *Flow::getGoToWindow()
+{
+    if (gotoWindow)
+        return gotoWindow;
+
+    Logger::log("main", "creating goto window");
+    gotoWindow = new GoToWindow();
+
+    // goto -> manager
+    connect(gotoWindow, &GoToWindow::goTo,
+            playbackManager, &PlaybackManager::navigateToTime);
+    return gotoWindow;
+}
+
+LogWindow *Flow::getLogWindow()
+{
+    if (logWindow)
+        return logWindow;
+
+    Logger::log("main", "creating log window");
+    logWindow = new LogWindow();
+    windowManager.restoreWindow(logWindow);
+    logWindow->setLogLimit(logLimit);
+    if (!logBacklog.isEmpty())
+        logWindow->appendMessageBlock(logBacklog);
+    logBacklog.clear();
+
+    // log -> mainwindow
+    connect(logWindow, &LogWindow::windowClosed,
+            mainWindow, &MainWindow::logWindowClosed);
+
+    // log -> mpvobject
+    connect(logWindow, &LogWindow::drainStatisticsRequested, this, [this]() {
+        mainWindow->mpvObject()->drainStatistics().then(logWindow, [this](const QVariant &v) {
+            logWindow->appendDrainStatistics(v.toMap());
+        });
+    });
+    return logWindow;
+}
+
+LibraryWindow *Flow::getLibraryWindow()
+{
+    if (libraryWindow)
+        return libraryWindow;
+
+    Logger::log("main", "creating library window");
+    libraryWindow = new LibraryWindow();
+    windowManager.restoreWindow(libraryWindow);
+    libraryWindow->refreshLibrary();
+
+    // library -> mainwindow
+    connect(libraryWindow, &LibraryWindow::windowClosed,
+            mainWindow, &MainWindow::libraryWindowClosed);
+    connect(libraryWindow, &LibraryWindow::playlistRestored,
+            mainWindow->playlistWindow(), &PlaylistWindow::addPlaylistByUuid);
+    connect(libraryWindow, &LibraryWindow::playlistCreated,
+            mainWindow->playlistWindow(), &PlaylistWindow::addPlaylistByUuid);
+
+    // playlistwindow -> library
+    connect(mainWindow->playlistWindow(), &PlaylistWindow::playlistMovedToBackup,
+            libraryWindow, &LibraryWindow::refreshLibrary);
+    return libraryWindow;
+}
+
+ThumbnailerWindow *Flow::getThumbnailerWindow()
+{
+    if (thumbnailerWindow)
+        return thumbnailerWindow;
+
+    Logger::log("main", "creating thumbnailer window");
+    thumbnailerWindow = new ThumbnailerWindow();
+    thumbnailerWindow->setScreenshotDirectory(screenshotDirectory);
+    thumbnailerWindow->setScreenshotFormat(screenshotFormat);
+
+    // settings -> thumbnailer
+    connect(settingsModel, &SettingsModel::screenshotDirectory,
+            thumbnailerWindow, &ThumbnailerWindow::setScreenshotDirectory);
+    connect(settingsModel, &SettingsModel::screenshotFormat,
+            thumbnailerWindow, &ThumbnailerWindow::setScreenshotFormat);
+    return thumbnailerWindow;
+}
+
 void Flow::self_windowsRestored()
 {
     server->fakePayload(makePayload());
@@ -1375,13 +1603,13 @@ void Flow::mainwindow_takeImageAutomatically(Helpers::ScreenshotRender render)
 
 void Flow::mainwindow_takeThumbnails()
 {
-    thumbnailerWindow->open(playbackManager->nowPlaying());
+    getThumbnailerWindow()->open(playbackManager->nowPlaying());
 }
 
 void Flow::mainwindow_optionsOpenRequested()
 {
     // Load the settings window with data and show it
-    settingsWindow->takeSettings(settings);
+    getSettingsWindow()->takeSettings(settings);
     settingsWindow->takeKeyMap(keyMap);
     settingsWindow->show();
     settingsWindow->raise();
@@ -1472,6 +1700,20 @@ void Flow::manager_stoppedPlaying()
     updateRecentPosition(true);
 }
 
+void Flow::manager_currentTrackInfo(const TrackInfo &track)
+{
+    if (favoritesWindow) {
+        favoritesWindow->addTrack(track);
+        return;
+    }
+    // Without the window, do what it would have done with the track.
+    if (track.url.isLocalFile())
+        favoriteFiles.append(track);
+    else
+        favoriteStreams.append(track);
+    mainWindow->setFavoriteTracks(favoriteFiles, favoriteStreams);
+}
+
 void Flow::mpcHcServer_fileSelected(QString fileName)
 {
     // Send the file open request to our playback manager
@@ -1596,6 +1838,33 @@ void Flow::settingswindow_screenshotFormat(const QString &fmt)
     this->screenshotFormat = fmt;
 }
 
+void Flow::settingswindow_logHistory(int lines)
+{
+    logLimit = lines;
+    if (logWindow)
+        logWindow->setLogLimit(lines);
+}
+
+void Flow::logger_logMessage(QString message)
+{
+    if (logWindow)
+        logWindow->appendMessage(message);
+    else
+        logger_logMessageBuffer({ message });
+}
+
+void Flow::logger_logMessageBuffer(QStringList messages)
+{
+    if (logWindow) {
+        logWindow->appendMessageBlock(messages);
+        return;
+    }
+    // Kept to the same number of lines the window would have kept.
+    logBacklog.append(messages);
+    if (logLimit > 0 && logBacklog.count() > logLimit)
+        logBacklog.remove(0, logBacklog.count() - logLimit);
+}
+
 void Flow::favoriteswindow_favoriteTracks(const QList<TrackInfo> &files, const QList<TrackInfo> &streams)
 {
     // Remember our favorite files and streams for later
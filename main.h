@@ -1,5 +1,6 @@
 #ifndef MAIN_H
 #define MAIN_H
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMetaMethod>
 #include "ipc/http.h"
@@ -27,7 +28,7 @@ void signalHandler(int signal);
 // a simple class to control program execution and own application objects
 class Flow : public QObject {
     Q_OBJECT
-    enum ProgramMode { UnknownMode, EarlyQuitMode, PrimaryMode, FreestandingMode, };
+    enum ProgramMode { UnknownMode, EarlyQuitMode, PrimaryMode, FreestandingMode, ThumbnailMode, };
 
 public:
     explicit Flow(QObject *owner = nullptr);
@@ -38,7 +39,7 @@ public:
     void init();
     int run();
     bool earlyQuit();
-    static void earlyPlatformOverride();
+    static void earlyPlatformOverride(bool headless);
     static bool isNvidiaGPU();
 
 signals:
@@ -55,6 +56,7 @@ private:
     void setupFlowConnections();
     void setupMpris();
     void setupMpcHc();
+    void initThumbnailBatch();
     void updateRecentPosition(bool resetPosition);
     void updateRecents(QUrl url, QUuid listUuid, QUuid itemUuid, QString title, double length,
                        double position, int64_t videoTrack, int64_t audioTrack, int64_t subtitleTrack);
@@ -65,6 +67,13 @@ private:
     QVariantMap favoritesToVMap() const;
     QVariantMap windowsToVMap_v2();
     void restoreWindows_v2(const QVariantMap &geometryMap);
+    SettingsWindow *getSettingsWindow();
+    PropertiesWindow *getPropertiesWindow();
+    FavoritesWindow *getFavoritesWindow();
+    GoToWindow *getGoToWindow();
+    LogWindow *getLogWindow();
+    LibraryWindow *getLibraryWindow();
+    ThumbnailerWindow *getThumbnailerWindow();
 
 private slots:
     void self_windowsRestored();
@@ -86,6 +95,7 @@ private slots:
     void manager_openingNewFile();
     void manager_startingPlayingFile(QUrl url);
     void manager_stoppedPlaying();
+    void manager_currentTrackInfo(const TrackInfo &track);
     void mpcHcServer_fileSelected(QString fileName);
     void settingswindow_settingsData(const QVariantMap &settings);
     void settingswindow_inhibitScreensaver(bool yes);
@@ -102,6 +112,9 @@ private slots:
     void settingswindow_screenshotTemplate(const QString &fmt);
     void settingswindow_encodeTemplate(const QString &fmt);
     void settingswindow_screenshotFormat(const QString &fmt);
+    void settingswindow_logHistory(int lines);
+    void logger_logMessage(QString message);
+    void logger_logMessageBuffer(QStringList messages);
     void favoriteswindow_favoriteTracks(const QList<TrackInfo> &files, const QList<TrackInfo> &streams);
     void favoriteswindow_favoriteTracksCancel();
 
@@ -118,6 +131,7 @@ private:
     ScreenSaver *screenSaver = nullptr;
     MainWindow *mainWindow = nullptr;
     PlaybackManager *playbackManager = nullptr;
+    SettingsModel *settingsModel = nullptr;
     SettingsWindow *settingsWindow = nullptr;
     PropertiesWindow *propertiesWindow = nullptr;
     FavoritesWindow *favoritesWindow = nullptr;
@@ -125,6 +139,7 @@ private:
     LogWindow *logWindow = nullptr;
     LibraryWindow *libraryWindow = nullptr;
     ThumbnailerWindow *thumbnailerWindow = nullptr;
+    ThumbnailBatch *thumbnailBatch = nullptr;
     QThread *logThread = nullptr;
     WindowManager windowManager;
     Storage storage;
@@ -133,6 +148,9 @@ private:
     QList<TrackInfo> recentFiles;
     QList<TrackInfo> favoriteFiles;
     QList<TrackInfo> favoriteStreams;
+    QStringList logBacklog;
+    int logLimit = 1000;
+    QElapsedTimer coldStartTimer;
 
     ProgramMode programMode = UnknownMode;
     bool cliNoConfig = false;
@@ -142,6 +160,7 @@ private:
     bool validCliSize = false;
     bool validCliPos = false;
     QStringList customFiles;
+    ThumbnailBatch::Options cliThumbnails;
 
     static bool settingsDisableWindowManagement;
     bool firstFile = true;
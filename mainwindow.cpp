@@ -7,6 +7,7 @@
 #include "platform/unify.h"
 #include "platform/devicemanager.h"
 #include <QActionGroup>
+#include <QGuiApplication>
 #include <QClipboard>
 #include <QLocale>
 #include <QStyle>
@@ -686,8 +687,12 @@ void MainWindow::setupPositionSlider()
     ui->seekbar->layout()->addWidget(positionSlider_);
     connect(positionSlider_, &MediaSlider::sliderMoved,
             this, &MainWindow::position_sliderMoved);
+    connect(positionSlider_, &MediaSlider::sliderReleased,
+            this, &MainWindow::position_sliderReleased);
     connect(positionSlider_, &MediaSlider::hoverValue,
             this, &MainWindow::position_hoverValue);
+    connect(positionSlider_, &MediaSlider::hoverEnd,
+            this, &MainWindow::position_hoverEnd);
 }
 
 void MainWindow::setupVolumeSlider()
@@ -717,7 +722,10 @@ void MainWindow::setupMpvObject()
 {
     mpvObject_ = new MpvObject(this, textWindowTitle);
     mpvObject_->setHostWindow(mpvHost_);
-    setupMpvWidget(Helpers::GlCbWidget);
+    // There is no gl to be had on the offscreen platform, so fall back to
+    // mpv's software renderer there.
+    bool offscreen = QGuiApplication::platformName() == "offscreen";
+    setupMpvWidget(offscreen ? Helpers::SwRenderWidget : Helpers::GlCbWidget);
     connect(mpvObject_, &MpvObject::logoSizeChanged,
             this, &MainWindow::setNoVideoSize);
     connect(mpvObject_, &MpvObject::subTextChanged,
@@ -1288,6 +1296,27 @@ QIcon MainWindow::createIconFromSvg(const QString& svgPath, int maxSize) {
     return icon;
 }
 
+void MainWindow::setPreviewSource(QUrl url)
+{
+    // The previewer is only made on the first hover over the seekbar, the
+    // indexer on the first drag, and the analyzer (when wanted at all) once
+    // there's something to look at.
+    previewSource = url;
+    if (seekPreviewer)
+        seekPreviewer->setSource(url);
+    if (keyframeIndexer)
+        keyframeIndexer->setSource(url);
+    if (!waveformAnalyzer && waveformShown && url.isLocalFile()) {
+        waveformAnalyzer = new WaveformAnalyzer(this);
+        connect(waveformAnalyzer, &WaveformAnalyzer::waveformChanged,
+                positionSlider_, &MediaSlider::setWaveform);
+    }
+    if (waveformAnalyzer)
+        waveformAnalyzer->setSource(url);
+    if (previewPopup)
+        previewPopup->setImage(QImage());
+}
+
 void MainWindow::httpQuickOpenFile()
 {
     if (ui->actionFileOpenQuick->isEnabled())
@@ -1867,6 +1896,42 @@ void MainWindow::setTimeTooltip(bool shown, bool above)
     timeTooltipAbove = above;
 }
 
+void MainWindow::setSeekPreviews(bool enabled)
+{
+    seekPreviewsShown = enabled;
+    if (enabled || !seekPreviewer)
+        return;
+    delete seekPreviewer;
+    seekPreviewer = nullptr;
+    previewBucket = -1;
+    if (previewPopup)
+        previewPopup->hide();
+}
+
+void MainWindow::setKeyframeSnapping(bool enabled)
+{
+    keyframeSnapping = enabled;
+    if (enabled || !keyframeIndexer)
+        return;
+    delete keyframeIndexer;
+    keyframeIndexer = nullptr;
+}
+
+void MainWindow::setWaveform(bool enabled)
+{
+    waveformShown = enabled;
+    if (enabled) {
+        if (!waveformAnalyzer && previewSource.isLocalFile())
+            setPreviewSource(previewSource);
+        return;
+    }
+    if (!waveformAnalyzer)
+        return;
+    delete waveformAnalyzer;
+    waveformAnalyzer = nullptr;
+    positionSlider_->setWaveform(Waveform());
+}
+
 void MainWindow::setOsdTimerOnSeek(bool enabled)
 {
     osdTimerOnSeek = enabled;
@@ -3010,9 +3075,28 @@ void MainWindow::mpvw_customContextMenuRequested(const QPoint &pos)
     contextMenu->popup(mpvw->mapToGlobal(pos));
 }
 
-void MainWindow::position_sliderMoved(int position)
+void MainWindow::position_sliderMoved(double position)
 {
-    emit timeSelected(position);
+    // A click seeks exactly, straight away.  Keyframes can be shown without
+    // decoding anything else, so once it turns into a drag, land on the
+    // nearest one instead, and seek exactly once let go.
+    if (!positionSlider_->dragMoved()) {
+        emit timeSelected(position, true);
+        return;
+    }
+    if (keyframeSnapping && !keyframeIndexer && previewSource.isLocalFile()) {
+        keyframeIndexer = new KeyframeIndexer(this);
+        keyframeIndexer->setSource(previewSource);
+    }
+    if (keyframeIndexer)
+        position = keyframeIndexer->snap(position);
+    emit timeSelected(position, false);
+}
+
+void MainWindow::position_sliderReleased(double position)
+{
+    if (positionSlider_->dragMoved())
+        emit timeSelected(position, true);
 }
 
 void MainWindow::position_hoverValue(double position, QString chapterInfo, double x)
@@ -3025,10 +3109,44 @@ void MainWindow::position_hoverValue(double position, QString chapterInfo, doubl
                                             timeShortMode ? Helpers::ShortFormat : Helpers::LongFormat),
                                       chapterInfo.isEmpty() ? "" : " - ",
                                       chapterInfo);
-    QPoint where = positionSlider_->mapToGlobal(QPoint(int(x), timeTooltipAbove ? -40 : 0));
-    QToolTip::showText(where, t, positionSlider_);
+    if (!seekPreviewer && seekPreviewsShown && previewSource.isLocalFile()) {
+        seekPreviewer = new SeekPreviewer(this);
+        connect(seekPreviewer, &SeekPreviewer::previewReady,
+                this, &MainWindow::previewer_previewReady);
+        seekPreviewer->setSource(previewSource);
+    }
+    int bucket = seekPreviewer ? seekPreviewer->request(position) : -1;
+    if (bucket < 0) {
+        // No preview to be had, so fall back to the system tooltip
+        QPoint where = positionSlider_->mapToGlobal(QPoint(int(x), timeTooltipAbove ? -40 : 0));
+        QToolTip::showText(where, t, positionSlider_);
+        return;
+    }
+
+    // The previous frame stays up until the new one arrives, which is less
+    // jarring than flashing an empty box while moving the mouse.
+    if (!previewPopup)
+        previewPopup = new PreviewPopup(this);
+    previewBucket = bucket;
+    previewPopup->setText(t);
+    QPoint anchor(int(x), timeTooltipAbove ? 0 : positionSlider_->height());
+    previewPopup->showAt(positionSlider_->mapToGlobal(anchor), timeTooltipAbove);
+}
+
+void MainWindow::position_hoverEnd()
+{
+    previewBucket = -1;
+    if (seekPreviewer)
+        seekPreviewer->cancel();
+    if (previewPopup)
+        previewPopup->hide();
+}
 
-    //FIXME: use a widget not the system tooltip?
+void MainWindow::previewer_previewReady(int bucket, QImage image)
+{
+    if (bucket != previewBucket || !previewPopup)
+        return;
+    previewPopup->setImage(image);
 }
 
 void MainWindow::on_play_clicked()
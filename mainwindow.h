@@ -9,10 +9,14 @@
 #include "helpers.h"
 #include "widgets/drawnslider.h"
 #include "widgets/drawnstatus.h"
+#include "widgets/previewpopup.h"
 #include "manager.h"
 #include "playlistwindow.h"
 #include "platform/screensaver.h"
 #include "platform/windowmanager.h"
+#include "keyframeindex.h"
+#include "seekpreview.h"
+#include "waveform.h"
 
 namespace Ui {
 class MainWindow;
@@ -159,7 +163,7 @@ signals:
     void fileNext(bool forceFolderFallback);
     void showGoToWindow(double playTime, double playLength, double fps);
     void chapterSelected(int64_t id);
-    void timeSelected(double time);
+    void timeSelected(double time, bool exact);
     void fullscreenModeChanged(bool fullscreen);
     void zoomPresetChanged(int which);
     void playCurrentItemRequested();
@@ -170,6 +174,7 @@ signals:
     void repeatAfter();
 
 public slots:
+    void setPreviewSource(QUrl url);
     void httpQuickOpenFile();
     void httpOpenFileUrl();
     void httpSaveImage();
@@ -249,6 +254,9 @@ public slots:
     void setBottomAreaBehavior(Helpers::ControlHiding method);
     void setBottomAreaHideTime(int milliseconds);
     void setTimeTooltip(bool show, bool above);
+    void setSeekPreviews(bool enabled);
+    void setKeyframeSnapping(bool enabled);
+    void setWaveform(bool enabled);
     void setOsdTimerOnSeek(bool enabled);
     void setFullscreenHidePanels(bool hidden);
     void setPlaybackState(PlaybackManager::PlaybackState state);
@@ -406,8 +414,11 @@ private slots:
     void on_actionPlaylistSearch_triggered();
 
     void mpvw_customContextMenuRequested(const QPoint &pos);
-    void position_sliderMoved(int position);
+    void position_sliderMoved(double position);
+    void position_sliderReleased(double position);
     void position_hoverValue(double value, QString text, double x);
+    void position_hoverEnd();
+    void previewer_previewReady(int bucket, QImage image);
     void on_play_clicked();
     void volume_sliderMoved(double position);
     void playlistWindow_windowDocked();
@@ -428,6 +439,12 @@ private:
     //MpvGlCbWidget *mpvw = nullptr;
     MediaSlider *positionSlider_ = nullptr;
     VolumeSlider *volumeSlider_ = nullptr;
+    SeekPreviewer *seekPreviewer = nullptr;
+    KeyframeIndexer *keyframeIndexer = nullptr;
+    WaveformAnalyzer *waveformAnalyzer = nullptr;
+    PreviewPopup *previewPopup = nullptr;
+    QUrl previewSource;
+    int previewBucket = -1;
     StatusTime *timePosition = nullptr;
     StatusTime *timeDuration = nullptr;
     PlaylistWindow *playlistWindow_ = nullptr;
@@ -453,6 +470,9 @@ private:
     int bottomAreaHideTime = 0;
     bool timeTooltipShown = true;
     bool timeTooltipAbove = true;
+    bool seekPreviewsShown = true;
+    bool keyframeSnapping = true;
+    bool waveformShown = false;
     bool osdTimerOnSeek = false;
     bool timeShortMode = false;
 
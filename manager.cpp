@@ -1,4 +1,5 @@
 #include <QRegularExpression>
+#include "directoryindex.h"
 #include "manager.h"
 #include "playlistwindow.h"
 #include "logger.h"
@@ -144,11 +145,17 @@ void PlaybackManager::openSeveralFiles(QList<QUrl> what, bool important)
     bool playAfterAdd = (playlistWindow_->isCurrentPlaylistEmpty()
                          && (important || nowPlayingItem == QUuid()))
                         || !playlistWindow_->isVisible();
-    PlaylistItem playlistItem = playlistWindow_->addToCurrentPlaylist(what);
-    if (playAfterAdd && !playlistItem.item.isNull()) {
-        QUrl urlToPlay = playlistWindow_->getUrlOf(playlistItem.list, playlistItem.item);
-        startPlayWithUuid(urlToPlay, playlistItem.list, playlistItem.item, false);
+    std::function<void(PlaylistItem)> play;
+    if (playAfterAdd) {
+        play = [this](PlaylistItem playlistItem) {
+            QUrl urlToPlay = playlistWindow_->getUrlOf(playlistItem.list, playlistItem.item);
+            startPlayWithUuid(urlToPlay, playlistItem.list, playlistItem.item, false);
+        };
     }
+    // Files found in directories come in later, and the first is played then
+    PlaylistItem playlistItem = playlistWindow_->addToCurrentPlaylist(what, play);
+    if (playAfterAdd && !playlistItem.item.isNull())
+        play(playlistItem);
 }
 
 void PlaybackManager::openFile(QUrl what, QUrl with)
@@ -156,11 +163,13 @@ void PlaybackManager::openFile(QUrl what, QUrl with)
     if (!nowPlayingItem.isNull())
         emit openingNewFile();
 
-    PlaylistItem playlistItem = playlistWindow_->urlToQuickPlaylist(what);
-    if (!playlistItem.item.isNull()) {
+    auto play = [this, with](PlaylistItem playlistItem) {
         QUrl urlToPlay = playlistWindow_->getUrlOf(playlistItem.list, playlistItem.item);
         startPlayWithUuid(urlToPlay, playlistItem.list, playlistItem.item, false, with);
-    }
+    };
+    PlaylistItem playlistItem = playlistWindow_->urlToQuickPlaylist(what, play);
+    if (!playlistItem.item.isNull())
+        play(playlistItem);
 }
 
 void PlaybackManager::playDiscFiles(QUrl where)
@@ -312,7 +321,9 @@ void PlaybackManager::deltaExtraPlaytimes(int delta)
 
 void PlaybackManager::navigateToChapter(int64_t chapter)
 {
-    if (!mpvObject_->setChapter(chapter)) {
+    mpvObject_->setChapter(chapter).then(this, [this](bool success) {
+        if (success)
+            return;
         // Out-of-bounds chapter navigation request. i.e. unseekable chapter
         // from either past-the-end or invalid.  So stop playback and continue
         // on the next via the playback finished slot.
@@ -323,7 +334,7 @@ void PlaybackManager::navigateToChapter(int64_t chapter)
             mpvObject_->setPaused(false);
             mpvObject_->stopPlayback();
         }
-    }
+    });
 }
 
 void PlaybackManager::navigateToTime(double time)
@@ -334,6 +345,14 @@ void PlaybackManager::navigateToTime(double time)
         mpvObject_->setTime(time);
 }
 
+void PlaybackManager::scrubToTime(double time, bool exact)
+{
+    if (playbackState_ == WaitingState || playbackState_ == StoppedState)
+        mpvStartTime = time;
+    else
+        mpvObject_->scrubTo(time, exact);
+}
+
 void PlaybackManager::speedUp()
 {
     double speed = speedStepAdditive ? mpvSpeed + speedStep - 1.0
@@ -730,30 +749,12 @@ void PlaybackManager::playPrevTrack()
 bool PlaybackManager::playNextFileUrl(QUrl url, int delta)
 {
     Logger::log("manager", "playNextFileUrl");
-    QFileInfo info;
-    QDir dir;
-    QStringList files;
-    int index;
-    QString nextFile;
-
-
-    if (url.isEmpty())
-        return false;
-    info = QFileInfo(url.toLocalFile());
-    if (!info.exists())
+    if (url.isEmpty() || !url.isLocalFile())
         return false;
-    dir = info.dir();
-    files = dir.entryList(QDir::Files, QDir::Name);
-    index = files.indexOf(info.fileName());
-    if (index == -1)
+    QString nextFile = DirectoryIndex::singleton()->neighbour(url.toLocalFile(), delta);
+    if (nextFile.isEmpty())
         return false;
-    do {
-        index += delta;
-        if (index < 0 || index >= files.count())
-            return false;
-        nextFile = dir.filePath(files.value(index));
-        url = QUrl::fromLocalFile(nextFile);
-    } while (!Helpers::urlSurvivesFilter(url, true));
+    url = QUrl::fromLocalFile(nextFile);
     emit playingNextFile();
     playlistWindow_->clearPlaylist(nowPlayingList);
     QUuid nowPlayingItemLocal = playlistWindow_->addToPlaylist(nowPlayingList, { url }).item;
@@ -979,6 +980,11 @@ void PlaybackManager::mpvw_playlistChanged(const QVariantList &playlist)
         if (Helpers::urlSurvivesFilter(QUrl::fromUserInput(i.toMap()["filename"].toString()), false))
             urls.append(QUrl::fromUserInput(i.toMap()["filename"].toString()));
     }
-    playlistWindow_->replaceItem(nowPlayingList, nowPlayingItem, urls);
-    playItem(nowPlayingList, nowPlayingItem);
+    // Directories in the list are walked first, so play the item once it
+    // has been replaced rather than straight away.
+    QUuid list = nowPlayingList;
+    QUuid item = nowPlayingItem;
+    playlistWindow_->replaceItem(list, item, urls, [this, list, item]() {
+        playItem(list, item);
+    });
 }
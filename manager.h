@@ -123,6 +123,7 @@ public slots:
     void deltaExtraPlaytimes(int delta);
     void navigateToChapter(int64_t chapter);
     void navigateToTime(double time);
+    void scrubToTime(double time, bool exact);
     void speedUp();
     void speedDown();
     void speedReset();
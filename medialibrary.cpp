@@ -0,0 +1,538 @@
+#include <QCollator>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <limits>
+#include "helpers.h"
+#include "logger.h"
+#include "medialibrary.h"
+#include "metadataprober.h"
+#include "storage.h"
+
+constexpr char logModule[] = "library";
+constexpr char catalogFile[] = "/library.catalog";
+constexpr quint32 catalogMagic = 0x4d50434c; // MPCL
+constexpr quint32 catalogVersion = 1;
+
+// Probe results arrive one file at a time; tell the views about them in
+// batches instead.
+constexpr int changeDelayMsec = 500;
+
+// Probed files are told apart by path, size and modification time, so that
+// a changed file is probed again.
+static const QUuid probeNamespace(0x6d7c1a52, 0x3f0b, 0x4c1e, 0x9b, 0x2d,
+                                  0x51, 0x0e, 0x8a, 0x47, 0xc3, 0x19);
+
+static const struct {
+    const char *label;
+    double from;
+    double to;
+} durationRanges[] = {
+    { QT_TRANSLATE_NOOP("MediaLibrary", "Under 5 minutes"), 0, 300 },
+    { QT_TRANSLATE_NOOP("MediaLibrary", "5 to 20 minutes"), 300, 1200 },
+    { QT_TRANSLATE_NOOP("MediaLibrary", "20 to 60 minutes"), 1200, 3600 },
+    { QT_TRANSLATE_NOOP("MediaLibrary", "Over an hour"), 3600,
+      std::numeric_limits<double>::infinity() }
+};
+
+MediaLibrary *MediaLibrary::singleton()
+{
+    // Parented to the application so that the catalog is saved on the way out.
+    static MediaLibrary *instance = new MediaLibrary(qApp);
+    return instance;
+}
+
+MediaLibrary::MediaLibrary(QObject *parent)
+    : QObject(parent), cancelled(new QAtomicInt(0))
+{
+    // The catalog keeps what the prober finds, so the cache would only
+    // hold a second copy.
+    prober = new MetadataProber(this);
+    prober->setCacheEnabled(false);
+    connect(prober, &MetadataProber::probed,
+            this, &MediaLibrary::prober_probed);
+    connect(prober, &MetadataProber::drained,
+            this, &MediaLibrary::prober_drained);
+
+    changeTimer = new QTimer(this);
+    changeTimer->setSingleShot(true);
+    changeTimer->setInterval(changeDelayMsec);
+    connect(changeTimer, &QTimer::timeout,
+            this, &MediaLibrary::catalogChanged);
+
+    load();
+    if (!roots_.isEmpty())
+        rescan();
+}
+
+MediaLibrary::~MediaLibrary()
+{
+    cancelled->storeRelaxed(1);
+    if (dirty)
+        save();
+}
+
+QStringList MediaLibrary::roots() const
+{
+    return roots_;
+}
+
+void MediaLibrary::addRoot(const QString &path)
+{
+    QString root = QDir::cleanPath(QDir(path).absolutePath());
+    if (roots_.contains(root))
+        return;
+    roots_.append(root);
+    dirty = true;
+    rescan();
+}
+
+void MediaLibrary::removeRoot(const QString &path)
+{
+    if (!roots_.removeOne(path))
+        return;
+    dirty = true;
+    rescan();
+}
+
+void MediaLibrary::rescan()
+{
+    if (scanning) {
+        rescanQueued = true;
+        return;
+    }
+    scanning = true;
+    markChanged();
+
+    QStringList roots = roots_;
+    QSharedPointer<QAtomicInt> cancelled = this->cancelled;
+    QtConcurrent::run([roots, cancelled]() {
+        return scanRoots(roots, cancelled);
+    }).then(this, [this](Scan scan) {
+        scanned(std::move(scan));
+    });
+}
+
+bool MediaLibrary::isScanning() const
+{
+    return scanning;
+}
+
+int MediaLibrary::count() const
+{
+    return entries.count();
+}
+
+int MediaLibrary::pendingCount() const
+{
+    return probing.count();
+}
+
+QStringList MediaLibrary::keys(Index index) const
+{
+    buildIndexes();
+    switch (index) {
+    case ByArtist:
+        return artistKeys;
+    case ByAlbum:
+        return albumKeys;
+    case ByFolder:
+        return folderKeys;
+    case ByDuration: {
+        QStringList labels;
+        for (const auto &range : durationRanges)
+            labels.append(tr(range.label));
+        return labels;
+    }
+    }
+    return {};
+}
+
+QList<int> MediaLibrary::find(Index index, const QString &key) const
+{
+    buildIndexes();
+    switch (index) {
+    case ByArtist:
+        return byArtist.value(key);
+    case ByAlbum:
+        return byAlbum.value(key);
+    case ByFolder:
+        return byFolder.value(key);
+    case ByDuration:
+        for (const auto &range : durationRanges) {
+            if (tr(range.label) != key)
+                continue;
+            auto shorterThan = [this](int id, double seconds) {
+                return entries[id].duration < seconds;
+            };
+            auto first = std::lower_bound(byDuration.cbegin(), byDuration.cend(),
+                                          range.from, shorterThan);
+            auto last = std::lower_bound(first, byDuration.cend(),
+                                         range.to, shorterThan);
+            QList<int> found(first, last);
+            std::sort(found.begin(), found.end());
+            return found;
+        }
+        break;
+    }
+    return {};
+}
+
+QUrl MediaLibrary::urlOf(int entry) const
+{
+    return QUrl::fromLocalFile(pathOf(entries[entry]));
+}
+
+QString MediaLibrary::displayNameOf(int entry) const
+{
+    const Entry &e = entries[entry];
+    if (e.title.isEmpty())
+        return e.name;
+    if (e.artist.isEmpty())
+        return e.title;
+    return e.artist + " - " + e.title;
+}
+
+QVariantMap MediaLibrary::metadataOf(int entry) const
+{
+    const Entry &e = entries[entry];
+    QVariantMap metadata;
+    if (!e.artist.isEmpty())
+        metadata.insert("artist", e.artist);
+    if (!e.album.isEmpty())
+        metadata.insert("album", e.album);
+    if (!e.title.isEmpty())
+        metadata.insert("title", e.title);
+    if (e.duration > 0)
+        metadata.insert("duration", e.duration);
+    return MetadataProber::displayable(metadata);
+}
+
+MediaLibrary::Scan MediaLibrary::scanRoots(const QStringList &roots,
+                                           const QSharedPointer<QAtomicInt> &cancelled)
+{
+    Scan scan;
+    int visited = 0;
+    for (const QString &root : roots) {
+        // An unplugged drive should not empty its part of the catalog.
+        if (!QFileInfo(root).isDir()) {
+            scan.missing.append(root);
+            continue;
+        }
+        // Symlinked directories are not followed, which keeps loops out.
+        QDirIterator it(root, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            if ((++visited & 255) == 0 && cancelled->loadRelaxed())
+                return Scan();
+            QFileInfo info = it.nextFileInfo();
+            if (!Helpers::audioVideoFileExtensions.contains(info.suffix().toLower().split(" ")[0]))
+                continue;
+            scan.files.append({ info.filePath(), info.size(),
+                                info.lastModified().toMSecsSinceEpoch() });
+        }
+    }
+
+    // Entries are kept in path order, so that every index built by walking
+    // them comes out in path order too.
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(scan.files.begin(), scan.files.end(),
+              [&collator](const FileStat &a, const FileStat &b) {
+        return collator.compare(a.path, b.path) < 0;
+    });
+    return scan;
+}
+
+void MediaLibrary::scanned(Scan scan)
+{
+    scanning = false;
+    if (cancelled->loadRelaxed())
+        return;
+
+    // Keep what is known about files under roots that could not be reached.
+    if (!scan.missing.isEmpty()) {
+        for (const Entry &entry : std::as_const(entries)) {
+            QString path = pathOf(entry);
+            for (const QString &root : std::as_const(scan.missing)) {
+                if (path.startsWith(root + "/")) {
+                    scan.files.append({ path, entry.size, entry.modified });
+                    break;
+                }
+            }
+        }
+        QCollator collator;
+        collator.setNumericMode(true);
+        std::sort(scan.files.begin(), scan.files.end(),
+                  [&collator](const FileStat &a, const FileStat &b) {
+            return collator.compare(a.path, b.path) < 0;
+        });
+    }
+
+    QList<Entry> kept;
+    QStringList keptFolders;
+    QHash<QString, int> folderIds;
+    QHash<QString, int> keptEntryOfPath;
+    QList<int> unprobed;
+    int unchanged = 0;
+    kept.reserve(scan.files.count());
+    for (const FileStat &file : std::as_const(scan.files)) {
+        if (keptEntryOfPath.contains(file.path))
+            continue;
+        int slash = file.path.lastIndexOf('/');
+        QString folder = file.path.left(slash);
+        int folderId = folderIds.value(folder, -1);
+        if (folderId < 0) {
+            folderId = keptFolders.count();
+            keptFolders.append(folder);
+            folderIds.insert(folder, folderId);
+        }
+
+        Entry entry;
+        int old = entryOfPath.value(file.path, -1);
+        if (old >= 0 && entries[old].size == file.size
+                && entries[old].modified == file.modified) {
+            entry = entries[old];
+            unchanged++;
+        } else {
+            entry.name = file.path.mid(slash + 1);
+            entry.size = file.size;
+            entry.modified = file.modified;
+        }
+        entry.folder = folderId;
+        if (!entry.probed)
+            unprobed.append(kept.count());
+        keptEntryOfPath.insert(file.path, kept.count());
+        kept.append(entry);
+    }
+
+    if (unchanged != entries.count() || unchanged != kept.count())
+        dirty = true;
+    Logger::log(logModule, QString("scanned %1 files, %2 new or changed, %3 gone")
+                .arg(kept.count()).arg(kept.count() - unchanged)
+                .arg(entries.count() - unchanged));
+    entries = kept;
+    folders = keptFolders;
+    entryOfPath = keptEntryOfPath;
+    markChanged();
+
+    if (rescanQueued) {
+        // Whatever was being probed is asked for again after the rescan.
+        probing.clear();
+        prober->probe({});
+        rescanQueued = false;
+        rescan();
+        return;
+    }
+    probeEntries(unprobed);
+    if (unprobed.isEmpty() && dirty)
+        save();
+}
+
+QString MediaLibrary::pathOf(const Entry &entry) const
+{
+    return folders[entry.folder] + "/" + entry.name;
+}
+
+QUuid MediaLibrary::probeUuid(const Entry &entry) const
+{
+    return QUuid::createUuidV5(probeNamespace, QString("%1|%2|%3").arg(pathOf(entry))
+                               .arg(entry.size).arg(entry.modified));
+}
+
+void MediaLibrary::probeEntries(const QList<int> &ids)
+{
+    probing.clear();
+    QList<MetadataProber::Request> requests;
+    requests.reserve(ids.count());
+    for (int id : ids) {
+        QUuid uuid = probeUuid(entries[id]);
+        probing.insert(uuid, pathOf(entries[id]));
+        requests.append({ QUuid(), uuid, urlOf(id) });
+    }
+    prober->probe(requests);
+}
+
+void MediaLibrary::load()
+{
+    QFile file(Storage::fetchConfigPath() + catalogFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QElapsedTimer clock;
+    clock.start();
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != catalogMagic || version != catalogVersion) {
+        Logger::log(logModule, "ignoring catalog of unknown format");
+        return;
+    }
+
+    QStringList tags;
+    qint32 entryCount = 0;
+    stream >> roots_ >> folders >> tags >> entryCount;
+    auto tag = [&tags](qint32 id) {
+        return id >= 0 && id < tags.count() ? tags[id] : QString();
+    };
+    for (qint32 i = 0; i < entryCount && stream.status() == QDataStream::Ok; i++) {
+        Entry entry;
+        qint32 folder, artist, album;
+        stream >> folder >> entry.name >> entry.size >> entry.modified
+               >> entry.duration >> artist >> album >> entry.title >> entry.probed;
+        if (folder < 0 || folder >= folders.count())
+            break;
+        entry.folder = folder;
+        entry.artist = tag(artist);
+        entry.album = tag(album);
+        entryOfPath.insert(pathOf(entry), entries.count());
+        entries.append(entry);
+    }
+    if (stream.status() != QDataStream::Ok || entries.count() != entryCount) {
+        // Start over, but remember where to look
+        Logger::log(logModule, "catalog is damaged, rescanning");
+        folders.clear();
+        entries.clear();
+        entryOfPath.clear();
+        return;
+    }
+    Logger::log(logModule, QString("loaded %1 files in %2ms")
+                .arg(entries.count()).arg(clock.elapsed()));
+}
+
+void MediaLibrary::save()
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    // Artists and albums repeat a lot, so each is written once and entries
+    // refer to them by number.
+    QStringList tags;
+    QHash<QString, qint32> tagIds;
+    auto tagId = [&tags, &tagIds](const QString &value) {
+        if (value.isEmpty())
+            return qint32(-1);
+        auto it = tagIds.find(value);
+        if (it != tagIds.end())
+            return it.value();
+        tags.append(value);
+        return tagIds.insert(value, qint32(tags.count() - 1)).value();
+    };
+    QList<QPair<qint32,qint32>> entryTags;
+    entryTags.reserve(entries.count());
+    for (const Entry &entry : std::as_const(entries))
+        entryTags.append({ tagId(entry.artist), tagId(entry.album) });
+
+    QSaveFile file(Storage::fetchConfigPath() + catalogFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Logger::log(logModule, "could not write catalog");
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << catalogMagic << catalogVersion
+           << roots_ << folders << tags << qint32(entries.count());
+    for (int i = 0; i < entries.count(); i++) {
+        const Entry &entry = entries[i];
+        stream << qint32(entry.folder) << entry.name << entry.size << entry.modified
+               << entry.duration << entryTags[i].first << entryTags[i].second
+               << entry.title << entry.probed;
+    }
+    if (!file.commit()) {
+        Logger::log(logModule, "could not write catalog");
+        return;
+    }
+    dirty = false;
+    Logger::log(logModule, QString("saved %1 files in %2ms")
+                .arg(entries.count()).arg(clock.elapsed()));
+}
+
+void MediaLibrary::markChanged()
+{
+    indexed = false;
+    if (!changeTimer->isActive())
+        changeTimer->start();
+}
+
+void MediaLibrary::buildIndexes() const
+{
+    if (indexed)
+        return;
+    indexed = true;
+    byArtist.clear();
+    byAlbum.clear();
+    byFolder.clear();
+    byDuration.clear();
+
+    for (int i = 0; i < entries.count(); i++) {
+        const Entry &entry = entries[i];
+        if (!entry.artist.isEmpty())
+            byArtist[entry.artist].append(i);
+        if (!entry.album.isEmpty())
+            byAlbum[entry.album].append(i);
+        byFolder[folders[entry.folder]].append(i);
+        if (entry.duration >= 0)
+            byDuration.append(i);
+    }
+    std::stable_sort(byDuration.begin(), byDuration.end(), [this](int a, int b) {
+        return entries[a].duration < entries[b].duration;
+    });
+
+    QCollator collator;
+    collator.setNumericMode(true);
+    auto sortedKeys = [&collator](const QHash<QString, QList<int>> &index) {
+        QStringList keys = index.keys();
+        std::sort(keys.begin(), keys.end(), [&collator](const QString &a, const QString &b) {
+            return collator.compare(a, b) < 0;
+        });
+        return keys;
+    };
+    artistKeys = sortedKeys(byArtist);
+    albumKeys = sortedKeys(byAlbum);
+    // Folders are already in path order
+    folderKeys.clear();
+    for (const QString &folder : folders)
+        if (byFolder.contains(folder))
+            folderKeys.append(folder);
+}
+
+void MediaLibrary::prober_probed(QUuid list, QUuid item, QVariantMap metadata)
+{
+    Q_UNUSED(list)
+    // Entries are renumbered by every scan, so they are found by path, and
+    // taken only if the file is still the one that was probed.
+    auto it = probing.constFind(item);
+    if (it == probing.cend())
+        return;
+    int id = entryOfPath.value(*it, -1);
+    probing.erase(it);
+    if (id < 0 || probeUuid(entries[id]) != item)
+        return;
+    Entry &entry = entries[id];
+    entry.artist = metadata.value("artist").toString();
+    entry.album = metadata.value("album").toString();
+    entry.title = metadata.value("title").toString();
+    entry.duration = metadata.value("duration", -1.0).toDouble();
+    entry.probed = true;
+    dirty = true;
+    markChanged();
+}
+
+void MediaLibrary::prober_drained()
+{
+    // Files that could not be opened are tried again on the next scan.
+    probing.clear();
+    if (dirty)
+        save();
+    markChanged();
+}
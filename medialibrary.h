@@ -0,0 +1,117 @@
+#ifndef MEDIALIBRARY_H
+#define MEDIALIBRARY_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QUrl>
+#include <QUuid>
+#include <QVariantMap>
+
+class MetadataProber;
+class QTimer;
+
+// MediaLibrary keeps a catalog of the media files found under a few chosen
+// folders, along with their tags and durations, so that they can be browsed
+// and turned into playlists without going back to the disk.  Rescanning
+// lists the folders on a worker thread and compares each file's size and
+// modification time with the catalog, so that only new or changed files are
+// handed to a MetadataProber of its own.  The catalog is a single binary
+// file in the config folder, with folder names and tag values written once
+// each.  Lookups by artist, album, folder and duration go through indexes
+// that are rebuilt on demand after the catalog changes.  Use from the gui
+// thread.
+class MediaLibrary : public QObject {
+    Q_OBJECT
+
+public:
+    enum Index { ByArtist, ByAlbum, ByFolder, ByDuration };
+
+    static MediaLibrary *singleton();
+    ~MediaLibrary();
+
+    QStringList roots() const;
+    void addRoot(const QString &path);
+    void removeRoot(const QString &path);
+    void rescan();
+    bool isScanning() const;
+    int count() const;
+    int pendingCount() const;
+
+    // The keys of an index in display order.  Duration keys are ranges.
+    QStringList keys(Index index) const;
+    // The files under one key, ordered by path.
+    QList<int> find(Index index, const QString &key) const;
+    QUrl urlOf(int entry) const;
+    QString displayNameOf(int entry) const;
+    // The same kind of map the player reports, for filling in playlist items.
+    QVariantMap metadataOf(int entry) const;
+
+signals:
+    void catalogChanged();
+
+private:
+    struct Entry {
+        QString name;
+        int folder = -1;
+        qint64 size = 0;
+        qint64 modified = 0;
+        double duration = -1;
+        QString artist;
+        QString album;
+        QString title;
+        bool probed = false;
+    };
+    struct FileStat {
+        QString path;
+        qint64 size;
+        qint64 modified;
+    };
+    struct Scan {
+        QList<FileStat> files;
+        QStringList missing;
+    };
+
+    explicit MediaLibrary(QObject *parent = nullptr);
+    static Scan scanRoots(const QStringList &roots,
+                          const QSharedPointer<QAtomicInt> &cancelled);
+    void scanned(Scan scan);
+    QString pathOf(const Entry &entry) const;
+    QUuid probeUuid(const Entry &entry) const;
+    void probeEntries(const QList<int> &ids);
+    void load();
+    void save();
+    void markChanged();
+    void buildIndexes() const;
+
+private slots:
+    void prober_probed(QUuid list, QUuid item, QVariantMap metadata);
+    void prober_drained();
+
+private:
+    MetadataProber *prober = nullptr;
+    QTimer *changeTimer = nullptr;
+    QSharedPointer<QAtomicInt> cancelled;
+    QStringList roots_;
+    QStringList folders;
+    QList<Entry> entries;
+    QHash<QString, int> entryOfPath;
+    QHash<QUuid, QString> probing;
+    bool scanning = false;
+    bool rescanQueued = false;
+    bool dirty = false;
+
+    mutable bool indexed = false;
+    mutable QStringList artistKeys;
+    mutable QStringList albumKeys;
+    mutable QStringList folderKeys;
+    mutable QHash<QString, QList<int>> byArtist;
+    mutable QHash<QString, QList<int>> byAlbum;
+    mutable QHash<QString, QList<int>> byFolder;
+    mutable QList<int> byDuration;
+};
+
+#endif // MEDIALIBRARY_H
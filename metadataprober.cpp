@@ -0,0 +1,314 @@
+#include <QDataStream>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include "helpers.h"
+#include "logger.h"
+#include "metadataprober.h"
+#include "mpvwidget.h"
+#include "thumbnailcache.h"
+
+constexpr char logModule[] = "prober";
+constexpr char friendlyName[] = "Media Player Classic Qute Theater - Prober";
+constexpr char cacheKey[] = "metadata:2";
+
+// Each player is a thread and a demuxer of its own, and probing is mostly
+// waiting on the disk, so a couple is plenty.
+constexpr int maxWorkers = 2;
+
+// Files that take longer than this to open are given up on.
+constexpr int probeTimeoutMsec = 10000;
+
+// Players are let go once there has been nothing to do for this long.
+constexpr int idleTimeoutMsec = 5000;
+
+// How many cache lookups are sent to the thread pool at once.
+constexpr int lookupsPerBatch = 64;
+
+MetadataProber::MetadataProber(QObject *parent) : QObject(parent)
+{
+    idleTimer = new QTimer(this);
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(idleTimeoutMsec);
+    connect(idleTimer, &QTimer::timeout,
+            this, &MetadataProber::deleteWorkers);
+}
+
+MetadataProber::~MetadataProber()
+{
+    while (!workers.isEmpty())
+        deleteWorker(workers.first());
+}
+
+void MetadataProber::setCacheEnabled(bool enabled)
+{
+    cacheEnabled = enabled;
+}
+
+void MetadataProber::probe(const QList<Request> &requests)
+{
+    // Only what is still being asked about is remembered, so that neither
+    // set outgrows the caller's list.
+    QSet<QUuid> requested;
+    for (const Request &request : requests)
+        requested.insert(request.item);
+    done.intersect(requested);
+    uncached.intersect(requested);
+
+    pending.clear();
+    for (const Request &request : requests) {
+        if (!request.url.isLocalFile() || done.contains(request.item))
+            continue;
+        bool inFlight = false;
+        for (Worker *worker : std::as_const(workers))
+            inFlight |= worker->busy && worker->request.item == request.item;
+        if (!inFlight)
+            pending.append(request);
+    }
+    // Scheduled even with nothing to do, so that drained is still sent.
+    if (!scheduleQueued) {
+        scheduleQueued = true;
+        QTimer::singleShot(0, this, &MetadataProber::schedule);
+    }
+}
+
+QVariantMap MetadataProber::displayable(const QVariantMap &metadata)
+{
+    auto it = metadata.constFind("duration");
+    if (it == metadata.cend() || it->typeId() != QMetaType::Double)
+        return metadata;
+    QVariantMap map = metadata;
+    double seconds = it->toDouble();
+    map.insert("duration", Helpers::toDateFormatFixed(seconds, seconds < 3600 ? Helpers::ShortHourFormat
+                                                                              : Helpers::ShortFormat));
+    return map;
+}
+
+MetadataProber::Worker *MetadataProber::newWorker()
+{
+    Worker *worker = new Worker;
+    worker->mpv = new MpvObject(this, friendlyName, MpvObject::HelperRole);
+    worker->timeout = new QTimer(this);
+    worker->timeout->setSingleShot(true);
+    worker->timeout->setInterval(probeTimeoutMsec);
+    workers.append(worker);
+
+    connect(worker->mpv, &MpvObject::playbackLoading,
+            this, [this, worker]() { mpv_playbackLoading(worker); });
+    connect(worker->mpv, &MpvObject::playbackStarted,
+            this, [this, worker]() { mpv_playbackStarted(worker); });
+    connect(worker->mpv, &MpvObject::playbackFinished,
+            this, [this, worker]() { mpv_playbackFinished(worker); });
+    connect(worker->timeout, &QTimer::timeout, this, [this, worker]() {
+        // The player may be stuck on a slow share, so start over with a
+        // fresh one rather than queue behind it.
+        Logger::log(logModule, QString("timed out on %1").arg(worker->request.url.toString()));
+        done.insert(worker->request.item);
+        deleteWorker(worker);
+        schedule();
+    });
+
+    // Open the file, read its headers, and go no further: nothing is shown
+    // or heard, and no other files are looked for.  mpv gives up on a file
+    // with neither video nor audio selected, so both are left to choose,
+    // and being paused keeps the decoding to the first frame.
+    emit worker->mpv->ctrlSetOptionVariant("vo", "null");
+    emit worker->mpv->ctrlSetOptionVariant("ao", "null");
+    emit worker->mpv->ctrlSetOptionVariant("sid", "no");
+    emit worker->mpv->ctrlSetOptionVariant("pause", "yes");
+    emit worker->mpv->ctrlSetOptionVariant("cache", "no");
+    emit worker->mpv->ctrlSetOptionVariant("sub-auto", "no");
+    emit worker->mpv->ctrlSetOptionVariant("audio-file-auto", "no");
+    emit worker->mpv->ctrlSetOptionVariant("cover-art-auto", "no");
+    return worker;
+}
+
+void MetadataProber::deleteWorker(Worker *worker)
+{
+    // This may be running from one of the worker's own signals.
+    workers.removeOne(worker);
+    worker->mpv->disconnect(this);
+    worker->timeout->disconnect(this);
+    worker->mpv->deleteLater();
+    worker->timeout->deleteLater();
+    delete worker;
+}
+
+void MetadataProber::deleteWorkers()
+{
+    for (Worker *worker : std::as_const(workers))
+        if (worker->busy)
+            return;
+    while (!workers.isEmpty())
+        deleteWorker(workers.first());
+}
+
+MetadataProber::Worker *MetadataProber::idleWorker()
+{
+    for (Worker *worker : std::as_const(workers))
+        if (!worker->busy)
+            return worker;
+    if (workers.count() < maxWorkers)
+        return newWorker();
+    return nullptr;
+}
+
+void MetadataProber::lookUp(const QList<Request> &requests)
+{
+    // Finding a file's pack means a stat and maybe reading its index, so
+    // the gui only ever sees the results.
+    lookingUp = true;
+    QtConcurrent::run([requests]() {
+        QList<QByteArray> found;
+        found.reserve(requests.count());
+        for (const Request &request : requests)
+            found.append(ThumbnailCache::singleton()->fetchData(request.url, cacheKey));
+        return found;
+    }).then(this, [this, requests](const QList<QByteArray> &found) {
+        lookingUp = false;
+        for (int i = 0; i < requests.count(); i++) {
+            if (takeCached(requests[i], found[i]))
+                done.insert(requests[i].item);
+            else
+                uncached.insert(requests[i].item);
+        }
+        schedule();
+    });
+}
+
+bool MetadataProber::takeCached(const Request &request, const QByteArray &data)
+{
+    if (data.isEmpty())
+        return false;
+    QVariantMap metadata;
+    QDataStream stream(data);
+    stream >> metadata;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+    // Files without tags or a duration are remembered too, as empty maps.
+    emit probed(request.list, request.item, metadata);
+    return true;
+}
+
+void MetadataProber::start(Worker *worker, const Request &request)
+{
+    worker->request = request;
+    worker->serial = ++serial;
+    worker->busy = true;
+    worker->loading = false;
+    worker->loaded = false;
+    idleTimer->stop();
+    worker->timeout->start();
+    worker->mpv->urlOpen(request.url);
+}
+
+void MetadataProber::finish(Worker *worker, const QVariantMap &metadata)
+{
+    worker->timeout->stop();
+    worker->busy = false;
+    done.insert(worker->request.item);
+
+    if (cacheEnabled) {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << metadata;
+        QUrl url = worker->request.url;
+        QThreadPool::globalInstance()->start([url, data]() {
+            ThumbnailCache::singleton()->storeData(url, cacheKey, data);
+        });
+    }
+
+    emit probed(worker->request.list, worker->request.item, metadata);
+    schedule();
+}
+
+void MetadataProber::fail(Worker *worker)
+{
+    worker->timeout->stop();
+    worker->busy = false;
+    done.insert(worker->request.item);
+    Logger::log(logModule, QString("could not open %1").arg(worker->request.url.toString()));
+    schedule();
+}
+
+void MetadataProber::schedule()
+{
+    scheduleQueued = false;
+    while (!pending.isEmpty()) {
+        Request request = pending.first();
+        if (done.contains(request.item)) {
+            pending.removeFirst();
+            continue;
+        }
+        if (cacheEnabled && !uncached.contains(request.item)) {
+            // Look the next batch up in the cache before probing any of it
+            if (lookingUp)
+                return;
+            QList<Request> batch;
+            for (const Request &r : std::as_const(pending)) {
+                if (batch.count() >= lookupsPerBatch)
+                    break;
+                if (!done.contains(r.item) && !uncached.contains(r.item))
+                    batch.append(r);
+            }
+            lookUp(batch);
+            return;
+        }
+        Worker *worker = idleWorker();
+        if (!worker)
+            return;
+        pending.removeFirst();
+        start(worker, request);
+    }
+
+    for (Worker *worker : std::as_const(workers))
+        if (worker->busy)
+            return;
+    if (!workers.isEmpty())
+        idleTimer->start();
+    emit drained();
+}
+
+bool MetadataProber::isCurrent(Worker *worker, int current) const
+{
+    // The worker may have been let go, or moved on, while mpv was replying.
+    return workers.contains(worker) && worker->busy && worker->serial == current;
+}
+
+void MetadataProber::mpv_playbackLoading(Worker *worker)
+{
+    // Ends of files opened before this one come first, and are no concern.
+    if (worker->busy)
+        worker->loading = true;
+}
+
+void MetadataProber::mpv_playbackStarted(Worker *worker)
+{
+    if (!worker->busy || !worker->loading || worker->loaded)
+        return;
+    worker->loaded = true;
+
+    int current = worker->serial;
+    worker->mpv->getMpvPropertyVariantAsync("metadata").then(this, [this, worker, current](const QVariant &tags) {
+        if (!isCurrent(worker, current))
+            return;
+        worker->mpv->getMpvPropertyVariantAsync("duration").then(this, [this, worker, current, tags](const QVariant &duration) {
+            if (!isCurrent(worker, current))
+                return;
+            // Keys are lowercased like those reported by the playing instance.
+            QVariantMap metadata;
+            const QVariantMap map = tags.toMap();
+            for (auto it = map.cbegin(); it != map.cend(); it++)
+                metadata.insert(it.key().toLower(), it.value());
+            if (duration.typeId() == QMetaType::Double && duration.toDouble() > 0)
+                metadata.insert("duration", duration.toDouble());
+            finish(worker, metadata);
+        });
+    });
+}
+
+void MetadataProber::mpv_playbackFinished(Worker *worker)
+{
+    if (worker->busy && worker->loading && !worker->loaded)
+        fail(worker);
+}
@@ -0,0 +1,87 @@
+#ifndef METADATAPROBER_H
+#define METADATAPROBER_H
+
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QUrl>
+#include <QUuid>
+#include <QVariantMap>
+
+class MpvObject;
+class QTimer;
+
+// MetadataProber reads the tags and duration of playlist items that have not
+// been played yet, so that the display format has something to show for
+// them.  A couple of paused, headless helper players do the reading, away
+// from the one that plays.  Requests are worked through in the order given,
+// and each call replaces whatever was still waiting, so the caller can keep
+// putting the rows on screen first.  Results are kept in the thumbnail
+// cache, which tells files apart by path, size and modification time, and
+// is looked in on the thread pool in batches.  Only local files are probed.
+// Use from the gui thread.
+class MetadataProber : public QObject {
+    Q_OBJECT
+
+public:
+    struct Request {
+        QUuid list;
+        QUuid item;
+        QUrl url;
+    };
+
+    explicit MetadataProber(QObject *parent = nullptr);
+    ~MetadataProber();
+
+    // Callers that keep the results themselves can leave the cache alone.
+    void setCacheEnabled(bool enabled);
+    void probe(const QList<Request> &requests);
+
+    // The duration is reported in seconds; this turns it into text.
+    static QVariantMap displayable(const QVariantMap &metadata);
+
+signals:
+    // Also sent with an empty map for files that have nothing to report.
+    void probed(QUuid list, QUuid item, QVariantMap metadata);
+    // Everything asked for has been probed, or given up on.
+    void drained();
+
+private:
+    struct Worker {
+        MpvObject *mpv = nullptr;
+        QTimer *timeout = nullptr;
+        Request request;
+        int serial = 0;
+        bool busy = false;
+        bool loading = false;
+        bool loaded = false;
+    };
+
+    Worker *newWorker();
+    void deleteWorker(Worker *worker);
+    void deleteWorkers();
+    Worker *idleWorker();
+    void lookUp(const QList<Request> &requests);
+    bool takeCached(const Request &request, const QByteArray &data);
+    void start(Worker *worker, const Request &request);
+    void finish(Worker *worker, const QVariantMap &metadata);
+    void fail(Worker *worker);
+    void schedule();
+    bool isCurrent(Worker *worker, int current) const;
+
+    void mpv_playbackLoading(Worker *worker);
+    void mpv_playbackStarted(Worker *worker);
+    void mpv_playbackFinished(Worker *worker);
+
+    QList<Worker*> workers;
+    QList<Request> pending;
+    QSet<QUuid> done;
+    QSet<QUuid> uncached;
+    QTimer *idleTimer = nullptr;
+    int serial = 0;
+    bool scheduleQueued = false;
+    bool lookingUp = false;
+    bool cacheEnabled = true;
+};
+
+#endif // METADATAPROBER_H
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui network widgets openglwidgets svg
+QT       += core gui network widgets openglwidgets svg concurrent
 
 QMAKE_CXXFLAGS += -Wall
 
@@ -164,7 +164,17 @@ SOURCES += main.cpp\
     platform/devicemanager.cpp \
     logwindow.cpp \
     logger.cpp \
+    latencystats.cpp \
+    keyframeindex.cpp \
+    directorywalker.cpp \
+    directoryindex.cpp \
+    metadataprober.cpp \
+    medialibrary.cpp \
     thumbnailerwindow.cpp \
+    seekpreview.cpp \
+    thumbnailcache.cpp \
+    waveform.cpp \
+    widgets/previewpopup.cpp \
     widgets/screencombo.cpp
 
 HEADERS  += \
@@ -197,7 +207,17 @@ HEADERS  += \
     platform/devicemanager.h \
     logwindow.h \
     logger.h \
+    latencystats.h \
+    keyframeindex.h \
+    directorywalker.h \
+    directoryindex.h \
+    metadataprober.h \
+    medialibrary.h \
     thumbnailerwindow.h \
+    seekpreview.h \
+    thumbnailcache.h \
+    waveform.h \
+    widgets/previewpopup.h \
     widgets/screencombo.h
 
 FORMS    += \
@@ -9,12 +9,17 @@
 #include <QTimer>
 #include <QOpenGLContext>
 #include <QMouseEvent>
+#include <QPainter>
 #include <QMetaObject>
+#include <QPromise>
 #include <QDir>
 #include <QDebug>
 #include <QWindow>
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <stdexcept>
+#include "latencystats.h"
 #include "logger.h"
 #include "mpvwidget.h"
 #include "widgets/logowidget.h"
@@ -30,6 +35,17 @@
 #define GLAPIENTRY
 #endif
 
+// Blocking calls into the mpv thread which take longer than this are logged
+constexpr qint64 blockingCallWarnMsec = 50;
+// As are event drains which start this long after mpv woke us up
+constexpr qint64 drainLatencyWarnUsec = 100000;
+// A single event drain yields to the worker's queue after this long
+constexpr int drainTimeSliceMsec = 20;
+// Scanlines of the software renderer's frame buffer start on this boundary
+constexpr size_t swFrameAlignment = 64;
+// A scrubbing seek that mpv hasn't finished by then no longer blocks others
+constexpr int scrubTimeoutMsec = 1000;
+
 #define HANDLE_PROP(p, method, converter, dflt) \
 { \
     p, \
@@ -47,7 +63,7 @@ MpvObject::PropertyDispatchMap MpvObject::propertyDispatch = {
     HANDLE_PROP("seekable", seekableChanged, toBool, false),
     HANDLE_PROP("pause", pausedChanged, toBool, true),
     HANDLE_PROP("eof-reached", eofReachedChanged, toString, QString()),
-    HANDLE_PROP("media-title", mediaTitleChanged, toString, QString()),
+    HANDLE_PROP("media-title", self_mediaTitleChanged, toString, QString()),
     HANDLE_PROP("chapter", self_chapterChanged, toDouble, 0.0),
     HANDLE_PROP("chapter-metadata/title", chapterTitleChanged, toString, QString()),
     HANDLE_PROP("chapter-list", chaptersChanged, toList, QVariantList()),
@@ -70,7 +86,7 @@ MpvObject::PropertyDispatchMap MpvObject::propertyDispatch = {
     HANDLE_PROP("sub-text", subTextChanged, toString, QString())
 };
 
-MpvObject::MpvObject(QObject *owner, const QString &clientName) : QObject(owner)
+MpvObject::MpvObject(QObject *owner, const QString &clientName, Role role) : QObject(owner)
 {
     // Setup threads
     worker = new QThread();
@@ -84,6 +100,9 @@ MpvObject::MpvObject(QObject *owner, const QString &clientName) : QObject(owner)
     hideTimer = new QTimer(this);
     hideTimer->setSingleShot(true);
     hideTimer->setInterval(1000);
+    scrubTimer = new QTimer(this);
+    scrubTimer->setSingleShot(true);
+    scrubTimer->setInterval(scrubTimeoutMsec);
 
     // Wire the basic mpv functions to avoid littering the codebase with
     // QMetaObject::invokeMethod.
@@ -121,28 +140,45 @@ MpvObject::MpvObject(QObject *owner, const QString &clientName) : QObject(owner)
             this, &MpvObject::self_keyRelease);
     connect(hideTimer, &QTimer::timeout,
             this, &MpvObject::hideTimer_timeout);
+    connect(scrubTimer, &QTimer::timeout,
+            this, &MpvObject::scrubTimer_timeout);
 
     // Wire up the logging interface
     connect(ctrl, &MpvController::logMessageByParts,
             Logger::singleton(), &Logger::makeLogDescriptively);
 
-    // Fetch installed scripts
-    QString scriptPath = Storage::fetchConfigPath() + "/scripts";
-    auto scriptInfoList = QDir(scriptPath).entryInfoList({"*.lua"}, QDir::Files);
-    QStringList scripts;
-    for (auto &info : scriptInfoList)
-        scripts.append(info.absoluteFilePath());
-
     // Initialize mpv playback instance
     MpvController::OptionList earlyOptions = {
         { "vo", "libmpv" },
-        { "ytdl", "yes" },
-        { "audio-client-name", clientName },
-        { "load-scripts", true },
-        { "scripts", scripts }
+        { "audio-client-name", clientName }
     };
+    recordLatency = role == PlayerRole;
+    if (role == HelperRole) {
+        earlyOptions += MpvController::OptionList {
+            { "ytdl", "no" },
+            { "load-scripts", false },
+            { "load-stats-overlay", false },
+            { "load-console", false },
+            { "load-auto-profiles", false }
+        };
+    } else {
+        // Fetch installed scripts
+        QString scriptPath = Storage::fetchConfigPath() + "/scripts";
+        auto scriptInfoList = QDir(scriptPath).entryInfoList({"*.lua"}, QDir::Files);
+        QStringList scripts;
+        for (auto &info : scriptInfoList)
+            scripts.append(info.absoluteFilePath());
+        earlyOptions += MpvController::OptionList {
+            { "ytdl", "yes" },
+            { "load-scripts", true },
+            { "scripts", scripts }
+        };
+    }
+    QElapsedTimer blockingTimer;
+    blockingTimer.start();
     QMetaObject::invokeMethod(ctrl, "create", Qt::BlockingQueuedConnection,
                               Q_ARG(MpvController::OptionList, earlyOptions));
+    logBlockingCall("create", blockingTimer);
 
     // clean up objects when the worker thread is deleted
     connect(worker, &QThread::finished, ctrl, &MpvController::deleteLater);
@@ -254,6 +290,9 @@ void MpvObject::setWidgetType(Helpers::MpvWidgetType widgetType, MpvWidgetInterf
     case Helpers::VulkanCbWidget:
         widget = new MpvVulkanCbWidget(this);
         break;
+    case Helpers::SwRenderWidget:
+        widget = new MpvSwWidget(this);
+        break;
     case Helpers::CustomWidget:
         widget = customWidget;
         if (widget == nullptr)
@@ -273,7 +312,8 @@ void MpvObject::setWidgetType(Helpers::MpvWidgetType widgetType, MpvWidgetInterf
 
 QString MpvObject::mpvVersion()
 {
-    return getMpvPropertyVariant("mpv-version").toString();
+    // Fetched once by the controller during creation, so no need to block.
+    return ctrl->mpvVersion();
 }
 
 MpvController *MpvObject::controller()
@@ -288,7 +328,8 @@ QWidget *MpvObject::mpvWidget()
 
 QList<AudioDevice> MpvObject::audioDevices()
 {
-    return AudioDevice::listFromVList(getMpvPropertyVariant("audio-device-list").toList());
+    // audio-device-list is observed, so the last emitted list is current.
+    return audioDevices_;
 }
 
 QStringList MpvObject::supportedProtocols()
@@ -421,9 +462,11 @@ void MpvObject::addSubFile(QString filename)
 
 void MpvObject::setSubtitlesDelay(int subDelayStep)
 {
-    double newSubDelay = getMpvPropertyVariant("sub-delay").toDouble() + (double) subDelayStep / 1000;
-    setMpvPropertyVariant("sub-delay", QString::number(newSubDelay, 'f', 3));
-    showMessage(tr("Subtitles delay: %1 ms").arg(std::round(newSubDelay * 1000)));
+    getMpvPropertyVariantAsync("sub-delay").then(this, [this, subDelayStep](const QVariant &v) {
+        double newSubDelay = v.toDouble() + (double) subDelayStep / 1000;
+        setMpvPropertyVariant("sub-delay", QString::number(newSubDelay, 'f', 3));
+        showMessage(tr("Subtitles delay: %1 ms").arg(std::round(newSubDelay * 1000)));
+    });
 }
 
 void MpvObject::setVideoAspect(double aspectDiff)
@@ -451,25 +494,22 @@ int64_t MpvObject::chapter()
     return chapter_;
 }
 
-bool MpvObject::setChapter(int64_t chapter)
+QFuture<bool> MpvObject::setChapter(int64_t chapter)
 {
     // As this requires knowledge of mpv's return value, it cannot be
     // queued as a simple message.  The usual return values are:
     // MPV_ERROR_PROPERTY_UNAVAILABLE: unchaptered file
     // MPV_ERROR_PROPERTY_FORMAT: past-the-end value requested
     // MPV_ERROR_SUCCESS: success
-    int r;
-    QMetaObject::invokeMethod(ctrl, "setPropertyVariant",
-                              Qt::BlockingQueuedConnection,
-                              Q_RETURN_ARG(int, r),
-                              Q_ARG(QString, "chapter"),
-                              Q_ARG(QVariant, QVariant(qlonglong(chapter))));
-    return r == MPV_ERROR_SUCCESS;
+    return setMpvPropertyVariantAsync("chapter", qlonglong(chapter))
+            .then([](const QVariant &v) {
+        return !v.canConvert<MpvErrorCode>();
+    });
 }
 
 QString MpvObject::mediaTitle()
 {
-    return getMpvPropertyVariant("media-title").toString();
+    return mediaTitle_;
 }
 
 void MpvObject::setMute(bool yes)
@@ -497,6 +537,76 @@ void MpvObject::setTimeSync(double position)
     ctrl->command(QVariantList() << "seek" << position << "absolute");
 }
 
+void MpvObject::scrubTo(double position, bool exact)
+{
+    // A target still waiting for the seek in flight is simply replaced, so
+    // mpv never works through a backlog of places the mouse has left.
+    if (scrubPending)
+        seeksDropped++;
+    scrubPending = true;
+    scrubPosition = position;
+    scrubExact = exact;
+    if (!scrubInFlight)
+        issueScrubSeek();
+}
+
+QVariantMap MpvObject::seekStatistics(bool reset)
+{
+    QVariantMap stats {
+        { "issued", seeksIssued },
+        { "dropped", seeksDropped },
+        { "timedOut", seeksTimedOut },
+        { "inFlight", scrubInFlight },
+        { "pending", scrubPending }
+    };
+    if (reset)
+        seeksIssued = seeksDropped = seeksTimedOut = 0;
+    return stats;
+}
+
+QFuture<QVariant> MpvObject::drainStatistics(bool reset)
+{
+    auto promise = std::make_shared<QPromise<QVariant>>();
+    promise->start();
+    QMetaObject::invokeMethod(ctrl, [ctrl = ctrl, promise, reset]() {
+        promise->addResult(ctrl->drainStatistics(reset));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return promise->future();
+}
+
+void MpvObject::setDrainTimeSlice(int msec)
+{
+    QMetaObject::invokeMethod(ctrl, [ctrl = ctrl, msec]() {
+        ctrl->setDrainTimeSlice(msec);
+    }, Qt::QueuedConnection);
+}
+
+void MpvObject::issueScrubSeek()
+{
+    scrubPending = false;
+    scrubInFlight = true;
+    scrubInFlightExact = scrubExact;
+    scrubIssuedNsec = LatencyStats::timestamp();
+    seeksIssued++;
+    scrubTimer->start();
+    emit ctrlCommand(QVariantList({ "seek", scrubPosition,
+                                    scrubExact ? "absolute+exact" : "absolute+keyframes" }));
+}
+
+void MpvObject::finishScrubSeek(bool landed)
+{
+    if (!scrubInFlight)
+        return;
+    scrubInFlight = false;
+    scrubTimer->stop();
+    if (landed && recordLatency)
+        LatencyStats::singleton()->record("seek", scrubInFlightExact ? "exact" : "keyframe",
+                                          scrubIssuedNsec, LatencyStats::timestamp());
+    if (scrubPending)
+        issueScrubSeek();
+}
+
 void MpvObject::setLoopPoints(double first, double end)
 {
     setMpvPropertyVariant("ab-loop-a",
@@ -588,21 +698,27 @@ void MpvObject::setCachedMpvOption(const QString &option, const QVariant &value)
 QVariant MpvObject::blockingMpvCommand(QVariant params)
 {
     QVariant v;
+    QElapsedTimer timer;
+    timer.start();
     QMetaObject::invokeMethod(ctrl, "command",
                               Qt::BlockingQueuedConnection,
                               Q_RETURN_ARG(QVariant, v),
                               Q_ARG(QVariant, params));
+    logBlockingCall("command", timer);
     return v;
 }
 
 QVariant MpvObject::blockingSetMpvPropertyVariant(QString name, QVariant value)
 {
     int v;
+    QElapsedTimer timer;
+    timer.start();
     QMetaObject::invokeMethod(ctrl, "setPropertyVariant",
                               Qt::BlockingQueuedConnection,
                               Q_RETURN_ARG(int, v),
                               Q_ARG(QString, name),
                               Q_ARG(QVariant, value));
+    logBlockingCall("set property " + name, timer);
     return v == MPV_ERROR_SUCCESS ? QVariant()
                                   : QVariant::fromValue(MpvErrorCode(v));
 }
@@ -610,11 +726,14 @@ QVariant MpvObject::blockingSetMpvPropertyVariant(QString name, QVariant value)
 QVariant MpvObject::blockingSetMpvOptionVariant(QString name, QVariant value)
 {
     int v;
+    QElapsedTimer timer;
+    timer.start();
     QMetaObject::invokeMethod(ctrl, "setOptionVariant",
                               Qt::BlockingQueuedConnection,
                               Q_RETURN_ARG(int, v),
                               Q_ARG(QString, name),
                               Q_ARG(QVariant, value));
+    logBlockingCall("set option " + name, timer);
     return v == MPV_ERROR_SUCCESS ? QVariant()
                                   : QVariant::fromValue(MpvErrorCode(v));
 }
@@ -622,13 +741,72 @@ QVariant MpvObject::blockingSetMpvOptionVariant(QString name, QVariant value)
 QVariant MpvObject::getMpvPropertyVariant(QString name)
 {
     QVariant v;
+    QElapsedTimer timer;
+    timer.start();
     QMetaObject::invokeMethod(ctrl, "getPropertyVariant",
                               Qt::BlockingQueuedConnection,
                               Q_RETURN_ARG(QVariant, v),
                               Q_ARG(QString, name));
+    logBlockingCall("get property " + name, timer);
     return v;
 }
 
+// Helper for the async functions below.  The promise is shared between the
+// callback and the future's lifetime, so it survives until mpv replies.
+static QFuture<QVariant> mpvFuture(MpvController *ctrl,
+                                   const std::function<void(MpvCallback*)> &dispatch)
+{
+    auto promise = std::make_shared<QPromise<QVariant>>();
+    promise->start();
+    auto callback = new MpvCallback([promise](QVariant v) {
+        promise->addResult(v);
+        promise->finish();
+    });
+    if (!QMetaObject::invokeMethod(ctrl, [dispatch, callback]() {
+            dispatch(callback);
+        }, Qt::QueuedConnection))
+        callback->reply(QVariant::fromValue(MpvErrorCode(MPV_ERROR_UNINITIALIZED)));
+    return promise->future();
+}
+
+QFuture<QVariant> MpvObject::mpvCommandAsync(const QVariant &params)
+{
+    return mpvFuture(ctrl, [ctrl = ctrl, params](MpvCallback *callback) {
+        ctrl->commandAsync(params, callback);
+    });
+}
+
+QFuture<QVariant> MpvObject::setMpvPropertyVariantAsync(const QString &name, const QVariant &value)
+{
+    if (debugMessages)
+        LogStream("mpvobject") << name << " property set async to " << value;
+    return mpvFuture(ctrl, [ctrl = ctrl, name, value](MpvCallback *callback) {
+        ctrl->setPropertyVariantAsync(name, value, callback);
+    });
+}
+
+QFuture<QVariant> MpvObject::setMpvOptionVariantAsync(const QString &name, const QVariant &value)
+{
+    // libmpv has no asynchronous option setter, but running it on the
+    // worker thread is still enough to keep the gui thread free.
+    auto promise = std::make_shared<QPromise<QVariant>>();
+    promise->start();
+    QMetaObject::invokeMethod(ctrl, [ctrl = ctrl, promise, name, value]() {
+        int v = ctrl->setOptionVariant(name, value);
+        promise->addResult(v == MPV_ERROR_SUCCESS ? QVariant()
+                                                  : QVariant::fromValue(MpvErrorCode(v)));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return promise->future();
+}
+
+QFuture<QVariant> MpvObject::getMpvPropertyVariantAsync(const QString &name)
+{
+    return mpvFuture(ctrl, [ctrl = ctrl, name](MpvCallback *callback) {
+        ctrl->getPropertyVariantAsync(name, callback);
+    });
+}
+
 
 void MpvObject::setMpvPropertyVariant(QString name, QVariant value)
 {
@@ -652,6 +830,14 @@ void MpvObject::showCursor()
     }
 }
 
+void MpvObject::logBlockingCall(const QString &what, const QElapsedTimer &timer)
+{
+    qint64 msec = timer.elapsed();
+    if (msec >= blockingCallWarnMsec)
+        LogStream("mpvobject") << what << " blocked the gui thread for "
+                               << QString::number(msec) << "ms";
+}
+
 void MpvObject::hideCursor()
 {
     if (widget) {
@@ -673,8 +859,14 @@ void MpvObject::self_aspectChanged(double newAspect)
     aspect = newAspect;
 }
 
-void MpvObject::ctrl_mpvPropertyChanged(QString name, QVariant v)
+void MpvObject::ctrl_mpvPropertyChanged(QString name, QVariant v, uint64_t userData,
+                                        qint64 eventNsec)
 {
+    Q_UNUSED(userData)
+    LatencyStats *latency = recordLatency ? LatencyStats::singleton() : nullptr;
+    if (latency)
+        latency->record(name, "queued", eventNsec, LatencyStats::timestamp());
+
     QVariant vForLog = v;
     // Don't show more than 3 decimals or none if those are zero
     if (vForLog.typeId() == QVariant::Double) {
@@ -691,6 +883,10 @@ void MpvObject::ctrl_mpvPropertyChanged(QString name, QVariant v)
         propertyDispatch[name](this, ok, v);
     else
         LogStream("mpvobject") << name << " property changed, but was not in dispatch list.";
+    // Our signals are directly connected to the manager et al, so by now
+    // their slots have run too.
+    if (latency)
+        latency->record(name, "handled", eventNsec, LatencyStats::timestamp());
 }
 
 void MpvObject::ctrl_hookEvent(QString name, uint64_t selfId, uint64_t mpvId)
@@ -699,9 +895,14 @@ void MpvObject::ctrl_hookEvent(QString name, uint64_t selfId, uint64_t mpvId)
         return;
 
     if (name == "on_unload") {
-        QVariantList playlist = getMpvPropertyVariant("playlist").toList();
-        if (playlist.count() > 1)
-            emit playlistChanged(playlist);
+        // mpv waits on the hook, so continue it once we have the playlist
+        getMpvPropertyVariantAsync("playlist").then(this, [this, mpvId](const QVariant &v) {
+            QVariantList playlist = v.toList();
+            if (playlist.count() > 1)
+                emit playlistChanged(playlist);
+            emit ctrlContinueHook(mpvId);
+        });
+        return;
     }
     emit ctrlContinueHook(mpvId);
 }
@@ -721,9 +922,21 @@ void MpvObject::ctrl_unhandledMpvEvent(int eventLevel)
         emit playbackStarted();
         break;
     }
+    // Received when playback resumes after a seek, with the new frame ready
+    case MPV_EVENT_PLAYBACK_RESTART: {
+        if (debugMessages)
+            Logger::log("mpvobject", "playback restart");
+        finishScrubSeek(true);
+        emit playbackRestarted();
+        break;
+    }
     case MPV_EVENT_END_FILE: {
         if (debugMessages)
             Logger::log("mpvobject", "end file");
+        if (scrubPending)
+            seeksDropped++;
+        scrubPending = false;
+        finishScrubSeek(false);
         emit playbackFinished();
         break;
     }
@@ -766,6 +979,12 @@ void MpvObject::self_chapterChanged(double chapter)
     chapter_ = chapter;
 }
 
+void MpvObject::self_mediaTitleChanged(QString title)
+{
+    mediaTitle_ = title;
+    emit mediaTitleChanged(title);
+}
+
 void MpvObject::self_metadata(QVariantMap metadata)
 {
     QVariantMap map;
@@ -776,7 +995,8 @@ void MpvObject::self_metadata(QVariantMap metadata)
 
 void MpvObject::self_audioDeviceList(const QVariantList &list)
 {
-    emit audioDeviceList(AudioDevice::listFromVList(list));
+    audioDevices_ = AudioDevice::listFromVList(list);
+    emit audioDeviceList(audioDevices_);
 }
 
 void MpvObject::self_mouseMoved(int x, int y)
@@ -824,6 +1044,12 @@ void MpvObject::hideTimer_timeout()
     hideCursor();
 }
 
+void MpvObject::scrubTimer_timeout()
+{
+    seeksTimedOut++;
+    finishScrubSeek(false);
+}
+
 //----------------------------------------------------------------------------
 
 MpvWidgetInterface::MpvWidgetInterface(MpvObject *object)
@@ -1102,6 +1328,214 @@ void MpvGlWidget::self_playbackFinished()
     update();
 }
 
+//----------------------------------------------------------------------------
+
+MpvSwWidget::MpvSwWidget(MpvObject *object, QWidget *parent) :
+    QWidget(parent), MpvWidgetInterface(object)
+{
+    logo = new LogoDrawer(this);
+    connect(logo, &LogoDrawer::logoSize,
+            mpvObject, &MpvObject::logoSizeChanged);
+    connect(mpvObject, &MpvObject::playbackStarted,
+            this, &MpvSwWidget::self_playbackStarted);
+    connect(mpvObject, &MpvObject::playbackFinished,
+            this, &MpvSwWidget::self_playbackFinished);
+    setContextMenuPolicy(Qt::CustomContextMenu);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+MpvSwWidget::~MpvSwWidget()
+{
+    if (render) {
+        ctrl->destroyRenderContext(render);
+        render = nullptr;
+    }
+    frame = QImage();
+    qFreeAligned(frameBuffer);
+    frameBuffer = nullptr;
+}
+
+QWidget *MpvSwWidget::self()
+{
+    return this;
+}
+
+void MpvSwWidget::initMpv()
+{
+    mpv_render_param params[] {
+        { MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_SW) },
+        { MPV_RENDER_PARAM_INVALID, nullptr }
+    };
+    render = ctrl->createRenderContext(params);
+    if (!render) {
+        Logger::log("swwidget", "could not create software render context");
+        return;
+    }
+    mpv_render_context_set_update_callback(render, MpvSwWidget::render_update, this);
+}
+
+void MpvSwWidget::setLogoUrl(const QString &filename)
+{
+    logo->setLogoUrl(filename);
+    logo->resizeGL(width(), height(), devicePixelRatioF());
+    if (drawLogo)
+        update();
+}
+
+void MpvSwWidget::setLogoBackground(const QColor &color)
+{
+    logo->setLogoBackground(color);
+}
+
+void MpvSwWidget::setDrawLogo(bool yes)
+{
+    drawLogo = yes;
+    update();
+}
+
+QImage MpvSwWidget::grabFrame()
+{
+    // Render afresh, so that callers reacting to mpv events (e.g. a seek
+    // finishing) get the current frame.  The buffer is reused for the next
+    // frame, so hand out a deep copy.
+    renderFrame();
+    return frame.copy();
+}
+
+void MpvSwWidget::setOffscreenSize(const QSize &size)
+{
+    offscreenSize = size;
+}
+
+void MpvSwWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    if (mpvObject->clientDebuggingMessages())
+        Logger::log("swwidget", "paintEvent");
+    if (drawLogo || !render || frame.isNull()) {
+        logo->paintGL(this);
+        return;
+    }
+
+    QPainter painter(this);
+    painter.drawImage(rect(), frame);
+    mpv_render_context_report_swap(render);
+}
+
+void MpvSwWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    logo->resizeGL(width(), height(), devicePixelRatioF());
+    if (render && !drawLogo)
+        renderFrame();
+}
+
+void MpvSwWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    QPointF pos = event->position();
+    emit mpvObject->mouseMoved(pos.x()*devicePixelRatioF(),
+                               pos.y()*devicePixelRatioF());
+    event->accept();
+}
+
+void MpvSwWidget::mousePressEvent(QMouseEvent *event)
+{
+    QPointF pos = event->position();
+    int btn = int(log2(double(event->button()) + 0.5));
+    emit mpvObject->mousePress(pos.x()*devicePixelRatioF(),
+                               pos.y()*devicePixelRatioF(),
+                               btn);
+    QWidget::mousePressEvent(event);
+}
+
+void MpvSwWidget::keyPressEvent(QKeyEvent *event)
+{
+    emit mpvObject->keyPress(event->key());
+}
+
+void MpvSwWidget::keyReleaseEvent(QKeyEvent *event)
+{
+    emit mpvObject->keyRelease(event->key());
+}
+
+void MpvSwWidget::render_update(void *ctx)
+{
+    QMetaObject::invokeMethod(reinterpret_cast<MpvSwWidget*>(ctx), "maybeUpdate");
+}
+
+QSize MpvSwWidget::renderSize()
+{
+    // When we're not on screen (e.g. headless use), render at the size we
+    // were asked for, or else at video size.
+    if (isVisible() && !size().isEmpty())
+        return size() * devicePixelRatioF();
+    if (offscreenSize.isValid())
+        return offscreenSize;
+    return mpvObject->videoSize();
+}
+
+void MpvSwWidget::allocateFrame(const QSize &size)
+{
+    if (frame.size() == size)
+        return;
+
+    // mpv's software renderer is fastest with aligned scanlines, so manage
+    // the buffer ourselves and only grow it when the frame gets bigger.
+    size_t stride = (size_t(size.width()) * 4 + swFrameAlignment - 1) & ~(swFrameAlignment - 1);
+    size_t needed = stride * size_t(size.height());
+    frame = QImage();
+    if (needed > frameBufferSize) {
+        qFreeAligned(frameBuffer);
+        frameBuffer = static_cast<uchar*>(qMallocAligned(needed, swFrameAlignment));
+        frameBufferSize = frameBuffer ? needed : 0;
+    }
+    if (frameBuffer)
+        frame = QImage(frameBuffer, size.width(), size.height(), qsizetype(stride),
+                       QImage::Format_RGBX8888);
+}
+
+void MpvSwWidget::renderFrame()
+{
+    QSize size = renderSize();
+    if (!render || size.isEmpty())
+        return;
+    allocateFrame(size);
+    if (frame.isNull())
+        return;
+
+    int swSize[2] { frame.width(), frame.height() };
+    size_t stride = size_t(frame.bytesPerLine());
+    mpv_render_param params[] {
+        { MPV_RENDER_PARAM_SW_SIZE, swSize },
+        { MPV_RENDER_PARAM_SW_FORMAT, const_cast<char*>("rgb0") },
+        { MPV_RENDER_PARAM_SW_STRIDE, &stride },
+        { MPV_RENDER_PARAM_SW_POINTER, frameBuffer },
+        { MPV_RENDER_PARAM_INVALID, nullptr }
+    };
+    mpv_render_context_render(render, params);
+}
+
+void MpvSwWidget::maybeUpdate()
+{
+    if (!render)
+        return;
+    if (mpv_render_context_update(render) & MPV_RENDER_UPDATE_FRAME) {
+        renderFrame();
+        update();
+    }
+}
+
+void MpvSwWidget::self_playbackStarted()
+{
+    drawLogo = false;
+}
+
+void MpvSwWidget::self_playbackFinished()
+{
+    drawLogo = true;
+    update();
+}
+
 
 
 MpvCallback::MpvCallback(const Callback &callback,
@@ -1127,6 +1561,8 @@ MpvController::MpvController(QObject *parent) : QObject(parent),
             this, &MpvController::flushProperties);
     throttler->setInterval(1000/12);
     throttler->start();
+    drainClock.start();
+    setDrainTimeSlice(drainTimeSliceMsec);
 }
 
 MpvController::~MpvController()
@@ -1149,8 +1585,15 @@ void MpvController::create(const OptionList &earlyOptions)
     if (mpv_initialize(mpv) < 0)
         throw std::runtime_error("could not initialize mpv context");
 
+    // Observe the video geometry ourselves, so that size changes arrive with
+    // the normal event batch rather than by querying mpv in the middle of it.
+    mpv_observe_property(mpv, 0, "dwidth", MPV_FORMAT_INT64);
+    mpv_observe_property(mpv, 0, "dheight", MPV_FORMAT_INT64);
+    mpv_observe_property(mpv, 0, "video-params", MPV_FORMAT_NODE);
+
     mpv_set_wakeup_callback(mpv, MpvController::mpvWakeup, this);
     protocolList_ = getPropertyVariant("protocol-list").toStringList();
+    mpvVersion_ = getPropertyVariant("mpv-version").toString();
 }
 
 void MpvController::stop()
@@ -1212,6 +1655,11 @@ QString MpvController::clientName()
     return QString::fromUtf8(mpv_client_name(mpv));
 }
 
+QString MpvController::mpvVersion()
+{
+    return mpvVersion_;
+}
+
 QStringList MpvController::protocolList()
 {
     return protocolList_;
@@ -1232,6 +1680,38 @@ void MpvController::setLogLevel(QString logLevel)
     mpv_request_log_messages(mpv, logLevel.toUtf8().data());
 }
 
+QVariantMap MpvController::drainStatistics(bool reset)
+{
+    auto average = [](qint64 total, uint64_t count) {
+        return count ? qlonglong(total / qint64(count)) : 0ll;
+    };
+    auto averageEvents = drainStats.drains ? double(drainStats.events) / drainStats.drains : 0.0;
+    QVariantMap stats {
+        { "wakeups", qulonglong(wakeups.load()) },
+        { "drains", qulonglong(drainStats.drains) },
+        { "slicedDrains", qulonglong(drainStats.slicedDrains) },
+        { "events", qulonglong(drainStats.events) },
+        { "averageEventsPerDrain", averageEvents },
+        { "maxEventsPerDrain", drainStats.maxEventsPerDrain },
+        { "lastLatencyUsec", qlonglong(drainStats.lastLatencyUsec) },
+        { "maxLatencyUsec", qlonglong(drainStats.maxLatencyUsec) },
+        { "averageLatencyUsec", average(drainStats.totalLatencyUsec, drainStats.drains) },
+        { "maxDrainUsec", qlonglong(drainStats.maxDrainUsec) },
+        { "timeSliceMsec", int(drainTimeSliceNsec / 1000000) }
+    };
+    if (reset) {
+        drainStats = DrainStatistics();
+        wakeups.store(0);
+    }
+    return stats;
+}
+
+void MpvController::setDrainTimeSlice(int msec)
+{
+    // A slice of zero drains the whole queue in one go.
+    drainTimeSliceNsec = std::max(msec, 0) * qint64(1000000);
+}
+
 void MpvController::showStatsPage(int page)
 {
     bool statsVisible = (shownStatsPage > 0 && shownStatsPage < 3);
@@ -1307,51 +1787,168 @@ QString MpvController::getPropertyString(const QString &name)
 
 void MpvController::commandAsync(const QVariant &params, MpvCallback *callback)
 {
+    if (!mpv) {
+        failAsync(callback, MPV_ERROR_UNINITIALIZED);
+        return;
+    }
     mpv::qt::node_builder node(params);
-    mpv_command_node_async(mpv, reinterpret_cast<uint64_t>(callback),
-                           node.node());
+    int rc = mpv_command_node_async(mpv, reinterpret_cast<uint64_t>(callback),
+                                    node.node());
+    if (rc < 0)
+        failAsync(callback, rc);
 }
 
 void MpvController::setPropertyVariantAsync(const QString &name,
                                             const QVariant &value,
                                             MpvCallback *callback)
 {
+    if (!mpv) {
+        failAsync(callback, MPV_ERROR_UNINITIALIZED);
+        return;
+    }
     mpv::qt::node_builder node(value);
-    mpv_set_property_async(mpv, reinterpret_cast<uint64_t>(callback),
-                           name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+    int rc = mpv_set_property_async(mpv, reinterpret_cast<uint64_t>(callback),
+                                    name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+    if (rc < 0)
+        failAsync(callback, rc);
 }
 
 void MpvController::getPropertyVariantAsync(const QString &name,
                                             MpvCallback *callback)
 {
-    mpv_get_property_async(mpv, reinterpret_cast<uint64_t>(callback),
-                           name.toUtf8().data(), MPV_FORMAT_NODE);
+    if (!mpv) {
+        failAsync(callback, MPV_ERROR_UNINITIALIZED);
+        return;
+    }
+    int rc = mpv_get_property_async(mpv, reinterpret_cast<uint64_t>(callback),
+                                    name.toUtf8().data(), MPV_FORMAT_NODE);
+    if (rc < 0)
+        failAsync(callback, rc);
+}
+
+void MpvController::failAsync(MpvCallback *callback, int rc)
+{
+    // mpv never queued the request, so no reply event will come for it.
+    // Answer with the error right away; reply() also disposes the callback.
+    QMetaObject::invokeMethod(callback, "reply", Qt::QueuedConnection,
+                              Q_ARG(QVariant, QVariant::fromValue<MpvErrorCode>(MpvErrorCode(rc))));
 }
 
 void MpvController::parseMpvEvents()
 {
-    // Process all events, until the event queue is empty.
+    // Clear the flag before looking at the queue, so that a wakeup arriving
+    // while we drain schedules another pass instead of being lost.
+    drainPending.store(false);
+    qint64 wakeupNsec = pendingWakeupNsec.exchange(0);
+    qint64 drainStartNsec = drainClock.nsecsElapsed();
+    int events = 0;
+    bool sliced = false;
+
+    // Process all events, until the event queue is empty or our time slice
+    // runs out.  In the latter case, let the rest of the worker's queue (e.g.
+    // hook replies) run before coming back for more.
     while (mpv) {
+        if (drainTimeSliceNsec && drainClock.nsecsElapsed() - drainStartNsec >= drainTimeSliceNsec) {
+            sliced = true;
+            break;
+        }
         mpv_event *event = mpv_wait_event(mpv, 0);
         if (event->event_id == MPV_EVENT_NONE) {
             break;
         }
         handleMpvEvent(event);
+        events++;
     }
+    flushVideoGeometry();
+
+    qint64 latencyUsec = wakeupNsec ? (drainStartNsec - wakeupNsec) / 1000 : 0;
+    recordDrain(latencyUsec, (drainClock.nsecsElapsed() - drainStartNsec) / 1000, events, sliced);
+    if (sliced) {
+        qint64 expected = 0;
+        pendingWakeupNsec.compare_exchange_strong(expected, drainClock.nsecsElapsed());
+        scheduleDrain();
+    }
+}
+
+void MpvController::scheduleDrain()
+{
+    // Only one drain is ever outstanding in the worker's event queue.
+    if (!drainPending.exchange(true))
+        QMetaObject::invokeMethod(this, "parseMpvEvents", Qt::QueuedConnection);
 }
 
-void MpvController::setThrottledProperty(const QString &name, const QVariant &v, uint64_t userData)
+void MpvController::setThrottledProperty(const QString &name, const QVariant &v, uint64_t userData,
+                                         qint64 eventNsec)
 {
-    throttledValues.insert(name, QPair<QVariant,uint64_t>(v,userData));
+    throttledValues.insert(name, ThrottledValue { v, userData, eventNsec });
 }
 
 void MpvController::flushProperties()
 {
     for (auto it = throttledValues.begin(); it != throttledValues.end(); it++)
-        emit mpvPropertyChanged(it.key(), it.value().first, it.value().second);
+        emit mpvPropertyChanged(it.key(), it.value().value, it.value().userData,
+                                it.value().eventNsec);
     throttledValues.clear();
 }
 
+bool MpvController::setVideoGeometryProperty(const QString &name, const QVariant &v)
+{
+    bool unavailable = v.canConvert<MpvErrorCode>();
+    if (name == "dwidth")
+        videoDWidth = unavailable ? 0 : v.toLongLong();
+    else if (name == "dheight")
+        videoDHeight = unavailable ? 0 : v.toLongLong();
+    else if (name == "video-params")
+        videoParams = unavailable ? QVariantMap() : v.toMap();
+    else
+        return false;
+    videoGeometryDirty = true;
+    return true;
+}
+
+void MpvController::flushVideoGeometry()
+{
+    // Called once per event batch, so a reconfig storm produces at most one
+    // size notification per drain.
+    if (!videoGeometryDirty)
+        return;
+    videoGeometryDirty = false;
+
+    int w = int(videoDWidth);
+    int h = int(videoDHeight);
+    if (w <= 0 || h <= 0) {
+        w = videoParams.value("dw").toInt();
+        h = videoParams.value("dh").toInt();
+    }
+    if (w > 0 && h > 0) {
+        QSize videoSize(w, h);
+        if (lastVideoSize != videoSize) {
+            emit videoSizeChanged(videoSize);
+            lastVideoSize = videoSize;
+        }
+    } else if (!lastVideoSize.isEmpty()) {
+        lastVideoSize = QSize();
+        emit videoSizeChanged(QSize());
+    }
+}
+
+void MpvController::recordDrain(qint64 latencyUsec, qint64 drainUsec, int events, bool sliced)
+{
+    drainStats.drains++;
+    if (sliced)
+        drainStats.slicedDrains++;
+    drainStats.events += events;
+    drainStats.maxEventsPerDrain = std::max(drainStats.maxEventsPerDrain, events);
+    drainStats.lastLatencyUsec = latencyUsec;
+    drainStats.totalLatencyUsec += latencyUsec;
+    drainStats.maxLatencyUsec = std::max(drainStats.maxLatencyUsec, latencyUsec);
+    drainStats.maxDrainUsec = std::max(drainStats.maxDrainUsec, drainUsec);
+    if (latencyUsec >= drainLatencyWarnUsec)
+        LogStream("mpvctrl") << "event drain started " << QString::number(latencyUsec / 1000)
+                             << "ms after wakeup and took " << QString::number(drainUsec / 1000)
+                             << "ms for " << QString::number(events) << " events";
+}
+
 void MpvController::handleMpvEvent(mpv_event *event)
 {
     auto propertyToVariant = [event](mpv_event_property *prop) -> QVariant {
@@ -1405,9 +2002,24 @@ void MpvController::handleMpvEvent(mpv_event *event)
                                   Q_ARG(QVariant, v));
         break;
     }
-    case MPV_EVENT_COMMAND_REPLY:
+    case MPV_EVENT_COMMAND_REPLY: {
+        if (!event->reply_userdata)
+            return;
+        QVariant v;
+        if (event->error < 0) {
+            v = QVariant::fromValue<MpvErrorCode>(MpvErrorCode(event->error));
+        } else {
+            mpv_node *result = &reinterpret_cast<mpv_event_command*>(event->data)->result;
+            v = mpv::qt::node_to_variant(result);
+        }
+        QMetaObject::invokeMethod(reinterpret_cast<MpvCallback*>(event->reply_userdata),
+                                  "reply", Qt::QueuedConnection,
+                                  Q_ARG(QVariant, v));
+        break;
+    }
     case MPV_EVENT_SET_PROPERTY_REPLY: {
-        QVariant v = QVariant::fromValue<MpvErrorCode>(MpvErrorCode(event->error));
+        QVariant v = event->error < 0 ? QVariant::fromValue<MpvErrorCode>(MpvErrorCode(event->error))
+                                      : QVariant();
         if (!event->reply_userdata)
             return;
         QMetaObject::invokeMethod(reinterpret_cast<MpvCallback*>(event->reply_userdata),
@@ -1416,12 +2028,15 @@ void MpvController::handleMpvEvent(mpv_event *event)
         break;
     }
     case MPV_EVENT_PROPERTY_CHANGE: {
+        qint64 eventNsec = LatencyStats::timestamp();
         QVariant v = propertyToVariant(reinterpret_cast<mpv_event_property*>(event->data));
         QString propname = QString::fromUtf8(reinterpret_cast<mpv_event_property*>(event->data)->name);
+        if (!event->reply_userdata && setVideoGeometryProperty(propname, v))
+            break;
         if (throttledProperties.contains(propname))
-            setThrottledProperty(propname, v, event->reply_userdata);
+            setThrottledProperty(propname, v, event->reply_userdata, eventNsec);
         else
-            emit mpvPropertyChanged(propname, v, event->reply_userdata);
+            emit mpvPropertyChanged(propname, v, event->reply_userdata, eventNsec);
         break;
     }
     case MPV_EVENT_LOG_MESSAGE: {
@@ -1440,22 +2055,8 @@ void MpvController::handleMpvEvent(mpv_event *event)
         break;
     }
     case MPV_EVENT_VIDEO_RECONFIG: {
-        // Retrieve the new video size.
-        QVariant vw, vh;
-        vw = getPropertyVariant("dwidth");
-        vh = getPropertyVariant("dheight");
-        int w, h;
-        if (!vw.canConvert<MpvErrorCode>() && !vh.canConvert<MpvErrorCode>()
-                && (w = vw.toInt()) > 0 && (h = vh.toInt()) > 0) {
-            QSize videoSize(w, h);
-            if (lastVideoSize != videoSize) {
-                emit videoSizeChanged(videoSize);
-                lastVideoSize = videoSize;
-            }
-        } else if (!lastVideoSize.isEmpty()) {
-            lastVideoSize = QSize();
-            emit videoSizeChanged(QSize());
-        }
+        // The new video size arrives through the observed dwidth, dheight
+        // and video-params properties, and is sent at the end of the drain.
         break;
     }
     case MPV_EVENT_HOOK: {
@@ -1470,6 +2071,11 @@ void MpvController::handleMpvEvent(mpv_event *event)
 
 void MpvController::mpvWakeup(void *ctx)
 {
-    QMetaObject::invokeMethod(static_cast<MpvController*>(ctx), "parseMpvEvents",
-                              Qt::QueuedConnection);
+    // Called from an mpv thread.  Remember when the first undrained wakeup
+    // happened, so we can tell how long events sat in the queue.
+    auto self = static_cast<MpvController*>(ctx);
+    self->wakeups++;
+    qint64 expected = 0;
+    self->pendingWakeupNsec.compare_exchange_strong(expected, self->drainClock.nsecsElapsed());
+    self->scheduleDrain();
 }
@@ -3,10 +3,13 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLTexture>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QTimer>
 #include <QVariant>
 #include <QSet>
 #include <QMap>
+#include <atomic>
 #include <functional>
 #include <mpv/client.h>
 #include <mpv/render.h>
@@ -34,7 +37,14 @@ class MpvObject : public QObject
     typedef std::function<void(MpvObject*,bool,const QVariant&)> PropertyDispatchFunction;
     typedef QMap<QString, PropertyDispatchFunction> PropertyDispatchMap;
 public:
-    explicit MpvObject(QObject *owner, const QString &clientName = "mpv");
+    // Helpers are background instances used for previews and analysis.
+    // They skip user scripts, youtube-dl and mpv's bundled scripts, so that
+    // they start quickly and behave the same whatever the user installed.
+    // Only the player records into the latency histograms.
+    enum Role { PlayerRole, HelperRole };
+
+    explicit MpvObject(QObject *owner, const QString &clientName = "mpv",
+                       Role role = PlayerRole);
     ~MpvObject();
 
     void setHostLayout(QLayout *hostLayout);
@@ -74,13 +84,24 @@ public:
     void setPanScan(double panScan);
 
     int64_t chapter();
-    bool setChapter(int64_t chapter);
+    QFuture<bool> setChapter(int64_t chapter);
     QString mediaTitle();
     void setMute(bool yes);
     void setPaused(bool yes);
     void setSpeed(double speed);
     void setTime(double position);
     void setTimeSync(double position);
+    // Seeks made while scrubbing.  Only one is ever in flight, and a newer
+    // target replaces one still waiting.  Fast keyframe seeks suit drags,
+    // while exact ones suit wherever the user settles.
+    void scrubTo(double position, bool exact);
+    QVariantMap seekStatistics(bool reset = false);
+    // How the controller keeps up with mpv's event queue, gathered on its
+    // own thread.
+    QFuture<QVariant> drainStatistics(bool reset = false);
+    // How long one pass over mpv's event queue may run before yielding to
+    // the rest of the controller's work.  Zero drains it all at once.
+    void setDrainTimeSlice(int msec);
     void setLoopPoints(double first, double end);
     void setAudioTrack(int64_t id);
     void setSubtitleTrack(int64_t id);
@@ -103,6 +124,14 @@ public:
     QVariant blockingSetMpvOptionVariant(QString name, QVariant value);
     QVariant getMpvPropertyVariant(QString name);
 
+    // Non-blocking counterparts of the above.  The returned future is
+    // fulfilled when mpv replies; use QFuture::then with a context object
+    // to receive the value on that object's thread.
+    QFuture<QVariant> mpvCommandAsync(const QVariant &params);
+    QFuture<QVariant> setMpvPropertyVariantAsync(const QString &name, const QVariant &value);
+    QFuture<QVariant> setMpvOptionVariantAsync(const QString &name, const QVariant &value);
+    QFuture<QVariant> getMpvPropertyVariantAsync(const QString &name);
+
 signals:
     void ctrlContinueHook(uint64_t mpvId);
     void ctrlCommand(QVariant params);
@@ -118,6 +147,7 @@ signals:
     void seekableChanged(bool yes);
     void playbackLoading();
     void playbackStarted();
+    void playbackRestarted();
     void pausedChanged(bool yes);
     void eofReachedChanged(QString eof);
     void playbackFinished();
@@ -159,18 +189,23 @@ private:
     void setMpvOptionVariant(QString name, QVariant value);
     void showCursor();
     void hideCursor();
+    void logBlockingCall(const QString &what, const QElapsedTimer &timer);
+    void issueScrubSeek();
+    void finishScrubSeek(bool landed);
 
 private slots:
-    void ctrl_mpvPropertyChanged(QString name, QVariant v);
+    void ctrl_mpvPropertyChanged(QString name, QVariant v, uint64_t userData, qint64 eventNsec);
     void ctrl_hookEvent(QString name, uint64_t selfId, uint64_t mpvId);
     void ctrl_unhandledMpvEvent(int eventLevel);
     void ctrl_videoSizeChanged(QSize size);
     void self_playTimeChanged(double playTime);
     void self_playLengthChanged(double playLength);
     void self_chapterChanged(double chapter);
+    void self_mediaTitleChanged(QString title);
     void self_metadata(QVariantMap metadata);
     void self_audioDeviceList(const QVariantList &list);
     void hideTimer_timeout();
+    void scrubTimer_timeout();
     void self_aspectChanged(double newAspect);
 
     void self_mouseMoved(int x, int y);
@@ -189,8 +224,11 @@ private:
 
     QThread *worker = nullptr;
     QTimer *hideTimer = nullptr;
+    QTimer *scrubTimer = nullptr;
 
     QVariantMap cachedState;
+    QList<AudioDevice> audioDevices_;
+    QString mediaTitle_;
     QSize videoSize_;
     double playTime_ = 0.0;
     double playLength_ = 0.0;
@@ -200,9 +238,20 @@ private:
     int shownStatsPage = 0;
     bool loopImages = true;
     bool debugMessages = false;
+    bool recordLatency = true;
 
     bool sendMouseEvents = false;
     bool sendKeyEvents = false;
+
+    bool scrubInFlight = false;
+    bool scrubInFlightExact = false;
+    bool scrubPending = false;
+    bool scrubExact = false;
+    double scrubPosition = 0.0;
+    qint64 scrubIssuedNsec = 0;
+    qint64 seeksIssued = 0;
+    qint64 seeksDropped = 0;
+    qint64 seeksTimedOut = 0;
 };
 
 class MpvWidgetInterface
@@ -274,6 +323,56 @@ private:
 };
 
 
+// Renders through mpv's software renderer into an image buffer, so it works
+// without any gpu or gl stack, including when never shown (e.g. offscreen).
+class MpvSwWidget : public QWidget, public MpvWidgetInterface
+{
+    Q_OBJECT
+    Q_INTERFACES(MpvWidgetInterface)
+
+public:
+    explicit MpvSwWidget(MpvObject *object, QWidget *parent = nullptr);
+    ~MpvSwWidget();
+
+    QWidget *self();
+    void initMpv();
+    void setLogoUrl(const QString &filename);
+    void setLogoBackground(const QColor &color);
+    void setDrawLogo(bool yes);
+    QImage grabFrame();
+    // The size to render at while off screen, rather than the video's own.
+    void setOffscreenSize(const QSize &size);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void keyPressEvent(QKeyEvent *event);
+    void keyReleaseEvent(QKeyEvent *event);
+
+private:
+    static void render_update(void *ctx);
+    QSize renderSize();
+    void allocateFrame(const QSize &size);
+    void renderFrame();
+
+private slots:
+    void maybeUpdate();
+    void self_playbackStarted();
+    void self_playbackFinished();
+
+private:
+    mpv_render_context *render = nullptr;
+    LogoDrawer *logo = nullptr;
+    bool drawLogo = true;
+    QImage frame;
+    QSize offscreenSize;
+    uchar *frameBuffer = nullptr;
+    size_t frameBufferSize = 0;
+};
+
+
 // FIXME: implement MpvVulkanCbWidget
 typedef MpvGlWidget MpvVulkanCbWidget;
 
@@ -343,7 +442,7 @@ public:
 signals:
     void durationChanged(int value);
     void positionChanged(int value);
-    void mpvPropertyChanged(QString name, QVariant v, uint64_t userData);
+    void mpvPropertyChanged(QString name, QVariant v, uint64_t userData, qint64 eventNsec);
     void logMessageByParts(QString prefix, QString level, QString msg);
     //void logMessage(QString message);
     void clientMessage(uint64_t id, QStringList args);
@@ -366,12 +465,15 @@ public slots:
     void setThrottleTime(int msec);
 
     QString clientName();
+    QString mpvVersion();
     QStringList protocolList();
     int64_t timeMicroseconds();
     unsigned long apiVersion();
 
     void setLogLevel(QString logLevel);
     void showStatsPage(int page);
+    QVariantMap drainStatistics(bool reset = false);
+    void setDrainTimeSlice(int msec);
 
     int setOptionVariant(QString name, const QVariant &value);
     QVariant command(const QVariant &params);
@@ -387,18 +489,52 @@ public slots:
     void parseMpvEvents();
 
 private:
-    void setThrottledProperty(const QString &name, const QVariant &v, uint64_t userData);
+    struct DrainStatistics {
+        uint64_t drains = 0;
+        uint64_t slicedDrains = 0;
+        uint64_t events = 0;
+        int maxEventsPerDrain = 0;
+        qint64 lastLatencyUsec = 0;
+        qint64 maxLatencyUsec = 0;
+        qint64 totalLatencyUsec = 0;
+        qint64 maxDrainUsec = 0;
+    };
+
+    void setThrottledProperty(const QString &name, const QVariant &v, uint64_t userData,
+                              qint64 eventNsec);
     void flushProperties();
+    bool setVideoGeometryProperty(const QString &name, const QVariant &v);
+    void flushVideoGeometry();
+    void failAsync(MpvCallback *callback, int rc);
+    void recordDrain(qint64 latencyUsec, qint64 drainUsec, int events, bool sliced);
+    void scheduleDrain();
     void handleMpvEvent(mpv_event *event);
     static void mpvWakeup(void *ctx);
 
     mpv::qt::Handle mpv;
+    QString mpvVersion_;
     QStringList protocolList_;
     QSize lastVideoSize = QSize(0,0);
+    int64_t videoDWidth = 0;
+    int64_t videoDHeight = 0;
+    QVariantMap videoParams;
+    bool videoGeometryDirty = false;
+
+    QElapsedTimer drainClock;
+    std::atomic<qint64> pendingWakeupNsec { 0 };
+    std::atomic<bool> drainPending { false };
+    std::atomic<uint64_t> wakeups { 0 };
+    qint64 drainTimeSliceNsec = 0;
+    DrainStatistics drainStats;
 
     QTimer *throttler = nullptr;
     QSet<QString> throttledProperties;
-    typedef QMap<QString,QPair<QVariant,uint64_t>> ThrottledValueMap;
+    struct ThrottledValue {
+        QVariant value;
+        uint64_t userData;
+        qint64 eventNsec;
+    };
+    typedef QMap<QString,ThrottledValue> ThrottledValueMap;
     ThrottledValueMap throttledValues;
 
     int shownStatsPage = 0;
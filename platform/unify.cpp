@@ -2,6 +2,8 @@
 #include <QProcess>
 #include <QApplication>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include "logger.h"
 #include "unify.h"
 
@@ -11,6 +13,7 @@
 #include "screensaver_win.h"
 #else
 #include <dlfcn.h>
+#include <sys/stat.h>
 #include "devicemanager_unix.h"
 #include "screensaver_unix.h"
 #endif
@@ -99,6 +102,21 @@ QString Platform::sanitizedFilename(QString fileName)
     return fileName;
 }
 
+QByteArray Platform::fileIdentity(const QString &path)
+{
+#if defined(Q_OS_WIN)
+    // Windows has file ids too, but opening a handle per directory costs
+    // more than resolving the path, which finds junction loops just as well.
+    return QFileInfo(path).canonicalFilePath().toUtf8();
+#else
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0)
+        return QByteArray();
+    return QByteArray::number(quint64(st.st_dev)) + ':'
+            + QByteArray::number(quint64(st.st_ino));
+#endif
+}
+
 bool Platform::tiledDesktopsExist()
 {
     return isUnix;
@@ -17,6 +17,9 @@ namespace Platform {
     QString resourcesPath();
     QString fixedConfigPath(QString configPath);
     QString sanitizedFilename(QString fileName);
+    // Something that is the same for every path leading to the same file,
+    // i.e. the device and inode on unix.  Empty if the file cannot be found.
+    QByteArray fileIdentity(const QString &path);
     bool tiledDesktopsExist();
     bool tilingDesktopActive();
 }
@@ -66,6 +66,14 @@ void WindowManager::saveWindow(QWidget *window)
     json_.insert(window->objectName(), data);
 }
 
+void WindowManager::keepWindow(const QString &objectName, const QVariantMap &previousJson)
+{
+    // For windows that were not made this time around, so that where they
+    // were last time is not forgotten.
+    if (previousJson.contains(objectName))
+        json_.insert(objectName, previousJson.value(objectName));
+}
+
 void WindowManager::restoreAppWindow(MainWindow *window, const CliInfo &cliInfo)
 {
     QVariantMap data = json_[window->objectName()].toMap();
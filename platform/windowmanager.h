@@ -37,6 +37,7 @@ public:
     void saveAppWindow(MainWindow *window, bool rememberWindowGeometry, bool rememberPanels);
     void saveDocks(QMainWindow *dockHost);
     void saveWindow(QWidget *window);
+    void keepWindow(const QString &objectName, const QVariantMap &previousJson);
 
     void restoreAppWindow(MainWindow *window, const CliInfo &cliInfo);
     void restoreDocks(QMainWindow *dockHost, QList<QDockWidget*> dockWidgets);
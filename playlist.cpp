@@ -59,6 +59,7 @@ QUrl Item::url() const
 void Item::setUrl(const QUrl &url)
 {
     url_ = url;
+    revision_++;
 }
 
 const QVariantMap &Item::metadata() const
@@ -69,6 +70,12 @@ const QVariantMap &Item::metadata() const
 void Item::setMetadata(const QVariantMap &qvm)
 {
     metadata_ = qvm;
+    revision_++;
+}
+
+quint32 Item::revision() const
+{
+    return revision_;
 }
 
 int Item::originalPosition() const
@@ -383,6 +390,14 @@ void Playlist::takeItemsRaw(const QList<QSharedPointer<Item>> &itemsToRemove)
     }
 }
 
+void Playlist::reorderItems(const std::function<void (QList<QSharedPointer<Item>> &)> &reorder)
+{
+    // The callback may only shuffle the items around; adding or dropping
+    // any would leave itemsByUuid out of step.
+    QWriteLocker locker(&listLock);
+    reorder(items);
+}
+
 QList<QUuid> Playlist::replaceItem(const QUuid &where, const QList<QUrl> &urls)
 {
     QWriteLocker lock(&listLock);
@@ -390,14 +405,25 @@ QList<QUuid> Playlist::replaceItem(const QUuid &where, const QList<QUrl> &urls)
         return QList<QUuid>();
 
     itemsByUuid[where]->setUrl(urls[0]);
+    return insertAfter_(where, urls.mid(1));
+}
 
+QList<QUuid> Playlist::insertAfter(const QUuid &where, const QList<QUrl> &urls)
+{
+    QWriteLocker lock(&listLock);
+    if (!itemsByUuid.contains(where))
+        return QList<QUuid>();
+    return insertAfter_(where, urls);
+}
+
+QList<QUuid> Playlist::insertAfter_(const QUuid &where, const QList<QUrl> &urls)
+{
     QList<QUuid> addedItems;
-    // essentially insertAfter(where, urls[1..end]);
     int insertIndex = items.indexOf(itemsByUuid[where]);
-    for (int urlIndex = 1; urlIndex < urls.count(); urlIndex++) {
+    for (int urlIndex = 0; urlIndex < urls.count(); urlIndex++) {
         QSharedPointer<Item> i(new Item(urls[urlIndex]));
         i->setPlaylistUuid(playlistUuid_);
-        items.insert(insertIndex + urlIndex, i);
+        items.insert(insertIndex + 1 + urlIndex, i);
         itemsByUuid.insert(i->uuid(), i);
         addedItems.append(i->uuid());
     }
@@ -33,6 +33,8 @@ public:
     void setUrl(const QUrl &url);
     const QVariantMap &metadata() const;
     void setMetadata(const QVariantMap &qvm);
+    // Bumped whenever something shown for this item changes.
+    quint32 revision() const;
 
     int originalPosition() const;
     void setOriginalPosition(int i);
@@ -62,6 +64,7 @@ private:
     QUuid playlistUuid_;
     QUrl url_;
     QVariantMap metadata_;
+    quint32 revision_ = 0;
     int originalPosition_;
     int queuePosition_ = 0;
     int extraPlayTimes_ = 0;
@@ -113,7 +116,9 @@ public:
     virtual void addItems(const QUuid &where, const QList<QSharedPointer<Item> > &itemsToAdd);
     virtual void removeItem(const QUuid &itemUuid);
     void takeItemsRaw(const QList<QSharedPointer<Item>> &itemsToRemove);
+    void reorderItems(const std::function<void(QList<QSharedPointer<Item>> &)> &reorder);
     QList<QUuid> replaceItem(const QUuid &where, const QList<QUrl> &urls);
+    QList<QUuid> insertAfter(const QUuid &where, const QList<QUrl> &urls);
     virtual void clear();
 
     QDateTime created();
@@ -137,6 +142,9 @@ public:
     QVariantMap toVMap();
     void fromVMap(const QVariantMap &qvm);
 
+private:
+    QList<QUuid> insertAfter_(const QUuid &where, const QList<QUrl> &urls);
+
 protected:
     QList<QSharedPointer<Item>> items;
     QHash<QUuid, QSharedPointer<Item>> itemsByUuid;
@@ -1,24 +1,40 @@
 #include <QAction>
 #include <QClipboard>
+#include <QCollator>
 #include <QDragEnterEvent>
 #include <QGuiApplication>
 #include <QMimeData>
 #include <QInputDialog>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMenu>
 #include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include "directorywalker.h"
 #include "logger.h"
+#include "metadataprober.h"
 #include "playlistwindow.h"
 #include "ui_playlistwindow.h"
 #include "widgets/drawnplaylist.h"
 #include "playlist.h"
 
+// How long the playlist has to sit still before its rows are probed.
+static constexpr int probeDelayMsec = 100;
+
+// How many rows below the visible ones are probed ahead of scrolling.
+static constexpr int probeReadAhead = 100;
+
 PlaylistWindow::PlaylistWindow(QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::PlaylistWindow),
     currentPlaylist()
 {
     clipboard = new PlaylistSelection;
+    prober = new MetadataProber(this);
+    probeTimer = new QTimer(this);
+    probeTimer->setSingleShot(true);
+    probeTimer->setInterval(probeDelayMsec);
 
     ui->setupUi(this);
     setObjectName("playlistWindow");
@@ -27,6 +43,7 @@ PlaylistWindow::PlaylistWindow(QWidget *parent) :
     addQuickQueue();
     ui->searchHost->setVisible(false);
     ui->searchField->installEventFilter(this);
+    ui->walkHost->setVisible(false);
 
     setupIconThemer();
     connectSignalsToSlots();
@@ -50,6 +67,7 @@ void PlaylistWindow::setCurrentPlaylist(QUuid what)
 
 void PlaylistWindow::clearPlaylist(QUuid what)
 {
+    cancelWalks(what);
     if (widgets.contains(what))
         widgets[what]->removeAll();
     updatePlaylistHasItems();
@@ -57,33 +75,22 @@ void PlaylistWindow::clearPlaylist(QUuid what)
 
 PlaylistItem PlaylistWindow::addToPlaylist(const QUuid &playlist, const QList<QUrl> &what)
 {
-    QList<QUrl> filtered = Helpers::filterUrls(what);
-    PlaylistItem firstPlaylistItem, currentItem;
-    bool firstSet = false;
-    auto qdp = widgets.contains(playlist) ? widgets.value(playlist) : widgets[QUuid()];
-    for (QUrl &url : filtered) {
-        currentItem = qdp->importUrl(url);
-        if (!firstSet) {
-            firstPlaylistItem = currentItem;
-            firstSet = true;
-        }
-    }
-    updatePlaylistHasItems();
-    return firstPlaylistItem;
+    return addUrls(playlist, what, nullptr);
 }
 
-PlaylistItem PlaylistWindow::addToCurrentPlaylist(QList<QUrl> what)
+PlaylistItem PlaylistWindow::addToCurrentPlaylist(QList<QUrl> what,
+                                                  std::function<void(PlaylistItem)> addedLater)
 {
-    return addToPlaylist(currentPlaylist, what);
+    return addUrls(currentPlaylist, what, addedLater);
 }
 
-PlaylistItem PlaylistWindow::urlToQuickPlaylist(QUrl what)
+PlaylistItem PlaylistWindow::urlToQuickPlaylist(QUrl what,
+                                                std::function<void(PlaylistItem)> addedLater)
 {
-    auto pl = PlaylistCollection::getSingleton()->getPlaylist(QUuid());
-    pl->clear();
-    widgets[QUuid()]->clear();
+    cancelWalks(QUuid());
+    widgets[QUuid()]->removeAll();
     ui->tabWidget->setCurrentWidget(widgets[QUuid()]);
-    return addToCurrentPlaylist(QList<QUrl>() << what);
+    return addToCurrentPlaylist(QList<QUrl>() << what, addedLater);
 }
 
 bool PlaylistWindow::isCurrentPlaylistEmpty()
@@ -181,7 +188,11 @@ void PlaylistWindow::setMetadata(QUuid list, QUuid item, const QVariantMap &map)
     auto i = pl->getItem(item);
     if (!i)
         return;
-    i->setMetadata(map);
+    // The playing instance reports tags only, so keep the probed duration
+    QVariantMap metadata = map;
+    if (!metadata.contains("duration") && i->metadata().contains("duration"))
+        metadata.insert("duration", i->metadata().value("duration"));
+    i->setMetadata(metadata);
 
     auto qdp = currentPlaylistWidget();
     if (qdp->uuid() == list)
@@ -189,28 +200,62 @@ void PlaylistWindow::setMetadata(QUuid list, QUuid item, const QVariantMap &map)
 
 }
 
-void PlaylistWindow::replaceItem(QUuid list, QUuid item, const QList<QUrl> &urls)
+void PlaylistWindow::replaceItem(QUuid list, QUuid item, const QList<QUrl> &urls,
+                                 std::function<void()> replaced)
 {
     auto pl = PlaylistCollection::getSingleton()->getPlaylist(list);
     if (!pl)
         return;
 
+    bool hasDirectories = std::any_of(urls.begin(), urls.end(), [](const QUrl &url) {
+        return url.isLocalFile() && QFileInfo(url.toLocalFile()).isDir();
+    });
+    if (hasDirectories) {
+        // The item takes the first file found, and the rest follow on
+        // behind whatever was placed last.
+        auto last = QSharedPointer<QUuid>::create();
+        walkInto(list, urls, [replaced](PlaylistItem) {
+            if (replaced)
+                replaced();
+        }, [this, item, last](DrawnPlaylist *qdp, const QList<QUrl> &found) {
+            bool first = last->isNull();
+            *last = placeUrls(qdp->uuid(), first ? item : *last, found, first);
+            return first ? PlaylistItem { qdp->uuid(), item } : PlaylistItem();
+        });
+        return;
+    }
+
     QList<QUrl> filtered = Helpers::filterUrls(urls);
     if (filtered.isEmpty()) {
         // FIXME: remove the item that cannot played
-        return;
+    } else {
+        placeUrls(list, item, filtered, true);
     }
+    if (replaced)
+        replaced();
+}
+
+QUuid PlaylistWindow::placeUrls(const QUuid &list, const QUuid &where,
+                                const QList<QUrl> &urls, bool replace)
+{
+    // Either replaces where with the urls, or puts them after it, and
+    // returns the last item placed.
+    auto pl = PlaylistCollection::getSingleton()->getPlaylist(list);
+    if (!pl)
+        return where;
 
-    QList<QUuid> addedItems = pl->replaceItem(item, filtered);
-    auto listWidget = widgets[list];
+    QList<QUuid> addedItems = replace ? pl->replaceItem(where, urls)
+                                      : pl->insertAfter(where, urls);
+    auto listWidget = widgets.value(list, nullptr);
     if (listWidget)
-        listWidget->addItemsAfter(item, addedItems);
+        listWidget->addItemsAfter(where, addedItems);
 
     auto qdp = currentPlaylistWidget();
     if (qdp->uuid() == list)
         qdp->viewport()->update();
 
     updatePlaylistHasItems();
+    return addedItems.isEmpty() ? where : addedItems.last();
 }
 
 int PlaylistWindow::extraPlayTimes(QUuid list, QUuid item)
@@ -267,6 +312,8 @@ void PlaylistWindow::tabsFromVList(const QVariantList &qvl)
                 this, &PlaylistWindow::itemDesired);
         connect(qdp, &DrawnPlaylist::contextMenuRequested,
                 this, &PlaylistWindow::playlist_contextMenuRequested);
+        connect(qdp, &DrawnPlaylist::visibleItemsChanged,
+                this, &PlaylistWindow::playlist_visibleItemsChanged);
         auto pl = PlaylistCollection::getSingleton()->getPlaylist(qdp->uuid());
         ui->tabWidget->addTab(qdp, pl->title());
         widgets.insert(pl->uuid(), qdp);
@@ -352,6 +399,11 @@ void PlaylistWindow::connectSignalsToSlots()
             this, &PlaylistWindow::visibleToQueue);
     connect(ui->showQueue, &QPushButton::clicked,
             this, &PlaylistWindow::setQueueMode);
+
+    connect(probeTimer, &QTimer::timeout,
+            this, &PlaylistWindow::probeVisibleItems);
+    connect(prober, &MetadataProber::probed,
+            this, &PlaylistWindow::prober_probed);
 }
 
 DrawnPlaylist *PlaylistWindow::currentPlaylistWidget()
@@ -368,6 +420,7 @@ void PlaylistWindow::updateCurrentPlaylist()
     setTabOrder(ui->tabWidget->focusProxy(), qdp);
     setTabOrder(qdp, ui->searchField);
     updatePlaylistHasItems();
+    probeTimer->start();
 }
 
 void PlaylistWindow::updatePlaylistHasItems()
@@ -394,11 +447,116 @@ void PlaylistWindow::addNewTab(QUuid playlist, QString title)
     connect(qdp, &DrawnPlaylist::itemDesired, this, &PlaylistWindow::itemDesired);
     connect(qdp, &DrawnPlaylist::contextMenuRequested,
             this, &PlaylistWindow::playlist_contextMenuRequested);
+    connect(qdp, &DrawnPlaylist::visibleItemsChanged,
+            this, &PlaylistWindow::playlist_visibleItemsChanged);
     widgets.insert(playlist, qdp);
     ui->tabWidget->addTab(qdp, title);
     ui->tabWidget->setCurrentWidget(qdp);
 }
 
+PlaylistItem PlaylistWindow::addUrls(const QUuid &playlist, const QList<QUrl> &what,
+                                     std::function<void(PlaylistItem)> addedLater)
+{
+    auto qdp = widgets.contains(playlist) ? widgets.value(playlist) : widgets[QUuid()];
+    bool hasDirectories = std::any_of(what.begin(), what.end(), [](const QUrl &url) {
+        return url.isLocalFile() && QFileInfo(url.toLocalFile()).isDir();
+    });
+    if (hasDirectories) {
+        walkInto(qdp->uuid(), what, addedLater);
+        return PlaylistItem();
+    }
+    PlaylistItem firstPlaylistItem = qdp->importUrls(Helpers::filterUrls(what));
+    updatePlaylistHasItems();
+    return firstPlaylistItem;
+}
+
+void PlaylistWindow::walkInto(const QUuid &playlist, const QList<QUrl> &what,
+                              std::function<void(PlaylistItem)> addedLater,
+                              std::function<PlaylistItem(DrawnPlaylist*, const QList<QUrl>&)> place)
+{
+    auto walker = new DirectoryWalker(this);
+    auto firstAdded = QSharedPointer<std::function<void(PlaylistItem)>>::create(addedLater);
+    walks.insert(walker, { playlist });
+
+    connect(walker, &DirectoryWalker::urlsFound,
+            this, [this, walker, playlist, firstAdded, place](const QList<QUrl> &urls) {
+        auto qdp = widgets.value(playlist, nullptr);
+        if (!qdp) {
+            walker->cancel();
+            return;
+        }
+        // Files go at the end of the playlist, unless told otherwise
+        PlaylistItem playlistItem = place ? place(qdp, urls) : qdp->importUrls(urls);
+        updatePlaylistHasItems();
+        if (*firstAdded && !playlistItem.item.isNull()) {
+            auto callback = *firstAdded;
+            *firstAdded = nullptr;
+            callback(playlistItem);
+        }
+    });
+    connect(walker, &DirectoryWalker::progress,
+            this, [this, walker](int directoriesListed, int directoriesFound, int filesFound) {
+        if (!walks.contains(walker))
+            return;
+        WalkState &state = walks[walker];
+        state.directoriesListed = directoriesListed;
+        state.directoriesFound = directoriesFound;
+        state.filesFound = filesFound;
+        updateWalkProgress();
+    });
+    connect(walker, &DirectoryWalker::finished,
+            this, [this, walker]() {
+        walks.remove(walker);
+        walker->deleteLater();
+        updateWalkProgress();
+    });
+
+    updateWalkProgress();
+    walker->walk(what);
+}
+
+void PlaylistWindow::cancelWalks(const QUuid &playlist)
+{
+    const QList<DirectoryWalker*> walkers = walks.keys();
+    for (DirectoryWalker *walker : walkers)
+        if (walks.value(walker).playlist == playlist)
+            walker->cancel();
+}
+
+void PlaylistWindow::updateWalkProgress()
+{
+    int directoriesListed = 0;
+    int directoriesFound = 0;
+    int filesFound = 0;
+    for (const WalkState &state : std::as_const(walks)) {
+        directoriesListed += state.directoriesListed;
+        directoriesFound += state.directoriesFound;
+        filesFound += state.filesFound;
+    }
+    ui->walkHost->setVisible(!walks.isEmpty());
+    ui->walkProgress->setMaximum(directoriesFound);
+    ui->walkProgress->setValue(directoriesListed);
+    ui->walkProgress->setFormat(tr("%n file(s) found", nullptr, filesFound));
+}
+
+void PlaylistWindow::probeVisibleItems()
+{
+    auto qdp = currentPlaylistWidget();
+    if (!qdp)
+        return;
+    auto pl = qdp->playlist();
+    if (!pl)
+        return;
+    QList<MetadataProber::Request> requests;
+    const QList<QUuid> visible = qdp->visibleItemUuids(probeReadAhead);
+    for (const QUuid &itemUuid : visible) {
+        auto item = pl->getItem(itemUuid);
+        if (item && item->metadata().isEmpty() && item->url().isLocalFile())
+            requests.append({ pl->uuid(), itemUuid, item->url() });
+    }
+    prober->probe(requests);
+}
+
 void PlaylistWindow::addQuickQueue()
 {
     queueWidget = new DrawnQueue();
@@ -466,6 +624,11 @@ void PlaylistWindow::setDisplayFormatSpecifier(QString fmt)
     ui->tabWidget->currentWidget()->update();
 }
 
+void PlaylistWindow::setNaturalSort(bool yes)
+{
+    naturalSort = yes;
+}
+
 void PlaylistWindow::dockLocationMaybeChanged()
 {
     QLayout *layout = ui->contents->layout();
@@ -724,13 +887,10 @@ void PlaylistWindow::sortPlaylistByLabel(const QUuid &playlistUuid)
     auto qdp = widgets.value(playlistUuid, nullptr);
     if (!qdp)
         return;
-    auto converter = [this](QSharedPointer<Item> i) {
+    auto label = [this](QSharedPointer<Item> i) {
         return displayParser.parseMetadata(i->metadata(), i->toDisplayString(), Helpers::VideoFile);
     };
-    auto lessThan = [](const QString &a, const QString &b) {
-        return a < b;
-    };
-    qdp->sort<QString>(converter, lessThan);
+    sortPlaylistByText(qdp, label);
 }
 
 void PlaylistWindow::sortPlaylistByUrl(const QUuid &playlistUuid)
@@ -738,13 +898,33 @@ void PlaylistWindow::sortPlaylistByUrl(const QUuid &playlistUuid)
     auto qdp = widgets.value(playlistUuid, nullptr);
     if (!qdp)
         return;
-    auto converter = [](QSharedPointer<Item> i) {
+    auto url = [](QSharedPointer<Item> i) {
         return i->url().toDisplayString();
     };
-    auto lessThan = [](const QString &a, const QString &b) {
-        return a < b;
+    sortPlaylistByText(qdp, url);
+}
+
+void PlaylistWindow::sortPlaylistByText(DrawnPlaylist *qdp, std::function<QString(QSharedPointer<Item>)> text)
+{
+    if (!naturalSort) {
+        auto lessThan = [](const QString &a, const QString &b) {
+            return a < b;
+        };
+        qdp->sort<QString>(text, lessThan);
+        return;
+    }
+
+    // Natural order, i.e. "file 2" before "file 10"
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    auto converter = [&collator, &text](QSharedPointer<Item> i) {
+        return collator.sortKey(text(i));
     };
-    qdp->sort<QString>(converter, lessThan);
+    auto lessThan = [](const QCollatorSortKey &a, const QCollatorSortKey &b) {
+        return a.compare(b) < 0;
+    };
+    qdp->sort<QCollatorSortKey>(converter, lessThan);
 }
 
 void PlaylistWindow::shufflePlaylist(const QUuid &playlistUuid, bool shuffle)
@@ -988,6 +1168,28 @@ void PlaylistWindow::playlist_contextMenuRequested(const QPoint &p, const QUuid
     delete m;
 }
 
+void PlaylistWindow::playlist_visibleItemsChanged()
+{
+    if (sender() == currentPlaylistWidget())
+        probeTimer->start();
+}
+
+void PlaylistWindow::prober_probed(QUuid list, QUuid item, QVariantMap metadata)
+{
+    auto pl = PlaylistCollection::getSingleton()->getPlaylist(list);
+    if (!pl)
+        return;
+    auto i = pl->getItem(item);
+    // Whatever the playing instance reported is more up to date
+    if (!i || !i->metadata().isEmpty() || metadata.isEmpty())
+        return;
+    i->setMetadata(MetadataProber::displayable(metadata));
+
+    auto qdp = currentPlaylistWidget();
+    if (qdp->uuid() == list)
+        qdp->viewport()->update();
+}
+
 void PlaylistWindow::on_tabWidget_tabCloseRequested(int index)
 {
     int current = ui->tabWidget->currentIndex();
@@ -1003,6 +1205,7 @@ void PlaylistWindow::on_tabWidget_tabCloseRequested(int index)
     backup->addPlaylist(copy);
     emit playlistMovedToBackup(copy->uuid());
 
+    cancelWalks(qdp->uuid());
     if (qdp->uuid().isNull()) {
         qdp->removeAll();
     } else {
@@ -1065,3 +1268,10 @@ void PlaylistWindow::on_searchField_returnPressed()
 {
     playCurrentItem();
 }
+
+void PlaylistWindow::on_walkCancel_clicked()
+{
+    const QList<DirectoryWalker*> walkers = walks.keys();
+    for (DirectoryWalker *walker : walkers)
+        walker->cancel();
+}
@@ -4,6 +4,7 @@
 #include <QDockWidget>
 #include <QHash>
 #include <QUuid>
+#include <functional>
 #include "helpers.h"
 #include "playlist.h"
 
@@ -11,9 +12,12 @@ namespace Ui {
 class PlaylistWindow;
 }
 
+class DirectoryWalker;
 class DrawnPlaylist;
+class MetadataProber;
 class PlaylistSelection;
 class QThread;
+class QTimer;
 class PlaylistSearcher;
 class PlaylistWindow : public QDockWidget
 {
@@ -26,8 +30,12 @@ public:
     void setCurrentPlaylist(QUuid what);
     void clearPlaylist(QUuid what);
     PlaylistItem addToPlaylist(const QUuid &playlist, const QList<QUrl> &what);
-    PlaylistItem addToCurrentPlaylist(QList<QUrl> what);
-    PlaylistItem urlToQuickPlaylist(QUrl what);
+    // When directories have to be listed first, these return a null item
+    // and call addedLater with the first item once it is in the playlist.
+    PlaylistItem addToCurrentPlaylist(QList<QUrl> what,
+                                      std::function<void(PlaylistItem)> addedLater = nullptr);
+    PlaylistItem urlToQuickPlaylist(QUrl what,
+                                    std::function<void(PlaylistItem)> addedLater = nullptr);
     bool isCurrentPlaylistEmpty();
     bool isPlaylistSingularFile(QUuid list);
     bool isPlaylistRepeat(QUuid list);
@@ -38,7 +46,11 @@ public:
     QUrl getUrlOf(QUuid list, QUuid item);
     QUrl getUrlOfFirst(QUuid list);
     void setMetadata(QUuid list, QUuid item, const QVariantMap &map);
-    void replaceItem(QUuid list, QUuid item, const QList<QUrl> &urls);
+    // Puts urls in the place of item.  When directories have to be listed
+    // first, the item is replaced as they are, and replaced is called once
+    // it has its first url; otherwise it is called straight away.
+    void replaceItem(QUuid list, QUuid item, const QList<QUrl> &urls,
+                     std::function<void()> replaced = nullptr);
     int extraPlayTimes(QUuid list, QUuid item);
     void setExtraPlayTimes(QUuid list, QUuid item, int amount);
     void deltaExtraPlayTimes(QUuid list, QUuid item, int delta);
@@ -64,6 +76,16 @@ private:
     void setPlaylistFilters(QString filterText);
     void addNewTab(QUuid playlist, QString title);
     void addQuickQueue();
+    PlaylistItem addUrls(const QUuid &playlist, const QList<QUrl> &what,
+                         std::function<void(PlaylistItem)> addedLater);
+    void walkInto(const QUuid &playlist, const QList<QUrl> &what,
+                  std::function<void(PlaylistItem)> addedLater,
+                  std::function<PlaylistItem(DrawnPlaylist*, const QList<QUrl>&)> place = nullptr);
+    QUuid placeUrls(const QUuid &list, const QUuid &where, const QList<QUrl> &urls,
+                    bool replace);
+    void cancelWalks(const QUuid &playlist);
+    void updateWalkProgress();
+    void probeVisibleItems();
 
 signals:
     void windowDocked();
@@ -88,6 +110,7 @@ public slots:
     void addSimplePlaylist(QStringList data);
     void addPlaylistByUuid(QUuid playlistUuid);
     void setDisplayFormatSpecifier(QString fmt);
+    void setNaturalSort(bool yes);
     void dockLocationMaybeChanged();
 
     void newTab();
@@ -124,6 +147,7 @@ private slots:
     void savePlaylist(const QUuid &playlistUuid);
     void sortPlaylistByLabel(const QUuid &playlistUuid);
     void sortPlaylistByUrl(const QUuid &playlistUuid);
+    void sortPlaylistByText(DrawnPlaylist *qdp, std::function<QString(QSharedPointer<Item>)> text);
     void shufflePlaylist(const QUuid &playlistUuid, bool shuffle);
     void refreshPlaylist(const QUuid & playlistUuid);
     void restorePlaylist(const QUuid &playlistUuid);
@@ -135,6 +159,8 @@ private slots:
     void playlist_copySelectionToClipboard(const QUuid &playlistUuid);
     void playlist_hideOnFullscreenToggled(bool checked);
     void playlist_contextMenuRequested(const QPoint &p, const QUuid &playlistUuid, const QUuid &itemUuid);
+    void playlist_visibleItemsChanged();
+    void prober_probed(QUuid list, QUuid item, QVariantMap metadata);
 
     void on_tabWidget_tabCloseRequested(int index);
 
@@ -148,6 +174,8 @@ private slots:
 
     void on_searchField_returnPressed();
 
+    void on_walkCancel_clicked();
+
 private:
     Ui::PlaylistWindow *ui = nullptr;
     IconThemer themer;
@@ -155,8 +183,18 @@ private:
     DisplayParser displayParser;
     bool showSearch = false;
     bool hideFullscreen = false;
+    bool naturalSort = false;
 
     QHash<QUuid, DrawnPlaylist*> widgets;
+    struct WalkState {
+        QUuid playlist;
+        int directoriesListed = 0;
+        int directoriesFound = 0;
+        int filesFound = 0;
+    };
+    QHash<DirectoryWalker*, WalkState> walks;
+    MetadataProber *prober = nullptr;
+    QTimer *probeTimer = nullptr;
     DrawnPlaylist* queueWidget = nullptr;
     PlaylistSelection *clipboard = nullptr;
 };
@@ -18,9 +18,6 @@ public:
     explicit PropertiesWindow(QWidget *parent = nullptr);
     ~PropertiesWindow();
 
-signals:
-    void artistAndTitleChanged(QString artistAndTitle);
-
 public slots:
     void setFileName(const QString &filename);
     void setFileFormat(const QString &format);
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include "logger.h"
+#include "mpvwidget.h"
+#include "seekpreview.h"
+#include "thumbnailcache.h"
+
+constexpr char logModule[] = "seekpreview";
+constexpr char friendlyName[] = "Media Player Classic Qute Theater - Preview";
+constexpr int previewHeight = 90;
+constexpr int previewBuckets = 400;
+constexpr double minimumBucketSec = 1.0;
+constexpr int prefetchRadius = 3;
+constexpr int cacheBytes = 32 * 1024 * 1024;
+
+SeekPreviewer::SeekPreviewer(QObject *parent)
+    : QObject(parent)
+{
+    cache.setMaxCost(cacheBytes);
+}
+
+SeekPreviewer::~SeekPreviewer()
+{
+    deinitPlayer();
+}
+
+void SeekPreviewer::setSource(const QUrl &url)
+{
+    // Streams would need a second connection just for previews, so only
+    // local files are previewed.
+    QUrl local = url.isLocalFile() ? url : QUrl();
+    if (local == source)
+        return;
+    source = local;
+    sourceSerial++;
+    duration = 0;
+    loaded = false;
+    ready = false;
+    pendingTime = -1;
+    wantedBucket = -1;
+    inFlightBucket = -1;
+    diskBucket = -1;
+    diskChecked.clear();
+
+    if (source.isEmpty()) {
+        deinitPlayer();
+        return;
+    }
+    // Once previews have been asked for, follow the player from file to
+    // file rather than making the next hover wait for the load.
+    if (mpv)
+        loadSource();
+}
+
+int SeekPreviewer::request(double time)
+{
+    if (source.isEmpty())
+        return -1;
+    if (!loaded)
+        loadSource();
+    int bucket = bucketOf(time);
+    if (bucket < 0) {
+        // Still loading; start on this position once the length is known
+        pendingTime = time;
+        return -1;
+    }
+    wantedBucket = bucket;
+    if (QImage *image = cachedImage(bucket))
+        emit previewReady(bucket, *image);
+    seekNext();
+    return bucket;
+}
+
+void SeekPreviewer::cancel()
+{
+    // Let any lookup in flight land in the cache, but don't start new ones.
+    pendingTime = -1;
+    wantedBucket = -1;
+}
+
+void SeekPreviewer::initPlayer()
+{
+    mpv = new MpvObject(this, friendlyName, MpvObject::HelperRole);
+    drawer = new MpvSwWidget(mpv);
+    mpv->setWidgetType(Helpers::CustomWidget, drawer);
+    connect(mpv, &MpvObject::playLengthChanged,
+            this, &SeekPreviewer::mpv_playLengthChanged);
+    connect(mpv, &MpvObject::playbackStarted,
+            this, &SeekPreviewer::mpv_playbackStarted);
+    connect(mpv, &MpvObject::playbackRestarted,
+            this, &SeekPreviewer::mpv_playbackRestarted);
+
+    // Cheap, keyframe-only decoding of a downscaled picture
+    emit mpv->ctrlSetOptionVariant("hr-seek", "no");
+    emit mpv->ctrlSetOptionVariant("vd-lavc-skiploopfilter", "all");
+    emit mpv->ctrlSetOptionVariant("vd-lavc-fast", "yes");
+    emit mpv->ctrlSetOptionVariant("vf", QString("scale=w=-2:h=%1").arg(previewHeight));
+    emit mpv->ctrlSetOptionVariant("aid", "no");
+    emit mpv->ctrlSetOptionVariant("sid", "no");
+    emit mpv->ctrlSetOptionVariant("ao", "null");
+    emit mpv->ctrlSetOptionVariant("osd-level", 0);
+    emit mpv->ctrlSetOptionVariant("untimed", "yes");
+}
+
+void SeekPreviewer::loadSource()
+{
+    if (!mpv)
+        initPlayer();
+    LogStream(logModule) << "loading " << source;
+    mpv->urlOpen(source);
+    mpv->setPaused(true);
+    loaded = true;
+}
+
+void SeekPreviewer::deinitPlayer()
+{
+    if (!mpv)
+        return;
+    mpv->setWidgetType(Helpers::NullWidget);
+    drawer = nullptr;
+
+    delete mpv;
+    mpv = nullptr;
+}
+
+int SeekPreviewer::bucketCount() const
+{
+    return std::max(1, std::min(previewBuckets, int(duration / minimumBucketSec)));
+}
+
+int SeekPreviewer::bucketOf(double time) const
+{
+    if (!ready || duration <= 0 || time < 0)
+        return -1;
+    return std::clamp(int(time / duration * bucketCount()), 0, bucketCount() - 1);
+}
+
+SeekPreviewer::CacheKey SeekPreviewer::keyOf(int bucket) const
+{
+    return { source.toLocalFile(), bucket };
+}
+
+QString SeekPreviewer::diskKeyOf(int bucket) const
+{
+    // Bucket boundaries depend on the bucket count, so it's part of the key
+    return QString("preview:%1:%2/%3").arg(QString::number(previewHeight),
+                                           QString::number(bucket),
+                                           QString::number(bucketCount()));
+}
+
+QImage *SeekPreviewer::cachedImage(int bucket)
+{
+    // Only memory is looked at here; the disk is left to fetchFromDisk
+    return cache.object(keyOf(bucket));
+}
+
+void SeekPreviewer::cacheImage(int bucket, const QImage &image)
+{
+    int cost = int(image.sizeInBytes());
+    cache.insert(keyOf(bucket), new QImage(image), cost);
+    if (bucket == wantedBucket)
+        emit previewReady(bucket, image);
+}
+
+int SeekPreviewer::nextBucket()
+{
+    if (wantedBucket < 0)
+        return -1;
+    if (!cachedImage(wantedBucket))
+        return wantedBucket;
+    for (int d = 1; d <= prefetchRadius; d++) {
+        for (int b : { wantedBucket + d, wantedBucket - d }) {
+            if (b >= 0 && b < bucketCount() && !cachedImage(b))
+                return b;
+        }
+    }
+    return -1;
+}
+
+void SeekPreviewer::seekNext()
+{
+    if (!ready || inFlightBucket >= 0 || diskBucket >= 0)
+        return;
+    int bucket = nextBucket();
+    if (bucket < 0)
+        return;
+    // Earlier runs may have left it on disk, which beats decoding it again
+    if (!diskChecked.contains(bucket)) {
+        fetchFromDisk(bucket);
+        return;
+    }
+    inFlightBucket = bucket;
+    double time = (inFlightBucket + 0.5) * duration / bucketCount();
+    mpv->setTime(time);
+}
+
+void SeekPreviewer::fetchFromDisk(int bucket)
+{
+    diskBucket = bucket;
+    int serial = sourceSerial;
+    QUrl media = source;
+    QString key = diskKeyOf(bucket);
+    QtConcurrent::run([media, key]() {
+        return ThumbnailCache::singleton()->fetchImage(media, key);
+    }).then(this, [this, serial, bucket](QImage image) {
+        if (serial != sourceSerial)
+            return;
+        diskBucket = -1;
+        diskChecked.insert(bucket);
+        if (!image.isNull())
+            cacheImage(bucket, image);
+        seekNext();
+    });
+}
+
+void SeekPreviewer::mpv_playLengthChanged(double length)
+{
+    duration = length;
+}
+
+void SeekPreviewer::mpv_playbackStarted()
+{
+    // Wait for the restart that follows loading, so that it can't be
+    // mistaken for the end of our first seek.
+    ready = false;
+    inFlightBucket = -1;
+}
+
+void SeekPreviewer::mpv_playbackRestarted()
+{
+    if (!ready) {
+        ready = true;
+        if (pendingTime >= 0 && wantedBucket < 0)
+            wantedBucket = bucketOf(pendingTime);
+        pendingTime = -1;
+        seekNext();
+        return;
+    }
+    if (inFlightBucket < 0)
+        return;
+
+    int bucket = inFlightBucket;
+    inFlightBucket = -1;
+    QImage frame = drawer->grabFrame();
+    if (!frame.isNull()) {
+        cacheImage(bucket, frame);
+        // Encoding and writing it out can take a while, so do it elsewhere
+        QUrl media = source;
+        QString key = diskKeyOf(bucket);
+        QThreadPool::globalInstance()->start([media, key, frame]() {
+            ThumbnailCache::singleton()->storeImage(media, key, frame);
+        });
+    }
+    seekNext();
+}
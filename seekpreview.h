@@ -0,0 +1,75 @@
+#ifndef SEEKPREVIEW_H
+#define SEEKPREVIEW_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QUrl>
+
+class MpvObject;
+class MpvSwWidget;
+
+// SeekPreviewer decodes small keyframe-only previews of the file being
+// played, for showing while hovering over the seekbar.  It runs its own
+// headless mpv instance, so decoding happens on mpv's threads and never
+// touches the main player.  The instance is only started by the first
+// request, as most files are never hovered over.  Only one lookup is ever
+// in flight, either in the on-disk cache or a seek; requests made meanwhile
+// replace each other, so it always heads for wherever the mouse is now.
+// Once that is served, it prefetches around it.
+class SeekPreviewer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SeekPreviewer(QObject *parent = nullptr);
+    ~SeekPreviewer();
+
+    void setSource(const QUrl &url);
+    // Returns the bucket the time falls into, or -1 if no preview can be
+    // made.  previewReady is emitted with the same bucket when available.
+    int request(double time);
+    void cancel();
+
+signals:
+    void previewReady(int bucket, QImage image);
+
+private:
+    typedef QPair<QString,int> CacheKey;
+
+    void initPlayer();
+    void deinitPlayer();
+    void loadSource();
+    int bucketCount() const;
+    int bucketOf(double time) const;
+    CacheKey keyOf(int bucket) const;
+    QString diskKeyOf(int bucket) const;
+    QImage *cachedImage(int bucket);
+    void cacheImage(int bucket, const QImage &image);
+    int nextBucket();
+    void seekNext();
+    void fetchFromDisk(int bucket);
+
+private slots:
+    void mpv_playLengthChanged(double length);
+    void mpv_playbackStarted();
+    void mpv_playbackRestarted();
+
+private:
+    MpvObject *mpv = nullptr;
+    MpvSwWidget *drawer = nullptr;
+    QUrl source;
+    int sourceSerial = 0;
+    double duration = 0;
+    bool loaded = false;
+    bool ready = false;
+    double pendingTime = -1;
+    int wantedBucket = -1;
+    int inFlightBucket = -1;
+    int diskBucket = -1;
+    QSet<int> diskChecked;
+    QCache<CacheKey, QImage> cache;
+};
+
+#endif // SEEKPREVIEW_H
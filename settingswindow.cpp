@@ -1,8 +1,10 @@
 #include <cmath>
+#include <QApplication>
 #include <QDesktopServices>
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QFileDialog>
+#include <QFontInfo>
 #include <QColorDialog>
 #include <QProcess>
 #include <QProcessEnvironment>
@@ -303,9 +305,1006 @@ void SettingMap::fromVMap(const QVariantMap &m)
 }
 
 
-SettingsWindow::SettingsWindow(QWidget *parent) :
+constexpr char paletteEditorName[] = "interfaceWidgetCustomPalette";
+constexpr char screenComboName[] = "fullscreenMonitor";
+// Entries in playbackAutoZoomMethod, the last three of which are autofits.
+constexpr int autoZoomMethodCount = 11;
+
+
+
+// The reason why we're using #define's like this instead of quoted-string
+// inspection is because this way guarantees that the app will not break from
+// the names here and the names in the ui file not matching up.  The model
+// has no widgets to ask, so the name is checked against the ui class instead.
+
+#define WIDGET_NAME(widget) \
+    (static_cast<void>(&Ui::SettingsWindow::widget), QStringLiteral(#widget))
+
+#define WIDGET_LOOKUP(widget) \
+    settings_[WIDGET_NAME(widget)]
+
+#define WIDGET_LOOKUP_PREFIX(prefix, widget) \
+    settings_[prefix + WIDGET_NAME(widget)]
+
+#define OFFSET_LOOKUP(source, widget) \
+    source.value(WIDGET_NAME(widget)).toInt()
+
+#define WIDGET_TO_TEXT(widget) \
+    SettingMap::indexedValueToText[WIDGET_NAME(widget)].value(OFFSET_LOOKUP(settings_,widget), \
+        SettingMap::indexedValueToText[WIDGET_NAME(widget)].value(OFFSET_LOOKUP(defaults,widget)))
+
+#define WIDGET_PLACEHOLD_LOOKUP(widget) \
+    (WIDGET_LOOKUP(widget).toString().isEmpty() ? placeholders.value(WIDGET_NAME(widget)).toString() \
+                                                : WIDGET_LOOKUP(widget).toString())
+
+#define WIDGET_LOOKUP2(option, widget, dflt) \
+    (WIDGET_LOOKUP(option).toBool() ? WIDGET_LOOKUP(widget) : QVariant(dflt))
+
+#define WIDGET_LOOKUP2_TEXT(option, widget, dflt) \
+    (WIDGET_LOOKUP(option).toBool() ? WIDGET_TO_TEXT(widget) : QVariant(dflt))
+
+// What each control holds in a freshly made settings window, so that the
+// model need not make one to find out.  This has to be kept in step with
+// settingswindow.ui by hand; the window logs any control that disagrees.
+static QVariantMap standardDefaults(const QPalette &systemPalette)
+{
+    QString defaultFont = QFontInfo(qApp->font()).family();
+    return {
+        { WIDGET_NAME(playerKeepHistory), true },
+        { WIDGET_NAME(playerKeepHistoryOnlyForVideos), true },
+        { WIDGET_NAME(playerRememberFilePosition), true },
+        { WIDGET_NAME(playerRememberLastPlaylist), false },
+        { WIDGET_NAME(playerRememberWindowGeometry), true },
+        { WIDGET_NAME(playerRememberPanels), true },
+        { WIDGET_NAME(playerRememberPanScanZoom), false },
+        { WIDGET_NAME(playerLanguageComboBox_v2), 0 },
+        { WIDGET_NAME(playerTitleDisplayFullPath), false },
+        { WIDGET_NAME(playerTitleFileNameOnly), true },
+        { WIDGET_NAME(playerTitleDontPrefix), false },
+        { WIDGET_NAME(playerTitleReplaceName), true },
+        { WIDGET_NAME(playerOpenSame), true },
+        { WIDGET_NAME(playerOpenNew), false },
+        { WIDGET_NAME(playerTrayIcon), false },
+        { WIDGET_NAME(playerOSD), false },
+        { WIDGET_NAME(playerLimitProportions), true },
+        { WIDGET_NAME(playerDisableOpenDisc), false },
+        { WIDGET_NAME(playerDisableScreensaver), true },
+        { WIDGET_NAME(formatList), QStringList() },
+        { WIDGET_NAME(ipcMpris), true },
+        { WIDGET_NAME(logoExternal), false },
+        { WIDGET_NAME(logoUseInternal), true },
+        { WIDGET_NAME(logoExternalLocation), QString() },
+        { WIDGET_NAME(logoInternal), 1 },
+        { WIDGET_NAME(interfaceIconsTheme), 0 },
+        { WIDGET_NAME(interfaceIconsCustomFolder), QString() },
+        { WIDGET_NAME(interfaceIconsInbuilt), 0 },
+        { WIDGET_NAME(interfaceWidgetHighContast), false },
+        { WIDGET_NAME(interfaceWidgetCustom), false },
+        { WIDGET_NAME(windowVideoValue), QString("000000") },
+        { WIDGET_NAME(windowInfoBackgroundValue), QString("000000") },
+        { WIDGET_NAME(windowInfoForegroundValue), QString("FFFFFF") },
+        { WIDGET_NAME(stylesheetFusion), Platform::isWindows },
+        { WIDGET_NAME(stylesheetText), QString() },
+        { WIDGET_NAME(webEnableServer), false },
+        { WIDGET_NAME(webPort), 13579 },
+        { WIDGET_NAME(webLocalhost_v2), true },
+        { WIDGET_NAME(webServePages), false },
+        { WIDGET_NAME(webRoot), QString() },
+        { WIDGET_NAME(webDefaultPage), QString() },
+        { WIDGET_NAME(playbackVolumeStep), 10 },
+        { WIDGET_NAME(playbackSpeedStep), 0 },
+        { WIDGET_NAME(playbackSpeedStepAdditive), false },
+        { WIDGET_NAME(playbackNormalStep), 5000 },
+        { WIDGET_NAME(playbackLargeStep), 20000 },
+        { WIDGET_NAME(playbackAutoCenterWindow), true },
+        { WIDGET_NAME(playbackAutoZoom), !Platform::tilingDesktopActive() },
+        { WIDGET_NAME(playbackAutoZoomMethod), 3 },
+        { WIDGET_NAME(playbackAutoFitFactor), 75 },
+        { WIDGET_NAME(playbackBalance), 0 },
+        { WIDGET_NAME(playbackVolume), 100 },
+        { WIDGET_NAME(playbackSubtitleTracks), QString() },
+        { WIDGET_NAME(playbackAudioTracks), QString() },
+        { WIDGET_NAME(playbackMouseHideFullscreen), true },
+        { WIDGET_NAME(playbackMouseHideFullscreenDuration), 1000 },
+        { WIDGET_NAME(playbackMouseHideWindowed), true },
+        { WIDGET_NAME(playbackMouseHideWindowedDuration), 1000 },
+        { WIDGET_NAME(afterPlaybackDefault), 0 },
+        { WIDGET_NAME(videoDumbMode), false },
+        { WIDGET_NAME(videoFramebuffer), 0 },
+        { WIDGET_NAME(videoUseAlpha), false },
+        { WIDGET_NAME(videoAlphaMode), 0 },
+        { WIDGET_NAME(videoSharpen), 0.0 },
+        { WIDGET_NAME(videoPreset), 0 },
+        { WIDGET_NAME(ditherDithering), false },
+        { WIDGET_NAME(ditherDepth), 0 },
+        { WIDGET_NAME(ditherType), 0 },
+        { WIDGET_NAME(ditherFruitSize), 4 },
+        { WIDGET_NAME(ditherTemporal), false },
+        { WIDGET_NAME(ditherTemporalPeriod), 1 },
+        { WIDGET_NAME(scalingCorrectDownscaling), false },
+        { WIDGET_NAME(scalingInLinearLight), false },
+        { WIDGET_NAME(scalingUpInLinearLight), false },
+        { WIDGET_NAME(scalingTemporalInterpolation), false },
+        { WIDGET_NAME(scalingBlendSubtitles), false },
+        { WIDGET_NAME(scalingSigmoidizedUpscaling), false },
+        { WIDGET_NAME(sigmoidizedCenter), 0.75 },
+        { WIDGET_NAME(sigmoidizedSlope), 6.5 },
+        { WIDGET_NAME(scaleParam1Set), false },
+        { WIDGET_NAME(scaleParam1Value), 0.0 },
+        { WIDGET_NAME(scaleRadiusSet), false },
+        { WIDGET_NAME(scaleRadiusValue), 2.0 },
+        { WIDGET_NAME(scaleParam2Set), false },
+        { WIDGET_NAME(scaleParam2Value), 0.0 },
+        { WIDGET_NAME(scaleAntiRingSet), false },
+        { WIDGET_NAME(scaleAntiRingValue), 0.0 },
+        { WIDGET_NAME(scaleBlurSet), false },
+        { WIDGET_NAME(scaleBlurValue), 0.0 },
+        { WIDGET_NAME(scaleWindowSet), false },
+        { WIDGET_NAME(scaleWindowValue), 0 },
+        { WIDGET_NAME(scaleWindowParamSet), false },
+        { WIDGET_NAME(scaleWindowParamValue), 0.0 },
+        { WIDGET_NAME(scaleClampSet), false },
+        { WIDGET_NAME(scaleClampValue), 0.0 },
+        { WIDGET_NAME(scaleScaler), 0 },
+        { WIDGET_NAME(dscaleScaler), 0 },
+        { WIDGET_NAME(dscaleParam1Set), false },
+        { WIDGET_NAME(dscaleParam1Value), 0.0 },
+        { WIDGET_NAME(dscaleRadiusSet), false },
+        { WIDGET_NAME(dscaleRadiusValue), 2.0 },
+        { WIDGET_NAME(dscaleParam2Set), false },
+        { WIDGET_NAME(dscaleParam2Value), 0.0 },
+        { WIDGET_NAME(dscaleAntiRingSet), false },
+        { WIDGET_NAME(dscaleAntiRingValue), 0.0 },
+        { WIDGET_NAME(dscaleBlurSet), false },
+        { WIDGET_NAME(dscaleBlurValue), 0.0 },
+        { WIDGET_NAME(dscaleClampSet), false },
+        { WIDGET_NAME(dscaleClampValue), 0.0 },
+        { WIDGET_NAME(dscaleWindowSet), false },
+        { WIDGET_NAME(dscaleWindowValue), 0 },
+        { WIDGET_NAME(dscaleWindowParamSet), false },
+        { WIDGET_NAME(dscaleWindowParamValue), 0.0 },
+        { WIDGET_NAME(cscaleScaler), 0 },
+        { WIDGET_NAME(cscaleParam1Set), false },
+        { WIDGET_NAME(cscaleParam1Value), 0.0 },
+        { WIDGET_NAME(cscaleRadiusSet), false },
+        { WIDGET_NAME(cscaleRadiusValue), 2.0 },
+        { WIDGET_NAME(cscaleParam2Set), false },
+        { WIDGET_NAME(cscaleParam2Value), 0.0 },
+        { WIDGET_NAME(cscaleAntiRingSet), false },
+        { WIDGET_NAME(cscaleAntiRingValue), 0.0 },
+        { WIDGET_NAME(cscaleBlurSet), false },
+        { WIDGET_NAME(cscaleBlurValue), 0.0 },
+        { WIDGET_NAME(cscaleClampSet), false },
+        { WIDGET_NAME(cscaleClampValue), 0.0 },
+        { WIDGET_NAME(cscaleWindowSet), false },
+        { WIDGET_NAME(cscaleWindowValue), 0 },
+        { WIDGET_NAME(cscaleWindowParamSet), false },
+        { WIDGET_NAME(cscaleWindowParamValue), 0.0 },
+        { WIDGET_NAME(tscaleScaler), 0 },
+        { WIDGET_NAME(tscaleParam1Set), false },
+        { WIDGET_NAME(tscaleParam1Value), 0.0 },
+        { WIDGET_NAME(tscaleRadiusSet), false },
+        { WIDGET_NAME(tscaleRadiusValue), 2.0 },
+        { WIDGET_NAME(tscaleParam2Set), false },
+        { WIDGET_NAME(tscaleParam2Value), 0.0 },
+        { WIDGET_NAME(tscaleAntiRingSet), false },
+        { WIDGET_NAME(tscaleAntiRingValue), 0.0 },
+        { WIDGET_NAME(tscaleBlurSet), false },
+        { WIDGET_NAME(tscaleBlurValue), 0.0 },
+        { WIDGET_NAME(tscaleClampSet), false },
+        { WIDGET_NAME(tscaleClampValue), 0.0 },
+        { WIDGET_NAME(tscaleWindowSet), false },
+        { WIDGET_NAME(tscaleWindowValue), 0 },
+        { WIDGET_NAME(tscaleWindowParamSet), false },
+        { WIDGET_NAME(tscaleWindowParamValue), 0.0 },
+        { WIDGET_NAME(debandEnabled), false },
+        { WIDGET_NAME(debandIterations), 1 },
+        { WIDGET_NAME(debandThreshold), 64.0 },
+        { WIDGET_NAME(debandRange), 16.0 },
+        { WIDGET_NAME(debandGrain), 48.0 },
+        { WIDGET_NAME(ccTargetPrim), 0 },
+        { WIDGET_NAME(ccTargetTrc_v2), 0 },
+        { WIDGET_NAME(ccTargetPeak), 9 },
+        { WIDGET_NAME(ccHdrMapper), 1 },
+        { WIDGET_NAME(ccHdrClipParam), 1.0 },
+        { WIDGET_NAME(ccHdrMobiusParam), 0.3 },
+        { WIDGET_NAME(ccHdrReinhardParam), 0.5 },
+        { WIDGET_NAME(ccHdrGammaParam), 1.8 },
+        { WIDGET_NAME(ccHdrLinearParam), 1.0 },
+        { WIDGET_NAME(ccHdrCompute), 2 },
+        { WIDGET_NAME(ccICCAutodetect), true },
+        { WIDGET_NAME(ccICCLocation), QString() },
+        { WIDGET_NAME(ccTargetGamut), 0 },
+        { WIDGET_NAME(ccGamutMapping), 0 },
+        { WIDGET_NAME(shadersFileList), QStringList() },
+        { WIDGET_NAME(shadersPresetsList), -1 },
+        { WIDGET_NAME(shadersWikiList), QStringList() },
+        { WIDGET_NAME(shadersActiveList), QStringList() },
+        { WIDGET_NAME(fullscreenShowWhenDuration), 0 },
+        { WIDGET_NAME(fullscreenHidePanels), true },
+        { WIDGET_NAME(fullscreenHideControls), true },
+        { WIDGET_NAME(fullscreenShowWhen), 2 },
+        { WIDGET_NAME(fullscreenLaunch), false },
+        { WIDGET_NAME(fullscreenWindowedAtEnd), false },
+        { WIDGET_NAME(framedroppingMode), 1 },
+        { WIDGET_NAME(framedroppingDecoderMode), 1 },
+        { WIDGET_NAME(syncMode), 0 },
+        { WIDGET_NAME(syncAudioDropSize), 0.02 },
+        { WIDGET_NAME(syncMaxAudioChange), 0.12 },
+        { WIDGET_NAME(syncMaxVideoChange), 1.0 },
+        { WIDGET_NAME(hwdecEnable), false },
+        { WIDGET_NAME(hwdecAll), false },
+        { WIDGET_NAME(hwdecMJpeg), false },
+        { WIDGET_NAME(hwdecMpeg1Video), false },
+        { WIDGET_NAME(hwdecMpeg2Video), true },
+        { WIDGET_NAME(hwdecMpeg4), false },
+        { WIDGET_NAME(hwdecH263), false },
+        { WIDGET_NAME(hwdecH264), true },
+        { WIDGET_NAME(hwdecVc1), true },
+        { WIDGET_NAME(hwdecWmv3), true },
+        { WIDGET_NAME(hwdecHevc), true },
+        { WIDGET_NAME(hwdecVp9), true },
+        { WIDGET_NAME(hwdecBackendAuto), true },
+        { WIDGET_NAME(hwdecBackendVaapi), false },
+        { WIDGET_NAME(hwdecBackendNvdec), false },
+        { WIDGET_NAME(hwdecBackendVdpau), false },
+        { WIDGET_NAME(hwdecBackendDxva2), false },
+        { WIDGET_NAME(hwdecBackendD3d11va), false },
+        { WIDGET_NAME(hwdecBackendCuda), false },
+        { WIDGET_NAME(hwdecBackendCrystalHd), false },
+        { WIDGET_NAME(playbackPlayTimes), true },
+        { WIDGET_NAME(playbackPlayAmount), 1 },
+        { WIDGET_NAME(playbackRepeatForever), false },
+        { WIDGET_NAME(playbackLoopImages), true },
+        { WIDGET_NAME(playlistFormat), QString("%artist{# - }{Unknown Artist - }{}%title{#}{$}{$}") },
+        { WIDGET_NAME(playlistNaturalSort), false },
+        { WIDGET_NAME(audioDevice), 0 },
+        { WIDGET_NAME(audioChannels), 0 },
+        { WIDGET_NAME(audioSpdifCodecs), QString() },
+        { WIDGET_NAME(audioStreamSilence), false },
+        { WIDGET_NAME(audioWaitTime), 0.0 },
+        { WIDGET_NAME(audioPitchCorrection), true },
+        { WIDGET_NAME(audioExclusiveMode), false },
+        { WIDGET_NAME(audioNormalizeDownmix), false },
+        { WIDGET_NAME(audioSpdif), false },
+        { WIDGET_NAME(pipewireBuffer), 20 },
+        { WIDGET_NAME(pulseBuffer), 250 },
+        { WIDGET_NAME(pulseLatency), false },
+        { WIDGET_NAME(alsaResample), false },
+        { WIDGET_NAME(alsaIgnoreChannelMap), false },
+        { WIDGET_NAME(ossMixerDevice), QString("/dev/mixer") },
+        { WIDGET_NAME(ossMixerChannel), QString("pcm") },
+        { WIDGET_NAME(jackName), QString("mpc-qt") },
+        { WIDGET_NAME(jackPort), QString() },
+        { WIDGET_NAME(jackConnect), true },
+        { WIDGET_NAME(jackAutostart), false },
+        { WIDGET_NAME(audioAutoloadExternal), true },
+        { WIDGET_NAME(audioAutoloadPath), QString() },
+        { WIDGET_NAME(audioAutoloadMatch), 0 },
+        { WIDGET_NAME(subtitlesOverridePlacement), false },
+        { WIDGET_NAME(subtitlePlacementX), 1 },
+        { WIDGET_NAME(subtitlePlacementY), 2 },
+        { WIDGET_NAME(subtitlesPosition), 100 },
+        { WIDGET_NAME(subtitlesUseMargins), true },
+        { WIDGET_NAME(subtitlesForceGrayscale), false },
+        { WIDGET_NAME(subtitlesDelayStep), 500 },
+        { WIDGET_NAME(subtitlesFixTiming), true },
+        { WIDGET_NAME(subtitlesClearOnSeek), false },
+        { WIDGET_NAME(subtitlesAssOverride), 0 },
+        { WIDGET_NAME(subsAssoverride), false },
+        { WIDGET_NAME(fontComboBox), defaultFont },
+        { WIDGET_NAME(fontBold), false },
+        { WIDGET_NAME(fontItalic), false },
+        { WIDGET_NAME(fontSize), 55 },
+        { WIDGET_NAME(borderSize), 3 },
+        { WIDGET_NAME(borderShadowOffset), 0 },
+        { WIDGET_NAME(subsAlignmentTopLeft), false },
+        { WIDGET_NAME(subsAlignmentTop), false },
+        { WIDGET_NAME(subsAlignmentTopRight), false },
+        { WIDGET_NAME(subsAlignmentLeft), false },
+        { WIDGET_NAME(subsAlignmentCenter), false },
+        { WIDGET_NAME(subsAlignmentRight), false },
+        { WIDGET_NAME(subsAlignmentBottomRight), false },
+        { WIDGET_NAME(subsAlignmentBottomLeft), false },
+        { WIDGET_NAME(subsAlignmentBottom), true },
+        { WIDGET_NAME(subsMarginX), 0 },
+        { WIDGET_NAME(subsMarginY), 0 },
+        { WIDGET_NAME(subsRelativeToVideoFrame), true },
+        { WIDGET_NAME(subsColorValue), QString("FFFF00") },
+        { WIDGET_NAME(subsBorderColorValue), QString("000000") },
+        { WIDGET_NAME(subsShadowColorValue), QString("000000") },
+        { WIDGET_NAME(subsBackcolorEnabled), false },
+        { WIDGET_NAME(subsBackcolorValue), QString("000000") },
+        { WIDGET_NAME(subtitlesPreferDefaultForced_v3), true },
+        { WIDGET_NAME(subtitlesPreferExternal), true },
+        { WIDGET_NAME(subtitlesIgnoreEmbedded), false },
+        { WIDGET_NAME(subtitlesAutoloadExternal), true },
+        { WIDGET_NAME(subtitlesAutoloadPath), QString() },
+        { WIDGET_NAME(subtitlesAutoloadMatch), 0 },
+        { WIDGET_NAME(subtitlesDatabaseLocation), 0 },
+        { WIDGET_NAME(screenshotDirectorySet), true },
+        { WIDGET_NAME(screenshotDirectoryValue), QString() },
+        { WIDGET_NAME(encodeDirectorySet), true },
+        { WIDGET_NAME(encodeDirectoryValue), QString() },
+        { WIDGET_NAME(screenshotTemplate), QString() },
+        { WIDGET_NAME(encodeTemplate), QString() },
+        { WIDGET_NAME(screenshotFormatHighBitDepth), true },
+        { WIDGET_NAME(screenshotFormat), 0 },
+        { WIDGET_NAME(jpgQuality), 90 },
+        { WIDGET_NAME(jpgSmooth), 0 },
+        { WIDGET_NAME(jpgSourceChroma), false },
+        { WIDGET_NAME(pngCompression), 7 },
+        { WIDGET_NAME(pngFilter), 5 },
+        { WIDGET_NAME(pngColorspace), false },
+        { WIDGET_NAME(encodeFormat), 0 },
+        { WIDGET_NAME(encodeVideoForget), false },
+        { WIDGET_NAME(encodeVideoHardsub), true },
+        { WIDGET_NAME(encodeVideoMethodFilesize), true },
+        { WIDGET_NAME(encodeVideoFilesize), 2.9 },
+        { WIDGET_NAME(encodeVideoMethodBitrate), false },
+        { WIDGET_NAME(encodeVideoBitrate), 500 },
+        { WIDGET_NAME(encodeVideoCrf), false },
+        { WIDGET_NAME(encodeVideoCrfValue), -1 },
+        { WIDGET_NAME(encodeVideoQMin), false },
+        { WIDGET_NAME(encodeVideoQMinValue), 2 },
+        { WIDGET_NAME(encodeVideoQMax), false },
+        { WIDGET_NAME(encodeVideoQMaxValue), 31 },
+        { WIDGET_NAME(encodeAudioForget), false },
+        { WIDGET_NAME(encodeAudioBitrate), 96 },
+        { WIDGET_NAME(tweaksFastSeek), true },
+        { WIDGET_NAME(tweaksSeekFramedrop), false },
+        { WIDGET_NAME(tweaksShowChapterMarks), true },
+        { WIDGET_NAME(tweaksOpenNextFile), true },
+        { WIDGET_NAME(tweaksVolumeLimit), true },
+        { WIDGET_NAME(tweaksTimeShort), true },
+        { WIDGET_NAME(tweaksPreferWayland), false },
+        { WIDGET_NAME(tweaksMpvMouseEvents), false },
+        { WIDGET_NAME(tweaksMpvKeyEvents), false },
+        { WIDGET_NAME(tweaksTimeTooltip), true },
+        { WIDGET_NAME(tweaksTimeTooltipLocation), 0 },
+        { WIDGET_NAME(tweaksOsdTimerOnSeek), false },
+        { WIDGET_NAME(tweaksOsdFontChkBox), false },
+        { WIDGET_NAME(tweaksOsdFont), defaultFont },
+        { WIDGET_NAME(tweaksOsdSize), 55 },
+        { WIDGET_NAME(tweaksSeekPreviews), true },
+        { WIDGET_NAME(tweaksKeyframeSnap), true },
+        { WIDGET_NAME(tweaksWaveform), false },
+        { WIDGET_NAME(loggingEnabled), false },
+        { WIDGET_NAME(debugClient), false },
+        { WIDGET_NAME(debugMpv), 3 },
+        { WIDGET_NAME(logFileCreate), false },
+        { WIDGET_NAME(logFilePathValue), QString() },
+        { WIDGET_NAME(logUpdateNoDelay), false },
+        { WIDGET_NAME(logUpdateDelayed), true },
+        { WIDGET_NAME(logUpdateInterval), 2000 },
+        { WIDGET_NAME(logHistoryUnlimited), false },
+        { WIDGET_NAME(logHistoryTrim), true },
+        { WIDGET_NAME(logHistoryLines), 1000 },
+        { WIDGET_NAME(miscBrightness), 0 },
+        { WIDGET_NAME(miscContrast), 0 },
+        { WIDGET_NAME(miscGamma), 0 },
+        { WIDGET_NAME(miscHue), 0 },
+        { WIDGET_NAME(miscSaturation), 0 },
+        { paletteEditorName, PaletteEditor::paletteToVariant(systemPalette) },
+        { screenComboName, QString() }
+    };
+}
+
+// Settings left empty fall back on their placeholder text.  The folders
+// depend on where the user's are, and the rest are translated as in the ui.
+static QVariantMap standardPlaceholders()
+{
+    QString pictures = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+    QString documents = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    return {
+        { WIDGET_NAME(interfaceIconsCustomFolder), SettingsWindow::tr("Folder (e.g. ~/Pictures/MyIcons/mpc-qt/leet)") },
+        { WIDGET_NAME(webRoot), SettingsWindow::tr("webroot") },
+        { WIDGET_NAME(webDefaultPage), SettingsWindow::tr("index.html") },
+        { WIDGET_NAME(playbackSubtitleTracks), "en,eng" },
+        { WIDGET_NAME(playbackAudioTracks), "jpn,eng" },
+        { WIDGET_NAME(playlistFormat), "%artist{# - }{Unknown Artist - }{}%title{#}{$}{$}" },
+        { WIDGET_NAME(audioSpdifCodecs), "truehd,eac3,dts-hd,dts,ac3" },
+        { WIDGET_NAME(audioAutoloadPath), ".;./audio" },
+        { WIDGET_NAME(subtitlesAutoloadPath), "./subtitles;./subs" },
+        { WIDGET_NAME(screenshotDirectoryValue), pictures + "/mpc_shots" },
+        { WIDGET_NAME(encodeDirectoryValue), pictures + "/mpc_encodes" },
+        { WIDGET_NAME(screenshotTemplate), "%f_snapshot_%wP_[%t{yyyy.MM.dd_hh.mm.ss}]%s{_subs}" },
+        { WIDGET_NAME(encodeTemplate), "%f_encode_%aP-%bP_[%t{yyyy.MM.dd_hh.mm.ss}]%s{_subs}%d{_novideo}{_noaudio}" },
+        { WIDGET_NAME(logFilePathValue), documents + "/mpc-qt-log.txt" }
+    };
+}
+
+SettingsModel::SettingsModel(QObject *parent) :
+    QObject(parent)
+{
+    // Taken before any custom palette replaces it.
+    systemPalette_ = qApp->palette();
+    defaults = standardDefaults(systemPalette_);
+    placeholders = standardPlaceholders();
+    settings_ = defaults;
+}
+
+QVariantMap SettingsModel::settings() const
+{
+    return settings_;
+}
+
+QVariantMap SettingsModel::keyMap() const
+{
+    return acceptedKeyMap;
+}
+
+QVariantMap SettingsModel::defaultKeyMap() const
+{
+    return defaultKeyMap_;
+}
+
+QList<Command> SettingsModel::commands() const
+{
+    return commands_;
+}
+
+QList<AudioDevice> SettingsModel::audioDevices() const
+{
+    return audioDevices_;
+}
+
+QString SettingsModel::placeholderText(const QString &name) const
+{
+    return placeholders.value(name).toString();
+}
+
+QPalette SettingsModel::systemPalette() const
+{
+    return systemPalette_;
+}
+
+int SettingsModel::maximumVolume() const
+{
+    return settings_.value(WIDGET_NAME(tweaksVolumeLimit)).toBool() ? 100 : 130;
+}
+
+QVariantMap SettingsModel::defaultSettings() const
+{
+    return defaults;
+}
+
+void SettingsModel::restoreColorControls()
+{
+    emit option("brightness", WIDGET_LOOKUP(miscBrightness).toInt());
+    emit option("contrast", WIDGET_LOOKUP(miscContrast).toInt());
+    emit option("gamma", WIDGET_LOOKUP(miscGamma).toInt());
+    emit option("hue", WIDGET_LOOKUP(miscHue).toInt());
+    emit option("saturation", WIDGET_LOOKUP(miscSaturation).toInt());
+}
+
+void SettingsModel::restoreAudioSettings()
+{
+    emit audioFilter("stereotools=balance_out=" +
+        QString().number(WIDGET_LOOKUP(playbackBalance).toDouble()/100), true);
+}
+
+QVariantMap SettingsModel::commandsToVMap() const
+{
+    QVariantMap map;
+    for (const Command &c : commands_)
+        map[c.action->objectName()] = c.toVMap();
+    return map;
+}
+
+void SettingsModel::commandsFromVMap(const QVariantMap &map)
+{
+    QMap<QString, int> nameToIndex;
+    for (int i = 0; i < commands_.count(); i++)
+        nameToIndex[commands_[i].action->objectName()] = i;
+    for (auto it = map.cbegin(); it != map.cend(); it++) {
+        int index = nameToIndex.value(it.key(), -1);
+        if (index >= 0)
+            commands_[index].fromVMap(it.value().toMap());
+    }
+}
+
+void SettingsModel::updateActions()
+{
+    MouseStateMap fullscreen, windowed;
+    for (const Command &c : std::as_const(commands_)) {
+        c.action->setShortcut(c.keys);
+        if (!!c.mouseFullscreen)
+            fullscreen[c.mouseFullscreen] = c.action;
+        if (!!c.mouseWindowed)
+            windowed[c.mouseWindowed] = c.action;
+    }
+    emit mouseFullscreenMap(fullscreen);
+    emit mouseWindowedMap(windowed);
+}
+
+QString SettingsModel::selectedLogo()
+{
+    return WIDGET_LOOKUP(logoExternal).toBool()
+                                ? WIDGET_LOOKUP(logoExternalLocation).toString()
+                                : internalLogos.value(WIDGET_LOOKUP(logoInternal).toInt());
+}
+
+QString SettingsModel::channelSwitcher()
+{
+    //FIXME: stub
+    return "2.0";
+}
+
+void SettingsModel::takeActions(const QList<QAction *> actions)
+{
+    commands_.clear();
+    for (QAction *a : actions) {
+        Command c;
+        c.fromAction(a);
+        commands_.append(c);
+    }
+    defaultKeyMap_ = commandsToVMap();
+}
+
+void SettingsModel::takeSettings(const QVariantMap &payload)
+{
+    // Only take settings that are already there.  (Don't accept nonsense.)
+    for (auto it = payload.cbegin(); it != payload.cend(); it++)
+        if (defaults.contains(it.key()))
+            settings_.insert(it.key(), it.value());
+}
+
+void SettingsModel::takeKeyMap(const QVariantMap &payload)
+{
+    commandsFromVMap(payload);
+    updateActions();
+    acceptedKeyMap = commandsToVMap();
+}
+
+void SettingsModel::setMouseMapDefaults(const QVariantMap &payload)
+{
+    commandsFromVMap(payload);
+    defaultKeyMap_ = commandsToVMap();
+}
+
+void SettingsModel::setAudioDevices(const QList<AudioDevice> &devices)
+{
+    audioDevices_ = devices;
+}
+
+void SettingsModel::sendSignals()
+{
+    auto widgetToPrefixHelper = [this](QString wprefix, QString wsuffix)
+    {
+        auto offsetLookup = [](const QVariantMap &source, QString objectName) {
+            return source.value(objectName).toInt();
+        };
+        QString objectName = wprefix + wsuffix;
+        return SettingMap::indexedValueToText[objectName].value(offsetLookup(settings_,objectName),
+            SettingMap::indexedValueToText[objectName].value(offsetLookup(defaults,objectName)));
+    };
+#define WIDGET_TO_TEXT_PREFIX(wp,w) widgetToPrefixHelper(wp,WIDGET_NAME(w))
+
+    // This function is usually ordered by the order they appear in the ui.
+    // However some times this is not the case: logging for example should
+    // be turned on early.
+
+    bool loggingIsEnabled = WIDGET_LOOKUP(loggingEnabled).toBool();
+    emit loggingEnabled(loggingIsEnabled);
+    if (loggingIsEnabled) {
+        emit logFilePath(WIDGET_LOOKUP(logFileCreate).toBool()
+                         ? WIDGET_PLACEHOLD_LOOKUP(logFilePathValue)
+                         : QString());
+        emit clientDebuggingMessages(WIDGET_LOOKUP(debugClient).toBool());
+        emit mpvLogLevel(WIDGET_TO_TEXT(debugMpv));
+        emit logDelay(WIDGET_LOOKUP(logUpdateDelayed).toBool() ?
+                    WIDGET_LOOKUP(logUpdateInterval).toInt() : -1);
+        emit logHistory(WIDGET_LOOKUP(logHistoryTrim).toBool() ?
+                        WIDGET_LOOKUP(logHistoryLines).toInt() : 0);
+    }
+
+    emit trayIcon(WIDGET_LOOKUP(playerTrayIcon).toBool());
+    emit showOsd(WIDGET_LOOKUP(playerOSD).toBool());
+    emit limitProportions(WIDGET_LOOKUP(playerLimitProportions).toBool());
+    emit disableOpenDiscMenu(WIDGET_LOOKUP(playerDisableOpenDisc).toBool());
+    emit inhibitScreensaver(WIDGET_LOOKUP(playerDisableScreensaver).toBool());
+    emit titleBarFormat(WIDGET_LOOKUP(playerTitleDisplayFullPath).toBool() ? Helpers::PrefixFullPath
+                        : WIDGET_LOOKUP(playerTitleFileNameOnly).toBool() ? Helpers::PrefixFileName : Helpers::NoPrefix);
+    emit titleUseMediaTitle(WIDGET_LOOKUP(playerTitleReplaceName).toBool());
+    emit rememberHistory(WIDGET_LOOKUP(playerKeepHistory).toBool(),
+                         WIDGET_LOOKUP(playerKeepHistoryOnlyForVideos).toBool());
+    emit rememberFilePosition(WIDGET_LOOKUP(playerRememberFilePosition).toBool());
+    emit rememberSelectedPlaylist(WIDGET_LOOKUP(playerRememberLastPlaylist).toBool());
+    emit rememberWindowGeometry(WIDGET_LOOKUP(playerRememberWindowGeometry).toBool());
+    emit rememberPanels(WIDGET_LOOKUP(playerRememberPanels).toBool());
+    emit rememberPanNScan(WIDGET_LOOKUP(playerRememberPanScanZoom).toBool());
+
+    emit mprisIpc(WIDGET_LOOKUP(ipcMpris).toBool());
+
+    emit logoSource(selectedLogo());
+    emit iconTheme(static_cast<IconThemer::FolderMode>(WIDGET_LOOKUP(interfaceIconsTheme).toInt()),
+                   WIDGET_TO_TEXT(interfaceIconsInbuilt),
+                   WIDGET_LOOKUP(interfaceIconsCustomFolder).toString());
+    emit highContrastWidgets(WIDGET_LOOKUP(interfaceWidgetHighContast).toBool());
+    emit applicationPalette(WIDGET_LOOKUP(interfaceWidgetCustom).toBool()
+                            ? PaletteEditor::variantToPalette(settings_.value(paletteEditorName), systemPalette_)
+                            : systemPalette_);
+    emit videoColor(QString("#%1").arg(WIDGET_LOOKUP(windowVideoValue).toString()));
+    emit option("background-color", QString("#%1").arg(WIDGET_LOOKUP(windowVideoValue).toString()));
+    emit infoStatsColors(QString("#%1").arg(WIDGET_LOOKUP(windowInfoForegroundValue).toString()),
+                         QString("#%1").arg(WIDGET_LOOKUP(windowInfoBackgroundValue).toString()));
+
+    emit stylesheetIsFusion(WIDGET_LOOKUP(stylesheetFusion).toBool());
+    emit stylesheetText(WIDGET_LOOKUP(stylesheetText).toString());
+
+    emit webserverListening(WIDGET_LOOKUP(webEnableServer).toBool());
+    emit webserverPort(WIDGET_LOOKUP(webPort).toInt());
+    emit webserverLocalhost(WIDGET_LOOKUP(webLocalhost_v2).toBool());
+    emit webserverServePages(WIDGET_LOOKUP(webServePages).toBool());
+    emit webserverRoot(WIDGET_PLACEHOLD_LOOKUP(webRoot));
+    emit webserverDefaultPage(WIDGET_PLACEHOLD_LOOKUP(webDefaultPage));
+
+    int vol = WIDGET_LOOKUP(playbackVolume).toInt();
+    int volmax = maximumVolume();
+    emit volumeMax(volmax);
+    emit volume(std::min(vol, volmax), true);
+    emit volumeStep(WIDGET_LOOKUP(playbackVolumeStep).toInt());
+    {
+        int i = WIDGET_LOOKUP(playbackSpeedStep).toInt();
+        emit speedStep(i > 0 ? 1.0 + i/100.0 : 2.0);
+        emit speedStepAdditive(WIDGET_LOOKUP(playbackSpeedStepAdditive).toBool());
+    }
+    emit audioFilter("stereotools=balance_out=" +
+        QString().number(WIDGET_LOOKUP(playbackBalance).toDouble()/100), true);
+    emit stepTimeNormal(WIDGET_LOOKUP(playbackNormalStep).toInt());
+    emit stepTimeLarge(WIDGET_LOOKUP(playbackLargeStep).toInt());
+
+    emit playbackPlayTimes(WIDGET_LOOKUP(playbackPlayAmount).toInt());
+    emit playbackForever(WIDGET_LOOKUP(playbackRepeatForever).toBool());
+    emit option("image-display-duration", WIDGET_LOOKUP(playbackLoopImages).toBool() ? QVariant("inf") : QVariant(1.0));
+
+    emit afterPlaybackDefault(Helpers::AfterPlayback(WIDGET_LOOKUP(afterPlaybackDefault).toInt()));
+
+    emit zoomCenter(WIDGET_LOOKUP(playbackAutoCenterWindow).toBool());
+    double factor = WIDGET_LOOKUP(playbackAutoFitFactor).toInt() / 100.0;
+    if (!WIDGET_LOOKUP(playbackAutoZoom).toBool())
+        emit zoomPreset(-1, factor);
+    else {
+        int preset = WIDGET_LOOKUP(playbackAutoZoomMethod).toInt();
+        int count = autoZoomMethodCount;
+        if (preset >= count - 3)
+            emit zoomPreset(preset - count - 1, factor);
+        else
+            emit zoomPreset(preset, factor);
+    }
+
+    emit mouseHideTimeFullscreen(WIDGET_LOOKUP(playbackMouseHideFullscreen).toBool()
+                                 ? WIDGET_LOOKUP(playbackMouseHideFullscreenDuration).toInt()
+                                 : 0);
+    emit mouseHideTimeWindowed(WIDGET_LOOKUP(playbackMouseHideWindowed).toBool()
+                               ? WIDGET_LOOKUP(playbackMouseHideWindowedDuration).toInt()
+                               : 0);
+
+    emit trackSubtitlePreference(WIDGET_PLACEHOLD_LOOKUP(playbackSubtitleTracks));
+    emit trackAudioPreference(WIDGET_PLACEHOLD_LOOKUP(playbackAudioTracks));
+
+    emit option("keep-open", true);
+    emit option("video-sync", WIDGET_TO_TEXT(syncMode));
+    emit option("gpu-dumb-mode", WIDGET_LOOKUP(videoDumbMode));
+    emit option("fbo-format", WIDGET_TO_TEXT(videoFramebuffer).split('-').value(WIDGET_LOOKUP(videoUseAlpha).toBool()));
+    emit option("alpha", WIDGET_TO_TEXT(videoAlphaMode));
+    emit option("sharpen", WIDGET_LOOKUP(videoSharpen).toString());
+
+    if (WIDGET_LOOKUP(ditherDithering).toBool()) {
+        emit option("dither-depth", WIDGET_LOOKUP(ditherDepth).toString());
+        emit option("dither", WIDGET_TO_TEXT(ditherType));
+        emit option("dither-size-fruit", WIDGET_LOOKUP(ditherFruitSize).toString());
+    } else {
+        emit option("dither", "no");
+    }
+    emit option("temporal-dither", WIDGET_LOOKUP(ditherTemporal));
+    emit option("temporal-dither-period", WIDGET_LOOKUP2(ditherTemporal, ditherTemporalPeriod, 1));
+    emit option("correct-downscaling", WIDGET_LOOKUP(scalingCorrectDownscaling));
+    emit option("linear-downscaling", WIDGET_LOOKUP(scalingInLinearLight));
+    emit option("linear-upscaling", WIDGET_LOOKUP(scalingUpInLinearLight));
+    emit option("interpolation", WIDGET_LOOKUP(scalingTemporalInterpolation));
+    emit option("blend-subtitles", WIDGET_LOOKUP(scalingBlendSubtitles));
+    if (WIDGET_LOOKUP(scalingSigmoidizedUpscaling).toBool()) {
+        emit option("sigmoid-upscaling", true);
+        emit option("sigmoid-center", WIDGET_LOOKUP(sigmoidizedCenter));
+        emit option("sigmoid-slope", WIDGET_LOOKUP(sigmoidizedSlope));
+    } else {
+        emit option("sigmoid-upscaling", false);
+    }
+
+    QString scaler;
+    FilterKernel filter;
+    auto fetchFilter = [&](QString prefix, bool temporal = false) {
+        scaler = WIDGET_TO_TEXT_PREFIX(prefix, scaleScaler);
+        filter = filterKernels.value(scaler);
+        filter.cutoff_(temporal ? 0.0 : 0.01);
+        filter.clamp_(temporal ? 1.0 : 0.0);
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleParam1Set).toBool())    filter.param1_(WIDGET_LOOKUP_PREFIX(prefix, scaleParam1Value).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleParam2Set).toBool())    filter.param2_(WIDGET_LOOKUP_PREFIX(prefix, scaleParam2Value).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleRadiusSet).toBool())    filter.radius_(WIDGET_LOOKUP_PREFIX(prefix, scaleRadiusValue).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleAntiRingSet).toBool())  filter.antiring_(WIDGET_LOOKUP_PREFIX(prefix, scaleAntiRingValue).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleBlurSet).toBool())      filter.blur_(WIDGET_LOOKUP_PREFIX(prefix, scaleBlurValue).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleWindowSet).toBool())    filter.window_(WIDGET_TO_TEXT_PREFIX(prefix, scaleWindowValue));
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleWindowParamSet).toBool())   filter.window.param_(WIDGET_LOOKUP_PREFIX(prefix, scaleWindowValue).toDouble());
+        if (WIDGET_LOOKUP_PREFIX(prefix, scaleClampSet).toBool())     filter.clamp_(WIDGET_TO_TEXT_PREFIX(prefix, scaleClampValue).toDouble());
+    };
+    auto applyFilter = [&](QString prefix) {
+        emit option(prefix + "scale", scaler);
+        emit option(prefix + "scale-param1", filter.params[0]);
+        emit option(prefix + "scale-param2", filter.params[1]);
+        emit option(prefix + "scale-radius", filter.radius);
+        emit option(prefix + "scale-antiring", filter.antiring);
+        emit option(prefix + "scale-blur", filter.blur);
+        emit option(prefix + "scale-window", filter.windowName);
+        emit option(prefix + "scale-wparam", filter.window.params[0]);
+        emit option(prefix + "scale-clamp", filter.clamp);
+    };
+
+    fetchFilter("");
+    applyFilter("");
+
+    if (OFFSET_LOOKUP(settings_, dscaleScaler) != 0)
+        fetchFilter("d");
+    applyFilter("d");
+
+    fetchFilter("c");
+    applyFilter("c");
+
+    fetchFilter("t", true);
+    applyFilter("t");
+
+    if (WIDGET_LOOKUP(debandEnabled).toBool()) {
+        emit option("deband", true);
+        emit option("deband-iterations", WIDGET_LOOKUP(debandIterations));
+        emit option("deband-threshold", WIDGET_LOOKUP(debandThreshold));
+        emit option("deband-range", WIDGET_LOOKUP(debandRange));
+        emit option("deband-grain", WIDGET_LOOKUP(debandGrain));
+    } else {
+        emit option("deband", false);
+    }
+
+    emit option("gamut-mapping-mode", WIDGET_TO_TEXT(ccGamutMapping));
+    emit option("target-gamut", WIDGET_TO_TEXT(ccTargetGamut));
+    emit option("target-prim", WIDGET_TO_TEXT(ccTargetPrim));
+    emit option("target-trc", WIDGET_TO_TEXT(ccTargetTrc_v2));
+    int targetPeak = WIDGET_LOOKUP(ccTargetPeak).toInt();
+    emit option("target-peak", targetPeak >= 10 ? QString::number(targetPeak) : QString("auto"));
+    emit option("tone-mapping", WIDGET_TO_TEXT(ccHdrMapper));
+    {
+        QStringList boxen {WIDGET_NAME(ccHdrClipParam),
+                    WIDGET_NAME(ccHdrMobiusParam), WIDGET_NAME(ccHdrReinhardParam), QString(),
+                    WIDGET_NAME(ccHdrGammaParam), WIDGET_NAME(ccHdrLinearParam)};
+        QString toneParam = boxen.value(WIDGET_LOOKUP(ccHdrMapper).toInt());
+        emit option("tone-mapping-param", !toneParam.isEmpty() ? settings_.value(toneParam) : QVariant(NAN));
+    }
+    emit option("hdr-compute-peak", WIDGET_TO_TEXT(ccHdrCompute));
+    if (WIDGET_LOOKUP(ccICCAutodetect).toBool()) {
+        emit option("icc-profile", "");
+        emit option("icc-profile-auto", true);
+    } else {
+        emit option("icc-profile-auto", false);
+        emit option("icc-profile", WIDGET_LOOKUP(ccICCLocation));
+    }
+    // FIXME: add icc-intent etc
+
+    emit option("glsl-shaders", WIDGET_LOOKUP(shadersActiveList).toStringList());
+
+    emit fullscreenScreen(settings_.value(screenComboName).toString());
+    emit fullscreenAtLaunch(WIDGET_LOOKUP(fullscreenLaunch).toBool());
+    emit fullscreenExitAtEnd(WIDGET_LOOKUP(fullscreenWindowedAtEnd).toBool());
+    emit fullscreenHideControls(WIDGET_LOOKUP(fullscreenHideControls).toBool(), \
+        WIDGET_LOOKUP(fullscreenShowWhen).toInt(), WIDGET_LOOKUP(fullscreenShowWhenDuration).toInt());
+    emit hidePanels(WIDGET_LOOKUP(fullscreenHidePanels).toBool());
+    emit option("framedrop", WIDGET_TO_TEXT(framedroppingMode));
+    emit option("vf-lavc-framedrop", WIDGET_TO_TEXT(framedroppingDecoderMode));
+    emit option("video-sync-adrop-size", WIDGET_LOOKUP(syncAudioDropSize).toDouble());
+    emit option("video-sync-max-audio-change", WIDGET_LOOKUP(syncMaxAudioChange).toDouble());
+    emit option("video-sync-max-video-change", WIDGET_LOOKUP(syncMaxVideoChange).toDouble());
+    if (WIDGET_LOOKUP(hwdecEnable).toBool()) {
+        QString backend = "auto";
+        if (WIDGET_LOOKUP(hwdecBackendVaapi).toBool())
+            backend = "vaapi,vaapi-copy";
+        if (WIDGET_LOOKUP(hwdecBackendNvdec).toBool())
+            backend = "nvdec,nvdec-copy";
+        if (WIDGET_LOOKUP(hwdecBackendVdpau).toBool())
+            backend = "vdpau,vdpau-copy";
+        if (WIDGET_LOOKUP(hwdecBackendDxva2).toBool())
+            backend = "dxva2,dxva2-copy";
+        if (WIDGET_LOOKUP(hwdecBackendD3d11va).toBool())
+            backend = "d3d11va,d3d11va-copy";
+        if (WIDGET_LOOKUP(hwdecBackendCuda).toBool())
+            backend = "cuda,cuda-copy";
+        if (WIDGET_LOOKUP(hwdecBackendCrystalHd).toBool())
+            backend = "crystalhd";
+        emit option("hwdec", backend);
+        if (WIDGET_LOOKUP(hwdecAll).toBool()) {
+            emit option("hwdec-codecs", "all");
+        } else {
+            QStringList codecs;
+            if (WIDGET_LOOKUP(hwdecMJpeg).toBool()) codecs << "mjpeg";
+            if (WIDGET_LOOKUP(hwdecMpeg1Video).toBool()) codecs << "mpeg1video";
+            if (WIDGET_LOOKUP(hwdecMpeg2Video).toBool()) codecs << "mpeg2video";
+            if (WIDGET_LOOKUP(hwdecMpeg4).toBool()) codecs << "mpeg4";
+            if (WIDGET_LOOKUP(hwdecH263).toBool()) codecs << "h263";
+            if (WIDGET_LOOKUP(hwdecH264).toBool()) codecs << "h264";
+            if (WIDGET_LOOKUP(hwdecVc1).toBool()) codecs << "vc1";
+            if (WIDGET_LOOKUP(hwdecWmv3).toBool()) codecs << "wmv3";
+            if (WIDGET_LOOKUP(hwdecHevc).toBool()) codecs << "hevc";
+            if (WIDGET_LOOKUP(hwdecVp9).toBool()) codecs << "vp9";
+            emit option("hwdec-codecs", codecs.join(','));
+        }
+    } else {
+        emit option("hwdec", "no");
+        emit option("hwdec-codecs", "");
+    }
+
+    emit playlistFormat(WIDGET_PLACEHOLD_LOOKUP(playlistFormat));
+    emit playlistNaturalSort(WIDGET_LOOKUP(playlistNaturalSort).toBool());
+
+    int index = WIDGET_LOOKUP(audioDevice).toInt();
+    emit option("audio-device", audioDevices_.value(index).deviceName());
+    index = WIDGET_LOOKUP(audioChannels).toInt();
+    emit option("audio-channels", index < 3 ? SettingMap::indexedValueToText[WIDGET_NAME(audioChannels)][index]
+                                         : channelSwitcher());
+    bool flag = WIDGET_LOOKUP(audioStreamSilence).toBool();
+    emit option("stream-silence", flag);
+    emit option("audio-wait-open", flag ? WIDGET_LOOKUP(audioWaitTime).toDouble() : 0.0);
+    emit option("audio-pitch-correction", WIDGET_LOOKUP(audioPitchCorrection).toBool());
+    emit option("audio-exclusive", WIDGET_LOOKUP(audioExclusiveMode).toBool());
+    emit option("audio-normalize-downmix", WIDGET_LOOKUP(audioNormalizeDownmix).toBool());
+    emit option("audio-spdif", WIDGET_LOOKUP(audioSpdif).toBool() ? WIDGET_PLACEHOLD_LOOKUP(audioSpdifCodecs) : "");
+    emit option("pipewire-buffer", WIDGET_LOOKUP(pipewireBuffer).toInt());
+    emit option("pulse-buffer", WIDGET_LOOKUP(pulseBuffer).toInt());
+    emit option("pulse-latency-hacks", WIDGET_LOOKUP(pulseLatency).toBool());
+    emit option("alsa-resample", WIDGET_LOOKUP(alsaResample).toBool());
+    emit option("alsa-ignore-chmap", WIDGET_LOOKUP(alsaIgnoreChannelMap).toBool());
+    emit option("oss-mixer-channel", WIDGET_LOOKUP(ossMixerChannel).toString());
+    emit option("oss-mixer-device", WIDGET_LOOKUP(ossMixerDevice).toString());
+    emit option("jack-autostart", WIDGET_LOOKUP(jackAutostart).toBool());
+    emit option("jack-connect", WIDGET_LOOKUP(jackConnect).toBool());
+    emit option("jack-name", WIDGET_LOOKUP(jackName).toString());
+    emit option("jack-port", WIDGET_LOOKUP(jackPort).toString());
+    bool audioAutoload = WIDGET_LOOKUP(audioAutoloadExternal).toBool();
+    emit option("audio-file-auto", audioAutoload ? WIDGET_TO_TEXT(audioAutoloadMatch) : "no");
+    emit option("audio-file-paths", WIDGET_PLACEHOLD_LOOKUP(audioAutoloadPath).split(';'));
+
+    emit option("sub-gray", WIDGET_LOOKUP(subtitlesForceGrayscale).toBool());
+    emit option("sub-font", WIDGET_LOOKUP(fontComboBox).toString());
+    emit option("sub-bold", WIDGET_LOOKUP(fontBold).toBool());
+    emit option("sub-italic", WIDGET_LOOKUP(fontItalic).toBool());
+    emit option("sub-font-size", WIDGET_LOOKUP(fontSize).toInt());
+    emit option("sub-border-size", WIDGET_LOOKUP(borderSize).toInt());
+    emit option("sub-shadow-offset", WIDGET_LOOKUP(borderShadowOffset).toInt());
+    emit subtitlesDelayStep(WIDGET_LOOKUP(subtitlesDelayStep).toInt());
+    {
+        struct AlignData { QString name; int x; int y; };
+        QVector<AlignData> alignments {
+            { WIDGET_NAME(subsAlignmentTopLeft), -1, -1 },
+            { WIDGET_NAME(subsAlignmentTop), 0, -1 },
+            { WIDGET_NAME(subsAlignmentTopRight), 1, -1 },
+            { WIDGET_NAME(subsAlignmentLeft), -1, 0 },
+            { WIDGET_NAME(subsAlignmentCenter), 0, 0 },
+            { WIDGET_NAME(subsAlignmentRight), 1, 0 },
+            { WIDGET_NAME(subsAlignmentBottomLeft), -1, 1 },
+            { WIDGET_NAME(subsAlignmentBottom), 0, 1 },
+            { WIDGET_NAME(subsAlignmentBottomRight), 1, 1 }
+        };
+        static QMap<int, const char *> wx {
+            { -1, "left" },
+            { 0, "center" },
+            { 1, "right" }
+        };
+        static QMap<int, const char *> wy {
+            { -1, "top" },
+            { 0, "center" },
+            { 1, "bottom" }
+        };
+        for (const AlignData &a : alignments) {
+            if (settings_.value(a.name).toBool()) {
+                emit option("sub-align-x", wx[a.x]);
+                emit option("sub-align-y", wy[a.y]);
+                break;
+            }
+        }
+    }
+    emit option("sub-ass", !WIDGET_LOOKUP(subsAssoverride).toBool());
+    emit option("sub-margin-x", WIDGET_LOOKUP(subsMarginX).toInt());
+    emit option("sub-margin-y", WIDGET_LOOKUP(subsMarginY).toInt());
+    emit option("sub-use-margins", !WIDGET_LOOKUP(subsRelativeToVideoFrame).toBool());
+    emit option("sub-color", QString("#%1").arg(WIDGET_LOOKUP(subsColorValue).toString()));
+    emit option("sub-border-color", QString("#%1").arg(WIDGET_LOOKUP(subsBorderColorValue).toString()));
+    emit option("sub-shadow-color", QString("#%1").arg(WIDGET_LOOKUP(subsShadowColorValue).toString()));
+    if (WIDGET_LOOKUP(subsBackcolorEnabled).toBool())
+        emit option("sub-back-color", QString("#%1").arg(WIDGET_LOOKUP(subsBackcolorValue).toString()));
+    else
+        emit option("sub-back-color", "#00000000");
+
+    emit subsPreferDefaultForced(WIDGET_LOOKUP(subtitlesPreferDefaultForced_v3).toBool());
+    emit subsPreferExternal(WIDGET_LOOKUP(subtitlesPreferExternal).toBool());
+    emit subsIgnoreEmbeded(WIDGET_LOOKUP(subtitlesIgnoreEmbedded).toBool());
+    bool subsAutoload = WIDGET_LOOKUP(subtitlesAutoloadExternal).toBool();
+    emit option("sub-auto", subsAutoload ? WIDGET_TO_TEXT(subtitlesAutoloadMatch) : QString("no"));
+    emit option("sub-file-paths", WIDGET_PLACEHOLD_LOOKUP(subtitlesAutoloadPath).split(';'));
+
+    emit screenshotDirectory(
+                WIDGET_LOOKUP(screenshotDirectorySet).toBool() ?
+                QFileInfo(WIDGET_PLACEHOLD_LOOKUP(screenshotDirectoryValue)).absoluteFilePath() : QString());
+
+    emit encodeDirectory(
+                WIDGET_LOOKUP(encodeDirectorySet).toBool() ?
+                QFileInfo(WIDGET_PLACEHOLD_LOOKUP(encodeDirectoryValue)).absoluteFilePath() : QString());
+    emit screenshotTemplate(WIDGET_PLACEHOLD_LOOKUP(screenshotTemplate));
+    emit encodeTemplate(WIDGET_PLACEHOLD_LOOKUP(encodeTemplate));
+    emit option("screenshot-high-bit-depth", WIDGET_LOOKUP(screenshotFormatHighBitDepth));
+    emit screenshotFormat(WIDGET_TO_TEXT(screenshotFormat));
+    emit option("screenshot-format", WIDGET_TO_TEXT(screenshotFormat));
+    emit option("screenshot-jpeg-quality", WIDGET_LOOKUP(jpgQuality).toInt());
+    emit option("screenshot-jpeg-smooth", WIDGET_LOOKUP(jpgSmooth).toInt());
+    emit option("screenshot-jpeg-source-chroma", WIDGET_LOOKUP(jpgSourceChroma).toBool());
+    emit option("screenshot-png-compression", WIDGET_LOOKUP(pngCompression).toInt());
+    emit option("screenshot-png-filter", WIDGET_LOOKUP(pngFilter).toInt());
+    emit option("screenshot-tag-colorspace", WIDGET_LOOKUP(pngColorspace).toBool());
+
+    emit option("hr-seek", WIDGET_LOOKUP(tweaksFastSeek).toBool() ? "absolute" : "yes");
+    emit option("hr-seek-framedrop", WIDGET_LOOKUP(tweaksSeekFramedrop).toBool());
+    emit fallbackToFolder(WIDGET_LOOKUP(tweaksOpenNextFile).toBool());
+    emit mpvMouseEvents(WIDGET_LOOKUP(tweaksMpvMouseEvents).toBool());
+    emit mpvKeyEvents(WIDGET_LOOKUP(tweaksMpvKeyEvents).toBool());
+    emit timeShorten(WIDGET_LOOKUP(tweaksTimeShort).toBool());
+    emit timeTooltip(WIDGET_LOOKUP(tweaksTimeTooltip).toBool(),
+                     WIDGET_LOOKUP(tweaksTimeTooltipLocation).toInt() == 0);
+    emit seekPreviews(WIDGET_LOOKUP(tweaksSeekPreviews).toBool());
+    emit keyframeSnapping(WIDGET_LOOKUP(tweaksKeyframeSnap).toBool());
+    emit waveform(WIDGET_LOOKUP(tweaksWaveform).toBool());
+    emit osdTimerOnSeek(WIDGET_LOOKUP(tweaksOsdTimerOnSeek).toBool());
+    emit option("osd-font", WIDGET_LOOKUP(tweaksOsdFontChkBox).toBool() ? WIDGET_LOOKUP(tweaksOsdFont).toString() : "");
+    emit option("osd-font-size", WIDGET_LOOKUP(tweaksOsdFontChkBox).toBool() ? WIDGET_LOOKUP(tweaksOsdSize).toInt() : 55);
+    emit option("brightness", WIDGET_LOOKUP(miscBrightness).toInt());
+    emit option("contrast", WIDGET_LOOKUP(miscContrast).toInt());
+    emit option("gamma", WIDGET_LOOKUP(miscGamma).toInt());
+    emit option("hue", WIDGET_LOOKUP(miscHue).toInt());
+    emit option("saturation", WIDGET_LOOKUP(miscSaturation).toInt());
+}
+
+void SettingsModel::sendAcceptedSettings()
+{
+    emit settingsData(settings_);
+    emit keyMapData(acceptedKeyMap);
+}
+
+void SettingsModel::setVolume(int level)
+{
+    WIDGET_LOOKUP(playbackVolume).setValue(level);
+}
+
+void SettingsModel::setZoomPreset(int which)
+{
+    bool autoZoom = which != -1;
+    int zoomMethod = which >= 0 ? which :
+                     which == -1 ? 1
+                                 : which + autoZoomMethodCount + 1;
+
+    WIDGET_LOOKUP(playbackAutoZoom).setValue(autoZoom);
+    WIDGET_LOOKUP(playbackAutoZoomMethod).setValue(zoomMethod);
+    emit settingsChanged({ { WIDGET_NAME(playbackAutoZoom), autoZoom },
+                           { WIDGET_NAME(playbackAutoZoomMethod), zoomMethod } });
+    emit settingsData(settings_);
+}
+
+void SettingsModel::setHidePanels(bool hidden)
+{
+    WIDGET_LOOKUP(fullscreenHidePanels).setValue(hidden);
+    emit settingsChanged({ { WIDGET_NAME(fullscreenHidePanels), hidden } });
+    emit settingsData(settings_);
+}
+
+
+
+SettingsWindow::SettingsWindow(SettingsModel *model, QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::SettingsWindow)
+    ui(new Ui::SettingsWindow),
+    model(model)
 {
     Logger::log("settings", "creating ui");
     ui->setupUi(this);
@@ -314,9 +1313,10 @@ SettingsWindow::SettingsWindow(QWidget *parent) :
     actionEditor = new ActionEditor(this);
     ui->keysHost->addWidget(actionEditor);
     connect(actionEditor, &ActionEditor::mouseWindowedMap,
-            this, &SettingsWindow::mouseWindowedMap);
+            model, &SettingsModel::mouseWindowedMap);
     connect(actionEditor, &ActionEditor::mouseFullscreenMap,
-            this, &SettingsWindow::mouseFullscreenMap);
+            model, &SettingsModel::mouseFullscreenMap);
+    actionEditor->setCommands(model->commands());
 
     actionEditor->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
     actionEditor->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
@@ -332,9 +1332,16 @@ SettingsWindow::SettingsWindow(QWidget *parent) :
     Logger::log("settings", "setting up fullscreen combo");
     setupFullscreenCombo();
 
+    ui->screenshotDirectoryValue->setPlaceholderText(
+                model->placeholderText(ui->screenshotDirectoryValue->objectName()));
+    ui->encodeDirectoryValue->setPlaceholderText(
+                model->placeholderText(ui->encodeDirectoryValue->objectName()));
+    ui->logFilePathValue->setPlaceholderText(
+                model->placeholderText(ui->logFilePathValue->objectName()));
+
     Logger::log("settings", "generating settings map");
     defaultSettings = generateSettingMap(this);
-    acceptedSettings = defaultSettings;
+    checkDefaults();
     generateVideoPresets();
     Logger::log("settings", "finished generating settings");
 
@@ -344,15 +1351,8 @@ SettingsWindow::SettingsWindow(QWidget *parent) :
     ui->audioTabs->setCurrentIndex(0);
     ui->hwdecTabs->setCurrentIndex(0);
 
-    ui->screenshotDirectoryValue->setPlaceholderText(
-                QStandardPaths::writableLocation(
-                    QStandardPaths::PicturesLocation) + "/mpc_shots");
-    ui->encodeDirectoryValue->setPlaceholderText(
-                QStandardPaths::writableLocation(
-                    QStandardPaths::PicturesLocation) + "/mpc_encodes");
-    ui->logFilePathValue->setPlaceholderText(
-                QStandardPaths::writableLocation(
-                    QStandardPaths::DocumentsLocation) + "/mpc-qt-log.txt");
+    setAudioDevices(model->audioDevices());
+    self_volumeMax(model->maximumVolume());
 
     setupPageTree();
     setupColorPickers();
@@ -365,11 +1365,6 @@ SettingsWindow::~SettingsWindow()
     delete ui;
 }
 
-QVariantMap SettingsWindow::settings()
-{
-    return acceptedSettings.toVMap();
-}
-
 void SettingsWindow::disableWindowManagment()
 {
     // Wayland breaks applications
@@ -429,7 +1424,9 @@ void SettingsWindow::setupPlatformWidgets()
 void SettingsWindow::setupPaletteEditor()
 {
     paletteEditor = new PaletteEditor(this);
-    paletteEditor->setObjectName("interfaceWidgetCustomPalette");
+    paletteEditor->setObjectName(paletteEditorName);
+    paletteEditor->setSystemPalette(model->systemPalette());
+    paletteEditor->resetPalette();
     ui->interfaceWidgetCustomHost->layout()->addWidget(paletteEditor);
 }
 
@@ -453,14 +1450,16 @@ void SettingsWindow::setupColorPickers()
 void SettingsWindow::setupFullscreenCombo()
 {
     screenCombo = new ScreenCombo(this);
-    screenCombo->setObjectName("fullscreenMonitor");
+    screenCombo->setObjectName(screenComboName);
     ui->fullscreenMonitorLayout->addWidget(screenCombo);
 }
 
 void SettingsWindow::setupSelfSignals()
 {
-    connect(this, &SettingsWindow::volumeMax,
+    connect(model, &SettingsModel::volumeMax,
             this, &SettingsWindow::self_volumeMax);
+    connect(model, &SettingsModel::settingsChanged,
+            this, &SettingsWindow::model_settingsChanged);
 }
 
 void SettingsWindow::setupUnimplementedWidgets()
@@ -498,11 +1497,6 @@ void SettingsWindow::setupUnimplementedWidgets()
 
 }
 
-void SettingsWindow::updateAcceptedSettings() {
-    acceptedSettings = generateSettingMap(this);
-    acceptedKeyMap = actionEditor->toVMap();
-}
-
 SettingMap SettingsWindow::generateSettingMap(QWidget *root)
 {
     SettingMap settingMap;
@@ -531,6 +1525,16 @@ SettingMap SettingsWindow::generateSettingMap(QWidget *root)
     return settingMap;
 }
 
+void SettingsWindow::checkDefaults()
+{
+    QVariantMap modelDefaults = model->defaultSettings();
+    for (const Setting &s : std::as_const(defaultSettings))
+        if (modelDefaults.value(s.name) != s.value)
+            Logger::log("settings", QString("the default of %1 differs from the ui").arg(s.name));
+    if (ui->playbackAutoZoomMethod->count() != autoZoomMethodCount)
+        Logger::log("settings", "the number of autozoom methods differs from the ui");
+}
+
 void SettingsWindow::generateVideoPresets()
 {
     SettingMap videoWidgets;
@@ -598,28 +1602,11 @@ QString SettingsWindow::selectedLogo()
                                 : internalLogos.value(ui->logoInternal->currentIndex());
 }
 
-QString SettingsWindow::channelSwitcher()
-{
-    //FIXME: stub
-    return "2.0";
-}
-
-void SettingsWindow::takeActions(const QList<QAction *> actions)
-{
-    QList<Command> commandList;
-    for (QAction *a : actions) {
-        Command c;
-        c.fromAction(a);
-        commandList.append(c);
-    }
-    actionEditor->setCommands(commandList);
-    defaultKeyMap = actionEditor->toVMap();
-}
-
 void SettingsWindow::takeSettings(QVariantMap payload)
 {
-    acceptedSettings.fromVMap(payload);
-    for (Setting &s : acceptedSettings) {
+    SettingMap controls = defaultSettings;
+    controls.fromVMap(payload);
+    for (Setting &s : controls) {
         s.sendToControl();
     }
     updateLogoWidget();
@@ -628,452 +1615,15 @@ void SettingsWindow::takeSettings(QVariantMap payload)
 void SettingsWindow::takeKeyMap(const QVariantMap &payload)
 {
     actionEditor->fromVMap(payload);
-    actionEditor->updateActions();
-    acceptedKeyMap = actionEditor->toVMap();
-}
-
-void SettingsWindow::setMouseMapDefaults(const QVariantMap &payload)
-{
-    actionEditor->fromVMap(payload);
-    defaultKeyMap = actionEditor->toVMap();
 }
 
 void SettingsWindow::setAudioDevices(const QList<AudioDevice> &devices)
 {
-    audioDevices = devices;
     ui->audioDevice->clear();
-    for (const AudioDevice &device : std::as_const(audioDevices))
+    for (const AudioDevice &device : devices)
         ui->audioDevice->addItem(device.displayString());
 }
 
-
-// The reason why we're using #define's like this instead of quoted-string
-// inspection is because this way guarantees that the app will not break from
-// the names here and the names in the ui file not matching up.
-
-#define WIDGET_LOOKUP(widget) \
-    acceptedSettings[widget->objectName()].value
-
-#define WIDGET_LOOKUP_PREFIX(prefix, widget) \
-    acceptedSettings[prefix + widget->objectName()].value
-
-#define OFFSET_LOOKUP(source, widget) \
-    source[widget->objectName()].value.toInt()
-
-#define WIDGET_TO_TEXT(widget) \
-    SettingMap::indexedValueToText[widget->objectName()].value(OFFSET_LOOKUP(acceptedSettings,widget), \
-        SettingMap::indexedValueToText[widget->objectName()].value(OFFSET_LOOKUP(defaultSettings,widget)))
-
-#define WIDGET_PLACEHOLD_LOOKUP(widget) \
-    (WIDGET_LOOKUP(widget).toString().isEmpty() ? widget->placeholderText() : WIDGET_LOOKUP(widget).toString())
-
-#define WIDGET_LOOKUP2(option, widget, dflt) \
-    (WIDGET_LOOKUP(option).toBool() ? WIDGET_LOOKUP(widget) : QVariant(dflt))
-
-#define WIDGET_LOOKUP2_TEXT(option, widget, dflt) \
-    (WIDGET_LOOKUP(option).toBool() ? WIDGET_TO_TEXT(widget) : QVariant(dflt))
-
-void SettingsWindow::sendSignals()
-{
-    auto widgetToPrefixHelper = [this](QString wprefix, QString wsuffix)
-    {
-        auto offsetLookup = [](const SettingMap &source, QString objectName) {
-            return source[objectName].value.toInt();
-        };
-        QString objectName = wprefix + wsuffix;
-        return SettingMap::indexedValueToText[objectName].value(offsetLookup(acceptedSettings,objectName),
-            SettingMap::indexedValueToText[objectName].value(offsetLookup(defaultSettings,objectName)));
-    };
-#define WIDGET_TO_TEXT_PREFIX(wp,w) widgetToPrefixHelper(wp,w->objectName())
-
-    // This function is usually ordered by the order they appear in the ui.
-    // However some times this is not the case: logging for example should
-    // be turned on early.
-
-    bool loggingIsEnabled = WIDGET_LOOKUP(ui->loggingEnabled).toBool();
-    emit loggingEnabled(loggingIsEnabled);
-    if (loggingIsEnabled) {
-        emit logFilePath(WIDGET_LOOKUP(ui->logFileCreate).toBool()
-                         ? WIDGET_PLACEHOLD_LOOKUP(ui->logFilePathValue)
-                         : QString());
-        emit clientDebuggingMessages(WIDGET_LOOKUP(ui->debugClient).toBool());
-        emit mpvLogLevel(WIDGET_TO_TEXT(ui->debugMpv));
-        emit logDelay(WIDGET_LOOKUP(ui->logUpdateDelayed).toBool() ?
-                    WIDGET_LOOKUP(ui->logUpdateInterval).toInt() : -1);
-        emit logHistory(WIDGET_LOOKUP(ui->logHistoryTrim).toBool() ?
-                        WIDGET_LOOKUP(ui->logHistoryLines).toInt() : 0);
-    }
-
-    emit trayIcon(WIDGET_LOOKUP(ui->playerTrayIcon).toBool());
-    emit showOsd(WIDGET_LOOKUP(ui->playerOSD).toBool());
-    emit limitProportions(WIDGET_LOOKUP(ui->playerLimitProportions).toBool());
-    emit disableOpenDiscMenu(WIDGET_LOOKUP(ui->playerDisableOpenDisc).toBool());
-    emit inhibitScreensaver(WIDGET_LOOKUP(ui->playerDisableScreensaver).toBool());
-    emit titleBarFormat(WIDGET_LOOKUP(ui->playerTitleDisplayFullPath).toBool() ? Helpers::PrefixFullPath
-                        : WIDGET_LOOKUP(ui->playerTitleFileNameOnly).toBool() ? Helpers::PrefixFileName : Helpers::NoPrefix);
-    emit titleUseMediaTitle(WIDGET_LOOKUP(ui->playerTitleReplaceName).toBool());
-    emit rememberHistory(WIDGET_LOOKUP(ui->playerKeepHistory).toBool(),
-                         WIDGET_LOOKUP(ui->playerKeepHistoryOnlyForVideos).toBool());
-    emit rememberFilePosition(WIDGET_LOOKUP(ui->playerRememberFilePosition).toBool());
-    emit rememberSelectedPlaylist(WIDGET_LOOKUP(ui->playerRememberLastPlaylist).toBool());
-    emit rememberWindowGeometry(WIDGET_LOOKUP(ui->playerRememberWindowGeometry).toBool());
-    emit rememberPanels(WIDGET_LOOKUP(ui->playerRememberPanels).toBool());
-    emit rememberPanNScan(WIDGET_LOOKUP(ui->playerRememberPanScanZoom).toBool());
-
-    emit mprisIpc(WIDGET_LOOKUP(ui->ipcMpris).toBool());
-
-    emit logoSource(selectedLogo());
-    emit iconTheme(static_cast<IconThemer::FolderMode>(WIDGET_LOOKUP(ui->interfaceIconsTheme).toInt()),
-                   WIDGET_TO_TEXT(ui->interfaceIconsInbuilt),
-                   WIDGET_LOOKUP(ui->interfaceIconsCustomFolder).toString());
-    emit highContrastWidgets(WIDGET_LOOKUP(ui->interfaceWidgetHighContast).toBool());
-    emit applicationPalette(WIDGET_LOOKUP(ui->interfaceWidgetCustom).toBool()
-                            ? paletteEditor->variantToPalette(WIDGET_LOOKUP(paletteEditor))
-                            : paletteEditor->systemPalette());
-    emit videoColor(QString("#%1").arg(WIDGET_LOOKUP(ui->windowVideoValue).toString()));
-    emit option("background-color", QString("#%1").arg(WIDGET_LOOKUP(ui->windowVideoValue).toString()));
-    emit infoStatsColors(QString("#%1").arg(WIDGET_LOOKUP(ui->windowInfoForegroundValue).toString()),
-                         QString("#%1").arg(WIDGET_LOOKUP(ui->windowInfoBackgroundValue).toString()));
-
-    emit stylesheetIsFusion(WIDGET_LOOKUP(ui->stylesheetFusion).toBool());
-    emit stylesheetText(WIDGET_LOOKUP(ui->stylesheetText).toString());
-
-    emit webserverListening(WIDGET_LOOKUP(ui->webEnableServer).toBool());
-    emit webserverPort(WIDGET_LOOKUP(ui->webPort).toInt());
-    emit webserverLocalhost(WIDGET_LOOKUP(ui->webLocalhost_v2).toBool());
-    emit webserverServePages(WIDGET_LOOKUP(ui->webServePages).toBool());
-    emit webserverRoot(WIDGET_PLACEHOLD_LOOKUP(ui->webRoot));
-    emit webserverDefaultPage(WIDGET_PLACEHOLD_LOOKUP(ui->webDefaultPage));
-
-    int vol = WIDGET_LOOKUP(ui->playbackVolume).toInt();
-    int volmax = WIDGET_LOOKUP(ui->tweaksVolumeLimit).toBool() ? 100 : 130;
-    emit volumeMax(volmax);
-    emit volume(std::min(vol, volmax), true);
-    emit volumeStep(WIDGET_LOOKUP(ui->playbackVolumeStep).toInt());
-    {
-        int i = WIDGET_LOOKUP(ui->playbackSpeedStep).toInt();
-        emit speedStep(i > 0 ? 1.0 + i/100.0 : 2.0);
-        emit speedStepAdditive(WIDGET_LOOKUP(ui->playbackSpeedStepAdditive).toBool());
-    }
-    emit audioFilter("stereotools=balance_out=" +
-        QString().number(WIDGET_LOOKUP(ui->playbackBalance).toDouble()/100), true);
-    emit stepTimeNormal(WIDGET_LOOKUP(ui->playbackNormalStep).toInt());
-    emit stepTimeLarge(WIDGET_LOOKUP(ui->playbackLargeStep).toInt());
-
-    emit playbackPlayTimes(WIDGET_LOOKUP(ui->playbackPlayAmount).toInt());
-    emit playbackForever(WIDGET_LOOKUP(ui->playbackRepeatForever).toBool());
-    emit option("image-display-duration", WIDGET_LOOKUP(ui->playbackLoopImages).toBool() ? QVariant("inf") : QVariant(1.0));
-
-    emit afterPlaybackDefault(Helpers::AfterPlayback(WIDGET_LOOKUP(ui->afterPlaybackDefault).toInt()));
-
-    emit zoomCenter(WIDGET_LOOKUP(ui->playbackAutoCenterWindow).toBool());
-    double factor = WIDGET_LOOKUP(ui->playbackAutoFitFactor).toInt() / 100.0;
-    if (!WIDGET_LOOKUP(ui->playbackAutoZoom).toBool())
-        emit zoomPreset(-1, factor);
-    else {
-        int preset = WIDGET_LOOKUP(ui->playbackAutoZoomMethod).toInt();
-        int count = ui->playbackAutoZoomMethod->count();
-        if (preset >= count - 3)
-            emit zoomPreset(preset - count - 1, factor);
-        else
-            emit zoomPreset(preset, factor);
-    }
-
-    emit mouseHideTimeFullscreen(WIDGET_LOOKUP(ui->playbackMouseHideFullscreen).toBool()
-                                 ? WIDGET_LOOKUP(ui->playbackMouseHideFullscreenDuration).toInt()
-                                 : 0);
-    emit mouseHideTimeWindowed(WIDGET_LOOKUP(ui->playbackMouseHideWindowed).toBool()
-                               ? WIDGET_LOOKUP(ui->playbackMouseHideWindowedDuration).toInt()
-                               : 0);
-
-    emit trackSubtitlePreference(WIDGET_PLACEHOLD_LOOKUP(ui->playbackSubtitleTracks));
-    emit trackAudioPreference(WIDGET_PLACEHOLD_LOOKUP(ui->playbackAudioTracks));
-
-    emit option("keep-open", true);
-    emit option("video-sync", WIDGET_TO_TEXT(ui->syncMode));
-    emit option("gpu-dumb-mode", WIDGET_LOOKUP(ui->videoDumbMode));
-    emit option("fbo-format", WIDGET_TO_TEXT(ui->videoFramebuffer).split('-').value(WIDGET_LOOKUP(ui->videoUseAlpha).toBool()));
-    emit option("alpha", WIDGET_TO_TEXT(ui->videoAlphaMode));
-    emit option("sharpen", WIDGET_LOOKUP(ui->videoSharpen).toString());
-
-    if (WIDGET_LOOKUP(ui->ditherDithering).toBool()) {
-        emit option("dither-depth", WIDGET_LOOKUP(ui->ditherDepth).toString());
-        emit option("dither", WIDGET_TO_TEXT(ui->ditherType));
-        emit option("dither-size-fruit", WIDGET_LOOKUP(ui->ditherFruitSize).toString());
-    } else {
-        emit option("dither", "no");
-    }
-    emit option("temporal-dither", WIDGET_LOOKUP(ui->ditherTemporal));
-    emit option("temporal-dither-period", WIDGET_LOOKUP2(ui->ditherTemporal, ui->ditherTemporalPeriod, 1));
-    emit option("correct-downscaling", WIDGET_LOOKUP(ui->scalingCorrectDownscaling));
-    emit option("linear-downscaling", WIDGET_LOOKUP(ui->scalingInLinearLight));
-    emit option("linear-upscaling", WIDGET_LOOKUP(ui->scalingUpInLinearLight));
-    emit option("interpolation", WIDGET_LOOKUP(ui->scalingTemporalInterpolation));
-    emit option("blend-subtitles", WIDGET_LOOKUP(ui->scalingBlendSubtitles));
-    if (WIDGET_LOOKUP(ui->scalingSigmoidizedUpscaling).toBool()) {
-        emit option("sigmoid-upscaling", true);
-        emit option("sigmoid-center", WIDGET_LOOKUP(ui->sigmoidizedCenter));
-        emit option("sigmoid-slope", WIDGET_LOOKUP(ui->sigmoidizedSlope));
-    } else {
-        emit option("sigmoid-upscaling", false);
-    }
-
-    QString scaler;
-    FilterKernel filter;
-    auto fetchFilter = [&](QString prefix, bool temporal = false) {
-        scaler = WIDGET_TO_TEXT_PREFIX(prefix, ui->scaleScaler);
-        filter = filterKernels.value(scaler);
-        filter.cutoff_(temporal ? 0.0 : 0.01);
-        filter.clamp_(temporal ? 1.0 : 0.0);
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleParam1Set).toBool())    filter.param1_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleParam1Value).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleParam2Set).toBool())    filter.param2_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleParam2Value).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleRadiusSet).toBool())    filter.radius_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleRadiusValue).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleAntiRingSet).toBool())  filter.antiring_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleAntiRingValue).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleBlurSet).toBool())      filter.blur_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleBlurValue).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleWindowSet).toBool())    filter.window_(WIDGET_TO_TEXT_PREFIX(prefix, ui->scaleWindowValue));
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleWindowParamSet).toBool())   filter.window.param_(WIDGET_LOOKUP_PREFIX(prefix, ui->scaleWindowValue).toDouble());
-        if (WIDGET_LOOKUP_PREFIX(prefix, ui->scaleClampSet).toBool())     filter.clamp_(WIDGET_TO_TEXT_PREFIX(prefix, ui->scaleClampValue).toDouble());
-    };
-    auto applyFilter = [&](QString prefix) {
-        emit option(prefix + "scale", scaler);
-        emit option(prefix + "scale-param1", filter.params[0]);
-        emit option(prefix + "scale-param2", filter.params[1]);
-        emit option(prefix + "scale-radius", filter.radius);
-        emit option(prefix + "scale-antiring", filter.antiring);
-        emit option(prefix + "scale-blur", filter.blur);
-        emit option(prefix + "scale-window", filter.windowName);
-        emit option(prefix + "scale-wparam", filter.window.params[0]);
-        emit option(prefix + "scale-clamp", filter.clamp);
-    };
-
-    fetchFilter("");
-    applyFilter("");
-
-    if (OFFSET_LOOKUP(acceptedSettings, ui->dscaleScaler) != 0)
-        fetchFilter("d");
-    applyFilter("d");
-
-    fetchFilter("c");
-    applyFilter("c");
-
-    fetchFilter("t", true);
-    applyFilter("t");
-
-    if (WIDGET_LOOKUP(ui->debandEnabled).toBool()) {
-        emit option("deband", true);
-        emit option("deband-iterations", WIDGET_LOOKUP(ui->debandIterations));
-        emit option("deband-threshold", WIDGET_LOOKUP(ui->debandThreshold));
-        emit option("deband-range", WIDGET_LOOKUP(ui->debandRange));
-        emit option("deband-grain", WIDGET_LOOKUP(ui->debandGrain));
-    } else {
-        emit option("deband", false);
-    }
-
-    emit option("gamut-mapping-mode", WIDGET_TO_TEXT(ui->ccGamutMapping));
-    emit option("target-gamut", WIDGET_TO_TEXT(ui->ccTargetGamut));
-    emit option("target-prim", WIDGET_TO_TEXT(ui->ccTargetPrim));
-    emit option("target-trc", WIDGET_TO_TEXT(ui->ccTargetTrc_v2));
-    int targetPeak = WIDGET_LOOKUP(ui->ccTargetPeak).toInt();
-    emit option("target-peak", targetPeak >= 10 ? QString::number(targetPeak) : QString("auto"));
-    emit option("tone-mapping", WIDGET_TO_TEXT(ui->ccHdrMapper));
-    {
-        QList<QDoubleSpinBox*> boxen {ui->ccHdrClipParam,
-                    ui->ccHdrMobiusParam, ui->ccHdrReinhardParam, nullptr,
-                    ui->ccHdrGammaParam, ui->ccHdrLinearParam};
-        QDoubleSpinBox* toneParam = boxen[WIDGET_LOOKUP(ui->ccHdrMapper).toInt()];
-        emit option("tone-mapping-param", toneParam ? WIDGET_LOOKUP(toneParam) : QVariant(NAN));
-    }
-    emit option("hdr-compute-peak", WIDGET_TO_TEXT(ui->ccHdrCompute));
-    if (WIDGET_LOOKUP(ui->ccICCAutodetect).toBool()) {
-        emit option("icc-profile", "");
-        emit option("icc-profile-auto", true);
-    } else {
-        emit option("icc-profile-auto", false);
-        emit option("icc-profile", WIDGET_LOOKUP(ui->ccICCLocation));
-    }
-    // FIXME: add icc-intent etc
-
-    emit option("glsl-shaders", WIDGET_LOOKUP(ui->shadersActiveList).toStringList());
-
-    emit fullscreenScreen(WIDGET_LOOKUP(screenCombo).toString());
-    emit fullscreenAtLaunch(WIDGET_LOOKUP(ui->fullscreenLaunch).toBool());
-    emit fullscreenExitAtEnd(WIDGET_LOOKUP(ui->fullscreenWindowedAtEnd).toBool());
-    emit fullscreenHideControls(WIDGET_LOOKUP(ui->fullscreenHideControls).toBool(), \
-        WIDGET_LOOKUP(ui->fullscreenShowWhen).toInt(), WIDGET_LOOKUP(ui->fullscreenShowWhenDuration).toInt());
-    emit hidePanels(WIDGET_LOOKUP(ui->fullscreenHidePanels).toBool());
-    emit option("framedrop", WIDGET_TO_TEXT(ui->framedroppingMode));
-    emit option("vf-lavc-framedrop", WIDGET_TO_TEXT(ui->framedroppingDecoderMode));
-    emit option("video-sync-adrop-size", WIDGET_LOOKUP(ui->syncAudioDropSize).toDouble());
-    emit option("video-sync-max-audio-change", WIDGET_LOOKUP(ui->syncMaxAudioChange).toDouble());
-    emit option("video-sync-max-video-change", WIDGET_LOOKUP(ui->syncMaxVideoChange).toDouble());
-    if (WIDGET_LOOKUP(ui->hwdecEnable).toBool()) {
-        QString backend = "auto";
-        if (WIDGET_LOOKUP(ui->hwdecBackendVaapi).toBool())
-            backend = "vaapi,vaapi-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendNvdec).toBool())
-            backend = "nvdec,nvdec-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendVdpau).toBool())
-            backend = "vdpau,vdpau-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendDxva2).toBool())
-            backend = "dxva2,dxva2-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendD3d11va).toBool())
-            backend = "d3d11va,d3d11va-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendCuda).toBool())
-            backend = "cuda,cuda-copy";
-        if (WIDGET_LOOKUP(ui->hwdecBackendCrystalHd).toBool())
-            backend = "crystalhd";
-        emit option("hwdec", backend);
-        if (WIDGET_LOOKUP(ui->hwdecAll).toBool()) {
-            emit option("hwdec-codecs", "all");
-        } else {
-            QStringList codecs;
-            if (WIDGET_LOOKUP(ui->hwdecMJpeg).toBool()) codecs << "mjpeg";
-            if (WIDGET_LOOKUP(ui->hwdecMpeg1Video).toBool()) codecs << "mpeg1video";
-            if (WIDGET_LOOKUP(ui->hwdecMpeg2Video).toBool()) codecs << "mpeg2video";
-            if (WIDGET_LOOKUP(ui->hwdecMpeg4).toBool()) codecs << "mpeg4";
-            if (WIDGET_LOOKUP(ui->hwdecH263).toBool()) codecs << "h263";
-            if (WIDGET_LOOKUP(ui->hwdecH264).toBool()) codecs << "h264";
-            if (WIDGET_LOOKUP(ui->hwdecVc1).toBool()) codecs << "vc1";
-            if (WIDGET_LOOKUP(ui->hwdecWmv3).toBool()) codecs << "wmv3";
-            if (WIDGET_LOOKUP(ui->hwdecHevc).toBool()) codecs << "hevc";
-            if (WIDGET_LOOKUP(ui->hwdecVp9).toBool()) codecs << "vp9";
-            emit option("hwdec-codecs", codecs.join(','));
-        }
-    } else {
-        emit option("hwdec", "no");
-        emit option("hwdec-codecs", "");
-    }
-
-    emit playlistFormat(WIDGET_PLACEHOLD_LOOKUP(ui->playlistFormat));
-
-    int index = WIDGET_LOOKUP(ui->audioDevice).toInt();
-    emit option("audio-device", audioDevices.value(index).deviceName());
-    index = WIDGET_LOOKUP(ui->audioChannels).toInt();
-    emit option("audio-channels", index < 3 ? SettingMap::indexedValueToText[ui->audioChannels->objectName()][index]
-                                         : channelSwitcher());
-    bool flag = WIDGET_LOOKUP(ui->audioStreamSilence).toBool();
-    emit option("stream-silence", flag);
-    emit option("audio-wait-open", flag ? WIDGET_LOOKUP(ui->audioWaitTime).toDouble() : 0.0);
-    emit option("audio-pitch-correction", WIDGET_LOOKUP(ui->audioPitchCorrection).toBool());
-    emit option("audio-exclusive", WIDGET_LOOKUP(ui->audioExclusiveMode).toBool());
-    emit option("audio-normalize-downmix", WIDGET_LOOKUP(ui->audioNormalizeDownmix).toBool());
-    emit option("audio-spdif", WIDGET_LOOKUP(ui->audioSpdif).toBool() ? WIDGET_PLACEHOLD_LOOKUP(ui->audioSpdifCodecs) : "");
-    emit option("pipewire-buffer", WIDGET_LOOKUP(ui->pipewireBuffer).toInt());
-    emit option("pulse-buffer", WIDGET_LOOKUP(ui->pulseBuffer).toInt());
-    emit option("pulse-latency-hacks", WIDGET_LOOKUP(ui->pulseLatency).toBool());
-    emit option("alsa-resample", WIDGET_LOOKUP(ui->alsaResample).toBool());
-    emit option("alsa-ignore-chmap", WIDGET_LOOKUP(ui->alsaIgnoreChannelMap).toBool());
-    emit option("oss-mixer-channel", WIDGET_LOOKUP(ui->ossMixerChannel).toString());
-    emit option("oss-mixer-device", WIDGET_LOOKUP(ui->ossMixerDevice).toString());
-    emit option("jack-autostart", WIDGET_LOOKUP(ui->jackAutostart).toBool());
-    emit option("jack-connect", WIDGET_LOOKUP(ui->jackConnect).toBool());
-    emit option("jack-name", WIDGET_LOOKUP(ui->jackName).toString());
-    emit option("jack-port", WIDGET_LOOKUP(ui->jackPort).toString());
-    bool audioAutoload = WIDGET_LOOKUP(ui->audioAutoloadExternal).toBool();
-    emit option("audio-file-auto", audioAutoload ? WIDGET_TO_TEXT(ui->audioAutoloadMatch) : "no");
-    emit option("audio-file-paths", WIDGET_PLACEHOLD_LOOKUP(ui->audioAutoloadPath).split(';'));
-
-    emit option("sub-gray", WIDGET_LOOKUP(ui->subtitlesForceGrayscale).toBool());
-    emit option("sub-font", WIDGET_LOOKUP(ui->fontComboBox).toString());
-    emit option("sub-bold", WIDGET_LOOKUP(ui->fontBold).toBool());
-    emit option("sub-italic", WIDGET_LOOKUP(ui->fontItalic).toBool());
-    emit option("sub-font-size", WIDGET_LOOKUP(ui->fontSize).toInt());
-    emit option("sub-border-size", WIDGET_LOOKUP(ui->borderSize).toInt());
-    emit option("sub-shadow-offset", WIDGET_LOOKUP(ui->borderShadowOffset).toInt());
-    emit subtitlesDelayStep(WIDGET_LOOKUP(ui->subtitlesDelayStep).toInt());
-    {
-        struct AlignData { QRadioButton *btn; int x; int y; };
-        QVector<AlignData> alignments {
-            { ui->subsAlignmentTopLeft, -1, -1 },
-            { ui->subsAlignmentTop, 0, -1 },
-            { ui->subsAlignmentTopRight, 1, -1 },
-            { ui->subsAlignmentLeft, -1, 0 },
-            { ui->subsAlignmentCenter, 0, 0 },
-            { ui->subsAlignmentRight, 1, 0 },
-            { ui->subsAlignmentBottomLeft, -1, 1 },
-            { ui->subsAlignmentBottom, 0, 1 },
-            { ui->subsAlignmentBottomRight, 1, 1 }
-        };
-        static QMap<int, const char *> wx {
-            { -1, "left" },
-            { 0, "center" },
-            { 1, "right" }
-        };
-        static QMap<int, const char *> wy {
-            { -1, "top" },
-            { 0, "center" },
-            { 1, "bottom" }
-        };
-        for (const AlignData &a : alignments) {
-            if (a.btn->isChecked()) {
-                emit option("sub-align-x", wx[a.x]);
-                emit option("sub-align-y", wy[a.y]);
-                break;
-            }
-        }
-    }
-    emit option("sub-ass", !WIDGET_LOOKUP(ui->subsAssoverride).toBool());
-    emit option("sub-margin-x", WIDGET_LOOKUP(ui->subsMarginX).toInt());
-    emit option("sub-margin-y", WIDGET_LOOKUP(ui->subsMarginY).toInt());
-    emit option("sub-use-margins", !WIDGET_LOOKUP(ui->subsRelativeToVideoFrame).toBool());
-    emit option("sub-color", QString("#%1").arg(WIDGET_LOOKUP(ui->subsColorValue).toString()));
-    emit option("sub-border-color", QString("#%1").arg(WIDGET_LOOKUP(ui->subsBorderColorValue).toString()));
-    emit option("sub-shadow-color", QString("#%1").arg(WIDGET_LOOKUP(ui->subsShadowColorValue).toString()));
-    if (WIDGET_LOOKUP(ui->subsBackcolorEnabled).toBool())
-        emit option("sub-back-color", QString("#%1").arg(WIDGET_LOOKUP(ui->subsBackcolorValue).toString()));
-    else
-        emit option("sub-back-color", "#00000000");
-
-    emit subsPreferDefaultForced(WIDGET_LOOKUP(ui->subtitlesPreferDefaultForced_v3).toBool());
-    emit subsPreferExternal(WIDGET_LOOKUP(ui->subtitlesPreferExternal).toBool());
-    emit subsIgnoreEmbeded(WIDGET_LOOKUP(ui->subtitlesIgnoreEmbedded).toBool());
-    bool subsAutoload = WIDGET_LOOKUP(ui->subtitlesAutoloadExternal).toBool();
-    emit option("sub-auto", subsAutoload ? WIDGET_TO_TEXT(ui->subtitlesAutoloadMatch) : QString("no"));
-    emit option("sub-file-paths", WIDGET_PLACEHOLD_LOOKUP(ui->subtitlesAutoloadPath).split(';'));
-
-    emit screenshotDirectory(
-                WIDGET_LOOKUP(ui->screenshotDirectorySet).toBool() ?
-                QFileInfo(WIDGET_PLACEHOLD_LOOKUP(ui->screenshotDirectoryValue)).absoluteFilePath() : QString());
-
-    emit encodeDirectory(
-                WIDGET_LOOKUP(ui->encodeDirectorySet).toBool() ?
-                QFileInfo(WIDGET_PLACEHOLD_LOOKUP(ui->encodeDirectoryValue)).absoluteFilePath() : QString());
-    emit screenshotTemplate(WIDGET_PLACEHOLD_LOOKUP(ui->screenshotTemplate));
-    emit encodeTemplate(WIDGET_PLACEHOLD_LOOKUP(ui->encodeTemplate));
-    emit option("screenshot-high-bit-depth", WIDGET_LOOKUP(ui->screenshotFormatHighBitDepth));
-    emit screenshotFormat(WIDGET_TO_TEXT(ui->screenshotFormat));
-    emit option("screenshot-format", WIDGET_TO_TEXT(ui->screenshotFormat));
-    emit option("screenshot-jpeg-quality", WIDGET_LOOKUP(ui->jpgQuality).toInt());
-    emit option("screenshot-jpeg-smooth", WIDGET_LOOKUP(ui->jpgSmooth).toInt());
-    emit option("screenshot-jpeg-source-chroma", WIDGET_LOOKUP(ui->jpgSourceChroma).toBool());
-    emit option("screenshot-png-compression", WIDGET_LOOKUP(ui->pngCompression).toInt());
-    emit option("screenshot-png-filter", WIDGET_LOOKUP(ui->pngFilter).toInt());
-    emit option("screenshot-tag-colorspace", WIDGET_LOOKUP(ui->pngColorspace).toBool());
-
-    emit option("hr-seek", WIDGET_LOOKUP(ui->tweaksFastSeek).toBool() ? "absolute" : "yes");
-    emit option("hr-seek-framedrop", WIDGET_LOOKUP(ui->tweaksSeekFramedrop).toBool());
-    emit fallbackToFolder(WIDGET_LOOKUP(ui->tweaksOpenNextFile).toBool());
-    emit mpvMouseEvents(WIDGET_LOOKUP(ui->tweaksMpvMouseEvents).toBool());
-    emit mpvKeyEvents(WIDGET_LOOKUP(ui->tweaksMpvKeyEvents).toBool());
-    emit timeShorten(WIDGET_LOOKUP(ui->tweaksTimeShort).toBool());
-    emit timeTooltip(WIDGET_LOOKUP(ui->tweaksTimeTooltip).toBool(),
-                     WIDGET_LOOKUP(ui->tweaksTimeTooltipLocation).toInt() == 0);
-    emit osdTimerOnSeek(WIDGET_LOOKUP(ui->tweaksOsdTimerOnSeek).toBool());
-    emit option("osd-font", WIDGET_LOOKUP(ui->tweaksOsdFontChkBox).toBool() ? WIDGET_LOOKUP(ui->tweaksOsdFont).toString() : "");
-    emit option("osd-font-size", WIDGET_LOOKUP(ui->tweaksOsdFontChkBox).toBool() ? WIDGET_LOOKUP(ui->tweaksOsdSize).toInt() : 55);
-    emit option("brightness", WIDGET_LOOKUP(ui->miscBrightness).toInt());
-    emit option("contrast", WIDGET_LOOKUP(ui->miscContrast).toInt());
-    emit option("gamma", WIDGET_LOOKUP(ui->miscGamma).toInt());
-    emit option("hue", WIDGET_LOOKUP(ui->miscHue).toInt());
-    emit option("saturation", WIDGET_LOOKUP(ui->miscSaturation).toInt());
-}
-
-void SettingsWindow::sendAcceptedSettings()
-{
-    emit settingsData(acceptedSettings.toVMap());
-    emit keyMapData(acceptedKeyMap);
-}
-
 void SettingsWindow::setScreensaverDisablingEnabled(bool enabled)
 {
     ui->playerDisableScreensaver->setEnabled(enabled);
@@ -1104,50 +1654,20 @@ void SettingsWindow::setFreestanding(bool freestanding)
     ui->webLocalFilesBox->setEnabled(yes);
 }
 
-void SettingsWindow::setVolume(int level)
-{
-    WIDGET_LOOKUP(ui->playbackVolume).setValue(level);
-}
-
-void SettingsWindow::setZoomPreset(int which)
-{
-    bool autoZoom = which != -1;
-    int zoomMethod = which >= 0 ? which :
-                     which == -1 ? 1
-                                 : which + ui->playbackAutoZoomMethod->count() + 1;
-
-    WIDGET_LOOKUP(ui->playbackAutoZoom).setValue(autoZoom);
-    WIDGET_LOOKUP(ui->playbackAutoZoomMethod).setValue(zoomMethod);
-    ui->playbackAutoZoom->setChecked(autoZoom);
-    ui->playbackAutoZoomMethod->setCurrentIndex(zoomMethod);
-
-    emit settingsData(acceptedSettings.toVMap());
-}
-
-void SettingsWindow::setHidePanels(bool hidden)
-{
-    ui->fullscreenHidePanels->setChecked(hidden);
-    WIDGET_LOOKUP(ui->fullscreenHidePanels).setValue(hidden);
-    emit settingsData(acceptedSettings.toVMap());
-}
-
 void SettingsWindow::self_volumeMax(int maximum)
 {
     ui->playbackVolume->setMaximum(maximum);
 }
 
-void SettingsWindow::restoreColorControls()
-{
-    emit option("brightness", acceptedSettings.value("miscBrightness").value.toInt());
-    emit option("contrast", acceptedSettings.value("miscContrast").value.toInt());
-    emit option("gamma", acceptedSettings.value("miscGamma").value.toInt());
-    emit option("hue", acceptedSettings.value("miscHue").value.toInt());
-    emit option("saturation", acceptedSettings.value("miscSaturation").value.toInt());
-}
-void SettingsWindow::restoreAudioSettings()
+void SettingsWindow::model_settingsChanged(const QVariantMap &changed)
 {
-    emit audioFilter("stereotools=balance_out=" +
-        QString().number(WIDGET_LOOKUP(ui->playbackBalance).toDouble()/100), true);
+    for (auto it = changed.cbegin(); it != changed.cend(); it++) {
+        if (!defaultSettings.contains(it.key()))
+            continue;
+        Setting s = defaultSettings.value(it.key());
+        s.value = it.value();
+        s.sendToControl();
+    }
 }
 
 void SettingsWindow::colorPick_clicked(QLineEdit *colorValue)
@@ -1188,15 +1708,15 @@ void SettingsWindow::on_buttonBox_clicked(QAbstractButton *button)
     QDialogButtonBox::ButtonRole buttonRole;
     buttonRole = ui->buttonBox->buttonRole(button);
     if (buttonRole == QDialogButtonBox::ApplyRole ||
-            buttonRole == QDialogButtonBox::AcceptRole) {\
-        updateAcceptedSettings();
-        sendAcceptedSettings();
-        actionEditor->updateActions();
-        sendSignals();
+            buttonRole == QDialogButtonBox::AcceptRole) {
+        model->takeSettings(generateSettingMap(this).toVMap());
+        model->takeKeyMap(actionEditor->toVMap());
+        model->sendAcceptedSettings();
+        model->sendSignals();
     }
     else {
-        restoreColorControls();
-        restoreAudioSettings();
+        model->restoreColorControls();
+        model->restoreAudioSettings();
     }
     if (buttonRole == QDialogButtonBox::AcceptRole ||
             buttonRole == QDialogButtonBox::RejectRole)
@@ -1206,8 +1726,8 @@ void SettingsWindow::on_buttonBox_clicked(QAbstractButton *button)
 void SettingsWindow::closeEvent(QCloseEvent *event)
 {
     Q_UNUSED(event)
-    restoreColorControls();
-    restoreAudioSettings();
+    model->restoreColorControls();
+    model->restoreAudioSettings();
 }
 
 void SettingsWindow::on_playerKeepHistory_checkStateChanged(Qt::CheckState state)
@@ -1236,7 +1756,7 @@ void SettingsWindow::on_logoExternalBrowse_clicked()
 #ifdef Q_OS_MAC
     options = QFileDialog::DontUseNativeDialog;
 #endif
-    QString file = WIDGET_LOOKUP(ui->logoExternalLocation).toString();
+    QString file = model->settings().value(WIDGET_NAME(logoExternalLocation)).toString();
     file = QFileDialog::getOpenFileName(this, tr("Open Logo Image"), file, "", nullptr, options);
     if (file.isEmpty())
         return;
@@ -1295,7 +1815,7 @@ void SettingsWindow::on_pngFilter_valueChanged(int value)
 
 void SettingsWindow::on_keysReset_clicked()
 {
-    actionEditor->fromVMap(defaultKeyMap);
+    actionEditor->fromVMap(model->defaultKeyMap());
     actionEditor->updateActions();
 }
 
@@ -1356,7 +1876,7 @@ void SettingsWindow::on_playbackVolume_valueChanged(int value)
 void SettingsWindow::on_playbackBalance_valueChanged(int value)
 {
     QToolTip::showText(QCursor::pos(), QString().number(value), ui->playbackBalance);
-    emit audioFilter("stereotools=balance_out=" + QString().number((double) value/100), true);
+    emit model->audioFilter("stereotools=balance_out=" + QString().number((double) value/100), true);
 }
 
 void SettingsWindow::on_playbackAutoZoom_toggled(bool checked)
@@ -1390,7 +1910,7 @@ void SettingsWindow::on_ccICCBrowse_clicked()
 #ifdef Q_OS_MAC
     options = QFileDialog::DontUseNativeDialog;
 #endif
-    QString file = WIDGET_LOOKUP(ui->ccICCLocation).toString();
+    QString file = model->settings().value(WIDGET_NAME(ccICCLocation)).toString();
     file = QFileDialog::getOpenFileName(this, tr("Open ICC Profile"),
                                         file, tr("ICC profile files (*.icc *.icm)"),
                                         nullptr, options);
@@ -1429,31 +1949,31 @@ void SettingsWindow::on_loggingEnabled_toggled(bool checked)
 void SettingsWindow::on_miscBrightness_valueChanged(int value)
 {
     ui->miscBrightnessValue->setText(QString("%1").arg(value, 4, 10, QChar(' ')));
-    emit option("brightness", value);
+    emit model->option("brightness", value);
 }
 
 void SettingsWindow::on_miscContrast_valueChanged(int value)
 {
     ui->miscContrastValue->setText(QString("%1").arg(value, 4, 10, QChar(' ')));
-    emit option("contrast", value);
+    emit model->option("contrast", value);
 }
 
 void SettingsWindow::on_miscGamma_valueChanged(int value)
 {
     ui->miscGammaValue->setText(QString("%1").arg(value, 4, 10, QChar(' ')));
-    emit option("gamma", value);
+    emit model->option("gamma", value);
 }
 
 void SettingsWindow::on_miscHue_valueChanged(int value)
 {
     ui->miscHueValue->setText(QString("%1").arg(value, 4, 10, QChar(' ')));
-    emit option("hue", value);
+    emit model->option("hue", value);
 }
 
 void SettingsWindow::on_miscSaturation_valueChanged(int value)
 {
     ui->miscSaturationValue->setText(QString("%1").arg(value, 4, 10, QChar(' ')));
-    emit option("saturation", value);
+    emit model->option("saturation", value);
 }
 
 void SettingsWindow::on_miscResetColor_clicked()
@@ -47,34 +47,43 @@ namespace Ui {
 class SettingsWindow;
 }
 
-class SettingsWindow : public QWidget
+// SettingsModel holds the accepted settings and key map, and turns them into
+// the signals that the rest of the player is configured by.  It works from
+// the values alone, so the settings window need only be made when it is
+// opened.  What a setting defaults to comes from a table kept alongside the
+// model, which mirrors what the controls start out as in settingswindow.ui.
+class SettingsModel : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit SettingsWindow(QWidget *parent = nullptr);
-    ~SettingsWindow();
-    QVariantMap settings();
-    QVariantMap keyMap();
-    void disableWindowManagment();
+    explicit SettingsModel(QObject *parent = nullptr);
+
+    QVariantMap settings() const;
+    QVariantMap keyMap() const;
+    QVariantMap defaultKeyMap() const;
+    QList<Command> commands() const;
+    QList<AudioDevice> audioDevices() const;
+    QString placeholderText(const QString &name) const;
+    QPalette systemPalette() const;
+    int maximumVolume() const;
+
+    QVariantMap defaultSettings() const;
+
+    void restoreColorControls();
+    void restoreAudioSettings();
 
 private:
-    void setupPageTree();
-    void setupPlatformWidgets();
-    void setupPaletteEditor();
-    void setupColorPickers();
-    void setupFullscreenCombo();
-    void setupSelfSignals();
-    void setupUnimplementedWidgets();
-    void updateAcceptedSettings();
-    SettingMap generateSettingMap(QWidget *root);
-    void generateVideoPresets();
-    void updateLogoWidget();
+    QVariantMap commandsToVMap() const;
+    void commandsFromVMap(const QVariantMap &map);
+    void updateActions();
     QString selectedLogo();
     QString channelSwitcher();
 
 signals:
     void settingsData(const QVariantMap &s);
+    // Settings changed from outside the window, such as the zoom menu.
+    void settingsChanged(const QVariantMap &changed);
     void keyMapData(const QVariantMap &s);
     void mouseWindowedMap(const MouseStateMap &map);
     void mouseFullscreenMap(const MouseStateMap &map);
@@ -142,6 +151,7 @@ signals:
     void playbackRewinds(bool yes);
     void playbackLoopImages(bool yes);
     void playlistFormat(const QString &fmt);
+    void playlistNaturalSort(bool yes);
 
     void subtitlesDelayStep(int subtitlesDelayStep);
 
@@ -176,6 +186,9 @@ signals:
     void mpvMouseEvents(bool yes);
     void mpvKeyEvents(bool yes);
     void timeTooltip(bool yes, bool above);
+    void seekPreviews(bool yes);
+    void keyframeSnapping(bool yes);
+    void waveform(bool yes);
     void osdTimerOnSeek(bool yes);
     void osdFont(const QString &family, const QString &size);
 
@@ -194,25 +207,63 @@ signals:
 
 public slots:
     void takeActions(const QList<QAction*> actions);
-    void takeSettings(QVariantMap payload);
+    void takeSettings(const QVariantMap &payload);
     void takeKeyMap(const QVariantMap &payload);
     void setMouseMapDefaults(const QVariantMap &payload);
     void setAudioDevices(const QList<AudioDevice> &devices);
     void sendSignals();
     void sendAcceptedSettings();
 
-    void setScreensaverDisablingEnabled(bool enabled);
-    void setServerName(const QString &name);
-    void setFreestanding(bool freestanding);
-
     void setVolume(int level);
     void setZoomPreset(int which);
     void setHidePanels(bool hidden);
 
+private:
+    QVariantMap settings_;
+    QVariantMap defaults;
+    QVariantMap placeholders;
+    QVariantMap acceptedKeyMap;
+    QVariantMap defaultKeyMap_;
+    QList<Command> commands_;
+    QList<AudioDevice> audioDevices_;
+    QPalette systemPalette_;
+};
+
+class SettingsWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsWindow(SettingsModel *model, QWidget *parent = nullptr);
+    ~SettingsWindow();
+    void disableWindowManagment();
+
+private:
+    void setupPageTree();
+    void setupPlatformWidgets();
+    void setupPaletteEditor();
+    void setupColorPickers();
+    void setupFullscreenCombo();
+    void setupSelfSignals();
+    void setupUnimplementedWidgets();
+    SettingMap generateSettingMap(QWidget *root);
+    void checkDefaults();
+    void generateVideoPresets();
+    void updateLogoWidget();
+    QString selectedLogo();
+
+public slots:
+    void takeSettings(QVariantMap payload);
+    void takeKeyMap(const QVariantMap &payload);
+    void setAudioDevices(const QList<AudioDevice> &devices);
+
+    void setScreensaverDisablingEnabled(bool enabled);
+    void setServerName(const QString &name);
+    void setFreestanding(bool freestanding);
+
 private slots:
     void self_volumeMax(int maximum);
-    void restoreColorControls();
-    void restoreAudioSettings();
+    void model_settingsChanged(const QVariantMap &changed);
     void colorPick_clicked(QLineEdit *colorValue);
     void colorPick_changed(QLineEdit *colorValue, QPushButton *colorPick);
 
@@ -312,16 +363,13 @@ private slots:
 
 private:
     Ui::SettingsWindow *ui = nullptr;
+    SettingsModel *model = nullptr;
     ActionEditor *actionEditor = nullptr;
     LogoWidget *logoWidget = nullptr;
     PaletteEditor *paletteEditor = nullptr;
     ScreenCombo *screenCombo = nullptr;
-    SettingMap acceptedSettings;
     SettingMap defaultSettings;
     QList<SettingMap> videoPresets;
-    QVariantMap acceptedKeyMap;
-    QVariantMap defaultKeyMap;
-    QList<AudioDevice> audioDevices;
 };
 
 #endif // SETTINGSWINDOW_H
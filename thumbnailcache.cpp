@@ -0,0 +1,263 @@
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include "logger.h"
+#include "storage.h"
+#include "thumbnailcache.h"
+
+constexpr char logModule[] = "thumbcache";
+constexpr char cacheSubdir[] = "/thumbcache";
+constexpr char packSuffix[] = ".pack";
+constexpr char indexSuffix[] = ".idx";
+constexpr qint64 cacheCapBytes = 256ll * 1024 * 1024;
+// Evicting down to a little below the cap means that a busy run doesn't
+// evict again on nearly every store.
+constexpr qint64 cacheTrimBytes = cacheCapBytes / 5 * 4;
+constexpr int maxLoadedIndexes = 64;
+constexpr int imageQuality = 85;
+
+ThumbnailCache *ThumbnailCache::singleton()
+{
+    static ThumbnailCache instance;
+    return &instance;
+}
+
+ThumbnailCache::ThumbnailCache()
+{
+    QDir().mkpath(cacheDir());
+    indexes.setMaxCost(maxLoadedIndexes);
+}
+
+QByteArray ThumbnailCache::fetchData(const QUrl &media, const QString &key)
+{
+    QMutexLocker lock(&mutex);
+    QString name = packName(media);
+    if (name.isEmpty())
+        return {};
+    PackIndex *index = packIndex(name);
+    if (index->isEmpty()) {
+        // Nothing of this file was ever stored, so don't hold on to it
+        indexes.remove(name);
+        return {};
+    }
+    if (!index->contains(key))
+        return {};
+
+    IndexEntry entry = index->value(key);
+    QFile pack(cacheDir() + "/" + name + packSuffix);
+    if (!pack.open(QIODevice::ReadOnly) || !pack.seek(entry.first))
+        return {};
+    QByteArray data = pack.read(entry.second);
+    if (data.size() != entry.second) {
+        // Pack was truncated behind our back; forget about it.
+        index->remove(key);
+        return {};
+    }
+    pack.close();
+    touch(name);
+    return data;
+}
+
+void ThumbnailCache::storeData(const QUrl &media, const QString &key, const QByteArray &data)
+{
+    QMutexLocker lock(&mutex);
+    QString name = packName(media);
+    if (name.isEmpty() || data.isEmpty())
+        return;
+    PackIndex *index = packIndex(name);
+    bool replacing = index->contains(key);
+
+    // Append the data, then its index record.  A crash in between leaves
+    // unreferenced bytes in the pack, which is harmless.
+    QFile pack(cacheDir() + "/" + name + packSuffix);
+    QFile indexFile(cacheDir() + "/" + name + indexSuffix);
+    if (!pack.open(QIODevice::Append) || !indexFile.open(QIODevice::Append)) {
+        LogStream(logModule) << "could not open pack " << name;
+        return;
+    }
+    qint64 offset = pack.size();
+    qint64 indexSize = indexFile.size();
+    if (pack.write(data) != data.size())
+        return;
+    QDataStream stream(&indexFile);
+    stream << key << offset << qint32(data.size());
+    index->insert(key, { offset, qint32(data.size()) });
+    pack.close();
+    indexFile.close();
+
+    // The directory is only scanned once a run; after that the total is
+    // kept up to date as packs grow and are evicted.
+    if (totalBytes < 0)
+        totalBytes = scanSize();
+    else
+        totalBytes += data.size() + indexFile.size() - indexSize;
+
+    // A key stored again leaves its old data behind in the pack.  Once that
+    // is most of the pack, copy out what is still in use.
+    if (replacing) {
+        qint64 liveBytes = 0;
+        for (const IndexEntry &entry : std::as_const(*index))
+            liveBytes += entry.second;
+        if (offset + data.size() > liveBytes * 2)
+            compact(name, index);
+    }
+    if (totalBytes > cacheCapBytes)
+        evict(name);
+}
+
+QImage ThumbnailCache::fetchImage(const QUrl &media, const QString &key)
+{
+    QByteArray data = fetchData(media, key);
+    return data.isEmpty() ? QImage() : QImage::fromData(data);
+}
+
+void ThumbnailCache::storeImage(const QUrl &media, const QString &key, const QImage &image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (image.save(&buffer, "JPG", imageQuality))
+        storeData(media, key, data);
+}
+
+QString ThumbnailCache::cacheDir() const
+{
+    return Storage::fetchConfigPath() + cacheSubdir;
+}
+
+QString ThumbnailCache::packName(const QUrl &media) const
+{
+    if (!media.isLocalFile())
+        return {};
+    QFileInfo info(media.toLocalFile());
+    if (!info.exists())
+        return {};
+    QString identity = QString("%1|%2|%3").arg(info.absoluteFilePath(),
+                                               QString::number(info.size()),
+                                               QString::number(info.lastModified().toMSecsSinceEpoch()));
+    return QCryptographicHash::hash(identity.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
+ThumbnailCache::PackIndex *ThumbnailCache::packIndex(const QString &name)
+{
+    if (PackIndex *index = indexes.object(name))
+        return index;
+
+    // Read the index, dropping records which point past the end of the pack
+    PackIndex index;
+    qint64 packSize = QFileInfo(cacheDir() + "/" + name + packSuffix).size();
+    QFile indexFile(cacheDir() + "/" + name + indexSuffix);
+    if (indexFile.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&indexFile);
+        while (!stream.atEnd()) {
+            QString key;
+            qint64 offset;
+            qint32 length;
+            stream >> key >> offset >> length;
+            if (stream.status() != QDataStream::Ok)
+                break;
+            if (offset + length <= packSize)
+                index.insert(key, { offset, length });
+        }
+    }
+    PackIndex *loaded = new PackIndex(index);
+    indexes.insert(name, loaded);
+    return loaded;
+}
+
+void ThumbnailCache::compact(const QString &name, PackIndex *index)
+{
+    // The old index goes before the new pack is put in place, so that a
+    // crash part way through loses the entries rather than pointing old
+    // offsets at new data.
+    QString base = cacheDir() + "/" + name;
+    QFile pack(base + packSuffix);
+    QSaveFile newPack(base + packSuffix);
+    QSaveFile newIndex(base + indexSuffix);
+    if (!pack.open(QIODevice::ReadOnly) || !newPack.open(QIODevice::WriteOnly)
+            || !newIndex.open(QIODevice::WriteOnly))
+        return;
+    qint64 oldBytes = pack.size() + QFileInfo(base + indexSuffix).size();
+
+    PackIndex compacted;
+    QDataStream stream(&newIndex);
+    qint64 offset = 0;
+    for (auto it = index->cbegin(); it != index->cend(); it++) {
+        if (!pack.seek(it->first))
+            return;
+        QByteArray data = pack.read(it->second);
+        if (data.size() != it->second)
+            continue;
+        if (newPack.write(data) != data.size())
+            return;
+        stream << it.key() << offset << qint32(data.size());
+        compacted.insert(it.key(), { offset, qint32(data.size()) });
+        offset += data.size();
+    }
+    pack.close();
+    qint64 newBytes = offset + newIndex.pos();
+
+    QFile::remove(base + indexSuffix);
+    if (!newPack.commit() || !newIndex.commit()) {
+        LogStream(logModule) << "could not compact pack " << name;
+        QFile::remove(base + packSuffix);
+        QFile::remove(base + indexSuffix);
+        indexes.remove(name);
+        totalBytes = scanSize();
+        return;
+    }
+    *index = compacted;
+    totalBytes += newBytes - oldBytes;
+}
+
+void ThumbnailCache::touch(const QString &name)
+{
+    // The pack's modification time doubles as its last use.  Once per run
+    // is precise enough for deciding what to evict.
+    if (touched.contains(name))
+        return;
+    touched.insert(name);
+    QFile pack(cacheDir() + "/" + name + packSuffix);
+    if (pack.open(QIODevice::ReadWrite))
+        pack.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+qint64 ThumbnailCache::scanSize()
+{
+    qint64 total = 0;
+    QDir dir(cacheDir());
+    for (const QFileInfo &info : dir.entryInfoList(QDir::Files))
+        total += info.size();
+    return total;
+}
+
+void ThumbnailCache::evict(const QString &keep)
+{
+    QDir dir(cacheDir());
+    QFileInfoList packs = dir.entryInfoList({ QString("*") + packSuffix }, QDir::Files,
+                                            QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : std::as_const(packs)) {
+        if (totalBytes <= cacheTrimBytes)
+            break;
+        QString name = info.completeBaseName();
+        if (name == keep)
+            continue;
+        LogStream(logModule) << "evicting " << name;
+        totalBytes -= info.size() + QFileInfo(dir.filePath(name + indexSuffix)).size();
+        dir.remove(name + packSuffix);
+        dir.remove(name + indexSuffix);
+        indexes.remove(name);
+        touched.remove(name);
+    }
+    // Running out of packs to evict means the running total may have
+    // drifted from what's on disk, e.g. if files were removed behind our
+    // back, so count again.
+    if (totalBytes > cacheTrimBytes)
+        totalBytes = scanSize();
+}
@@ -0,0 +1,52 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+// ThumbnailCache keeps generated images on disk, so that previews and
+// thumbnail sheets survive between runs.  Each media file, identified by
+// its path, size and modification time, gets one pack file holding the
+// encoded images back to back, plus an append-only index of where each
+// keyed entry lives.  Storing a key again appends it afresh, and a pack is
+// rewritten without the stale copies once they take up most of it.  The
+// whole cache is capped in size, and once over it the least recently used
+// media files are evicted until it is comfortably under again.  It may be
+// used from any thread; lookups hit the disk, so the gui thread should
+// leave them to a worker.
+class ThumbnailCache {
+public:
+    static ThumbnailCache *singleton();
+
+    QByteArray fetchData(const QUrl &media, const QString &key);
+    void storeData(const QUrl &media, const QString &key, const QByteArray &data);
+    QImage fetchImage(const QUrl &media, const QString &key);
+    void storeImage(const QUrl &media, const QString &key, const QImage &image);
+
+private:
+    typedef QPair<qint64,qint32> IndexEntry; // offset, length
+    typedef QHash<QString,IndexEntry> PackIndex;
+
+    ThumbnailCache();
+    QString cacheDir() const;
+    QString packName(const QUrl &media) const;
+    PackIndex *packIndex(const QString &name);
+    void compact(const QString &name, PackIndex *index);
+    void touch(const QString &name);
+    qint64 scanSize();
+    void evict(const QString &keep);
+
+    QMutex mutex;
+    QCache<QString,PackIndex> indexes;
+    QSet<QString> touched;
+    qint64 totalBytes = -1;
+};
+
+#endif // THUMBNAILCACHE_H
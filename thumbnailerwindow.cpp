@@ -1,12 +1,19 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <QFile>
+#include <QDir>
+#include <QDirIterator>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QFont>
 #include <QFontMetrics>
-#include <QOpenGLContext>
 #include <QPainter>
+#include <QThread>
 #include <QTimer>
 #include "helpers.h"
 #include "logger.h"
+#include "thumbnailcache.h"
 #include "thumbnailerwindow.h"
 #include "ui_thumbnailerwindow.h"
 
@@ -23,9 +30,12 @@ constexpr int rhsPadding = pageMargin - thumbMargin;
 constexpr int emptySpace = pageMargin + rhsPadding;
 constexpr int pageMarginSum = pageMargin * 2;
 constexpr int thumbShadow = 4;
-constexpr int timerWaitMsec = 500;
+constexpr int seekTimeoutMsec = 5000;
 constexpr int osdFontSize = 12;
 constexpr int osdFontShadow = 2;
+constexpr int maxInstances = 8;
+constexpr char batchSuffix[] = "_thumbs.jpg";
+constexpr int batchJobTimeoutMsec = 180000;
 
 ThumbnailerWindow::ThumbnailerWindow(QWidget *parent) :
     QWidget(parent),
@@ -111,6 +121,11 @@ void ThumbnailerWindow::begin()
 
 }
 
+static double safeDiv(double u, double v)
+{
+    return std::max(1.0,u) / std::max(1.0,v);
+}
+
 MpvThumbnailer::MpvThumbnailer(QObject *parent)
     : QObject(parent)
 {
@@ -124,19 +139,64 @@ MpvThumbnailer::~MpvThumbnailer()
 
 void MpvThumbnailer::execute(const MpvThumbnailer::Params &p)
 {
-    if (thumbState != AvailableState) {
+    if (!instances.isEmpty()) {
         Logger::log(logModule, "tried to start with an already started thumbnailer");
         return;
     }
-    thumbState = StartedState;
 
-    initPlayer();
-    LogStream(logModule) << "starting thumbnailing process for " << p.sourceUrl;
     this->p = p;
+    if (useCachedSheet())
+        return;
+
+    LogStream(logModule) << "starting thumbnailing process for " << p.sourceUrl;
     pendingPts.clear();
     processedPts.clear();
+    thumbCount = std::max(1, p.rows * p.cols);
+    // Every instance now also renders its frames in software, so split the
+    // cores between them rather than letting each one take them all.
+    decoderThreads = p.threads > 0 ? p.threads
+                                   : std::max(1, QThread::idealThreadCount() / instanceCount(thumbCount));
+    mpvDuration = -1;
+    mpvFileSize = 0;
+    mpvVideoSize = {-1,-1};
+    thumbSize = QSize();
+
+    // The first instance also tells us about the file itself.
+    Instance *primary = initPlayer();
+    connect(primary->mpv, &MpvObject::fileSizeChanged,
+            this, &MpvThumbnailer::mpv_fileSizeChanged);
+    connect(primary->mpv, &MpvObject::playLengthChanged,
+            this, &MpvThumbnailer::mpv_playLengthChanged);
+    startPlayer(primary);
+    emit progress(0);
+}
 
-    emit mpv->ctrlSetOptionVariant("profile", "gpu-hq");
+MpvThumbnailer::Instance *MpvThumbnailer::initPlayer()
+{
+    Instance *inst = new Instance;
+    inst->mpv = new MpvObject(this, friendlyName, MpvObject::HelperRole);
+    inst->drawer = new MpvSwWidget(inst->mpv);
+    inst->mpv->setWidgetType(Helpers::CustomWidget, inst->drawer);
+    connect(inst->mpv, &MpvObject::playbackFinished,
+            this, [this, inst]() { mpv_playbackFinished(inst); });
+    connect(inst->mpv, &MpvObject::eofReachedChanged,
+            this, [this, inst]() { mpv_eofReachedChanged(inst); });
+    connect(inst->mpv, &MpvObject::playTimeChanged,
+            this, [this, inst](double time) { mpv_playTimeChanged(inst, time); });
+    connect(inst->mpv, &MpvObject::playbackRestarted,
+            this, [this, inst]() { mpv_playbackRestarted(inst); });
+    connect(inst->mpv, &MpvObject::videoSizeChanged,
+            this, [this, inst](QSize size) { mpv_videoSizeChanged(inst, size); });
+    if (thumbSize.isValid())
+        resizeDrawer(inst);
+    instances.append(inst);
+    return inst;
+}
+
+void MpvThumbnailer::startPlayer(Instance *inst)
+{
+    inst->state = StartedState;
+    MpvObject *mpv = inst->mpv;
     emit mpv->ctrlSetOptionVariant("blend-subtitles", "video");
     emit mpv->ctrlSetOptionVariant("sub-visibility", "no");
     emit mpv->ctrlSetOptionVariant("osd-align-x", "right");
@@ -149,46 +209,46 @@ void MpvThumbnailer::execute(const MpvThumbnailer::Params &p)
     emit mpv->ctrlSetOptionVariant("ao-null-untimed", "yes");
     emit mpv->ctrlSetOptionVariant("untimed", "yes");
     emit mpv->ctrlSetOptionVariant("fps", 200);
+    emit mpv->ctrlSetOptionVariant("vd-lavc-threads", decoderThreads);
     mpv->urlOpen(p.sourceUrl);
     mpv->setPaused(true);
-    emit progress(0);
 }
 
-void MpvThumbnailer::initPlayer()
+void MpvThumbnailer::deinitPlayer()
 {
-    mpv = new MpvObject(this, friendlyName);
-    thumbnailer = new MpvThumbnailDrawer(mpv);
-    mpv->setWidgetType(Helpers::CustomWidget, thumbnailer);
-    connect(mpv, &MpvObject::fileSizeChanged,
-            this, &MpvThumbnailer::mpv_fileSizeChanged);
-    connect(mpv, &MpvObject::playbackFinished,
-            this, &MpvThumbnailer::mpv_playbackFinished);
-    connect(mpv, &MpvObject::eofReachedChanged,
-            this, &MpvThumbnailer::mpv_eofReachedChanged);
-    connect(mpv, &MpvObject::playLengthChanged,
-            this, &MpvThumbnailer::mpv_playLengthChanged);
-    connect(mpv, &MpvObject::playTimeChanged,
-            this, &MpvThumbnailer::mpv_playTimeChanged);
-    connect(mpv, &MpvObject::videoSizeChanged,
-            this, &MpvThumbnailer::mpv_videoSizeChanged);
-    thumbnailer->setAttribute(Qt::WA_DontShowOnScreen);
-    thumbnailer->show();
+    for (Instance *inst : std::as_const(instances)) {
+        inst->mpv->setWidgetType(Helpers::NullWidget);
+        delete inst->mpv;
+        delete inst;
+    }
+    instances.clear();
 }
 
-void MpvThumbnailer::deinitPlayer()
+int MpvThumbnailer::instanceCount(int thumbs) const
 {
-    if (!mpv)
-        return;
-    mpv->setWidgetType(Helpers::NullWidget);
-    thumbnailer = nullptr;
+    // Opening a remote stream several times over costs more than seeking
+    // it serially, so only spread local files across decoders.  Each mpv
+    // instance runs its own decoder threads, hence half the core count.
+    if (!p.sourceUrl.isLocalFile())
+        return 1;
+    int wanted = QThread::idealThreadCount() / 2;
+    if (p.decoders > 0)
+        wanted = std::min(wanted, p.decoders);
+    return std::clamp(wanted, 1, std::max(1, std::min(maxInstances, thumbs)));
+}
+
+void MpvThumbnailer::resizeDrawer(Instance *inst)
+{
+    inst->drawer->setOffscreenSize(thumbSize);
 
-    delete mpv;
-    mpv = nullptr;
+    // Set a consistent size for the osd message
+    double factor = safeDiv(mpvVideoSize.height(), thumbSize.height());
+    emit inst->mpv->ctrlSetOptionVariant("osd-font-size", int(osdFontSize * factor));
+    emit inst->mpv->ctrlSetOptionVariant("osd-border-size", int(osdFontShadow * factor));
 }
 
 void MpvThumbnailer::initThumbPts()
 {
-    int total = p.rows * p.cols;
     int index = 1;
     int dx = (p.imageWidth - emptySpace)/p.cols;
     int dy = thumbSize.height() + thumbMargin;
@@ -198,36 +258,75 @@ void MpvThumbnailer::initThumbPts()
     for (int r = 0; r < p.rows; r++) {
         for (int c = 0; c < p.cols; c++) {
             pendingPts.enqueue({c*dx, r*dy,
-                                (mpvDuration * index) / (total+1),
-                                index * 100 / total, index,
-                                QImage()});
+                                (mpvDuration * index) / (thumbCount+1),
+                                index, QImage()});
             index++;
         }
     }
 }
 
-void MpvThumbnailer::processThumb()
+void MpvThumbnailer::distributeThumbPts()
+{
+    // Hand out contiguous runs of timestamps, so that every decoder only
+    // ever seeks forwards.  The first instance is already open.
+    int count = instanceCount(pendingPts.count());
+    int total = pendingPts.count();
+    LogStream(logModule) << "using " << QString::number(count) << " decoder instance(s)";
+    for (int i = 0; i < count; i++) {
+        Instance *inst = i == 0 ? instances.first() : initPlayer();
+        int share = total / count + (i < total % count ? 1 : 0);
+        for (int j = 0; j < share; j++)
+            inst->pendingPts.enqueue(pendingPts.dequeue());
+        if (i > 0)
+            startPlayer(inst);
+    }
+}
+
+void MpvThumbnailer::beginThumbnailing(Instance *inst)
+{
+    if (inst == instances.first()) {
+        initThumbPts();
+        distributeThumbPts();
+    }
+    seekNextFrame(inst);
+}
+
+void MpvThumbnailer::processThumb(Instance *inst)
 {
-    if (pendingPts.isEmpty()) {
+    if (inst->pendingPts.isEmpty()) {
         Logger::log(logModule, "tried to process a thumb but there's nothing here");
         return;
     }
-    ThumbPts &front = pendingPts.front();
+    ThumbPts &front = inst->pendingPts.front();
+    int percent = (processedPts.count() + 1) * 100 / thumbCount;
     LogStream(logModule) << "Processing slide " << front.index
-                         << "(" << front.percent << "%)";
-    emit progress(front.percent);
-    front.thumb = thumbnailer->grabFramebuffer();
-    processedPts.enqueue(pendingPts.dequeue());
+                         << "(" << percent << "%)";
+    emit progress(percent);
+    // grabFrame renders afresh, so this picks up the frame mpv has just
+    // handed over rather than whatever was last painted.
+    front.thumb = inst->drawer->grabFrame();
+    processedPts.enqueue(inst->pendingPts.dequeue());
 }
 
-bool MpvThumbnailer::seekNextFrame()
+bool MpvThumbnailer::seekNextFrame(Instance *inst)
 {
-    if (pendingPts.isEmpty())
+    if (inst->pendingPts.isEmpty())
         return false;
-    LogStream(logModule) << "seeking to " << pendingPts.front().pts;
-    mpv->setTime(pendingPts.front().pts);
-    mpv->showMessage(Helpers::toDateFormatFixed(pendingPts.front().pts, osdTimeFormat));
-    thumbState = SeekingState;
+    double pts = inst->pendingPts.front().pts;
+    LogStream(logModule) << "seeking to " << pts;
+    inst->mpv->setTime(pts);
+    inst->mpv->showMessage(Helpers::toDateFormatFixed(pts, osdTimeFormat));
+    inst->state = SeekingState;
+
+    // Should mpv never report the seek as done, take whatever is there.
+    // The timer dies with the player if we finish in the meantime.
+    int serial = ++inst->seekSerial;
+    QTimer::singleShot(seekTimeoutMsec, inst->mpv, [this, inst, serial]() {
+        if (inst->state != SeekingState || inst->seekSerial != serial)
+            return;
+        Logger::log(logModule, "seek did not complete in time, grabbing the frame anyway");
+        captureFrame(inst);
+    });
     return true;
 }
 
@@ -291,9 +390,41 @@ void MpvThumbnailer::renderImage()
 void MpvThumbnailer::saveImage()
 {
     LogStream(logModule) << "saving thumbnails to " << p.imageFile;
-    if (!render.save(p.imageFile, nullptr, p.jpegQuality))
+    if (!render.save(p.imageFile, nullptr, p.jpegQuality)) {
         Logger::log(logModule, "file was not saved. Is the filename correct?");
+        render.detach();
+        return;
+    }
     render.detach();
+
+    QFile saved(p.imageFile);
+    if (saved.open(QIODevice::ReadOnly))
+        ThumbnailCache::singleton()->storeData(p.sourceUrl, sheetKey(), saved.readAll());
+}
+
+QString MpvThumbnailer::sheetKey() const
+{
+    // Everything that changes the resulting file, bar the media itself
+    return QString("sheet:%1x%2:%3:%4:%5").arg(QString::number(p.cols),
+                                               QString::number(p.rows),
+                                               QString::number(p.imageWidth),
+                                               QString::number(p.jpegQuality),
+                                               QFileInfo(p.imageFile).suffix().toLower());
+}
+
+bool MpvThumbnailer::useCachedSheet()
+{
+    QByteArray data = ThumbnailCache::singleton()->fetchData(p.sourceUrl, sheetKey());
+    if (data.isEmpty())
+        return false;
+
+    QFile file(p.imageFile);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+        return false;
+    LogStream(logModule) << "saved cached thumbnails to " << p.imageFile;
+    emit progress(100);
+    emit finished();
+    return true;
 }
 
 void MpvThumbnailer::mpv_fileSizeChanged(int64_t bytes)
@@ -301,31 +432,24 @@ void MpvThumbnailer::mpv_fileSizeChanged(int64_t bytes)
     mpvFileSize = bytes;
 }
 
-void MpvThumbnailer::mpv_videoSizeChanged(QSize video)
+void MpvThumbnailer::mpv_videoSizeChanged(Instance *inst, QSize video)
 {
-    mpvVideoSize = video;
-    if (mpvVideoSize == QSize(-1,-1))
+    if (inst != instances.first() || video == QSize(-1,-1))
         return;
+    mpvVideoSize = video;
 
     // Resize thumbnail
-    auto safeDiv = [](double u, double v) { return std::max(1.0,u) / std::max(1.0,v); };
     double aRatio = safeDiv(video.width(), video.height());
     int availPx = (p.imageWidth - emptySpace)/p.cols - thumbMargin;
     int h = int(availPx / aRatio + 0.5);
     int w = int(h * aRatio + 0.5);
     thumbSize = QSize(w, h);
-    thumbnailer->resize(thumbSize);
+    resizeDrawer(inst);
 
-    // Set a consistent size for the osd message
-    double factor = safeDiv(mpvVideoSize.height(), h);
-    emit mpv->ctrlSetOptionVariant("osd-font-size", int(osdFontSize * factor));
-    emit mpv->ctrlSetOptionVariant("osd-border-size", int(osdFontShadow * factor));
-
-    if (thumbState == StaleState) {
+    if (inst->state == StaleState) {
         // video size was not valid at first navigation,
         // so initialize our stuff now.
-        initThumbPts();
-        seekNextFrame();
+        beginThumbnailing(inst);
     }
 }
 
@@ -336,168 +460,218 @@ void MpvThumbnailer::mpv_playLengthChanged(double length)
                                     : Helpers::ShortFormat;
 }
 
-void MpvThumbnailer::mpv_playTimeChanged(double time)
-{
-    // This function is called:
-    // * Once at file open with timestamp 0
-    // * Once per seek navigation with the requested time (sometimes)
-    // * Once with a msec accurate value (soon after seek navigation)
-    //
-    // Therefore when we get the seek navigation, the render pipeline may not
-    // have caught up and may be stale.  But we can't just ignore the first
-    // time change notification since that sometimes is skipped.  And there
-    // will be some file out there where our divided pts will line up with a
-    // msec exactly, so we can't just check if the pts is the same either.
-    // Therefore, we need to either use a longish timer to give time for
-    // frames to render (ha ha), or use some other potentionally more correct
-    // option.  Perhaps core-idle?  Patches welcome.
-    mpvTime = time;
+void MpvThumbnailer::mpv_playTimeChanged(Instance *inst, double time)
+{
+    // Only used to learn that the file was opened.  Time changes during a
+    // seek don't tell us whether the frame has been rendered yet; see
+    // mpv_playbackRestarted for that.
     if (time < 0) {
-        thumbState = AvailableState;
+        inst->state = AvailableState;
         return;
     }
 
-    if (thumbState == StartedState) {
-        if (mpvVideoSize == QSize(-1,-1)) {
-            thumbState = StaleState;
+    if (inst->state == StartedState) {
+        // Instances other than the first are made once the thumb size is
+        // known, so only the first one can go stale here.
+        if (!thumbSize.isValid()) {
+            inst->state = StaleState;
             return;
         }
-        initThumbPts();
-        seekNextFrame();
-        return;
-    }
-
-    if (thumbState == SeekingState) {
-        //Logger::log(logModule, "ignored the seek navigation");
-        thumbState = PlayingState;
-        //return;
+        beginThumbnailing(inst);
     }
+}
 
-    if (thumbState == PlayingState) {
-        thumbState = WaitingForTimer;
-        QTimer::singleShot(timerWaitMsec, this, &MpvThumbnailer::timer_navigateTick);
-    }
+void MpvThumbnailer::mpv_playbackRestarted(Instance *inst)
+{
+    // mpv restarts playback once the frame at the seek target has been
+    // handed to the renderer, so it can be grabbed straight away.  The
+    // restart after opening the file arrives before any seek and is ignored.
+    if (inst->state != SeekingState)
+        return;
+    captureFrame(inst);
 }
 
-void MpvThumbnailer::mpv_playbackFinished()
+void MpvThumbnailer::mpv_playbackFinished(Instance *inst)
 {
-    thumbState = FinishedState;
+    inst->state = FinishedState;
 }
 
-void MpvThumbnailer::mpv_eofReachedChanged()
+void MpvThumbnailer::mpv_eofReachedChanged(Instance *inst)
 {
-    if (thumbState != FinishedState)
+    if (inst->state != FinishedState)
         return;
+    for (Instance *other : std::as_const(instances))
+        if (other->state != FinishedState)
+            return;
     deinitPlayer();
-    thumbState = AvailableState;
     emit finished();
 }
 
-void MpvThumbnailer::timer_navigateTick()
+void MpvThumbnailer::captureFrame(Instance *inst)
 {
-    processThumb();
-    if (seekNextFrame())
+    processThumb(inst);
+    if (seekNextFrame(inst))
         return;
+    inst->state = DrainedState;
 
-    renderImage();
-    saveImage();
-    mpv->stopPlayback();
+    // This instance is done with its share.  The last one to finish puts
+    // the sheet together.
+    if (processedPts.count() >= thumbCount) {
+        renderImage();
+        saveImage();
+    }
+    inst->mpv->stopPlayback();
 }
 
 
 
-MpvThumbnailDrawer::MpvThumbnailDrawer(MpvObject *object)
-    : QOpenGLWidget(nullptr), MpvWidgetInterface(object)
+ThumbnailBatch::ThumbnailBatch(QObject *parent)
+    : QObject(parent)
 {
-    setWindowTitle(friendlyName);
-}
 
-MpvThumbnailDrawer::~MpvThumbnailDrawer()
-{
-    makeCurrent();
-    if (render) {
-        ctrl->destroyRenderContext(render);
-        render = nullptr;
-    }
-    doneCurrent();
 }
 
-void MpvThumbnailDrawer::setLogoUrl(const QString &filename)
+ThumbnailBatch::~ThumbnailBatch()
 {
-    Q_UNUSED(filename)
+    for (Job *job : std::as_const(running)) {
+        delete job->thumbnailer;
+        delete job;
+    }
+    running.clear();
 }
 
-void MpvThumbnailDrawer::setLogoBackground(const QColor &color)
+void ThumbnailBatch::execute(const ThumbnailBatch::Options &o)
 {
-    Q_UNUSED(color)
-}
+    this->o = o;
+    totalFiles = madeFiles = skippedFiles = failedFiles = 0;
 
-void MpvThumbnailDrawer::setDrawLogo(bool yes)
-{
-    Q_UNUSED(yes)
-}
+    // Every file gets a decoder of its own before any file gets a second
+    // one, as files run side by side scale better than seeks in one file.
+    int cores = std::max(1, QThread::idealThreadCount() / 2);
+    jobLimit = o.jobs > 0 ? o.jobs : cores;
+    decodersPerJob = std::max(1, cores / jobLimit);
 
-void MpvThumbnailDrawer::initializeGL()
-{
-#if MPV_CLIENT_API_VERSION < MPV_MAKE_VERSION(2,0)
-    mpv_opengl_init_params glInit { &MpvGlWidget::get_proc_address, this, nullptr };
-#else
-    mpv_opengl_init_params glInit { &MpvGlWidget::get_proc_address, this };
-#endif
-    mpv_render_param params[] {
-        { MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_OPENGL) },
-        { MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &glInit },
-        { MPV_RENDER_PARAM_INVALID, nullptr },
-    };
-    render = ctrl->createRenderContext(params);
-    mpv_render_context_set_update_callback(render, MpvThumbnailDrawer::render_update, this);
+    collectFiles();
+    printLine(QString("%1 media files found in %2, %3 at a time")
+              .arg(QString::number(totalFiles), o.directory, QString::number(jobLimit)));
+    batchClock.start();
+    active = true;
+    startJobs();
 }
 
-void MpvThumbnailDrawer::paintGL()
+void ThumbnailBatch::collectFiles()
 {
-    if (!render) {
-        Logger::log(logModule, "tried to draw a frame, but no renderer set");
-        return;
+    QStringList files;
+    QDirIterator it(o.directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString file = it.next();
+        if (Helpers::audioVideoFileExtensions.contains(it.fileInfo().suffix().toLower()))
+            files.append(file);
     }
-    int yes = 1; //true
-    mpv_opengl_fbo fbo { static_cast<int>(defaultFramebufferObject()), glWidth, glHeight, 0 };
-    mpv_render_param params[] {
-        { MPV_RENDER_PARAM_OPENGL_FBO, &fbo },
-        { MPV_RENDER_PARAM_FLIP_Y, &yes },
-        { MPV_RENDER_PARAM_INVALID, nullptr }
-    };
-    mpv_render_context_render(render, params);
-    emit renderedFrame();
-}
+    files.sort();
 
-void MpvThumbnailDrawer::resizeGL(int w, int h)
-{
-    qreal r = devicePixelRatioF();
-    glWidth = int(w * r);
-    glHeight = int(h * r);
+    pendingFiles.clear();
+    for (const QString &file : std::as_const(files))
+        pendingFiles.enqueue(file);
+    totalFiles = files.count();
 }
 
-void MpvThumbnailDrawer::alwaysUpdate()
+QString ThumbnailBatch::imageFileOf(const QString &sourceFile)
 {
-    makeCurrent();
-    paintGL();
-    context()->swapBuffers(context()->surface());
-    mpv_render_context_report_swap(render);
-    doneCurrent();
+    QFileInfo info(sourceFile);
+    return info.dir().filePath(info.completeBaseName() + batchSuffix);
 }
 
-void MpvThumbnailDrawer::render_update(void *ctx)
+bool ThumbnailBatch::isUpToDate(const QString &sourceFile, const QString &imageFile)
 {
-    QMetaObject::invokeMethod(reinterpret_cast<MpvThumbnailDrawer*>(ctx), "alwaysUpdate");
+    QFileInfo image(imageFile);
+    return image.exists() && image.size() > 0
+            && image.lastModified() >= QFileInfo(sourceFile).lastModified();
 }
 
-void MpvThumbnailDrawer::initMpv()
+void ThumbnailBatch::startJobs()
 {
+    while (running.count() < jobLimit && !pendingFiles.isEmpty()) {
+        QString sourceFile = pendingFiles.dequeue();
+        if (isUpToDate(sourceFile, imageFileOf(sourceFile))) {
+            skippedFiles++;
+            printLine(QString("skipped %1 (up to date)").arg(sourceFile));
+            continue;
+        }
+        startJob(sourceFile);
+    }
+    if (!active || !running.isEmpty())
+        return;
+    active = false;
+
+    double seconds = batchClock.nsecsElapsed() / 1e9;
+    int thumbs = madeFiles * o.cols * o.rows;
+    printLine(QString("%1 made, %2 skipped, %3 failed in %4s (%5 files/s, %6 thumbs/s)")
+              .arg(QString::number(madeFiles), QString::number(skippedFiles),
+                   QString::number(failedFiles), QString::number(seconds, 'f', 2),
+                   QString::number(madeFiles / std::max(seconds, 0.001), 'f', 2),
+                   QString::number(thumbs / std::max(seconds, 0.001), 'f', 1)));
+    emit finished(failedFiles);
+}
+
+void ThumbnailBatch::startJob(const QString &sourceFile)
+{
+    Job *job = new Job;
+    job->sourceFile = sourceFile;
+    job->imageFile = imageFileOf(sourceFile);
+    job->thumbnailer = new MpvThumbnailer(this);
+    running.append(job);
+
+    // A file which never produces a frame would otherwise hold its slot
+    // forever, so give up on it after a while.
+    job->watchdog = new QTimer(job->thumbnailer);
+    job->watchdog->setSingleShot(true);
+    connect(job->watchdog, &QTimer::timeout,
+            this, [this, job]() { finishJob(job, true); });
+    connect(job->thumbnailer, &MpvThumbnailer::finished,
+            this, [this, job]() { finishJob(job, false); });
 
+    MpvThumbnailer::Params p;
+    p.sourceUrl = QUrl::fromLocalFile(sourceFile);
+    p.imageFile = job->imageFile;
+    p.jpegQuality = o.jpegQuality;
+    p.imageWidth = o.imageWidth;
+    p.cols = o.cols;
+    p.rows = o.rows;
+    p.decoders = decodersPerJob;
+    p.threads = std::max(1, QThread::idealThreadCount() / (jobLimit * decodersPerJob));
+    job->clock.start();
+    job->watchdog->start(batchJobTimeoutMsec);
+    job->thumbnailer->execute(p);
+}
+
+void ThumbnailBatch::finishJob(Job *job, bool timedOut)
+{
+    // Nothing from this thumbnailer may reach us after this point.  It may
+    // also be in the middle of emitting, so it has to be deleted later.
+    job->watchdog->stop();
+    job->thumbnailer->disconnect(this);
+    job->thumbnailer->deleteLater();
+    running.removeOne(job);
+
+    double seconds = job->clock.nsecsElapsed() / 1e9;
+    bool made = !timedOut && isUpToDate(job->sourceFile, job->imageFile);
+    if (made)
+        madeFiles++;
+    else
+        failedFiles++;
+    printLine(QString("%1 %2 in %3s")
+              .arg(QString(made ? "made" : timedOut ? "timed out on" : "failed on"),
+                   job->imageFile, QString::number(seconds, 'f', 2)));
+    delete job;
+
+    // A cached sheet finishes from within execute, so don't recurse.
+    QMetaObject::invokeMethod(this, &ThumbnailBatch::startJobs, Qt::QueuedConnection);
+}
+
+void ThumbnailBatch::printLine(const QString &text)
+{
+    Logger::log(logModule, text);
+    std::fprintf(stdout, "%s\n", text.toLocal8Bit().constData());
+    std::fflush(stdout);
 }
-
-QWidget *MpvThumbnailDrawer::self()
-{
-    return this;
-}
-
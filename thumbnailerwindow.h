@@ -1,8 +1,8 @@
 #ifndef THUMBNAILERWINDOW_H
 #define THUMBNAILERWINDOW_H
 
+#include <QElapsedTimer>
 #include <QImage>
-#include <QOpenGLWidget>
 #include <QWidget>
 #include <QQueue>
 #include <QUrl>
@@ -11,8 +11,8 @@
 namespace Ui {
 class ThumbnailerWindow;
 }
-class MpvThumbnailDrawer;
 class MpvThumbnailer;
+class QTimer;
 
 class ThumbnailerWindow : public QWidget
 {
@@ -47,25 +47,35 @@ class MpvThumbnailer : public QObject {
         AvailableState, // Available for use
         StartedState,   // File opened
         StaleState,     // File opened, but no video size yet
-        SeekingState,   // Seek command sent
-        PlayingState,   // Playing video until frozen
-        WaitingForTimer, // Waiting for snapshot timer
+        SeekingState,   // Seek command sent, waiting for the new frame
+        DrainedState,   // All thumbs taken, waiting for playback to stop
         FinishedState   // Playback finished
     };
 
     struct ThumbPts {
         int x, y;
         double pts;
-        int percent, index;
+        int index;
         QImage thumb;
     };
 
+    // One decoder working through its share of the timestamps
+    struct Instance {
+        MpvObject *mpv = nullptr;
+        MpvSwWidget *drawer = nullptr;
+        ThumbnailingState state = AvailableState;
+        QQueue<ThumbPts> pendingPts;
+        int seekSerial = 0;
+    };
+
 public:
     struct Params {
         QUrl sourceUrl;
         QString imageFile;
         int jpegQuality, imageWidth;
         int cols, rows;
+        int decoders = 0;   // upper bound on mpv instances, 0 for automatic
+        int threads = 0;    // decoder threads per instance, 0 for automatic
     };
 
     explicit MpvThumbnailer(QObject *parent);
@@ -77,71 +87,102 @@ signals:
     void finished();
 
 private:
-    void initPlayer();
+    Instance *initPlayer();
+    void startPlayer(Instance *inst);
     void deinitPlayer();
+    int instanceCount(int thumbs) const;
+    void resizeDrawer(Instance *inst);
 
     void initThumbPts();
-    void processThumb();
-    bool seekNextFrame();
+    void distributeThumbPts();
+    void beginThumbnailing(Instance *inst);
+    void processThumb(Instance *inst);
+    bool seekNextFrame(Instance *inst);
     void renderImage();
     void saveImage();
+    QString sheetKey() const;
+    bool useCachedSheet();
+
+    // Per-instance handlers, connected through lambdas which supply inst
+    void mpv_videoSizeChanged(Instance *inst, QSize size);
+    void mpv_playTimeChanged(Instance *inst, double time);
+    void mpv_playbackRestarted(Instance *inst);
+    void mpv_playbackFinished(Instance *inst);
+    void mpv_eofReachedChanged(Instance *inst);
+    void captureFrame(Instance *inst);
 
 private slots:
     void mpv_fileSizeChanged(int64_t bytes);
-    void mpv_videoSizeChanged(QSize size);
     void mpv_playLengthChanged(double length);
-    void mpv_playTimeChanged(double time);
-    void mpv_playbackFinished();
-    void mpv_eofReachedChanged();
-    void timer_navigateTick();
 
 private:
     Params p;
-    MpvObject *mpv = nullptr;
-    MpvThumbnailDrawer *thumbnailer = nullptr;
+    QList<Instance*> instances;
 
-    ThumbnailingState thumbState = AvailableState;
-    double mpvTime = -1;
     double mpvDuration = -1;
     Helpers::TimeFormat osdTimeFormat = Helpers::ShortFormat;
     int64_t mpvFileSize = 0;
     QSize mpvVideoSize = {-1,-1};
     QQueue<ThumbPts> pendingPts;
     QQueue<ThumbPts> processedPts;
+    int thumbCount = 0;
+    int decoderThreads = 0;
     QImage render;
     QSize thumbSize;
 };
 
 
-class MpvThumbnailDrawer : public QOpenGLWidget, public MpvWidgetInterface {
+
+// Thumbnails every media file below a directory, several files at a time,
+// for the --thumbnails command line mode.
+class ThumbnailBatch : public QObject {
     Q_OBJECT
-    Q_INTERFACES(MpvWidgetInterface)
+
+    struct Job {
+        MpvThumbnailer *thumbnailer = nullptr;
+        QTimer *watchdog = nullptr;
+        QString sourceFile;
+        QString imageFile;
+        QElapsedTimer clock;
+    };
 
 public:
-    explicit MpvThumbnailDrawer(MpvObject *object);
-    ~MpvThumbnailDrawer();
+    struct Options {
+        QString directory;
+        int jpegQuality = 97;
+        int imageWidth = 800;
+        int cols = 4, rows = 4;
+        int jobs = 0;       // files thumbnailed at once, 0 for automatic
+    };
 
-    QWidget *self();
-    void initMpv();
-    void setLogoUrl(const QString &filename);
-    void setLogoBackground(const QColor &color);
-    void setDrawLogo(bool yes);
+    explicit ThumbnailBatch(QObject *parent = nullptr);
+    ~ThumbnailBatch();
+    void execute(const Options &o);
 
 signals:
-    void renderedFrame();
-
-protected:
-    void initializeGL();
-    void paintGL();
-    void resizeGL(int w, int h);
-
-private slots:
-    void alwaysUpdate();
+    void finished(int failures);
 
 private:
-    static void render_update(void *ctx);
-    mpv_render_context *render = nullptr;
-    int glWidth, glHeight;
+    void collectFiles();
+    void startJobs();
+    void startJob(const QString &sourceFile);
+    void finishJob(Job *job, bool timedOut);
+    void printLine(const QString &text);
+    static QString imageFileOf(const QString &sourceFile);
+    static bool isUpToDate(const QString &sourceFile, const QString &imageFile);
+
+    Options o;
+    int jobLimit = 1;
+    int decodersPerJob = 1;
+    QQueue<QString> pendingFiles;
+    QList<Job*> running;
+    QElapsedTimer batchClock;
+    bool active = false;
+    int totalFiles = 0;
+    int madeFiles = 0;
+    int skippedFiles = 0;
+    int failedFiles = 0;
 };
 
+
 #endif // THUMBNAILERWINDOW_H
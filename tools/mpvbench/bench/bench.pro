@@ -0,0 +1,18 @@
+# Runs mpc-qt against the stand-in libmpv and reports what it measured.
+
+QT = core network
+
+TARGET = mpvbench
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -Wall
+
+unix {
+    DESTDIR = ../bin
+    OBJECTS_DIR = .obj
+    MOC_DIR = .moc
+}
+
+SOURCES += main.cpp
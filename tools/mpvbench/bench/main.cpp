@@ -0,0 +1,238 @@
+// mpvbench starts mpc-qt with the stand-in libmpv preloaded, lets it replay
+// a script of events for a while, and then asks the player over its ipc
+// socket how well it kept up.  The player runs in a scratch environment so
+// that it neither reads nor touches the user's settings.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+
+constexpr char socketName[] = "cmdrkotori.mpc-qt";
+constexpr char mockLibrary[] = "libmockmpv.so";
+constexpr int startupTimeoutMsec = 30000;
+
+static QTextStream out(stdout);
+static QTextStream err(stderr);
+
+// Sends one ipc command and waits for its reply.  The player answers each
+// command on its own connection.
+static bool ipcCall(const QString &socketPath, const QVariantMap &request,
+                    QVariant *value = nullptr)
+{
+    QLocalSocket socket;
+    socket.connectToServer(socketPath);
+    if (!socket.waitForConnected(1000))
+        return false;
+    socket.write(QJsonDocument::fromVariant(request).toJson(QJsonDocument::Compact).append('\n'));
+    socket.flush();
+    QByteArray reply;
+    while (!reply.contains('\n') && socket.waitForReadyRead(5000))
+        reply += socket.readAll();
+    reply += socket.readAll();
+    QVariantMap map = QJsonDocument::fromJson(reply.trimmed()).toVariant().toMap();
+    if (map.value("code").toString() != "ok")
+        return false;
+    if (value)
+        *value = map.value("value");
+    return true;
+}
+
+// Memory figures from /proc, in kilobytes.
+static QVariantMap processMemory(qint64 pid)
+{
+    QVariantMap memory;
+    QFile status(QString("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly))
+        return memory;
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith("VmRSS:") || line.startsWith("VmHWM:")) {
+            QList<QByteArray> parts = line.simplified().split(' ');
+            if (parts.size() >= 2)
+                memory[QString::fromUtf8(parts[0]).chopped(1)] = parts[1].toLongLong();
+        }
+    }
+    return memory;
+}
+
+static void wait(int msec)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msec, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static void printDrainStats(const QVariantMap &drain, double seconds)
+{
+    out << "mpv event drain\n";
+    out << QString("  %1 wakeups, %2 drains (%3 sliced), %4 events, %5 events/s\n")
+           .arg(drain["wakeups"].toULongLong()).arg(drain["drains"].toULongLong())
+           .arg(drain["slicedDrains"].toULongLong()).arg(drain["events"].toULongLong())
+           .arg(seconds > 0 ? drain["events"].toDouble() / seconds : 0.0, 0, 'f', 0);
+    out << QString("  events per drain: %1 average, %2 max\n")
+           .arg(drain["averageEventsPerDrain"].toDouble(), 0, 'f', 2)
+           .arg(drain["maxEventsPerDrain"].toInt());
+    out << QString("  wakeup to drain: %1 us average, %2 us max; longest drain %3 us; "
+                   "time slice %4 ms\n")
+           .arg(drain["averageLatencyUsec"].toLongLong())
+           .arg(drain["maxLatencyUsec"].toLongLong())
+           .arg(drain["maxDrainUsec"].toLongLong())
+           .arg(drain["timeSliceMsec"].toInt());
+}
+
+static void printLatencyStats(const QVariantMap &latency)
+{
+    out << "gui dispatch (us)\n";
+    out << QString("  %1 %2 %3 %4 %5 %6\n")
+           .arg("class", -24).arg("stage", -8).arg("count", 9)
+           .arg("p50", 9).arg("p99", 9).arg("max", 9);
+    for (auto it = latency.cbegin(); it != latency.cend(); it++) {
+        QVariantMap stages = it.value().toMap();
+        for (auto st = stages.cbegin(); st != stages.cend(); st++) {
+            QVariantMap h = st.value().toMap();
+            out << QString("  %1 %2 %3 %4 %5 %6\n")
+                   .arg(it.key(), -24).arg(st.key(), -8)
+                   .arg(h["count"].toLongLong(), 9)
+                   .arg(h["p50Usec"].toLongLong(), 9)
+                   .arg(h["p99Usec"].toLongLong(), 9)
+                   .arg(h["maxUsec"].toLongLong(), 9);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mpvbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure how mpc-qt copes with a scripted stream of mpv events.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("script", "Event script for the stand-in libmpv.");
+    QCommandLineOption playerOpt("player", "The mpc-qt binary to run.", "path", "mpc-qt");
+    QCommandLineOption mockOpt("mock", "The stand-in libmpv to preload.", "path",
+                               QDir(QCoreApplication::applicationDirPath()).filePath(mockLibrary));
+    QCommandLineOption secondsOpt("seconds", "How long to measure for.", "n", "10");
+    QCommandLineOption sliceOpt("time-slice", "Drain time slice to use, in milliseconds.", "msec");
+    QCommandLineOption jsonOpt("json", "Print the raw figures as json.");
+    parser.addOption(playerOpt);
+    parser.addOption(mockOpt);
+    parser.addOption(secondsOpt);
+    parser.addOption(sliceOpt);
+    parser.addOption(jsonOpt);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+    QString script = QFileInfo(parser.positionalArguments().first()).absoluteFilePath();
+    QString mock = QFileInfo(parser.value(mockOpt)).absoluteFilePath();
+    if (!QFileInfo::exists(script) || !QFileInfo::exists(mock)) {
+        err << "mpvbench: script or stand-in library not found\n";
+        return 1;
+    }
+
+    QTemporaryDir scratch;
+    if (!scratch.isValid()) {
+        err << "mpvbench: could not make a scratch directory\n";
+        return 1;
+    }
+    QDir scratchDir(scratch.path());
+    for (const char *dir : { "tmp", "config", "data", "cache" })
+        scratchDir.mkpath(dir);
+
+    // A private temp directory also gives the player a private ipc socket,
+    // so a running mpc-qt is left alone.
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    QString preload = env.value("LD_PRELOAD");
+    env.insert("LD_PRELOAD", preload.isEmpty() ? mock : mock + ":" + preload);
+    env.insert("MOCKMPV_SCRIPT", script);
+    env.insert("TMPDIR", scratchDir.filePath("tmp"));
+    env.insert("XDG_CONFIG_HOME", scratchDir.filePath("config"));
+    env.insert("XDG_DATA_HOME", scratchDir.filePath("data"));
+    env.insert("XDG_CACHE_HOME", scratchDir.filePath("cache"));
+    QString socketPath = QDir(scratchDir.filePath("tmp")).filePath(socketName);
+
+    QProcess player;
+    QStringList mockLines;
+    QByteArray stderrTail;
+    player.setProcessEnvironment(env);
+    player.setStandardOutputFile(QProcess::nullDevice());
+    // Keep only what the stand-in library reports, but do keep reading, so
+    // that a chatty player never stalls on a full pipe.
+    QObject::connect(&player, &QProcess::readyReadStandardError, [&]() {
+        stderrTail += player.readAllStandardError();
+        qsizetype end;
+        while ((end = stderrTail.indexOf('\n')) >= 0) {
+            QByteArray line = stderrTail.left(end);
+            stderrTail.remove(0, end + 1);
+            if (line.startsWith("mockmpv:"))
+                mockLines << QString::fromUtf8(line);
+        }
+    });
+    player.start(parser.value(playerOpt), { "--no-config", "--no-files" });
+    if (!player.waitForStarted()) {
+        err << "mpvbench: could not start " << parser.value(playerOpt) << "\n";
+        return 1;
+    }
+
+    QElapsedTimer startup;
+    startup.start();
+    while (!ipcCall(socketPath, { { "command", "getDrainStats" }, { "reset", true } })) {
+        if (player.state() != QProcess::Running || startup.elapsed() > startupTimeoutMsec) {
+            err << "mpvbench: the player did not come up\n";
+            player.kill();
+            return 1;
+        }
+        wait(100);
+    }
+    out << "player up after " << startup.elapsed() << " ms\n";
+    if (parser.isSet(sliceOpt))
+        ipcCall(socketPath, { { "command", "setDrainTimeSlice" },
+                              { "value", parser.value(sliceOpt).toInt() } });
+    ipcCall(socketPath, { { "command", "getLatencyStats" }, { "reset", true } });
+
+    QElapsedTimer measured;
+    measured.start();
+    wait(parser.value(secondsOpt).toInt() * 1000);
+    double seconds = measured.elapsed() / 1000.0;
+
+    QVariant drain, latency;
+    bool ok = ipcCall(socketPath, { { "command", "getDrainStats" } }, &drain)
+              && ipcCall(socketPath, { { "command", "getLatencyStats" } }, &latency);
+    QVariantMap memory = processMemory(player.processId());
+
+    player.terminate();
+    if (!player.waitForFinished(10000))
+        player.kill();
+    player.waitForFinished();
+
+    if (!ok) {
+        err << "mpvbench: could not read the player's statistics\n";
+        return 1;
+    }
+    if (parser.isSet(jsonOpt)) {
+        QVariantMap all {
+            { "seconds", seconds }, { "drain", drain },
+            { "latency", latency }, { "memory", memory }
+        };
+        out << QJsonDocument::fromVariant(all).toJson();
+        return 0;
+    }
+    out << QString("measured for %1 s\n").arg(seconds, 0, 'f', 2);
+    printDrainStats(drain.toMap(), seconds);
+    printLatencyStats(latency.toMap());
+    out << QString("memory: %1 kB resident, %2 kB peak\n")
+           .arg(memory.value("VmRSS").toLongLong()).arg(memory.value("VmHWM").toLongLong());
+    for (const QString &line : std::as_const(mockLines))
+        out << line << "\n";
+    return 0;
+}
@@ -0,0 +1,27 @@
+# Times the display and file name format parsers against the ones they
+# replaced.  Built with the rest of mpvbench, and not part of the player.
+
+QT = core gui widgets openglwidgets concurrent
+
+TARGET = formatbench
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -Wall
+
+unix {
+    DESTDIR = ../bin
+    OBJECTS_DIR = .obj
+    MOC_DIR = .moc
+}
+
+INCLUDEPATH += ../../..
+
+SOURCES += main.cpp \
+    legacyformat.cpp \
+    platformstub.cpp \
+    ../../../helpers.cpp
+
+HEADERS += legacyformat.h \
+    ../../../helpers.h
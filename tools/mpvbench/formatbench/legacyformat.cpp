@@ -0,0 +1,409 @@
+// The display and file name format parsers as they were before they were
+// compiled into op lists, kept here only so that the benchmark has
+// something to compare against.  Do not fix bugs here.
+
+#include <QDateTime>
+#include <QFileInfo>
+#include "legacyformat.h"
+
+namespace Legacy {
+
+static QString grabBrackets(QString source, int &position, int &length) {
+    QString match;
+    QChar c;
+    enum MatchMode { Bracket, Inside, Finish };
+    MatchMode mm = Bracket;
+    while (mm != Finish && position < length) {
+        c = source.at(position);
+        if (mm == Bracket) {
+            if (c != '{') {
+                position--;
+                mm = Finish;
+            } else {
+                mm = Inside;
+            }
+            ++position;
+        } else if (mm == Inside) {
+            if (c != '}')
+                match.append(c);
+            else
+                mm = Finish;
+            ++position;
+        }
+    }
+    return match;
+}
+
+
+
+QString parseFormat(QString fmt, QString fileName,
+                    Helpers::DisabledTrack disabled,
+                    Helpers::Subtitles subtitles, double timeNav,
+                    double timeBegin, double timeEnd)
+{
+    // convenient format parsing
+    struct TimeParse {
+        TimeParse(double time) {
+            this->time = time;
+            int t = int(time*1000 + 0.5);
+            hr = t/3600000;
+            mn = t/60000 % 60;
+            se = t%60000 / 1000;
+            fr = t % 1000;
+        }
+        QString toString(QChar fmt) {
+            switch (fmt.unicode()) {
+            case 'p':
+                return QString("%1:%2:%3")
+                        .arg(QString::number(hr),2,'0')
+                        .arg(QString::number(mn),2,'0')
+                        .arg(QString::number(se),2,'0');
+            case 'P':
+                return QString("%1:%2:%3.%4")
+                        .arg(QString::number(hr),2,'0')
+                        .arg(QString::number(mn),2,'0')
+                        .arg(QString::number(se),2,'0')
+                        .arg(QString::number(fr),3,'0');
+            case 'H':
+                return QString("%1").arg(QString::number(hr),2,'0');
+            case 'M':
+                return QString("%1").arg(QString::number(mn),2,'0');
+            case 'S':
+                return QString("%1").arg(QString::number(se),2,'0');
+            case 'T':
+                return QString("%1").arg(QString::number(fr),3,'0');
+            case 'h':
+                return QString::number(hr);
+            case 'm':
+                return QString::number(int(time)/60);
+            case 's':
+                return QString::number(int(time));
+            case 'f':
+                return QString::number(time,'f');
+            }
+            return fmt;
+        }
+        double time;
+        int hr, mn, se, fr;
+    };
+
+    QString fileNameNoExt = QFileInfo(fileName).completeBaseName();
+    TimeParse nav(timeNav), begin(timeBegin), end(timeEnd);
+    QDateTime currentTime = QDateTime::currentDateTime();
+    QString output;
+    int length = fmt.length();
+    int position = 0;
+
+    // grab a {}{} pair from the format string
+    auto grabPair = [&position, &length](QString source) {
+        QString p1 = grabBrackets(source, position, length);
+        QString p2 = grabBrackets(source, position, length);
+        return QStringList({p1, p2});
+    };
+
+    QStringList pairs;
+    while (position < length) {
+        QChar c = fmt.at(position);
+        if (c == '%') {
+            position++;
+            if (position >= length)
+                break;
+            c = fmt.at(position);
+            switch (c.unicode()) {
+            case 'f':
+                ++position;
+                output += fileName;
+                break;
+            case 'F':
+                ++position;
+                output += fileNameNoExt;
+                break;
+            case 's':
+                ++position;
+                pairs = grabPair(fmt);
+                if (subtitles == Helpers::SubtitlesPresent)
+                    output.append(pairs[0]);
+                if (subtitles == Helpers::SubtitlesDisabled)
+                    output.append(pairs[1]);
+                break;
+            case 'd':
+                ++position;
+                pairs = grabPair(fmt);
+                if (disabled == Helpers::DisabledAudio)
+                    output.append(pairs[0]);
+                if (disabled == Helpers::DisabledVideo)
+                    output.append(pairs[1]);
+                break;
+            case 't':
+                ++position;
+                output.append(currentTime.toString(grabBrackets(fmt, position, length)));
+                break;
+            case 'a':
+                if (++position < length)
+                    output.append(begin.toString(fmt.at(position)));
+                ++position;
+                break;
+            case 'b':
+                if (++position < length)
+                    output.append(end.toString(fmt.at(position)));
+                ++position;
+                break;
+            case 'w':
+                if (++position < length)
+                    output.append(nav.toString(fmt.at(position)));
+                ++position;
+                break;
+            case '%':
+                output.append('%');
+                ++position;
+                break;
+            default:
+                output.append(c);
+                ++position;
+                // %n unimplemented (look at mpv source code?)
+            }
+        } else {
+            output.append(c);
+            position++;
+        }
+    }
+    return output;
+}
+
+
+
+
+// For the sake of optimizing 0.0001% of execution time, let's create a
+// tree out of the format string, so we don't need to do string operations
+// all the time other than those we need to.
+class DisplayNode {
+public:
+    enum NodeType { NullNode, PlainText, Trie, Property, DisplayName };
+    DisplayNode() { }
+    ~DisplayNode() {
+        empty();
+        if (next)
+            delete next;
+        next = nullptr;
+    }
+
+    bool isNull() {
+        return type == NullNode;
+    }
+
+    DisplayNode *nextNode() { return next; }
+
+    void setPlainText(QString text) {
+        empty();
+        data = text;
+        type = PlainText;
+    }
+
+    void setDisplayName() {
+        empty();
+        type = DisplayName;
+    }
+
+    void setActualProperty(QString text) {
+        empty();
+        type = Property;
+        data = text;
+    }
+
+    void setNodeTrie(QString propertyName, DisplayNode *tag,
+                     DisplayNode *audio, DisplayNode *video) {
+        empty();
+        type = Trie;
+        data = propertyName;
+        tagNode = tag;
+        audioNode = audio;
+        videoNode = video;
+    }
+
+    void appendNode(DisplayNode *next) {
+        if (this->next)
+            delete this->next;
+        this->next = next;
+    }
+
+    void empty() {
+        if (tagNode)    { delete tagNode;   tagNode = nullptr; }
+        if (audioNode)  { delete audioNode; audioNode = nullptr; }
+        if (videoNode)  { delete videoNode; videoNode = nullptr; }
+    }
+
+    QString output(const QVariantMap &metaData, const QString &displayString,
+                   const Helpers::FileType fileType) {
+        QString t;
+        switch (type) {
+        case NullNode:
+            break;
+        case PlainText:
+            t += data;
+            break;
+        case Trie:
+            if (metaData.contains(data) && tagNode) {
+                t += tagNode->output(metaData, displayString, fileType);
+            } else if (fileType == Helpers::AudioFile && audioNode) {
+                t += audioNode->output(metaData, displayString, fileType);
+            } else if (videoNode) {
+                t += videoNode->output(metaData, displayString, fileType);
+            }
+            break;
+        case Property:
+            if (metaData.contains(data)) {
+                t += metaData[data].toString();
+            }
+            break;
+        case DisplayName:
+            t += displayString;
+            break;
+        }
+        if (next)
+            t += next->output(metaData, displayString, fileType);
+        return t;
+    }
+
+private:
+    DisplayNode *tagNode = nullptr;
+    DisplayNode *audioNode = nullptr;
+    DisplayNode *videoNode = nullptr;
+    DisplayNode *next = nullptr;
+    QString data;
+    NodeType type = NullNode;
+};
+
+
+
+DisplayParser::DisplayParser()
+{
+
+}
+
+DisplayParser::~DisplayParser()
+{
+    if (node) { delete node; node = nullptr; }
+}
+
+void DisplayParser::takeFormatString(QString fmt)
+{
+    int length = fmt.length();
+    int position = 0;
+
+    // grab a {}{}{} tuple from the format string
+    auto grabTuple = [&position, &length](QString source) {
+        QString p1 = grabBrackets(source, position, length);
+        QString p2 = grabBrackets(source, position, length);
+        QString p3 = grabBrackets(source, position, length);
+        return QStringList({p1, p2, p3});
+    };
+
+    // grab the text between % and {
+    auto grabProp = [&position](QString source) {
+        int run = source.indexOf(QChar('{'), position) - position;
+        if (run >= 0) {
+            QString ret = source.mid(position, run);
+            position += run;
+            return ret;
+        }
+        return QString();
+    };
+
+    // dump whatever data may have been gathered up to this point
+    auto dumpGatheredData = [](QString &gathered, DisplayNode* &current,
+            bool final = false) {
+        if (!gathered.isEmpty()) {
+            current->setPlainText(gathered);
+            if (!final) {
+                current->appendNode(new DisplayNode);
+                current = current->nextNode();
+                gathered.clear();
+            }
+        }
+    };
+
+    // convert text inside {} to a node
+    auto nodeInnerChars = [dumpGatheredData](QString text, QString propertyValue) {
+        DisplayNode *first = new DisplayNode;
+        DisplayNode *current = first;
+        QString gathered;
+        QChar c;
+        int length = text.length();
+        int position = 0;
+        while (position < length) {
+            c = text.at(position);
+            position++;
+            if (c == '#') {
+                if (position < length && text.at(position)=='#') {
+                    gathered += '#';
+                    position++;
+                } else {
+                    dumpGatheredData(gathered, current);
+                    current->setActualProperty(propertyValue);
+                    current->appendNode(new DisplayNode);
+                    current = current->nextNode();
+                }
+            } else if (c == '$') {
+                if (position < length && text.at(position)=='$') {
+                    gathered += '$';
+                    position++;
+                } else {
+                    dumpGatheredData(gathered, current);
+                    current->setDisplayName();
+                    current->appendNode(new DisplayNode);
+                    current = current->nextNode();
+                }
+            } else {
+                gathered += c;
+            }
+        }
+        dumpGatheredData(gathered, current, true);
+        return first;
+    };
+
+    if (node)
+        delete node;
+    node = new DisplayNode;
+
+    DisplayNode *current = node;
+    QString prop;
+    QStringList tuple;
+    QString gathered;
+    while (position < length) {
+        QChar c = fmt.at(position++);
+        if (c == '%') {
+            if (position < length && fmt.at(position)=='%') {
+                gathered += '%';
+                continue;
+            }
+            dumpGatheredData(gathered, current);
+            prop = grabProp(fmt);
+            if (prop.isEmpty())
+                continue;
+            tuple = grabTuple(fmt);
+            current->setNodeTrie(prop, nodeInnerChars(tuple[0], prop),
+                                 nodeInnerChars(tuple[1], prop),
+                                 nodeInnerChars(tuple[2], prop));
+            current->appendNode(new DisplayNode);
+            current = current->nextNode();
+        } else {
+            gathered += c;
+        }
+    }
+    dumpGatheredData(gathered, current, true);
+}
+
+QString DisplayParser::parseMetadata(QVariantMap metaData,
+                                     QString displayString,
+                                     Helpers::FileType fileType)
+{
+    if (metaData.isEmpty()) {
+        return displayString;
+    } else {
+        if (!metaData.contains("title"))
+            metaData["title"] = displayString;
+        return node->output(metaData, displayString, fileType);
+    }
+}
+
+} // namespace Legacy
@@ -0,0 +1,29 @@
+#ifndef LEGACYFORMAT_H
+#define LEGACYFORMAT_H
+
+#include <QString>
+#include <QVariantMap>
+#include "helpers.h"
+
+// The format parsers from before they were compiled, for comparison.
+namespace Legacy {
+    QString parseFormat(QString fmt, QString fileName,
+                        Helpers::DisabledTrack disabled,
+                        Helpers::Subtitles subtitles, double timeNav,
+                        double timeBegin, double timeEnd);
+
+    class DisplayNode;
+    class DisplayParser {
+    public:
+        DisplayParser();
+        ~DisplayParser();
+
+        void takeFormatString(QString fmt);
+        QString parseMetadata(QVariantMap metaData, QString displayString,
+                              Helpers::FileType fileType);
+    private:
+        DisplayNode *node = nullptr;
+    };
+}
+
+#endif // LEGACYFORMAT_H
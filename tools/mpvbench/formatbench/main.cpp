@@ -0,0 +1,143 @@
+// formatbench times the playlist display format and the screenshot file
+// name templates, once with the parsers in helpers.cpp and once with the
+// ones they replaced.  Both are first checked to give the same text.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "helpers.h"
+#include "legacyformat.h"
+
+constexpr char displayFormat[] = "%artist{# - }{Unknown Artist - }{}%title{#}{$}{$}";
+// The date is left out of the checked template, as it may change between
+// the two runs.  The timed template is the default screenshot one.
+constexpr char checkedFileFormat[] = "%f_snapshot_%wP_%s{_subs}%d{_novideo}{_noaudio}";
+constexpr char timedFileFormat[] = "%f_snapshot_%wP_[%t{yyyy.MM.dd_hh.mm.ss}]%s{_subs}";
+constexpr int rowCount = 1000;
+
+static QTextStream out(stdout);
+static QTextStream err(stderr);
+
+// Kept so that the compiler cannot drop the work being timed.
+static qsizetype sink = 0;
+
+// Rows like a playlist's: most fully tagged, some with a title only, and
+// some not probed yet.
+static QList<QVariantMap> makeRows()
+{
+    QList<QVariantMap> rows;
+    rows.reserve(rowCount);
+    for (int i = 0; i < rowCount; i++) {
+        QVariantMap row;
+        if (i % 10 < 7) {
+            row.insert("artist", QString("Artist %1").arg(i % 37));
+            row.insert("album", QString("Album %1").arg(i % 91));
+            row.insert("title", QString("Track title number %1").arg(i));
+            row.insert("duration", 180.0 + i);
+        } else if (i % 10 < 9) {
+            row.insert("title", QString("Untagged track %1").arg(i));
+        }
+        rows.append(row);
+    }
+    return rows;
+}
+
+static QString displayName(int i)
+{
+    return QString("%1 - some file name.flac").arg(i);
+}
+
+template <class F>
+static double nsecPerCall(int iterations, F call)
+{
+    QElapsedTimer clock;
+    clock.start();
+    for (int i = 0; i < iterations; i++)
+        call(i);
+    return double(clock.nsecsElapsed()) / iterations;
+}
+
+static void printResult(const QString &name, double legacy, double compiled)
+{
+    out << QString("  %1 %2 %3 %4x\n")
+           .arg(name, -12)
+           .arg(legacy, 10, 'f', 0)
+           .arg(compiled, 10, 'f', 0)
+           .arg(compiled > 0 ? legacy / compiled : 0.0, 6, 'f', 2);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("formatbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Time the format parsers against the ones they replaced.");
+    parser.addHelpOption();
+    QCommandLineOption iterationsOpt("iterations", "Calls to time for each parser.", "n", "200000");
+    parser.addOption(iterationsOpt);
+    parser.process(app);
+    int iterations = std::max(1, parser.value(iterationsOpt).toInt());
+
+    QList<QVariantMap> rows = makeRows();
+    QStringList names;
+    for (int i = 0; i < rowCount; i++)
+        names.append(displayName(i));
+
+    DisplayParser compiled;
+    compiled.takeFormatString(displayFormat);
+    Legacy::DisplayParser legacy;
+    legacy.takeFormatString(displayFormat);
+
+    int mismatches = 0;
+    for (int i = 0; i < rowCount; i++) {
+        Helpers::FileType type = i & 1 ? Helpers::AudioFile : Helpers::VideoFile;
+        if (compiled.parseMetadata(rows[i], names[i], type)
+                != legacy.parseMetadata(rows[i], names[i], type))
+            mismatches++;
+        auto subs = Helpers::Subtitles(i % 3);
+        auto disabled = Helpers::DisabledTrack(i % 3);
+        if (Helpers::parseFormat(checkedFileFormat, names[i], disabled, subs, i, i, i * 2)
+                != Legacy::parseFormat(checkedFileFormat, names[i], disabled, subs, i, i, i * 2))
+            mismatches++;
+    }
+    if (mismatches) {
+        err << "formatbench: the parsers disagree on " << mismatches << " outputs\n";
+        return 1;
+    }
+
+    // Warm both up, so that neither pays for the first allocations.
+    for (int i = 0; i < rowCount; i++) {
+        sink += compiled.parseMetadata(rows[i], names[i], Helpers::AudioFile).size();
+        sink += legacy.parseMetadata(rows[i], names[i], Helpers::AudioFile).size();
+    }
+
+    double legacyDisplay = nsecPerCall(iterations, [&](int i) {
+        int row = i % rowCount;
+        sink += legacy.parseMetadata(rows[row], names[row], Helpers::AudioFile).size();
+    });
+    double compiledDisplay = nsecPerCall(iterations, [&](int i) {
+        int row = i % rowCount;
+        sink += compiled.parseMetadata(rows[row], names[row], Helpers::AudioFile).size();
+    });
+
+    // File names are made far less often, so fewer calls are enough.
+    int fileIterations = std::max(1, iterations / 10);
+    double legacyFile = nsecPerCall(fileIterations, [&](int i) {
+        sink += Legacy::parseFormat(timedFileFormat, names[i % rowCount], Helpers::NothingDisabled,
+                                    Helpers::SubtitlesPresent, i, 0, 0).size();
+    });
+    double compiledFile = nsecPerCall(fileIterations, [&](int i) {
+        sink += Helpers::parseFormat(timedFileFormat, names[i % rowCount], Helpers::NothingDisabled,
+                                     Helpers::SubtitlesPresent, i, 0, 0).size();
+    });
+
+    out << QString("  %1 %2 %3 %4\n").arg("ns per call", -12).arg("legacy", 10)
+           .arg("compiled", 10).arg("speedup", 7);
+    printResult("display", legacyDisplay, compiledDisplay);
+    printResult("file name", legacyFile, compiledFile);
+    out << QString("(%1 display calls, %2 file name calls, checksum %3)\n")
+           .arg(iterations).arg(fileIterations).arg(sink);
+    return 0;
+}
@@ -0,0 +1,12 @@
+// helpers.cpp only needs these two things from the platform layer, and the
+// rest of it would drag in most of the player.
+
+#include "platform/unify.h"
+
+const bool Platform::isWindows = false;
+const bool Platform::isUnix = true;
+
+QString Platform::sanitizedFilename(QString fileName)
+{
+    return fileName;
+}
@@ -0,0 +1,1157 @@
+// A stand-in for libmpv that plays no media.  Instead, it replays a script
+// of events (property changes, log messages, reconfigs, hooks) at a chosen
+// rate, so the player's event handling can be exercised and measured
+// without real files.  Load it with LD_PRELOAD in front of the real libmpv,
+// and point MOCKMPV_SCRIPT at a script.  See ../README.md for the format.
+//
+// Only the first handle to be initialized runs the script; any others (e.g.
+// helper instances) just answer requests.  Every handle keeps a store of
+// property values, so getters return what was last set or scripted.
+
+// Built as strict C11, which hides clock_gettime, nanosleep and strdup.
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+
+#define MOCK_EXPORT __attribute__((visibility("default")))
+
+enum { maxLine = 1024 };
+
+typedef struct queued_event {
+    struct queued_event *next;
+    mpv_event_id id;
+    int error;
+    uint64_t userdata;
+    char *name;             // property or hook name, log prefix
+    char *level;            // log level
+    char *text;             // log text
+    uint64_t hookId;
+    mpv_format format;      // format of the property payload
+    mpv_node value;         // property value or command result
+} queued_event;
+
+typedef struct observed_property {
+    char *name;
+    uint64_t userdata;
+    mpv_format format;
+} observed_property;
+
+typedef struct stored_property {
+    char *name;
+    mpv_node value;
+} stored_property;
+
+typedef struct registered_hook {
+    char *name;
+    uint64_t userdata;
+} registered_hook;
+
+typedef struct script_line {
+    char *verb;
+    char *args;
+} script_line;
+
+struct mpv_handle {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    queued_event *head;
+    queued_event *tail;
+    size_t queued;
+    size_t maxQueued;
+
+    void (*wakeup)(void *);
+    void *wakeupData;
+
+    observed_property *observed;
+    int observedCount;
+    stored_property *store;
+    int storeCount;
+    registered_hook *hooks;
+    int hookCount;
+    uint64_t nextHookId;
+    int logEnabled;
+
+    // The event handed out by the last mpv_wait_event, and its payload.
+    mpv_event current;
+    queued_event *currentSource;
+    union {
+        mpv_event_property property;
+        mpv_event_log_message log;
+        mpv_event_hook hook;
+        mpv_event_command command;
+        mpv_event_start_file startFile;
+        mpv_event_end_file endFile;
+    } payload;
+    union {
+        char *string;
+        int flag;
+        int64_t int64;
+        double double_;
+        mpv_node node;
+    } propertyData;
+
+    int scripted;
+    volatile int terminating;
+    pthread_t scriptThread;
+    unsigned long long generated;
+    unsigned long long delivered;
+    struct timespec scriptStart;
+    struct timespec scriptEnd;
+};
+
+struct mpv_render_context {
+    mpv_render_update_fn update;
+    void *updateData;
+};
+
+static pthread_mutex_t globalLock = PTHREAD_MUTEX_INITIALIZER;
+static int scriptClaimed;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double elapsed_sec(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+// Sleeps in short steps, so that a handle being destroyed does not have to
+// wait out a long pause in its script.
+static void sleep_until(mpv_handle *ctx, double when)
+{
+    double left;
+    while (!ctx->terminating && (left = when - now_sec()) > 0) {
+        if (left > 0.05)
+            left = 0.05;
+        struct timespec ts;
+        ts.tv_sec = (time_t)left;
+        ts.tv_nsec = (long)((left - ts.tv_sec) * 1e9);
+        while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+            ;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Nodes
+
+static char *copy_string(const char *s)
+{
+    return s ? strdup(s) : NULL;
+}
+
+static void node_copy(mpv_node *dst, const mpv_node *src)
+{
+    *dst = *src;
+    switch (src->format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+        dst->u.string = copy_string(src->u.string);
+        break;
+    case MPV_FORMAT_NODE_ARRAY:
+    case MPV_FORMAT_NODE_MAP: {
+        const mpv_node_list *from = src->u.list;
+        mpv_node_list *to = calloc(1, sizeof(*to));
+        to->num = from->num;
+        if (from->num) {
+            to->values = calloc(from->num, sizeof(mpv_node));
+            for (int i = 0; i < from->num; i++)
+                node_copy(&to->values[i], &from->values[i]);
+            if (from->keys) {
+                to->keys = calloc(from->num, sizeof(char *));
+                for (int i = 0; i < from->num; i++)
+                    to->keys[i] = copy_string(from->keys[i]);
+            }
+        }
+        dst->u.list = to;
+        break;
+    }
+    case MPV_FORMAT_BYTE_ARRAY: {
+        mpv_byte_array *ba = calloc(1, sizeof(*ba));
+        ba->size = src->u.ba->size;
+        ba->data = malloc(ba->size ? ba->size : 1);
+        memcpy(ba->data, src->u.ba->data, ba->size);
+        dst->u.ba = ba;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+MOCK_EXPORT void mpv_free_node_contents(mpv_node *node)
+{
+    switch (node->format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+        free(node->u.string);
+        break;
+    case MPV_FORMAT_NODE_ARRAY:
+    case MPV_FORMAT_NODE_MAP:
+        if (node->u.list) {
+            for (int i = 0; i < node->u.list->num; i++) {
+                mpv_free_node_contents(&node->u.list->values[i]);
+                if (node->u.list->keys)
+                    free(node->u.list->keys[i]);
+            }
+            free(node->u.list->values);
+            free(node->u.list->keys);
+            free(node->u.list);
+        }
+        break;
+    case MPV_FORMAT_BYTE_ARRAY:
+        if (node->u.ba) {
+            free(node->u.ba->data);
+            free(node->u.ba);
+        }
+        break;
+    default:
+        break;
+    }
+    node->format = MPV_FORMAT_NONE;
+}
+
+// Reads a value passed in one of mpv's formats into a node.
+static int node_from_data(mpv_node *dst, mpv_format format, void *data)
+{
+    dst->format = format;
+    switch (format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+        dst->u.string = copy_string(*(char **)data);
+        return 0;
+    case MPV_FORMAT_FLAG:
+        dst->u.flag = *(int *)data;
+        return 0;
+    case MPV_FORMAT_INT64:
+        dst->u.int64 = *(int64_t *)data;
+        return 0;
+    case MPV_FORMAT_DOUBLE:
+        dst->u.double_ = *(double *)data;
+        return 0;
+    case MPV_FORMAT_NODE:
+        node_copy(dst, (mpv_node *)data);
+        return 0;
+    default:
+        dst->format = MPV_FORMAT_NONE;
+        return MPV_ERROR_PROPERTY_FORMAT;
+    }
+}
+
+// Writes a node out in the format the caller asked for.  Numbers convert
+// between each other, and anything converts to a string.
+static int node_to_data(const mpv_node *src, mpv_format format, void *data)
+{
+    char buffer[64];
+    switch (format) {
+    case MPV_FORMAT_NODE:
+        node_copy((mpv_node *)data, src);
+        return 0;
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+        switch (src->format) {
+        case MPV_FORMAT_STRING:
+        case MPV_FORMAT_OSD_STRING:
+            *(char **)data = copy_string(src->u.string);
+            return 0;
+        case MPV_FORMAT_FLAG:
+            *(char **)data = copy_string(src->u.flag ? "yes" : "no");
+            return 0;
+        case MPV_FORMAT_INT64:
+            snprintf(buffer, sizeof(buffer), "%lld", (long long)src->u.int64);
+            *(char **)data = copy_string(buffer);
+            return 0;
+        case MPV_FORMAT_DOUBLE:
+            snprintf(buffer, sizeof(buffer), "%f", src->u.double_);
+            *(char **)data = copy_string(buffer);
+            return 0;
+        default:
+            *(char **)data = copy_string("");
+            return 0;
+        }
+    case MPV_FORMAT_FLAG:
+        if (src->format == MPV_FORMAT_FLAG)
+            *(int *)data = src->u.flag;
+        else if (src->format == MPV_FORMAT_INT64)
+            *(int *)data = src->u.int64 != 0;
+        else
+            return MPV_ERROR_PROPERTY_FORMAT;
+        return 0;
+    case MPV_FORMAT_INT64:
+        if (src->format == MPV_FORMAT_INT64)
+            *(int64_t *)data = src->u.int64;
+        else if (src->format == MPV_FORMAT_DOUBLE)
+            *(int64_t *)data = (int64_t)src->u.double_;
+        else if (src->format == MPV_FORMAT_FLAG)
+            *(int64_t *)data = src->u.flag;
+        else
+            return MPV_ERROR_PROPERTY_FORMAT;
+        return 0;
+    case MPV_FORMAT_DOUBLE:
+        if (src->format == MPV_FORMAT_DOUBLE)
+            *(double *)data = src->u.double_;
+        else if (src->format == MPV_FORMAT_INT64)
+            *(double *)data = (double)src->u.int64;
+        else
+            return MPV_ERROR_PROPERTY_FORMAT;
+        return 0;
+    default:
+        return MPV_ERROR_PROPERTY_FORMAT;
+    }
+}
+
+// Script values are typed by their looks: yes/no are flags, whole numbers
+// are integers, other numbers are doubles, [] is an empty list, and the
+// rest are strings.
+static void node_from_text(mpv_node *dst, const char *text)
+{
+    char *end;
+    if (!strcmp(text, "yes") || !strcmp(text, "no")) {
+        dst->format = MPV_FORMAT_FLAG;
+        dst->u.flag = !strcmp(text, "yes");
+        return;
+    }
+    if (!strcmp(text, "[]")) {
+        dst->format = MPV_FORMAT_NODE_ARRAY;
+        dst->u.list = calloc(1, sizeof(mpv_node_list));
+        return;
+    }
+    long long i = strtoll(text, &end, 10);
+    if (*text && !*end) {
+        dst->format = MPV_FORMAT_INT64;
+        dst->u.int64 = i;
+        return;
+    }
+    double d = strtod(text, &end);
+    if (*text && !*end) {
+        dst->format = MPV_FORMAT_DOUBLE;
+        dst->u.double_ = d;
+        return;
+    }
+    dst->format = MPV_FORMAT_STRING;
+    dst->u.string = copy_string(text);
+}
+
+//----------------------------------------------------------------------------
+// Property store and event queue.  Callers hold the handle's lock.
+
+static stored_property *store_find(mpv_handle *ctx, const char *name)
+{
+    for (int i = 0; i < ctx->storeCount; i++)
+        if (!strcmp(ctx->store[i].name, name))
+            return &ctx->store[i];
+    return NULL;
+}
+
+static void store_set(mpv_handle *ctx, const char *name, const mpv_node *value)
+{
+    stored_property *p = store_find(ctx, name);
+    if (!p) {
+        ctx->store = realloc(ctx->store, (ctx->storeCount + 1) * sizeof(*ctx->store));
+        p = &ctx->store[ctx->storeCount++];
+        p->name = copy_string(name);
+        p->value.format = MPV_FORMAT_NONE;
+    }
+    mpv_free_node_contents(&p->value);
+    node_copy(&p->value, value);
+}
+
+static void store_set_text(mpv_handle *ctx, const char *name, const char *text)
+{
+    mpv_node value;
+    node_from_text(&value, text);
+    store_set(ctx, name, &value);
+    mpv_free_node_contents(&value);
+}
+
+static queued_event *event_new(mpv_event_id id)
+{
+    queued_event *e = calloc(1, sizeof(*e));
+    e->id = id;
+    return e;
+}
+
+static void event_free(queued_event *e)
+{
+    if (!e)
+        return;
+    free(e->name);
+    free(e->level);
+    free(e->text);
+    mpv_free_node_contents(&e->value);
+    free(e);
+}
+
+// Queues an event and tells the client about it.  Takes the lock itself,
+// and calls the wakeup callback outside of it like mpv does.
+static void event_push(mpv_handle *ctx, queued_event *e)
+{
+    pthread_mutex_lock(&ctx->lock);
+    if (ctx->tail)
+        ctx->tail->next = e;
+    else
+        ctx->head = e;
+    ctx->tail = e;
+    ctx->queued++;
+    if (ctx->queued > ctx->maxQueued)
+        ctx->maxQueued = ctx->queued;
+    ctx->generated++;
+    void (*wakeup)(void *) = ctx->wakeup;
+    void *wakeupData = ctx->wakeupData;
+    pthread_cond_signal(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+    if (wakeup)
+        wakeup(wakeupData);
+}
+
+static queued_event *property_event(mpv_event_id id, uint64_t userdata,
+                                    const char *name, mpv_format format,
+                                    const mpv_node *value)
+{
+    queued_event *e = event_new(id);
+    e->userdata = userdata;
+    e->name = copy_string(name);
+    e->format = format;
+    if (value)
+        node_copy(&e->value, value);
+    else
+        e->error = MPV_ERROR_PROPERTY_UNAVAILABLE;
+    return e;
+}
+
+// Sends a change event to everyone observing the property.
+static void notify_observers(mpv_handle *ctx, const char *name)
+{
+    queued_event *pending[16];
+    int count = 0;
+    pthread_mutex_lock(&ctx->lock);
+    stored_property *p = store_find(ctx, name);
+    for (int i = 0; i < ctx->observedCount && count < 16; i++) {
+        if (strcmp(ctx->observed[i].name, name))
+            continue;
+        pending[count++] = property_event(MPV_EVENT_PROPERTY_CHANGE,
+                                          ctx->observed[i].userdata, name,
+                                          ctx->observed[i].format,
+                                          p ? &p->value : NULL);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    for (int i = 0; i < count; i++)
+        event_push(ctx, pending[i]);
+}
+
+//----------------------------------------------------------------------------
+// Script playback
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t')
+        s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+        *--end = '\0';
+    return s;
+}
+
+static script_line *script_load(const char *path, int *count)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "mockmpv: could not open script %s\n", path);
+        return NULL;
+    }
+    script_line *lines = NULL;
+    char buffer[maxLine];
+    *count = 0;
+    while (fgets(buffer, sizeof(buffer), f)) {
+        char *line = trim(buffer);
+        if (!*line || *line == '#')
+            continue;
+        char *args = line + strcspn(line, " \t");
+        if (*args)
+            *args++ = '\0';
+        lines = realloc(lines, (*count + 1) * sizeof(*lines));
+        lines[*count].verb = copy_string(line);
+        lines[*count].args = copy_string(trim(args));
+        (*count)++;
+    }
+    fclose(f);
+    return lines;
+}
+
+typedef struct pacer {
+    double rate;    // events per second, or 0 for as fast as possible
+    double start;
+    unsigned long long sent;
+} pacer;
+
+static void pace(mpv_handle *ctx, pacer *p)
+{
+    if (p->rate <= 0)
+        return;
+    sleep_until(ctx, p->start + p->sent / p->rate);
+    p->sent++;
+}
+
+static void pacer_reset(pacer *p, double rate)
+{
+    p->rate = rate;
+    p->start = now_sec();
+    p->sent = 0;
+}
+
+static void script_emit(mpv_handle *ctx, pacer *p, mpv_event_id id)
+{
+    pace(ctx, p);
+    event_push(ctx, event_new(id));
+}
+
+static void script_set(mpv_handle *ctx, pacer *p, const char *name, const mpv_node *value)
+{
+    pace(ctx, p);
+    pthread_mutex_lock(&ctx->lock);
+    store_set(ctx, name, value);
+    pthread_mutex_unlock(&ctx->lock);
+    notify_observers(ctx, name);
+}
+
+static int script_step(mpv_handle *ctx, pacer *p, const script_line *line)
+{
+    char name[256], text[maxLine];
+    long long count = 1;
+    double from, to, msec;
+
+    if (!strcmp(line->verb, "rate")) {
+        pacer_reset(p, atof(line->args));
+    } else if (!strcmp(line->verb, "sleep")) {
+        msec = atof(line->args);
+        sleep_until(ctx, now_sec() + msec / 1000.0);
+        pacer_reset(p, p->rate);
+    } else if (!strcmp(line->verb, "set")) {
+        if (sscanf(line->args, "%255s %1023[^\n]", name, text) != 2)
+            return -1;
+        mpv_node value;
+        node_from_text(&value, text);
+        script_set(ctx, p, name, &value);
+        mpv_free_node_contents(&value);
+    } else if (!strcmp(line->verb, "ramp")) {
+        if (sscanf(line->args, "%255s %lf %lf %lld", name, &from, &to, &count) != 4)
+            return -1;
+        for (long long i = 0; i < count && !ctx->terminating; i++) {
+            mpv_node value;
+            value.format = MPV_FORMAT_DOUBLE;
+            value.u.double_ = count > 1 ? from + (to - from) * i / (count - 1) : from;
+            script_set(ctx, p, name, &value);
+        }
+    } else if (!strcmp(line->verb, "log")) {
+        if (sscanf(line->args, "%255s %lld %1023[^\n]", name, &count, text) != 3)
+            return -1;
+        for (long long i = 0; i < count && !ctx->terminating; i++) {
+            if (!ctx->logEnabled)
+                break;
+            pace(ctx, p);
+            queued_event *e = event_new(MPV_EVENT_LOG_MESSAGE);
+            e->name = copy_string("mock");
+            e->level = copy_string(name);
+            e->text = malloc(strlen(text) + 2);
+            sprintf(e->text, "%s\n", text);
+            event_push(ctx, e);
+        }
+    } else if (!strcmp(line->verb, "reconfig")) {
+        if (sscanf(line->args, "%255s %lld", name, &count) < 1)
+            return -1;
+        mpv_event_id id = !strcmp(name, "audio") ? MPV_EVENT_AUDIO_RECONFIG
+                                                 : MPV_EVENT_VIDEO_RECONFIG;
+        for (long long i = 0; i < count && !ctx->terminating; i++)
+            script_emit(ctx, p, id);
+    } else if (!strcmp(line->verb, "hook")) {
+        if (sscanf(line->args, "%255s %lld", name, &count) < 1)
+            return -1;
+        for (long long i = 0; i < count && !ctx->terminating; i++) {
+            pthread_mutex_lock(&ctx->lock);
+            queued_event *e = NULL;
+            for (int h = 0; h < ctx->hookCount; h++) {
+                if (strcmp(ctx->hooks[h].name, name))
+                    continue;
+                e = event_new(MPV_EVENT_HOOK);
+                e->userdata = ctx->hooks[h].userdata;
+                e->name = copy_string(name);
+                e->hookId = ctx->nextHookId++;
+                break;
+            }
+            pthread_mutex_unlock(&ctx->lock);
+            if (!e)
+                break;
+            pace(ctx, p);
+            event_push(ctx, e);
+        }
+    } else if (!strcmp(line->verb, "event")) {
+        static const struct { const char *name; mpv_event_id id; } events[] = {
+            { "start-file", MPV_EVENT_START_FILE },
+            { "file-loaded", MPV_EVENT_FILE_LOADED },
+            { "playback-restart", MPV_EVENT_PLAYBACK_RESTART },
+            { "end-file", MPV_EVENT_END_FILE },
+            { "idle", MPV_EVENT_IDLE },
+            { "seek", MPV_EVENT_SEEK },
+        };
+        if (sscanf(line->args, "%255s %lld", name, &count) < 1)
+            return -1;
+        for (size_t e = 0; e < sizeof(events) / sizeof(events[0]); e++) {
+            if (strcmp(events[e].name, name))
+                continue;
+            for (long long i = 0; i < count && !ctx->terminating; i++)
+                script_emit(ctx, p, events[e].id);
+            return 0;
+        }
+        return -1;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static void *script_run(void *data)
+{
+    mpv_handle *ctx = data;
+    int count = 0;
+    script_line *lines = script_load(getenv("MOCKMPV_SCRIPT"), &count);
+    pacer p;
+    pacer_reset(&p, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &ctx->scriptStart);
+    // "repeat N" runs the lines up to the matching "end" N times.
+    int repeatStart = -1;
+    long long repeatsLeft = 0;
+    for (int i = 0; i < count && !ctx->terminating; i++) {
+        if (!strcmp(lines[i].verb, "repeat")) {
+            repeatStart = i;
+            repeatsLeft = atoll(lines[i].args);
+            continue;
+        }
+        if (!strcmp(lines[i].verb, "end")) {
+            if (repeatStart >= 0 && --repeatsLeft > 0)
+                i = repeatStart;
+            else
+                repeatStart = -1;
+            continue;
+        }
+        if (script_step(ctx, &p, &lines[i]) < 0)
+            fprintf(stderr, "mockmpv: bad script line: %s %s\n", lines[i].verb, lines[i].args);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ctx->scriptEnd);
+
+    pthread_mutex_lock(&ctx->lock);
+    double seconds = elapsed_sec(&ctx->scriptStart, &ctx->scriptEnd);
+    fprintf(stderr, "mockmpv: script finished: %llu events in %.3f s (%.0f/s), "
+                    "queue peaked at %zu\n", ctx->generated, seconds,
+            seconds > 0 ? ctx->generated / seconds : 0.0, ctx->maxQueued);
+    pthread_mutex_unlock(&ctx->lock);
+
+    for (int i = 0; i < count; i++) {
+        free(lines[i].verb);
+        free(lines[i].args);
+    }
+    free(lines);
+    return NULL;
+}
+
+//----------------------------------------------------------------------------
+// Client API
+
+MOCK_EXPORT unsigned long mpv_client_api_version(void)
+{
+    return MPV_CLIENT_API_VERSION;
+}
+
+MOCK_EXPORT const char *mpv_error_string(int error)
+{
+    switch (error) {
+    case MPV_ERROR_SUCCESS: return "success";
+    case MPV_ERROR_NOMEM: return "memory allocation failed";
+    case MPV_ERROR_UNINITIALIZED: return "core not uninitialized";
+    case MPV_ERROR_INVALID_PARAMETER: return "invalid parameter";
+    case MPV_ERROR_PROPERTY_NOT_FOUND: return "property not found";
+    case MPV_ERROR_PROPERTY_FORMAT: return "unsupported format for accessing property";
+    case MPV_ERROR_PROPERTY_UNAVAILABLE: return "property unavailable";
+    case MPV_ERROR_COMMAND: return "error running command";
+    default: return "unknown error";
+    }
+}
+
+MOCK_EXPORT const char *mpv_event_name(mpv_event_id event)
+{
+    switch (event) {
+    case MPV_EVENT_NONE: return "none";
+    case MPV_EVENT_SHUTDOWN: return "shutdown";
+    case MPV_EVENT_LOG_MESSAGE: return "log-message";
+    case MPV_EVENT_GET_PROPERTY_REPLY: return "get-property-reply";
+    case MPV_EVENT_SET_PROPERTY_REPLY: return "set-property-reply";
+    case MPV_EVENT_COMMAND_REPLY: return "command-reply";
+    case MPV_EVENT_START_FILE: return "start-file";
+    case MPV_EVENT_END_FILE: return "end-file";
+    case MPV_EVENT_FILE_LOADED: return "file-loaded";
+    case MPV_EVENT_IDLE: return "idle";
+    case MPV_EVENT_VIDEO_RECONFIG: return "video-reconfig";
+    case MPV_EVENT_AUDIO_RECONFIG: return "audio-reconfig";
+    case MPV_EVENT_SEEK: return "seek";
+    case MPV_EVENT_PLAYBACK_RESTART: return "playback-restart";
+    case MPV_EVENT_PROPERTY_CHANGE: return "property-change";
+    case MPV_EVENT_HOOK: return "hook";
+    default: return NULL;
+    }
+}
+
+MOCK_EXPORT void mpv_free(void *data)
+{
+    free(data);
+}
+
+MOCK_EXPORT const char *mpv_client_name(mpv_handle *ctx)
+{
+    (void)ctx;
+    return "main";
+}
+
+MOCK_EXPORT int64_t mpv_get_time_us(mpv_handle *ctx)
+{
+    (void)ctx;
+    return (int64_t)(now_sec() * 1e6);
+}
+
+MOCK_EXPORT mpv_handle *mpv_create(void)
+{
+    mpv_handle *ctx = calloc(1, sizeof(*ctx));
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+    ctx->nextHookId = 1;
+    store_set_text(ctx, "mpv-version", "mpv mock");
+    store_set_text(ctx, "protocol-list", "[]");
+    store_set_text(ctx, "audio-device-list", "[]");
+    store_set_text(ctx, "idle-active", "yes");
+    store_set_text(ctx, "pause", "no");
+    store_set_text(ctx, "volume", "100");
+    store_set_text(ctx, "speed", "1.0");
+    return ctx;
+}
+
+MOCK_EXPORT int mpv_initialize(mpv_handle *ctx)
+{
+    const char *script = getenv("MOCKMPV_SCRIPT");
+    if (!script || !*script)
+        return 0;
+    pthread_mutex_lock(&globalLock);
+    int claim = !scriptClaimed;
+    scriptClaimed = 1;
+    pthread_mutex_unlock(&globalLock);
+    if (claim) {
+        ctx->scripted = 1;
+        pthread_create(&ctx->scriptThread, NULL, script_run, ctx);
+    }
+    return 0;
+}
+
+MOCK_EXPORT void mpv_terminate_destroy(mpv_handle *ctx)
+{
+    if (!ctx)
+        return;
+    ctx->terminating = 1;
+    if (ctx->scripted) {
+        pthread_join(ctx->scriptThread, NULL);
+        fprintf(stderr, "mockmpv: %llu events generated, %llu delivered\n",
+                ctx->generated, ctx->delivered);
+    }
+    while (ctx->head) {
+        queued_event *e = ctx->head;
+        ctx->head = e->next;
+        event_free(e);
+    }
+    event_free(ctx->currentSource);
+    for (int i = 0; i < ctx->observedCount; i++)
+        free(ctx->observed[i].name);
+    free(ctx->observed);
+    for (int i = 0; i < ctx->storeCount; i++) {
+        free(ctx->store[i].name);
+        mpv_free_node_contents(&ctx->store[i].value);
+    }
+    free(ctx->store);
+    for (int i = 0; i < ctx->hookCount; i++)
+        free(ctx->hooks[i].name);
+    free(ctx->hooks);
+    pthread_cond_destroy(&ctx->cond);
+    pthread_mutex_destroy(&ctx->lock);
+    free(ctx);
+}
+
+MOCK_EXPORT void mpv_destroy(mpv_handle *ctx)
+{
+    mpv_terminate_destroy(ctx);
+}
+
+MOCK_EXPORT int mpv_set_option(mpv_handle *ctx, const char *name,
+                               mpv_format format, void *data)
+{
+    return mpv_set_property(ctx, name, format, data);
+}
+
+MOCK_EXPORT int mpv_set_option_string(mpv_handle *ctx, const char *name,
+                                      const char *data)
+{
+    return mpv_set_property_string(ctx, name, data);
+}
+
+MOCK_EXPORT int mpv_command(mpv_handle *ctx, const char **args)
+{
+    (void)ctx;
+    return args && args[0] ? 0 : MPV_ERROR_INVALID_PARAMETER;
+}
+
+MOCK_EXPORT int mpv_command_node(mpv_handle *ctx, mpv_node *args, mpv_node *result)
+{
+    (void)ctx;
+    (void)args;
+    if (result)
+        result->format = MPV_FORMAT_NONE;
+    return 0;
+}
+
+MOCK_EXPORT int mpv_command_string(mpv_handle *ctx, const char *args)
+{
+    (void)ctx;
+    return args ? 0 : MPV_ERROR_INVALID_PARAMETER;
+}
+
+MOCK_EXPORT int mpv_command_async(mpv_handle *ctx, uint64_t reply_userdata,
+                                  const char **args)
+{
+    if (!args || !args[0])
+        return MPV_ERROR_INVALID_PARAMETER;
+    queued_event *e = event_new(MPV_EVENT_COMMAND_REPLY);
+    e->userdata = reply_userdata;
+    event_push(ctx, e);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_command_node_async(mpv_handle *ctx, uint64_t reply_userdata,
+                                       mpv_node *args)
+{
+    (void)args;
+    queued_event *e = event_new(MPV_EVENT_COMMAND_REPLY);
+    e->userdata = reply_userdata;
+    event_push(ctx, e);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_set_property(mpv_handle *ctx, const char *name,
+                                 mpv_format format, void *data)
+{
+    mpv_node value;
+    int r = node_from_data(&value, format, data);
+    if (r < 0)
+        return r;
+    pthread_mutex_lock(&ctx->lock);
+    store_set(ctx, name, &value);
+    pthread_mutex_unlock(&ctx->lock);
+    mpv_free_node_contents(&value);
+    notify_observers(ctx, name);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_set_property_string(mpv_handle *ctx, const char *name,
+                                        const char *data)
+{
+    return mpv_set_property(ctx, name, MPV_FORMAT_STRING, &data);
+}
+
+MOCK_EXPORT int mpv_set_property_async(mpv_handle *ctx, uint64_t reply_userdata,
+                                       const char *name, mpv_format format,
+                                       void *data)
+{
+    int r = mpv_set_property(ctx, name, format, data);
+    queued_event *e = event_new(MPV_EVENT_SET_PROPERTY_REPLY);
+    e->userdata = reply_userdata;
+    e->error = r;
+    event_push(ctx, e);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_get_property(mpv_handle *ctx, const char *name,
+                                 mpv_format format, void *data)
+{
+    pthread_mutex_lock(&ctx->lock);
+    stored_property *p = store_find(ctx, name);
+    int r = p ? node_to_data(&p->value, format, data)
+              : MPV_ERROR_PROPERTY_UNAVAILABLE;
+    pthread_mutex_unlock(&ctx->lock);
+    return r;
+}
+
+MOCK_EXPORT char *mpv_get_property_string(mpv_handle *ctx, const char *name)
+{
+    char *s = NULL;
+    if (mpv_get_property(ctx, name, MPV_FORMAT_STRING, &s) < 0)
+        return NULL;
+    return s;
+}
+
+MOCK_EXPORT char *mpv_get_property_osd_string(mpv_handle *ctx, const char *name)
+{
+    return mpv_get_property_string(ctx, name);
+}
+
+MOCK_EXPORT int mpv_get_property_async(mpv_handle *ctx, uint64_t reply_userdata,
+                                       const char *name, mpv_format format)
+{
+    pthread_mutex_lock(&ctx->lock);
+    stored_property *p = store_find(ctx, name);
+    queued_event *e = property_event(MPV_EVENT_GET_PROPERTY_REPLY, reply_userdata,
+                                     name, format, p ? &p->value : NULL);
+    pthread_mutex_unlock(&ctx->lock);
+    event_push(ctx, e);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_observe_property(mpv_handle *ctx, uint64_t reply_userdata,
+                                     const char *name, mpv_format format)
+{
+    pthread_mutex_lock(&ctx->lock);
+    ctx->observed = realloc(ctx->observed, (ctx->observedCount + 1) * sizeof(*ctx->observed));
+    observed_property *o = &ctx->observed[ctx->observedCount++];
+    o->name = copy_string(name);
+    o->userdata = reply_userdata;
+    o->format = format;
+    // Like mpv, report the initial value straight away.
+    stored_property *p = store_find(ctx, name);
+    queued_event *e = property_event(MPV_EVENT_PROPERTY_CHANGE, reply_userdata,
+                                     name, format, p ? &p->value : NULL);
+    pthread_mutex_unlock(&ctx->lock);
+    event_push(ctx, e);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_unobserve_property(mpv_handle *ctx, uint64_t registered_reply_userdata)
+{
+    int removed = 0;
+    pthread_mutex_lock(&ctx->lock);
+    for (int i = 0; i < ctx->observedCount; ) {
+        if (ctx->observed[i].userdata != registered_reply_userdata) {
+            i++;
+            continue;
+        }
+        free(ctx->observed[i].name);
+        ctx->observed[i] = ctx->observed[--ctx->observedCount];
+        removed++;
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return removed;
+}
+
+MOCK_EXPORT int mpv_request_event(mpv_handle *ctx, mpv_event_id event, int enable)
+{
+    (void)ctx;
+    (void)event;
+    (void)enable;
+    return 0;
+}
+
+MOCK_EXPORT int mpv_request_log_messages(mpv_handle *ctx, const char *min_level)
+{
+    ctx->logEnabled = min_level && strcmp(min_level, "no");
+    return 0;
+}
+
+MOCK_EXPORT mpv_event *mpv_wait_event(mpv_handle *ctx, double timeout)
+{
+    pthread_mutex_lock(&ctx->lock);
+    // The previous event's payload stays valid until the next call.
+    event_free(ctx->currentSource);
+    ctx->currentSource = NULL;
+    if (ctx->current.event_id == MPV_EVENT_PROPERTY_CHANGE
+            || ctx->current.event_id == MPV_EVENT_GET_PROPERTY_REPLY) {
+        if (ctx->payload.property.format == MPV_FORMAT_NODE)
+            mpv_free_node_contents(&ctx->propertyData.node);
+        else if (ctx->payload.property.format == MPV_FORMAT_STRING
+                 || ctx->payload.property.format == MPV_FORMAT_OSD_STRING)
+            free(ctx->propertyData.string);
+    }
+    memset(&ctx->current, 0, sizeof(ctx->current));
+    memset(&ctx->payload, 0, sizeof(ctx->payload));
+    memset(&ctx->propertyData, 0, sizeof(ctx->propertyData));
+
+    if (!ctx->head && timeout > 0) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        double when = until.tv_sec + until.tv_nsec / 1e9 + timeout;
+        until.tv_sec = (time_t)when;
+        until.tv_nsec = (long)((when - until.tv_sec) * 1e9);
+        while (!ctx->head && pthread_cond_timedwait(&ctx->cond, &ctx->lock, &until) == 0)
+            ;
+    }
+
+    queued_event *e = ctx->head;
+    if (!e) {
+        ctx->current.event_id = MPV_EVENT_NONE;
+        pthread_mutex_unlock(&ctx->lock);
+        return &ctx->current;
+    }
+    ctx->head = e->next;
+    if (!ctx->head)
+        ctx->tail = NULL;
+    ctx->queued--;
+    ctx->delivered++;
+    ctx->currentSource = e;
+
+    ctx->current.event_id = e->id;
+    ctx->current.error = e->error;
+    ctx->current.reply_userdata = e->userdata;
+    switch (e->id) {
+    case MPV_EVENT_PROPERTY_CHANGE:
+    case MPV_EVENT_GET_PROPERTY_REPLY:
+        ctx->payload.property.name = e->name;
+        ctx->payload.property.format = MPV_FORMAT_NONE;
+        ctx->current.data = &ctx->payload.property;
+        if (e->error < 0 || e->value.format == MPV_FORMAT_NONE)
+            break;
+        if (node_to_data(&e->value, e->format, &ctx->propertyData) < 0)
+            break;
+        ctx->payload.property.format = e->format;
+        ctx->payload.property.data = &ctx->propertyData;
+        ctx->current.error = 0;
+        break;
+    case MPV_EVENT_LOG_MESSAGE:
+        ctx->payload.log.prefix = e->name;
+        ctx->payload.log.level = e->level;
+        ctx->payload.log.text = e->text;
+        ctx->payload.log.log_level = MPV_LOG_LEVEL_INFO;
+        ctx->current.data = &ctx->payload.log;
+        break;
+    case MPV_EVENT_HOOK:
+        ctx->payload.hook.name = e->name;
+        ctx->payload.hook.id = e->hookId;
+        ctx->current.data = &ctx->payload.hook;
+        break;
+    case MPV_EVENT_COMMAND_REPLY:
+        ctx->payload.command.result.format = MPV_FORMAT_NONE;
+        ctx->current.data = &ctx->payload.command;
+        break;
+    case MPV_EVENT_START_FILE:
+        ctx->current.data = &ctx->payload.startFile;
+        break;
+    case MPV_EVENT_END_FILE:
+        ctx->payload.endFile.reason = MPV_END_FILE_REASON_EOF;
+        ctx->current.data = &ctx->payload.endFile;
+        break;
+    default:
+        break;
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return &ctx->current;
+}
+
+MOCK_EXPORT void mpv_wakeup(mpv_handle *ctx)
+{
+    pthread_mutex_lock(&ctx->lock);
+    void (*wakeup)(void *) = ctx->wakeup;
+    void *wakeupData = ctx->wakeupData;
+    pthread_cond_signal(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+    if (wakeup)
+        wakeup(wakeupData);
+}
+
+MOCK_EXPORT void mpv_set_wakeup_callback(mpv_handle *ctx, void (*cb)(void *d), void *d)
+{
+    pthread_mutex_lock(&ctx->lock);
+    ctx->wakeup = cb;
+    ctx->wakeupData = d;
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+MOCK_EXPORT int mpv_hook_add(mpv_handle *ctx, uint64_t reply_userdata,
+                             const char *name, int priority)
+{
+    (void)priority;
+    pthread_mutex_lock(&ctx->lock);
+    ctx->hooks = realloc(ctx->hooks, (ctx->hookCount + 1) * sizeof(*ctx->hooks));
+    ctx->hooks[ctx->hookCount].name = copy_string(name);
+    ctx->hooks[ctx->hookCount].userdata = reply_userdata;
+    ctx->hookCount++;
+    pthread_mutex_unlock(&ctx->lock);
+    return 0;
+}
+
+MOCK_EXPORT int mpv_hook_continue(mpv_handle *ctx, uint64_t id)
+{
+    (void)ctx;
+    (void)id;
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// Render API.  Nothing is ever drawn, so there are never new frames.
+
+MOCK_EXPORT int mpv_render_context_create(mpv_render_context **res, mpv_handle *mpv,
+                                          mpv_render_param *params)
+{
+    (void)mpv;
+    (void)params;
+    *res = calloc(1, sizeof(mpv_render_context));
+    return 0;
+}
+
+MOCK_EXPORT int mpv_render_context_set_parameter(mpv_render_context *ctx,
+                                                 mpv_render_param param)
+{
+    (void)ctx;
+    (void)param;
+    return 0;
+}
+
+MOCK_EXPORT int mpv_render_context_get_info(mpv_render_context *ctx,
+                                            mpv_render_param param)
+{
+    (void)ctx;
+    (void)param;
+    return MPV_ERROR_NOT_IMPLEMENTED;
+}
+
+MOCK_EXPORT void mpv_render_context_set_update_callback(mpv_render_context *ctx,
+                                                        mpv_render_update_fn callback,
+                                                        void *callback_ctx)
+{
+    ctx->update = callback;
+    ctx->updateData = callback_ctx;
+}
+
+MOCK_EXPORT uint64_t mpv_render_context_update(mpv_render_context *ctx)
+{
+    (void)ctx;
+    return 0;
+}
+
+MOCK_EXPORT int mpv_render_context_render(mpv_render_context *ctx,
+                                          mpv_render_param *params)
+{
+    (void)ctx;
+    (void)params;
+    return 0;
+}
+
+MOCK_EXPORT void mpv_render_context_report_swap(mpv_render_context *ctx)
+{
+    (void)ctx;
+}
+
+MOCK_EXPORT void mpv_render_context_free(mpv_render_context *ctx)
+{
+    free(ctx);
+}
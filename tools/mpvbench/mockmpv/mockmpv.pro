@@ -0,0 +1,17 @@
+# A stand-in libmpv, meant to be loaded with LD_PRELOAD.  Only the mpv
+# headers are needed, not the library itself.
+
+TEMPLATE = lib
+TARGET = mockmpv
+CONFIG -= qt
+CONFIG += plugin c11 hide_symbols
+
+unix {
+    DESTDIR = ../bin
+    OBJECTS_DIR = .obj
+}
+
+QMAKE_CFLAGS += -Wall $$system(pkg-config --cflags mpv)
+LIBS += -lpthread
+
+SOURCES += mockmpv.c
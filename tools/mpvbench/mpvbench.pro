@@ -0,0 +1,7 @@
+# Benchmarks for mpc-qt.  These are built on their own and are not part of
+# the player's build:
+#     qmake tools/mpvbench/mpvbench.pro && make
+# See README.md for how to run them.
+
+TEMPLATE = subdirs
+SUBDIRS = mockmpv bench formatbench
@@ -0,0 +1,516 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTimer>
+#include <QUuid>
+#include <QtConcurrent/QtConcurrentRun>
+#if defined(Q_OS_WIN)
+#include <QLocalServer>
+#include <QLocalSocket>
+#else
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <QSocketNotifier>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "logger.h"
+#include "mpvwidget.h"
+#include "thumbnailcache.h"
+#include "waveform.h"
+
+constexpr char logModule[] = "waveform";
+constexpr char friendlyName[] = "Media Player Classic Qute Theater - Waveform";
+constexpr char cacheKey[] = "waveform:1";
+constexpr int waveformBuckets = 1024;
+constexpr int sampleRate = 8000;
+constexpr int pollMsec = 100;
+constexpr qint64 chunkSamples = 64 * 1024;
+constexpr qint64 maxSamplesPerRead = 16 * chunkSamples;
+
+// PcmPipe is where mpv's pcm output writes to: a fifo on unix, and a named
+// pipe on windows.  Reads never block, and return 0 when nothing is waiting
+// or -1 once mpv has closed its end.  mpv's writes block while the pipe is
+// full, which paces decoding to however fast we read.
+class PcmPipe {
+public:
+    PcmPipe(QObject *context, const std::function<void()> &readyRead);
+    ~PcmPipe();
+
+    bool open();
+    QString path() const;
+    qint64 read(char *data, qint64 maxSize);
+    void setEnabled(bool enabled);
+    // Closes the pipe while calling stopWriter, which is expected to get rid
+    // of mpv, without either side waiting on the other.
+    void close(const std::function<void()> &stopWriter);
+
+private:
+    QObject *context;
+    std::function<void()> readyRead;
+    QString path_;
+#if defined(Q_OS_WIN)
+    QLocalServer *server = nullptr;
+    QLocalSocket *socket = nullptr;
+#else
+    int fd = -1;
+    bool connected = false;
+    QSocketNotifier *notifier = nullptr;
+#endif
+};
+
+PcmPipe::PcmPipe(QObject *context, const std::function<void()> &readyRead)
+    : context(context), readyRead(readyRead)
+{
+
+}
+
+PcmPipe::~PcmPipe()
+{
+    close([]() {});
+}
+
+#if defined(Q_OS_WIN)
+
+bool PcmPipe::open()
+{
+    server = new QLocalServer;
+    server->setMaxPendingConnections(1);
+    if (!server->listen(QString("mpc-qt-waveform-%1")
+                        .arg(QUuid::createUuid().toString(QUuid::WithoutBraces))))
+        return false;
+    path_ = server->fullServerName();
+    QObject::connect(server, &QLocalServer::newConnection, context, [this]() {
+        if (socket)
+            return;
+        socket = server->nextPendingConnection();
+        // Let the pipe fill up rather than our buffer
+        socket->setReadBufferSize(chunkSamples * qint64(sizeof(qint16)));
+        QObject::connect(socket, &QLocalSocket::readyRead, context, readyRead);
+        readyRead();
+    });
+    return true;
+}
+
+qint64 PcmPipe::read(char *data, qint64 maxSize)
+{
+    if (!socket)
+        return 0;
+    qint64 got = socket->read(data, maxSize);
+    if (got <= 0 && socket->state() != QLocalSocket::ConnectedState)
+        return -1;
+    return std::max<qint64>(got, 0);
+}
+
+void PcmPipe::setEnabled(bool enabled)
+{
+    // The socket only buffers so much, so there's nothing to hold back
+    Q_UNUSED(enabled)
+}
+
+void PcmPipe::close(const std::function<void()> &stopWriter)
+{
+    // Once our end is gone, mpv's writes fail rather than block, and a
+    // late attempt to open the pipe finds nothing there.
+    delete socket;
+    socket = nullptr;
+    delete server;
+    server = nullptr;
+    stopWriter();
+}
+
+#else
+
+bool PcmPipe::open()
+{
+    path_ = QDir::temp().filePath(QString("mpc-qt-waveform-%1.pcm")
+                                  .arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    QByteArray name = QFile::encodeName(path_);
+    if (::mkfifo(name.constData(), 0600) < 0) {
+        path_.clear();
+        return false;
+    }
+    // Opened without blocking, so that mpv's open finds a reader waiting
+    fd = ::open(name.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
+    // The fifo only wakes us up once a writer has been and brought data or
+    // gone again.
+    QObject::connect(notifier, &QSocketNotifier::activated, context, [this]() {
+        connected = true;
+        this->readyRead();
+    });
+    return true;
+}
+
+qint64 PcmPipe::read(char *data, qint64 maxSize)
+{
+    if (fd < 0)
+        return -1;
+    ssize_t got;
+    do {
+        got = ::read(fd, data, size_t(maxSize));
+    } while (got < 0 && errno == EINTR);
+    if (got > 0)
+        return got;
+    // Until mpv opens its end, the fifo reads as empty rather than ended
+    if ((got < 0 && errno == EAGAIN) || !connected)
+        return 0;
+    // The writer went away; stop the notifier from firing on the hangup
+    if (notifier)
+        notifier->setEnabled(false);
+    return -1;
+}
+
+void PcmPipe::setEnabled(bool enabled)
+{
+    if (notifier)
+        notifier->setEnabled(enabled);
+}
+
+void PcmPipe::close(const std::function<void()> &stopWriter)
+{
+    delete notifier;
+    notifier = nullptr;
+    if (fd < 0) {
+        stopWriter();
+    } else {
+        // mpv may be blocked writing into a full pipe, or about to open it,
+        // and closing our end first would leave it stuck in the latter.  So
+        // keep emptying the pipe until mpv is gone.
+        std::atomic<bool> stopped { false };
+        std::thread drain([this, &stopped]() {
+            char sink[4096];
+            while (!stopped) {
+                pollfd p { fd, POLLIN, 0 };
+                if (::poll(&p, 1, 20) > 0 && ::read(fd, sink, sizeof(sink)) == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        });
+        stopWriter();
+        stopped = true;
+        drain.join();
+        ::close(fd);
+        fd = -1;
+    }
+    if (!path_.isEmpty()) {
+        QFile::remove(path_);
+        path_.clear();
+    }
+}
+
+#endif
+
+QString PcmPipe::path() const
+{
+    return path_;
+}
+
+WaveformAnalyzer::WaveformAnalyzer(QObject *parent)
+    : QObject(parent)
+{
+    poll = new QTimer(this);
+    poll->setInterval(pollMsec);
+    connect(poll, &QTimer::timeout,
+            this, &WaveformAnalyzer::poll_timeout);
+}
+
+WaveformAnalyzer::~WaveformAnalyzer()
+{
+    deinitPlayer();
+}
+
+void WaveformAnalyzer::setSource(const QUrl &url)
+{
+    // Decoding a stream twice would double the bandwidth, so only local
+    // files get a waveform.
+    QUrl local = url.isLocalFile() ? url : QUrl();
+    if (local == source)
+        return;
+    source = local;
+    serial++;
+    duration = 0;
+
+    // A fresh instance per file, so that the end of the last file can't be
+    // mistaken for the end of this one.
+    deinitPlayer();
+    waveform = Waveform();
+    emit waveformChanged(waveform);
+    if (!source.isEmpty())
+        loadWaveform();
+}
+
+void WaveformAnalyzer::initPlayer()
+{
+    pipe = new PcmPipe(this, [this]() { readPipe(); });
+    if (!pipe->open()) {
+        LogStream(logModule) << "could not make a pipe for " << source;
+        delete pipe;
+        pipe = nullptr;
+        return;
+    }
+    mpv = new MpvObject(this, friendlyName, MpvObject::HelperRole);
+    int current = serial;
+    connect(mpv, &MpvObject::playLengthChanged,
+            this, [this, current](double length) {
+        if (current == serial)
+            mpv_playLengthChanged(length);
+    });
+    connect(mpv, &MpvObject::playbackFinished,
+            this, [this, current]() {
+        if (current == serial)
+            mpv_playbackFinished();
+    });
+
+    // Raw mono samples at a low rate are plenty for an overview, and keep
+    // the amount of data to go through small.
+    emit mpv->ctrlSetOptionVariant("vid", "no");
+    emit mpv->ctrlSetOptionVariant("sid", "no");
+    emit mpv->ctrlSetOptionVariant("vo", "null");
+    emit mpv->ctrlSetOptionVariant("ao", "pcm");
+    emit mpv->ctrlSetOptionVariant("ao-pcm-file", pipe->path());
+    emit mpv->ctrlSetOptionVariant("ao-pcm-waveheader", "no");
+    emit mpv->ctrlSetOptionVariant("audio-format", "s16");
+    emit mpv->ctrlSetOptionVariant("audio-channels", "mono");
+    emit mpv->ctrlSetOptionVariant("audio-samplerate", sampleRate);
+    emit mpv->ctrlSetOptionVariant("untimed", "yes");
+
+    decoding = true;
+    draining = false;
+    readSincePoll = false;
+    pendingByte = false;
+    poll->start();
+    LogStream(logModule) << "analyzing " << source;
+    mpv->urlOpen(source);
+}
+
+void WaveformAnalyzer::deinitPlayer()
+{
+    poll->stop();
+    decoding = false;
+    draining = false;
+    MpvObject *player = mpv;
+    mpv = nullptr;
+    auto stopWriter = [player]() { delete player; };
+    if (pipe) {
+        pipe->close(stopWriter);
+        delete pipe;
+        pipe = nullptr;
+    } else {
+        stopWriter();
+    }
+}
+
+void WaveformAnalyzer::loadWaveform()
+{
+    // Look for a waveform from an earlier run off the gui thread, and only
+    // decode the file when there isn't one.
+    int current = serial;
+    QUrl media = source;
+    QtConcurrent::run([media]() {
+        return ThumbnailCache::singleton()->fetchData(media, cacheKey);
+    }).then(this, [this, current](const QByteArray &data) {
+        if (current != serial)
+            return;
+        if (!takeWaveform(data))
+            initPlayer();
+    });
+}
+
+bool WaveformAnalyzer::takeWaveform(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return false;
+    Waveform loaded;
+    QDataStream stream(data);
+    stream >> loaded.low >> loaded.high >> loaded.rms;
+    if (stream.status() != QDataStream::Ok || loaded.low.isEmpty()
+            || loaded.high.count() != loaded.count() || loaded.rms.count() != loaded.count())
+        return false;
+    loaded.filled = loaded.count();
+    waveform = loaded;
+    emit waveformChanged(waveform);
+    return true;
+}
+
+void WaveformAnalyzer::saveWaveform()
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << waveform.low << waveform.high << waveform.rms;
+    ThumbnailCache::singleton()->storeData(source, cacheKey, data);
+}
+
+void WaveformAnalyzer::resetBuckets()
+{
+    totalSamples = std::max<qint64>(1, qint64(duration * sampleRate));
+    samplesSeen = 0;
+    bucket = 0;
+    bucketEnd = std::max<qint64>(1, totalSamples / waveformBuckets);
+    bucketLow = std::numeric_limits<qint16>::max();
+    bucketHigh = std::numeric_limits<qint16>::min();
+    bucketSquares = 0;
+    bucketSamples = 0;
+    waveform = Waveform();
+    waveform.low.fill(0, waveformBuckets);
+    waveform.high.fill(0, waveformBuckets);
+    waveform.rms.fill(0, waveformBuckets);
+}
+
+// The inner loop keeps its accumulators in locals and has no branches, so
+// that compilers turn it into packed min, max and multiply-add instructions.
+static void accumulate(const qint16 *samples, qint64 count,
+                       int &low, int &high, qint64 &squares)
+{
+    int l = low;
+    int h = high;
+    qint64 sq = 0;
+    for (qint64 i = 0; i < count; i++) {
+        int v = samples[i];
+        l = std::min(l, v);
+        h = std::max(h, v);
+        sq += v * v;
+    }
+    low = l;
+    high = h;
+    squares += sq;
+}
+
+void WaveformAnalyzer::consume(const qint16 *samples, qint64 count)
+{
+    while (count > 0) {
+        // The duration is only an estimate, so anything past the end of it
+        // goes into the last bucket.
+        qint64 span = bucket < waveformBuckets - 1 ? std::min(count, bucketEnd - samplesSeen)
+                                                   : count;
+        accumulate(samples, span, bucketLow, bucketHigh, bucketSquares);
+        bucketSamples += span;
+        samplesSeen += span;
+        samples += span;
+        count -= span;
+        if (bucket < waveformBuckets - 1 && samplesSeen >= bucketEnd)
+            closeBucket();
+    }
+}
+
+void WaveformAnalyzer::closeBucket()
+{
+    constexpr float scale = 1.0f / 32768.0f;
+    if (bucketSamples > 0) {
+        waveform.low[bucket] = bucketLow * scale;
+        waveform.high[bucket] = bucketHigh * scale;
+        waveform.rms[bucket] = float(std::sqrt(double(bucketSquares) / bucketSamples)) * scale;
+    }
+    waveform.filled = ++bucket;
+    bucketEnd = totalSamples * (bucket + 1) / waveformBuckets;
+    bucketLow = std::numeric_limits<qint16>::max();
+    bucketHigh = std::numeric_limits<qint16>::min();
+    bucketSquares = 0;
+    bucketSamples = 0;
+}
+
+void WaveformAnalyzer::finish()
+{
+    while (bucket < waveformBuckets)
+        closeBucket();
+    LogStream(logModule) << "analyzed " << QString::number(samplesSeen) << " samples of " << source;
+    deinitPlayer();
+    saveWaveform();
+    emit waveformChanged(waveform);
+}
+
+void WaveformAnalyzer::mpv_playLengthChanged(double length)
+{
+    // Buckets are laid out by duration, so nothing is read before it's known.
+    if (duration > 0 || length <= 0)
+        return;
+    duration = length;
+    resetBuckets();
+    if (pipe)
+        pipe->setEnabled(true);
+    readPipe();
+}
+
+void WaveformAnalyzer::mpv_playbackFinished()
+{
+    // Whatever is still in the pipe is read by the next polls.
+    draining = true;
+}
+
+void WaveformAnalyzer::readPipe()
+{
+    if (!decoding || !pipe)
+        return;
+    if (duration <= 0) {
+        // Leave the samples in the pipe until they can be put in buckets
+        pipe->setEnabled(false);
+        return;
+    }
+
+    // Read what has arrived in bounded chunks, and leave any odd byte for
+    // when the rest of its sample arrives.
+    QList<qint16> chunk(chunkSamples);
+    char *bytes = reinterpret_cast<char*>(chunk.data());
+    qint64 budget = maxSamplesPerRead;
+    while (budget > 0) {
+        qint64 offset = pendingByte ? 1 : 0;
+        if (pendingByte)
+            bytes[0] = oddByte;
+        qint64 wanted = std::min(chunkSamples, budget) * qint64(sizeof(qint16));
+        qint64 got = pipe->read(bytes + offset, wanted - offset);
+        if (got <= 0)
+            break;
+        got += offset;
+        pendingByte = got & 1;
+        if (pendingByte)
+            oddByte = bytes[got - 1];
+        consume(chunk.constData(), got / qint64(sizeof(qint16)));
+        budget -= got / qint64(sizeof(qint16));
+        readSincePoll = true;
+    }
+
+    // Don't hog the event loop; carry on once it has had a look around.
+    if (budget <= 0) {
+        int current = serial;
+        QTimer::singleShot(0, this, [this, current]() {
+            if (current == serial)
+                readPipe();
+        });
+    }
+}
+
+void WaveformAnalyzer::poll_timeout()
+{
+    if (!decoding)
+        return;
+    if (duration <= 0) {
+        if (draining) {
+            Logger::log(logModule, "no duration known, giving up");
+            deinitPlayer();
+        }
+        return;
+    }
+
+    // Everything mpv wrote before finishing is in the pipe by then, so
+    // once a whole poll goes by without anything arriving, we're done.
+    bool gotSamples = readSincePoll;
+    readSincePoll = false;
+    if (draining && !gotSamples) {
+        readPipe();
+        if (!readSincePoll) {
+            finish();
+            return;
+        }
+    }
+    if (gotSamples)
+        emit waveformChanged(waveform);
+}
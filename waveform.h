@@ -0,0 +1,86 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+class MpvObject;
+class PcmPipe;
+class QTimer;
+
+// A loudness overview of a file's audio.  The file is split into a fixed
+// number of buckets, and each one holds its lowest and highest sample and
+// its rms, all scaled to -1..1.  Buckets before filled are final.
+struct Waveform {
+    QList<float> low;
+    QList<float> high;
+    QList<float> rms;
+    int filled = 0;
+
+    int count() const { return low.count(); }
+    bool isEmpty() const { return filled == 0; }
+};
+
+// WaveformAnalyzer works out the waveform of the file being played.  A
+// headless, audio-only mpv instance decodes the file, downmixed and
+// resampled to a low rate, into a pipe which is read and reduced to buckets
+// as the samples arrive.  mpv can only get ahead of us by the size of the
+// pipe, so neither memory nor disk use depends on the length of the file,
+// and the waveform fills in from left to right.  The finished waveform is
+// kept in the thumbnail cache.
+class WaveformAnalyzer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WaveformAnalyzer(QObject *parent = nullptr);
+    ~WaveformAnalyzer();
+
+    void setSource(const QUrl &url);
+
+signals:
+    void waveformChanged(const Waveform &waveform);
+
+private:
+    void initPlayer();
+    void deinitPlayer();
+    void loadWaveform();
+    bool takeWaveform(const QByteArray &data);
+    void saveWaveform();
+    void resetBuckets();
+    void readPipe();
+    void consume(const qint16 *samples, qint64 count);
+    void closeBucket();
+    void finish();
+
+    void mpv_playLengthChanged(double length);
+    void mpv_playbackFinished();
+
+private slots:
+    void poll_timeout();
+
+private:
+    MpvObject *mpv = nullptr;
+    QTimer *poll = nullptr;
+    QUrl source;
+    int serial = 0;
+    PcmPipe *pipe = nullptr;
+    double duration = 0;
+    bool decoding = false;
+    bool draining = false;
+    bool readSincePoll = false;
+    bool pendingByte = false;
+    char oddByte = 0;
+
+    qint64 totalSamples = 0;
+    qint64 samplesSeen = 0;
+    qint64 bucketEnd = 0;
+    int bucket = 0;
+    int bucketLow = 0;
+    int bucketHigh = 0;
+    qint64 bucketSquares = 0;
+    qint64 bucketSamples = 0;
+    Waveform waveform;
+};
+
+#endif // WAVEFORM_H
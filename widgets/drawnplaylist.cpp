@@ -4,12 +4,18 @@
 #include <QFontMetrics>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QScrollBar>
+#include <QSet>
+#include <algorithm>
 #include "drawnplaylist.h"
 #include "playlist.h"
 #include "helpers.h"
 #include "logger.h"
 
-PlayPainter::PlayPainter(QObject *parent) : QAbstractItemDelegate(parent) {}
+static constexpr int textCacheSize = 4096;
+
+PlayPainter::PlayPainter(QObject *parent) : QAbstractItemDelegate(parent),
+    textCache(textCacheSize) {}
 
 void PlayPainter::paint(QPainter *painter, const QStyleOptionViewItem &option,
                         const QModelIndex &index) const
@@ -18,7 +24,7 @@ void PlayPainter::paint(QPainter *painter, const QStyleOptionViewItem &option,
     auto p = playWidget->playlist();
     if (p == nullptr)
         return;
-    QSharedPointer<Item> i = p->getItem(QUuid(index.data(Qt::DisplayRole).toString()));
+    QSharedPointer<Item> i = p->getItem(index.data(Qt::UserRole).toUuid());
     if (i == nullptr)
         return;
 
@@ -47,20 +53,22 @@ void PlayPainter::paint(QPainter *painter, const QStyleOptionViewItem &option,
         rc.adjust(0, 0, -(3 + extraTextWidth), 0);
     }
 
-    DisplayParser *dp = playWidget->displayParser();
-    QString text = i->toDisplayString();
-    if (dp) {
-        // TODO: detect what type of file is being played
-        text = dp->parseMetadata(i->metadata(), text, Helpers::VideoFile);
-    }
-    text.replace('\n',' ');
+    RenderedText *rendered = renderedText(i, playWidget->displayParser());
+    bool bold = i->uuid() == playWidget->nowPlayingItem();
 
     QFont f = playWidget->font();
-    f.setBold(i->uuid() == playWidget->nowPlayingItem());
+    f.setBold(bold);
     painter->setFont(f);
+    if (rendered->elidedWidth != rc.width() || rendered->elidedBold != bold) {
+        rendered->elided = painter->fontMetrics().elidedText(rendered->text,
+                                                             Qt::ElideRight,
+                                                             rc.width());
+        rendered->elidedWidth = rc.width();
+        rendered->elidedBold = bold;
+    }
     painter->setPen(playWidget->palette().text().color());
     painter->drawText(rc, Qt::AlignLeft|Qt::AlignVCenter,
-                      text);
+                      rendered->elided);
     painter->setFont(playWidget->font());
 }
 
@@ -73,32 +81,204 @@ QSize PlayPainter::sizeHint(const QStyleOptionViewItem &option,
                                                    option.rect.size());
 }
 
-PlayItem::PlayItem(const QUuid &itemUuid, const QUuid &playlistUuid,
-                   QListWidget *parent)
-    : QListWidgetItem(parent, QListWidgetItem::UserType)
+void PlayPainter::clearTextCache()
 {
-    playlistUuid_ = playlistUuid;
-    itemUuid_ = itemUuid;
-    setData(Qt::DisplayRole, itemUuid.toString());
+    textCache.clear();
 }
 
-PlayItem::~PlayItem()
+PlayPainter::RenderedText *PlayPainter::renderedText(const QSharedPointer<Item> &item,
+                                                     DisplayParser *dp) const
 {
+    int parserRevision = dp ? dp->revision() : -1;
+    RenderedText *rendered = textCache.object(item->uuid());
+    if (rendered && rendered->itemRevision == item->revision()
+            && rendered->parserRevision == parserRevision)
+        return rendered;
+
+    QString text = item->toDisplayString();
+    if (dp) {
+        // TODO: detect what type of file is being played
+        text = dp->parseMetadata(item->metadata(), text, Helpers::VideoFile);
+    }
+    text.replace('\n',' ');
 
+    rendered = new RenderedText;
+    rendered->itemRevision = item->revision();
+    rendered->parserRevision = parserRevision;
+    rendered->text = text;
+    textCache.insert(item->uuid(), rendered);
+    return rendered;
 }
 
-QUuid PlayItem::playlistUuid()
+PlaylistModel::PlaylistModel(DrawnPlaylist *list)
+    : QAbstractListModel(list), list(list)
 {
-    return playlistUuid_;
 }
 
-QUuid PlayItem::uuid()
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return rows.count();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.count())
+        return QVariant();
+    if (role == Qt::UserRole)
+        return rows[index.row()];
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    auto p = list->playlist();
+    if (p == nullptr)
+        return QVariant();
+    QSharedPointer<Item> i = p->getItem(rows[index.row()]);
+    if (i == nullptr)
+        return QVariant();
+    return i->toDisplayString();
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::ItemIsDropEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions PlaylistModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+bool PlaylistModel::moveRows(const QModelIndex &sourceParent, int sourceRow,
+                             int count, const QModelIndex &destinationParent,
+                             int destinationChild)
+{
+    if (sourceParent.isValid() || destinationParent.isValid() || count < 1
+            || sourceRow < 0 || sourceRow + count > rows.count())
+        return false;
+    if (!beginMoveRows(QModelIndex(), sourceRow, sourceRow + count - 1,
+                       QModelIndex(), destinationChild))
+        return false;
+
+    // The moved items go before whatever is shown at the destination row,
+    // or to the end of the playlist when dropped past the last row.
+    QUuid destinationId = destinationChild < rows.count() ? rows[destinationChild]
+                                                          : QUuid();
+    QList<QUuid> moved = rows.mid(sourceRow, count);
+    rows.remove(sourceRow, count);
+    invalidateIndexFrom(std::min(sourceRow, destinationChild));
+    int target = destinationChild > sourceRow ? destinationChild - count
+                                              : destinationChild;
+    for (int i = 0; i < moved.count(); i++)
+        rows.insert(target + i, moved[i]);
+
+    QSharedPointer<Playlist> p = list->playlist();
+    if (!p.isNull()) {
+        QList<QSharedPointer<Item>> itemsToGrab;
+        for (const QUuid &itemUuid : moved)
+            itemsToGrab.append(p->getItem(itemUuid));
+        p->takeItemsRaw(itemsToGrab);
+        p->addItems(destinationId, itemsToGrab);
+    }
+    endMoveRows();
+    return true;
+}
+
+QUuid PlaylistModel::uuidAt(int row) const
+{
+    if (row < 0 || row >= rows.count())
+        return QUuid();
+    return rows[row];
+}
+
+int PlaylistModel::rowOf(const QUuid &itemUuid) const
+{
+    auto it = rowIndex.constFind(itemUuid);
+    if (it != rowIndex.constEnd() && it.value() < indexedRows)
+        return it.value();
+    if (indexedRows == rows.count())
+        return -1;
+    rowIndex.reserve(rows.count());
+    for (int i = indexedRows; i < rows.count(); i++)
+        rowIndex.insert(rows[i], i);
+    indexedRows = rows.count();
+    return rowIndex.value(itemUuid, -1);
+}
+
+void PlaylistModel::invalidateIndexFrom(int row)
+{
+    indexedRows = std::min(indexedRows, row);
+}
+
+void PlaylistModel::setUuids(const QList<QUuid> &uuids)
+{
+    // When only the order changed (i.e. a sort), keep the selection and
+    // scroll position by announcing a layout change instead of a reset.
+    bool reordered = uuids.count() == rows.count() && !rows.isEmpty();
+    if (reordered) {
+        QSet<QUuid> before(rows.constBegin(), rows.constEnd());
+        for (const QUuid &itemUuid : uuids) {
+            if (!before.contains(itemUuid)) {
+                reordered = false;
+                break;
+            }
+        }
+    }
+    rowIndex.clear();
+    indexedRows = 0;
+    if (!reordered) {
+        beginResetModel();
+        rows = uuids;
+        endResetModel();
+        return;
+    }
+
+    emit layoutAboutToBeChanged();
+    QHash<QUuid, int> newRows;
+    newRows.reserve(uuids.count());
+    for (int i = 0; i < uuids.count(); i++)
+        newRows.insert(uuids[i], i);
+    QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.count());
+    for (const QModelIndex &index : std::as_const(from))
+        to.append(index.isValid() ? this->index(newRows.value(rows[index.row()]))
+                                  : QModelIndex());
+    rows = uuids;
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+}
+
+void PlaylistModel::insertUuids(int row, const QList<QUuid> &uuids)
+{
+    if (uuids.isEmpty())
+        return;
+    row = qBound(0, row, rows.count());
+    beginInsertRows(QModelIndex(), row, row + uuids.count() - 1);
+    for (int i = 0; i < uuids.count(); i++)
+        rows.insert(row + i, uuids[i]);
+    invalidateIndexFrom(row);
+    endInsertRows();
+}
+
+void PlaylistModel::removeUuids(int row, int count)
 {
-    return itemUuid_;
+    if (count < 1 || row < 0 || row + count > rows.count())
+        return;
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    for (int i = row; i < row + count; i++)
+        rowIndex.remove(rows[i]);
+    rows.remove(row, count);
+    invalidateIndexFrom(row);
+    endRemoveRows();
 }
 
+
+
 DrawnPlaylist::DrawnPlaylist(QSharedPointer<PlaylistCollection> collection,
-                             QWidget *parent) : QListWidget(parent),
+                             QWidget *parent) : QListView(parent),
     displayParser_(nullptr), worker(nullptr), searcher(nullptr)
 {
     worker = new QThread();
@@ -107,27 +287,42 @@ DrawnPlaylist::DrawnPlaylist(QSharedPointer<PlaylistCollection> collection,
     searcher->moveToThread(worker);
 
     collection_ = collection;
+    model_ = new PlaylistModel(this);
+    setModel(model_);
+    setUniformItemSizes(true);
     setSelectionMode(QAbstractItemView::ContiguousSelection);
     setDragDropMode(QAbstractItemView::InternalMove);
 
-    setItemDelegate(new PlayPainter(this));
+    painter_ = new PlayPainter(this);
+    setItemDelegate(painter_);
 
     connect(worker, &QThread::finished, searcher, &QObject::deleteLater);
-    connect(model(), SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
-            this, SLOT(model_rowsMoved(QModelIndex,int,int,QModelIndex,int)));
     connect(this, &DrawnPlaylist::searcher_filterPlaylist,
             searcher, &PlaylistSearcher::filterPlaylist,
             Qt::QueuedConnection);
     connect(searcher, &PlaylistSearcher::playlistFiltered,
             this, &DrawnPlaylist::repopulateItems,
             Qt::QueuedConnection);
-    connect(this, &DrawnPlaylist::currentItemChanged,
-            this, &DrawnPlaylist::self_currentItemChanged);
-    connect(this, SIGNAL(itemDoubleClicked(QListWidgetItem*)),
-            this, SLOT(self_itemDoubleClicked(QListWidgetItem*)));
+    connect(selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &DrawnPlaylist::self_currentChanged);
+    connect(this, &DrawnPlaylist::doubleClicked,
+            this, &DrawnPlaylist::self_doubleClicked);
     connect(this, SIGNAL(customContextMenuRequested(QPoint)),
             this, SLOT(self_customContextMenuRequested(QPoint)));
     setContextMenuPolicy(Qt::CustomContextMenu);
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &DrawnPlaylist::visibleItemsChanged);
+    connect(model_, &PlaylistModel::rowsInserted,
+            this, &DrawnPlaylist::visibleItemsChanged);
+    connect(model_, &PlaylistModel::rowsRemoved,
+            this, &DrawnPlaylist::visibleItemsChanged);
+    connect(model_, &PlaylistModel::rowsMoved,
+            this, &DrawnPlaylist::visibleItemsChanged);
+    connect(model_, &PlaylistModel::layoutChanged,
+            this, &DrawnPlaylist::visibleItemsChanged);
+    connect(model_, &PlaylistModel::modelReset,
+            this, &DrawnPlaylist::visibleItemsChanged);
 }
 
 DrawnPlaylist::~DrawnPlaylist()
@@ -151,46 +346,72 @@ QUuid DrawnPlaylist::uuid() const
     return playlistUuid_;
 }
 
+int DrawnPlaylist::count() const
+{
+    return model_->rowCount();
+}
+
+int DrawnPlaylist::currentRow() const
+{
+    QModelIndex index = currentIndex();
+    return index.isValid() ? index.row() : -1;
+}
+
+void DrawnPlaylist::setCurrentRow(int row)
+{
+    setCurrentIndex(model_->index(row));
+}
+
 QUuid DrawnPlaylist::currentItemUuid() const
 {
-    PlayItem *item = reinterpret_cast<PlayItem*>(currentItem());
-    if (!item)
-        item = reinterpret_cast<PlayItem*>(QListWidget::item(0));
-    if (item)
-        return item->uuid();
-    return QUuid();
+    QModelIndex index = currentIndex();
+    return model_->uuidAt(index.isValid() ? index.row() : 0);
 }
 
 QList<QUuid> DrawnPlaylist::currentItemUuids() const
 {
+    QModelIndexList indexes = selectionModel()->selectedRows();
+    std::sort(indexes.begin(), indexes.end());
     QList<QUuid> selected;
-    for (auto &i : selectedItems())
-        selected.append(QUuid(i->text()));
+    selected.reserve(indexes.count());
+    for (const QModelIndex &index : std::as_const(indexes))
+        selected.append(model_->uuidAt(index.row()));
     return selected;
 }
 
+QList<QUuid> DrawnPlaylist::visibleItemUuids(int readAhead) const
+{
+    QList<QUuid> visible;
+    QRect area = viewport()->rect();
+    QModelIndex first = indexAt(area.topLeft());
+    if (!first.isValid())
+        return visible;
+    QModelIndex last = indexAt(area.bottomLeft());
+    int end = last.isValid() ? last.row() + 1 : model_->rowCount();
+    end = std::min(end + readAhead, model_->rowCount());
+    visible.reserve(end - first.row());
+    for (int row = first.row(); row < end; row++)
+        visible.append(model_->uuidAt(row));
+    return visible;
+}
+
 void DrawnPlaylist::traverseSelected(std::function<void (QUuid)> callback)
 {
-    for (auto &i : selectedItems())
-        callback(QUuid(i->text()));
+    for (const QUuid &itemUuid : currentItemUuids())
+        callback(itemUuid);
 }
 
 void DrawnPlaylist::setCurrentItem(QUuid itemUuid)
 {
-    QList<QListWidgetItem *> items = findItems(itemUuid.toString(), Qt::MatchExactly);
-    if (items.isEmpty())
-        setCurrentRow(-1);
-    else
-        QListWidget::setCurrentItem(items.first());
+    setCurrentRow(model_->rowOf(itemUuid));
 }
 
 void DrawnPlaylist::scrollToItem(QUuid itemUuid)
 {
-    auto items = findItems(itemUuid.toString(), Qt::MatchExactly);
-    if (items.empty())
+    int row = model_->rowOf(itemUuid);
+    if (row < 0)
         return;
-    auto item = items.first();
-    scrollTo(indexFromItem(item));
+    scrollTo(model_->index(row));
 }
 
 void DrawnPlaylist::setUuid(const QUuid &playlistUuid)
@@ -206,26 +427,20 @@ void DrawnPlaylist::setUuid(const QUuid &playlistUuid)
 
 void DrawnPlaylist::addItem(QUuid itemUuid)
 {
-    PlayItem *playItem = new PlayItem(itemUuid, playlistUuid_, this);
-    QListWidget::addItem(playItem);
+    addItems({ itemUuid });
 }
 
 void DrawnPlaylist::addItems(const QList<QUuid> &items)
 {
-    for (const QUuid &item : items)
-        addItem(item);
+    model_->insertUuids(model_->rowCount(), items);
 }
 
 void DrawnPlaylist::addItemsAfter(QUuid item, const QList<QUuid> &items)
 {
-    auto matchingRows = findItems(item.toString(), Qt::MatchExactly);
-    if (matchingRows.length() < 1)
+    int row = model_->rowOf(item);
+    if (row < 0)
         return;
-    int itemIndex = row(matchingRows[0]) + 1;
-    for (auto i : items) {
-        PlayItem *playItem = new PlayItem(i);
-        QListWidget::insertItem(itemIndex++, playItem);
-    }
+    model_->insertUuids(row + 1, items);
 }
 
 void DrawnPlaylist::removeItem(QUuid itemUuid)
@@ -233,9 +448,9 @@ void DrawnPlaylist::removeItem(QUuid itemUuid)
     QSharedPointer<Playlist> playlist = this->playlist();
     if (playlist && playlist->contains(itemUuid))
         playlist->removeItem(itemUuid);
-    auto matchingRows = findItems(itemUuid.toString(), Qt::MatchExactly);
-    if (matchingRows.length() > 0)
-        takeItem(row(matchingRows[0]));
+    int row = model_->rowOf(itemUuid);
+    if (row >= 0)
+        model_->removeUuids(row, 1);
 }
 
 void DrawnPlaylist::removeItems(const QList<int> &indicies)
@@ -243,7 +458,7 @@ void DrawnPlaylist::removeItems(const QList<int> &indicies)
     QListIterator<int> iterator(indicies);
     iterator.toBack();
     while (iterator.hasPrevious())
-        delete takeItem(iterator.previous());
+        model_->removeUuids(iterator.previous(), 1);
 }
 
 void DrawnPlaylist::removeAll()
@@ -252,22 +467,33 @@ void DrawnPlaylist::removeAll()
     if (!p)
         return;
     p->clear();
-    clear();
+    model_->setUuids({});
 }
 
 PlaylistItem DrawnPlaylist::importUrl(QUrl url)
 {
-    PlaylistItem playlistItem;
+    return importUrls({ url });
+}
+
+PlaylistItem DrawnPlaylist::importUrls(const QList<QUrl> &urls)
+{
+    PlaylistItem firstPlaylistItem;
     QSharedPointer<Playlist> playlist = this->playlist();
     if (!playlist)
-        return playlistItem;
-    auto item = playlist->addItem(url);
-    playlistItem.list = playlistUuid_;
-    playlistItem.item = item->uuid();
-    if (currentFilterText.isEmpty() ||
-            PlaylistSearcher::itemMatchesFilter(item, currentFilterList))
-        addItem(item->uuid());
-    return playlistItem;
+        return firstPlaylistItem;
+    QList<QUuid> shown;
+    for (const QUrl &url : urls) {
+        auto item = playlist->addItem(url);
+        if (firstPlaylistItem.item.isNull()) {
+            firstPlaylistItem.list = playlistUuid_;
+            firstPlaylistItem.item = item->uuid();
+        }
+        if (currentFilterText.isEmpty() ||
+                PlaylistSearcher::itemMatchesFilter(item, currentFilterList))
+            shown.append(item->uuid());
+    }
+    addItems(shown);
+    return firstPlaylistItem;
 }
 
 void DrawnPlaylist::currentToQueue()
@@ -288,11 +514,11 @@ QUuid DrawnPlaylist::nowPlayingItem()
 void DrawnPlaylist::setNowPlayingItem(QUuid itemUuid)
 {
     QSharedPointer<Playlist> playlist = this->playlist();
-    bool refreshNeeded = playlist->contains(nowPlayingItem()) || playlist->contains(itemUuid);
+    QUuid previousItem = nowPlayingItem();
     nowPlayingItem_ = itemUuid;
     playlist->setNowPlaying(nowPlayingItem_);
-    if (refreshNeeded)
-        viewport()->repaint();
+    updateItem(previousItem);
+    updateItem(itemUuid);
 }
 
 QVariantMap DrawnPlaylist::toVMap() const
@@ -314,6 +540,7 @@ void DrawnPlaylist::fromVMap(const QVariantMap &qvm)
 void DrawnPlaylist::setDisplayParser(DisplayParser *parser)
 {
     displayParser_ = parser;
+    painter_->clearTextCache();
 }
 
 DisplayParser *DrawnPlaylist::displayParser()
@@ -344,70 +571,80 @@ bool DrawnPlaylist::event(QEvent *e)
         }
     }
     end:
-    return QListWidget::event(e);
+    return QListView::event(e);
 }
 
-void DrawnPlaylist::repopulateItems()
+void DrawnPlaylist::changeEvent(QEvent *e)
 {
-    clear();
-
-    auto playlist = this->playlist();
-    if (playlist == nullptr)
-        return;
+    if (e->type() == QEvent::FontChange)
+        painter_->clearTextCache();
+    QListView::changeEvent(e);
+}
 
-    auto itemAdder = [&](QSharedPointer<Item> item) {
-        if (!item->hidden())
-            addItem(item->uuid());
-    };
-    playlist->iterateItems(itemAdder);
-    setCurrentItem(lastSelectedItem);
+void DrawnPlaylist::resizeEvent(QResizeEvent *e)
+{
+    QListView::resizeEvent(e);
+    emit visibleItemsChanged();
 }
 
-void DrawnPlaylist::model_rowsMoved(const QModelIndex &parent,
-                                     int start, int end,
-                                     const QModelIndex &destination, int row)
+void DrawnPlaylist::repopulateItems()
 {
-    Q_UNUSED(parent)
-    Q_UNUSED(destination)
-    QSharedPointer<Playlist> p = playlist();
-    if (p.isNull())
-        return;
-    QListWidgetItem *destinationItem = QListWidget::item(row);
-    QUuid destinationId = destinationItem ? QUuid(destinationItem->text())
-                                          : QUuid();
-    QList<QSharedPointer<Item>> itemsToGrab;
-    for (int index = start; index <= end; index++) {
-        QUuid itemUuid = QUuid(QListWidget::item(index)->text());
-        itemsToGrab.append(p->getItem(itemUuid));
+    QList<QUuid> visible;
+    auto playlist = this->playlist();
+    if (playlist != nullptr) {
+        visible.reserve(playlist->count());
+        auto itemAdder = [&](QSharedPointer<Item> item) {
+            if (!item->hidden())
+                visible.append(item->uuid());
+        };
+        playlist->iterateItems(itemAdder);
     }
-    p->takeItemsRaw(itemsToGrab);
-    p->addItems(destinationId, itemsToGrab);
+    model_->setUuids(visible);
+    if (playlist != nullptr)
+        setCurrentItem(lastSelectedItem);
+}
+
+void DrawnPlaylist::updateItem(const QUuid &itemUuid)
+{
+    int row = model_->rowOf(itemUuid);
+    if (row >= 0)
+        update(model_->index(row));
 }
 
-void DrawnPlaylist::self_currentItemChanged(QListWidgetItem *current,
-                                             QListWidgetItem *previous)
+void DrawnPlaylist::self_currentChanged(const QModelIndex &current,
+                                        const QModelIndex &previous)
 {
     Q_UNUSED(previous)
     QUuid itemUuid;
-    if (current && !(itemUuid=reinterpret_cast<PlayItem*>(current)->uuid()).isNull())
+    if (current.isValid() && !(itemUuid=model_->uuidAt(current.row())).isNull())
         lastSelectedItem = itemUuid;
 }
 
-void DrawnPlaylist::self_itemDoubleClicked(QListWidgetItem *item)
+void DrawnPlaylist::self_doubleClicked(const QModelIndex &index)
 {
-    PlayItem *playItem = reinterpret_cast<PlayItem*>(item);
-    emit itemDesired(playItem->playlistUuid(), playItem->uuid());
+    QUuid itemUuid = model_->uuidAt(index.row());
+    if (itemUuid.isNull())
+        return;
+    QUuid itemPlaylistUuid = playlistUuid_;
+    QSharedPointer<Playlist> p = playlist();
+    if (p == PlaylistCollection::queuePlaylist()) {
+        // Items shown in the queue still belong to the playlist they came from.
+        QSharedPointer<Item> item = p->getItem(itemUuid);
+        if (item.isNull())
+            return;
+        itemPlaylistUuid = item->playlistUuid();
+    }
+    emit itemDesired(itemPlaylistUuid, itemUuid);
 }
 
 void DrawnPlaylist::self_customContextMenuRequested(const QPoint &p)
 {
-    PlayItem *playItem = reinterpret_cast<PlayItem*>(this->itemAt(p));
-    QUuid playItemUuid = playItem ? playItem->uuid() : QUuid();
+    QModelIndex index = indexAt(p);
+    QUuid playItemUuid = index.isValid() ? model_->uuidAt(index.row()) : QUuid();
     emit contextMenuRequested(p, playlistUuid_, playItemUuid);
 }
 
 
-
 class PlaylistSelectionPrivate {
 public:
     QList<QSharedPointer<Item>> items;
@@ -507,11 +744,12 @@ QSharedPointer<Playlist> DrawnQueue::playlist() const
     return PlaylistCollection::queuePlaylist();
 }
 
-void DrawnQueue::addItem(QUuid itemUuid)
+void DrawnQueue::addItems(const QList<QUuid> &items)
 {
-    auto actualItem = ItemCollection::getSingleton()->getItem(itemUuid);
-    if (actualItem.isNull())
-        return;
-    PlayItem *playItem = new PlayItem(itemUuid, actualItem->playlistUuid(), this);
-    QListWidget::addItem(playItem);
+    QList<QUuid> existing;
+    existing.reserve(items.count());
+    for (const QUuid &itemUuid : items)
+        if (!ItemCollection::getSingleton()->getItem(itemUuid).isNull())
+            existing.append(itemUuid);
+    DrawnPlaylist::addItems(existing);
 }
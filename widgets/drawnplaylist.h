@@ -1,15 +1,20 @@
 #ifndef QDRAWNPLAYLIST_H
 #define QDRAWNPLAYLIST_H
 
-#include <QListWidget>
+#include <QAbstractListModel>
+#include <QCache>
+#include <QListView>
 #include <QUuid>
 #include <functional>
+#include "helpers.h"
 #include "playlist.h"
 
-class DisplayParser;
 class QThread;
 class PlaylistSearcher;
 
+// PlayPainter keeps the text it last drew for each item, along with the
+// elided form that fit the row, so that scrolling through a long playlist
+// does not run the display parser again for every row it passes.
 class PlayPainter : public QAbstractItemDelegate {
     Q_OBJECT
 public:
@@ -18,27 +23,62 @@ public:
                const QModelIndex &index) const;
     QSize sizeHint(const QStyleOptionViewItem &option,
                    const QModelIndex &index) const;
+    void clearTextCache();
+
+private:
+    struct RenderedText {
+        quint32 itemRevision = 0;
+        int parserRevision = -1;
+        QString text;
+        QString elided;
+        int elidedWidth = -1;
+        bool elidedBold = false;
+    };
+    RenderedText *renderedText(const QSharedPointer<Item> &item,
+                               DisplayParser *dp) const;
+
+    mutable QCache<QUuid, RenderedText> textCache;
 };
 
 
-class PlayItem : public QListWidgetItem {
+class DrawnPlaylist;
+
+// PlaylistModel presents the visible items of a playlist as rows.  Each row
+// only holds its item's uuid, and everything else is read from the playlist
+// when the row is asked for, so the cost of a list is that of its uuids.
+// Rows are found by uuid through an index that is trusted up to the first
+// row changed since it was built, and rebuilt from there when needed.
+class PlaylistModel : public QAbstractListModel {
+    Q_OBJECT
 public:
-    PlayItem(const QUuid &itemUuid = QUuid(), const QUuid &playlistUuid = QUuid(), QListWidget *parent = nullptr);
-    ~PlayItem();
+    explicit PlaylistModel(DrawnPlaylist *list);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual Qt::ItemFlags flags(const QModelIndex &index) const;
+    virtual Qt::DropActions supportedDropActions() const;
+    virtual bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                          const QModelIndex &destinationParent, int destinationChild);
 
-    QUuid playlistUuid();
-    QUuid uuid();
+    QUuid uuidAt(int row) const;
+    int rowOf(const QUuid &itemUuid) const;
+    void setUuids(const QList<QUuid> &uuids);
+    void insertUuids(int row, const QList<QUuid> &uuids);
+    void removeUuids(int row, int count);
 
 private:
-    QUuid playlistUuid_;
-    QUuid itemUuid_;
+    void invalidateIndexFrom(int row);
+
+    DrawnPlaylist *list = nullptr;
+    QList<QUuid> rows;
+    mutable QHash<QUuid, int> rowIndex;
+    mutable int indexedRows = 0;
 };
 
 
-// DrawnPlaylist abuses a ListWidget's items to store the uuid of playlist
-// items, which is decoded and looked up during drawing.  The alternative is a
-// subclass of QAbstractItemModel with about 1.5x the code.
-class DrawnPlaylist : public QListWidget {
+// DrawnPlaylist shows a playlist through a PlaylistModel, and PlayPainter
+// looks each row's item up in the playlist while drawing it.
+class DrawnPlaylist : public QListView {
     Q_OBJECT
 public:
     DrawnPlaylist(QSharedPointer<PlaylistCollection> collection, QWidget *parent = nullptr);
@@ -47,13 +87,19 @@ public:
     virtual QSharedPointer<Playlist> playlist() const;
     QUuid uuid() const;
     void setUuid(const QUuid &playlistUuid);
+    int count() const;
+    int currentRow() const;
+    void setCurrentRow(int row);
     QUuid currentItemUuid() const;
     QList<QUuid> currentItemUuids() const;
+    // The rows on screen from top to bottom, followed by up to readAhead
+    // of the rows below them.
+    QList<QUuid> visibleItemUuids(int readAhead = 0) const;
     void traverseSelected(std::function<void(QUuid)> callback);
     void setCurrentItem(QUuid itemUuid);
     void scrollToItem(QUuid itemUuid);
-    virtual void addItem(QUuid itemUuid);
-    void addItems(const QList<QUuid> &items);
+    void addItem(QUuid itemUuid);
+    virtual void addItems(const QList<QUuid> &items);
     void addItemsAfter(QUuid item, const QList<QUuid> &items);
     void removeItem(QUuid itemUuid);
     void removeItems(const QList<int> &indicies);
@@ -63,6 +109,7 @@ public:
               std::function<bool(const T &a, const T &b)> lessThan);
 
     PlaylistItem importUrl(QUrl url);
+    PlaylistItem importUrls(const QList<QUrl> &urls);
     void currentToQueue();
 
     QUuid nowPlayingItem();
@@ -80,11 +127,16 @@ public:
 
 protected:
     bool event(QEvent *e);
+    void changeEvent(QEvent *e);
+    void resizeEvent(QResizeEvent *e);
 
 private:
+    void updateItem(const QUuid &itemUuid);
+
     QSharedPointer<PlaylistCollection> collection_;
     QUuid playlistUuid_;
-    QHash <QUuid, PlayItem*> itemsByUuid;
+    PlaylistModel *model_ = nullptr;
+    PlayPainter *painter_ = nullptr;
     QUuid lastSelectedItem;
     QUuid nowPlayingItem_;
     DisplayParser *displayParser_ = nullptr;
@@ -101,13 +153,13 @@ signals:
     void menuOpenItem(QUuid playlistUuid, QUuid itemUuid);
 
     void contextMenuRequested(QPoint p, QUuid playlistUuid, QUuid itemUuid);
+    // Scrolled, resized, or the rows changed.
+    void visibleItemsChanged();
 
 private slots:
-    void model_rowsMoved(const QModelIndex & parent, int start, int end,
-                         const QModelIndex & destination, int row);
-    void self_currentItemChanged(QListWidgetItem *current,
-                                 QListWidgetItem *previous);
-    void self_itemDoubleClicked(QListWidgetItem *item);
+    void self_currentChanged(const QModelIndex &current,
+                             const QModelIndex &previous);
+    void self_doubleClicked(const QModelIndex &index);
     void self_customContextMenuRequested(const QPoint &p);
 };
 
@@ -115,20 +167,26 @@ template<class T>
 void DrawnPlaylist::sort(
         std::function<T(QSharedPointer<Item>)> converter,
         std::function<bool(const T &a, const T &b)> lessThan) {
-    QMap<QUuid,T> playlistMap;
-    QList<QSharedPointer<Item>> items;
+    using Keyed = std::pair<T, QSharedPointer<Item>>;
     auto pl = playlist();
-    int index = 0;
-    pl->iterateItems([&](QSharedPointer<Item> i) {
-        playlistMap.insert(i->uuid(), converter(i));
-        items.append(i);
-        i->setOriginalPosition(index++);
+    if (pl.isNull())
+        return;
+    // Work out each item's key once, sort the (key, item) pairs, and write
+    // the items back in that order.  The model sees a single layout change.
+    pl->reorderItems([&](QList<QSharedPointer<Item>> &items) {
+        QList<Keyed> keyed;
+        keyed.reserve(items.count());
+        for (int index = 0; index < items.count(); index++) {
+            keyed.append({ converter(items[index]), items[index] });
+            items[index]->setOriginalPosition(index);
+        }
+        Helpers::parallelSort(keyed.begin(), keyed.end(),
+                              [&lessThan](const Keyed &a, const Keyed &b) {
+            return lessThan(a.first, b.first);
+        });
+        for (int index = 0; index < items.count(); index++)
+            items[index] = keyed[index].second;
     });
-    std::sort(items.begin(), items.end(), [&](const QSharedPointer<Item> &a, const QSharedPointer<Item> &b) {
-        return lessThan(playlistMap.value(a->uuid()), playlistMap.value(b->uuid()));
-    });
-    pl->takeItemsRaw(items);
-    pl->addItems(QUuid(), items);
     repopulateItems();
 }
 
@@ -138,7 +196,7 @@ class DrawnQueue : public DrawnPlaylist {
 public:
     DrawnQueue();
     virtual QSharedPointer<Playlist> playlist() const;
-    void addItem(QUuid itemUuid);
+    virtual void addItems(const QList<QUuid> &items);
 };
 
 class PlaylistSelectionPrivate;
@@ -4,8 +4,10 @@
 #include <QOpenGLContext>
 #include <QTimer>
 #include <QCursor>
+#include <algorithm>
 #include <cmath>
 #include "drawnslider.h"
+#include "latencystats.h"
 #include "logger.h"
 
 
@@ -35,9 +37,16 @@ DrawnSlider::DrawnSlider(QWidget *parent, QSize handle, QSize margin, int paddin
 
 void DrawnSlider::setValue(double v)
 {
+    double before = handleX();
     vValue = qBound(vMinimum, v, vMaximum);
     xPosition = valueToX(vValue);
-    update();
+
+    // Position updates arrive far more often than the handle visibly moves,
+    // and when it does, only the area it left and entered needs painting.
+    double after = handleX();
+    if (std::abs(after - before) < 1.0/16.0)
+        return;
+    update(handleRect(before).united(handleRect(after)));
 }
 
 void DrawnSlider::setMaximum(double v)
@@ -45,8 +54,7 @@ void DrawnSlider::setMaximum(double v)
     vMaximum = v;
     if (vValue > v)
         setValue(v);
-    else
-        update();
+    invalidateBackground();
 }
 
 void DrawnSlider::setMinimum(double v)
@@ -54,8 +62,7 @@ void DrawnSlider::setMinimum(double v)
     vMinimum = v;
     if (vValue < v)
         setValue(v);
-    else
-        update();
+    invalidateBackground();
 }
 
 double DrawnSlider::value()
@@ -73,16 +80,21 @@ double DrawnSlider::minimum()
     return vMinimum;
 }
 
+bool DrawnSlider::dragMoved()
+{
+    return isDragMoved;
+}
+
 void DrawnSlider::setHighContrast(bool enabled)
 {
     highContrast = enabled;
-    redrawHandle = true;
+    recolor = true;
     update();
 }
 
 void DrawnSlider::applicationPaletteChanged()
 {
-    redrawHandle = true;
+    recolor = true;
     update();
 }
 
@@ -106,6 +118,12 @@ void DrawnSlider::handleHover(double x)
     (void)x;
 }
 
+void DrawnSlider::invalidateBackground()
+{
+    redrawBackground = true;
+    update();
+}
+
 double DrawnSlider::valueToX(double value)
 {
     double stride = sliderArea.right() - sliderArea.left();
@@ -122,9 +140,8 @@ double DrawnSlider::xToValue(double x)
     return qBound(minimum(), val, maximum());
 }
 
-void DrawnSlider::paintEvent(QPaintEvent *event)
+void DrawnSlider::updateColors()
 {
-    Q_UNUSED(event)
     QPalette pal;
     pal = reinterpret_cast<QWidget*>(parentWidget())->palette();
     if (highContrast) {
@@ -154,28 +171,72 @@ void DrawnSlider::paintEvent(QPaintEvent *event)
             markColor = markColor.lighter();
         }
     }
+}
+
+double DrawnSlider::handleX()
+{
+    return isDragging ? xPosition : valueToX(value());
+}
+
+QRect DrawnSlider::handleRect(double x)
+{
+    // Wide enough for every subpixel offset of the handle images
+    double left = std::floor(x - handleWidth/2.0);
+    double top = (height() - handleHeight)/2;
+    return QRectF(left - 1, top - 1, handleWidth + 3, handleHeight + 2).toAlignedRect();
+}
 
-    makeBackground();
+void DrawnSlider::paintEvent(QPaintEvent *event)
+{
+    qint64 started = LatencyStats::timestamp();
+    qreal pr = devicePixelRatioF();
+    bool fullPaint = recolor || redrawBackground || backgroundPic.isNull()
+            || !qFuzzyCompare(backgroundRatio, pr);
+    if (recolor) {
+        updateColors();
+        recolor = false;
+        redrawHandle = true;
+    }
+    if (fullPaint) {
+        makeBackground();
+        backgroundRatio = pr;
+        redrawBackground = false;
+    }
     if (redrawHandle) {
         makeHandle();
         redrawHandle = false;
     }
 
     QPainter p(this);
-    qreal pr = devicePixelRatioF();
     p.scale(1.0/pr, 1.0/pr);
     p.setRenderHint(QPainter::Antialiasing);
     p.setRenderHint(QPainter::SmoothPixmapTransform);
-    p.drawImage(0, 0, backgroundPic);
+    QRectF dirty(QPointF(event->rect().topLeft()) * pr, QSizeF(event->rect().size()) * pr);
+    p.drawImage(dirty, backgroundPic, dirty);
     p.setOpacity(isEnabled() ? 1.0 : 0.333);
 
     if (minimum() != maximum()) {
         double px;
-        double x = isDragging ? xPosition : valueToX(value());
+        double x = handleX();
         x -= handleWidth/2.0;
         int index = int(modf(x, &px) * 16.0)&15;
         p.drawImage(QPointF(px, (height() - handleHeight)/2)*pr, handlePics[index]);
     }
+    p.end();
+
+    // Painting cost shows up next to the mpv latencies.  A "handle" paint
+    // only moved the handle, a "full" one had to remake the background.
+    LatencyStats::singleton()->record(metaObject()->className(), fullPaint ? "full" : "handle",
+                                      started, LatencyStats::timestamp());
+}
+
+void DrawnSlider::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange)
+        recolor = true;
+    if (event->type() == QEvent::EnabledChange)
+        invalidateBackground();
+    QWidget::changeEvent(event);
 }
 
 void DrawnSlider::resizeEvent(QResizeEvent *event)
@@ -261,14 +322,20 @@ height  |         +          ----    hH
     sliderArea = grooveArea;
     sliderArea.adjust(0, 0, -(handleWidth&1), 0);
     redrawHandle = true;
+    redrawBackground = true;
 }
 
 void DrawnSlider::mousePressEvent(QMouseEvent *ev)
 {
     if (ev->button() == Qt::LeftButton) {
+        // Taken before the drag starts, as setValue would otherwise compare
+        // the new position with itself and leave the old handle drawn.
+        double before = handleX();
         isDragging = true;
+        isDragMoved = false;
         xPosition = ev->position().x();
         setValue(xToValue(ev->position().x()));
+        update(handleRect(before).united(handleRect(handleX())));
         emit sliderMoved(value());
     }
 }
@@ -276,8 +343,10 @@ void DrawnSlider::mousePressEvent(QMouseEvent *ev)
 void DrawnSlider::mouseReleaseEvent(QMouseEvent *ev)
 {
     if (isDragging && ev->button() == Qt::LeftButton) {
+        double before = handleX();
         isDragging = false;
-        update();
+        update(handleRect(before).united(handleRect(handleX())));
+        emit sliderReleased(value());
     }
 }
 
@@ -286,6 +355,7 @@ void DrawnSlider::mouseMoveEvent(QMouseEvent *ev)
     if (isDragging && ev->buttons() & Qt::LeftButton) {
         double mouseValue = xToValue(ev->position().x());
         if (value() != mouseValue) {
+            isDragMoved = true;
             setValue(mouseValue);
             emit sliderMoved(value());
         }
@@ -306,11 +376,13 @@ void MediaSlider::clearTicks()
     vLoopA = vLoopB = -1;
     loopArea = { -1, -1, 0, 0 };
     redrawHandle = true;
+    invalidateBackground();
 }
 
 void MediaSlider::setTick(double value, QString text)
 {
     ticks.insert(value, text);
+    invalidateBackground();
 }
 
 void MediaSlider::setLoopA(double a)
@@ -323,6 +395,12 @@ void MediaSlider::setLoopB(double b)
     vLoopB = b; updateLoopArea();
 }
 
+void MediaSlider::setWaveform(const Waveform &waveform)
+{
+    this->waveform = waveform;
+    invalidateBackground();
+}
+
 double MediaSlider::loopA()
 {
     return vLoopA;
@@ -343,7 +421,7 @@ void MediaSlider::makeBackground()
     Logger::log("drawnslider", "MediaSlider::makeBackground");
     qreal pr = devicePixelRatioF();
     int pw = width() * pr;
-    int ph = width() * pr;
+    int ph = height() * pr;
     backgroundPic = QImage(pw, ph, QImage::Format_RGBA8888);
     backgroundPic.fill(Qt::transparent);
     QPainter p(&backgroundPic);
@@ -371,6 +449,9 @@ void MediaSlider::makeBackground()
 
     }
 
+    // Draw the audio overview
+    drawWaveform(&p);
+
     // Draw chapter marks
     p.setPen(markColor);
     for (auto i = ticks.constBegin(); i != ticks.constEnd(); i++) {
@@ -392,6 +473,31 @@ void MediaSlider::makeBackground()
 
 }
 
+void MediaSlider::drawWaveform(QPainter *p)
+{
+    if (waveform.isEmpty() || maximum() <= minimum())
+        return;
+
+    // Peaks are drawn faintly, with the rms in the middle of them stronger.
+    double mid = grooveArea.center().y();
+    double half = (grooveArea.height() - 4) / 2.0;
+    double stride = (maximum() - minimum()) / waveform.count();
+    QColor peakColor = markColor;
+    QColor rmsColor = markColor;
+    peakColor.setAlphaF(0.35f);
+    rmsColor.setAlphaF(0.7f);
+    p->setPen(Qt::NoPen);
+    for (int i = 0; i < waveform.filled; i++) {
+        double left = valueToX(minimum() + i * stride);
+        double right = std::max(left + 1.0, valueToX(minimum() + (i + 1) * stride));
+        double top = mid - waveform.high[i] * half;
+        double bottom = mid - waveform.low[i] * half;
+        p->fillRect(QRectF(left, top, right - left, std::max(1.0, bottom - top)), peakColor);
+        double rms = waveform.rms[i] * half;
+        p->fillRect(QRectF(left, mid - rms, right - left, std::max(1.0, rms * 2)), rmsColor);
+    }
+}
+
 void MediaSlider::makeHandle()
 {
     qreal pr = devicePixelRatioF();
@@ -439,8 +545,7 @@ void MediaSlider::updateLoopArea()
     double left = valueToX(vLoopA);
     double right = valueToX(vLoopB);
     loopArea = {left, grooveArea.top() + 1, right - left, grooveArea.height() - 2};
-    makeBackground();
-    update();
+    invalidateBackground();
 }
 
 QString MediaSlider::valueToTickText(double value)
@@ -10,6 +10,7 @@
 #include <QWidget>
 #include <QImage>
 #include <QMouseEvent>
+#include "waveform.h"
 
 class DrawnSlider : public QWidget {
     Q_OBJECT
@@ -22,9 +23,13 @@ public:
     double value();
     double maximum();
     double minimum();
+    // Whether the mouse has moved since the button was pressed, for the
+    // drag in progress or else the last one.
+    bool dragMoved();
 
 signals:
     void sliderMoved(double v);
+    void sliderReleased(double v);
 
 public slots:
     void setHighContrast(bool enabled);
@@ -38,16 +43,22 @@ protected:
     virtual void makeBackground() = 0;
     virtual void makeHandle() = 0;
     virtual void handleHover(double x);
+    // The background is only remade when something drawn in it changed
+    void invalidateBackground();
 
     double valueToX(double value);
     double xToValue(double x);
 
     void paintEvent(QPaintEvent *event);
     void resizeEvent(QResizeEvent *event);
+    void changeEvent(QEvent *event);
 
     bool highContrast = false;
     bool redrawHandle = true;
+    bool redrawBackground = true;
+    bool recolor = true;
     QImage backgroundPic;
+    qreal backgroundRatio = 0;
     QImage handlePics[16];
 
     QRectF drawnArea;
@@ -59,11 +70,15 @@ protected:
     int handleWidth, handleHeight, marginX, marginY, paddingHeight;
 
 private:
+    void updateColors();
+    double handleX();
+    QRect handleRect(double x);
     void mousePressEvent(QMouseEvent *ev);
     void mouseReleaseEvent(QMouseEvent *ev);
     void mouseMoveEvent(QMouseEvent *ev);
 
     bool isDragging = false;
+    bool isDragMoved = false;
     double xPosition = 0.0;
 
     double vValue = 0.0;
@@ -80,6 +95,7 @@ public:
     void setTick(double value, QString text);
     void setLoopA(double a);
     void setLoopB(double b);
+    void setWaveform(const Waveform &waveform);
     double loopA();
     double loopB();
 
@@ -97,9 +113,11 @@ protected:
     void handleHover(double x);
 
     void updateLoopArea();
+    void drawWaveform(QPainter *p);
 
     QString valueToTickText(double value);
     QMap<double, QString> ticks;
+    Waveform waveform;
     double vLoopA = -1;
     double vLoopB = -1;
     QRectF loopArea = { -1, -1, 0, 0};
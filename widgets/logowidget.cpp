@@ -51,7 +51,7 @@ void LogoDrawer::resizeGL(int w, int h, qreal pixelRatio)
     logoLocation = QRectF(lx, ly, lw, lh);
 }
 
-void LogoDrawer::paintGL(QOpenGLWidget *widget)
+void LogoDrawer::paintGL(QWidget *widget)
 {
     QPainter painter(widget);
     QRect bgRect = {0, 0, widget->width(), widget->height()};
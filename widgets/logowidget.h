@@ -12,7 +12,7 @@ public:
     void setLogoUrl(const QString &filename);
     void setLogoBackground(const QColor &color);
     void resizeGL(int w, int h, qreal pixelRatio);
-    void paintGL(QOpenGLWidget *widget);
+    void paintGL(QWidget *widget);
 
 signals:
     void logoSize(QSize size);
@@ -158,7 +158,12 @@ QVariant PaletteEditor::variant()
 
 QPalette PaletteEditor::variantToPalette(const QVariant &v)
 {
-    QPalette p = system;
+    return variantToPalette(v, system);
+}
+
+QPalette PaletteEditor::variantToPalette(const QVariant &v, const QPalette &base)
+{
+    QPalette p = base;
     QVariantList array = v.toList();
     RoleLabels::ConstIterator it;
     QVariant defaultValue("#000000");
@@ -194,6 +199,13 @@ void PaletteEditor::setPalette(const QPalette &pal)
     emit paletteChanged(selected);
 }
 
+void PaletteEditor::setSystemPalette(const QPalette &pal)
+{
+    // The application palette may have been replaced by the time this editor
+    // is made, so the one from before that is handed down instead.
+    system = pal;
+}
+
 void PaletteEditor::setVariant(const QVariant &value)
 {
     setPalette(variantToPalette(value));
@@ -47,7 +47,8 @@ public:
     // custom variant et al routines are needed for json serialisation
     QVariant variant();
     QPalette variantToPalette(const QVariant &v);
-    QVariant paletteToVariant(const QPalette &p);
+    static QPalette variantToPalette(const QVariant &v, const QPalette &base);
+    static QVariant paletteToVariant(const QPalette &p);
 
 signals:
     void paletteChanged(QPalette pal);
@@ -55,6 +56,7 @@ signals:
 
 public slots:
     void setPalette(const QPalette &pal);
+    void setSystemPalette(const QPalette &pal);
     void setVariant(const QVariant &value);
     void resetPalette();
 
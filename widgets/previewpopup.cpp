@@ -0,0 +1,75 @@
+#include <QPainter>
+#include <algorithm>
+#include <QScreen>
+#include "previewpopup.h"
+
+constexpr int popupPadding = 3;
+
+PreviewPopup::PreviewPopup(QWidget *parent)
+    : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint)
+{
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+void PreviewPopup::setImage(const QImage &image)
+{
+    this->image = image;
+    updateSize();
+    update();
+}
+
+void PreviewPopup::setText(const QString &text)
+{
+    if (this->text == text)
+        return;
+    this->text = text;
+    updateSize();
+    update();
+}
+
+void PreviewPopup::showAt(const QPoint &anchor, bool above)
+{
+    this->anchor = anchor;
+    this->above = above;
+
+    // Center horizontally on the anchor, and keep within the screen
+    QPoint where(anchor.x() - width() / 2, above ? anchor.y() - height() : anchor.y());
+    if (QScreen *screen = QWidget::screen()) {
+        QRect avail = screen->availableGeometry();
+        where.setX(std::clamp(where.x(), avail.left(), std::max(avail.left(), avail.right() - width())));
+    }
+    move(where);
+    if (!isVisible())
+        show();
+}
+
+void PreviewPopup::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    QPainter p(this);
+    p.fillRect(rect(), palette().toolTipBase());
+    p.setPen(palette().toolTipText().color());
+    p.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    int y = popupPadding;
+    if (!image.isNull()) {
+        p.drawImage(QPoint((width() - image.width()) / 2, y), image);
+        y += image.height();
+    }
+    QRect textRect(popupPadding, y, width() - 2 * popupPadding, height() - y - popupPadding);
+    p.drawText(textRect, Qt::AlignCenter, text);
+}
+
+void PreviewPopup::updateSize()
+{
+    QSize textSize = fontMetrics().size(0, text);
+    int w = std::max(image.width(), textSize.width()) + 2 * popupPadding;
+    int h = image.height() + textSize.height() + 2 * popupPadding;
+    if (size() == QSize(w, h))
+        return;
+    resize(w, h);
+    // Stay attached to the anchor as we grow or shrink
+    if (isVisible())
+        showAt(anchor, above);
+}
@@ -0,0 +1,30 @@
+#ifndef PREVIEWPOPUP_H
+#define PREVIEWPOPUP_H
+
+#include <QImage>
+#include <QWidget>
+
+// A tooltip-like window showing a preview frame with a caption beneath it.
+class PreviewPopup : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PreviewPopup(QWidget *parent = nullptr);
+
+    void setImage(const QImage &image);
+    void setText(const QString &text);
+    void showAt(const QPoint &anchor, bool above);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    void updateSize();
+
+    QImage image;
+    QString text;
+    QPoint anchor;
+    bool above = true;
+};
+
+#endif // PREVIEWPOPUP_H